@@ -0,0 +1,58 @@
+//
+// ImageDecoder.cpp
+//
+#include "ImageDecoder.hpp"
+
+#include <string>
+
+#include <windows.h>
+#include <wincodec.h>
+#include <wrl.h>
+
+using Microsoft::WRL::ComPtr;
+
+
+//---------------------------------------------------------------------------------------
+bool DecodeImage (
+	const char * path,
+	std::vector<byte> & pixels,
+	uint32 & width,
+	uint32 & height
+) {
+	ComPtr<IWICImagingFactory> factory;
+	if (FAILED (CoCreateInstance (CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+		IID_PPV_ARGS (&factory))))
+	{
+		return false;
+	}
+
+	const std::string narrowPath (path);
+	const std::wstring widePath (narrowPath.begin (), narrowPath.end ());
+
+	ComPtr<IWICBitmapDecoder> decoder;
+	ComPtr<IWICBitmapFrameDecode> frame;
+	ComPtr<IWICFormatConverter> converter;
+	if (FAILED (factory->CreateDecoderFromFilename (widePath.c_str (), nullptr, GENERIC_READ,
+			WICDecodeMetadataCacheOnDemand, &decoder)) ||
+		FAILED (decoder->GetFrame (0, &frame)) ||
+		FAILED (factory->CreateFormatConverter (&converter)) ||
+		FAILED (converter->Initialize (frame.Get (), GUID_WICPixelFormat32bppRGBA,
+			WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+	{
+		return false;
+	}
+
+	UINT frameWidth;
+	UINT frameHeight;
+	if (FAILED (converter->GetSize (&frameWidth, &frameHeight)) ||
+		frameWidth == 0 || frameHeight == 0)
+	{
+		return false;
+	}
+
+	width = frameWidth;
+	height = frameHeight;
+	pixels.resize (size_t (width) * height * 4);
+	return SUCCEEDED (converter->CopyPixels (nullptr, width * 4,
+		static_cast<UINT>(pixels.size ()), pixels.data ()));
+}
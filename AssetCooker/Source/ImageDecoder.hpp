@@ -0,0 +1,19 @@
+//
+// ImageDecoder.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+
+
+/// Decodes the image file at path, in any format Windows Imaging Component supports,
+/// into 8-bit RGBA pixels.  COM must be initialized on the calling thread.  Returns false
+/// if the file could not be decoded.
+bool DecodeImage (
+	const char * path,
+	std::vector<byte> & pixels,
+	uint32 & width,
+	uint32 & height
+);
@@ -0,0 +1,251 @@
+//
+// Main.cpp
+//
+// Converts source assets into the binary formats the engine loads at runtime.
+//
+//     AssetCooker <asset directory> <output directory> [<compiled shader directory>]
+//
+// Every file below the asset directory is cooked according to its extension, and the
+// cooked assets are written to Assets.pack in the output directory:
+//     .obj  A .mesh of indexed vertices, and a .material for the material it uses.
+//     .png  A .texture of RGBA8 pixels and their mip levels.
+//     .cso  A .shader of compiled shader bytecode.
+// Compiled shaders are also cooked from the compiled shader directory, if given.
+//
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <objbase.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Core/AssetLocator.hpp"
+#include "Core/CookedAsset.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Logger.hpp"
+#include "Core/ObjParser.hpp"
+#include "Core/PackFile.hpp"
+
+#include "ImageDecoder.hpp"
+
+
+namespace
+{
+	/// Invokes visit(path) for every file below directory.
+	template <typename Function>
+	void forEachFile (
+		const std::string & directory,
+		const Function & visit
+	) {
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA ((directory + "\\*").c_str (), &data);
+		if (find == INVALID_HANDLE_VALUE) {
+			return;
+		}
+
+		do {
+			const std::string name (data.cFileName);
+			if (name == "." || name == "..") {
+				continue;
+			}
+
+			const std::string path = directory + "\\" + name;
+			if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				forEachFile (path, visit);
+			} else {
+				visit (path);
+			}
+		} while (FindNextFileA (find, &data));
+
+		FindClose (find);
+	}
+
+
+	class Cooker {
+	public:
+		explicit Cooker (
+			const std::string & assetDirectory
+		)
+			: _assetDirectory (assetDirectory),
+			  _jobSystem (JobSystem::DefaultWorkerThreadCount ()),
+			  _cooked (0),
+			  _failed (0)
+		{
+
+		}
+
+		/// Cooks the file at path if it is of a kind of source asset.
+		void cook (
+			const std::string & path
+		) {
+			const std::string extension = GetPathExtension (path);
+			bool cooked = true;
+			if (extension == "obj") {
+				cooked = cookMesh (path);
+			} else if (extension == "png") {
+				cooked = cookTexture (path);
+			} else if (extension == "cso") {
+				cooked = cookShader (path);
+			} else {
+				return;
+			}
+
+			if (cooked) {
+				++_cooked;
+			} else {
+				std::fprintf (stderr, "Failed to cook %s\n", path.c_str ());
+				++_failed;
+			}
+		}
+
+		uint cookedCount () const
+		{
+			return _cooked;
+		}
+
+		uint failedCount () const
+		{
+			return _failed;
+		}
+
+		/// Writes every asset cooked to the pack file at path.
+		bool writePack (
+			const std::string & path
+		) const {
+			if (!_pack.write (path.c_str ())) {
+				std::fprintf (stderr, "Unable to write %s\n", path.c_str ());
+				return false;
+			}
+
+			std::printf ("Wrote %u assets to %s\n", _pack.numAssets (), path.c_str ());
+			return true;
+		}
+
+	private:
+		bool cookMesh (
+			const std::string & path
+		) {
+			// Material libraries not beside their mesh are found in the Materials directory.
+			const std::string materialDirectory = _assetDirectory + "\\Materials";
+			std::vector<byte> materialBlob;
+			if (!CookObjFile (path.c_str (), materialDirectory.c_str (), &_jobSystem, _blob,
+				materialBlob))
+			{
+				return false;
+			}
+
+			const std::string name = GetPathBaseName (path);
+			if (!write (name, CookedAssetType::Mesh)) {
+				return false;
+			}
+
+			_blob.swap (materialBlob);
+			return _blob.empty () || write (name, CookedAssetType::Material);
+		}
+
+		bool cookTexture (
+			const std::string & path
+		) {
+			std::vector<byte> pixels;
+			uint32 width;
+			uint32 height;
+			if (!DecodeImage (path.c_str (), pixels, width, height)) {
+				return false;
+			}
+
+			CookTexture (pixels.data (), width, height, _blob);
+			return write (GetPathBaseName (path), CookedAssetType::Texture);
+		}
+
+		bool cookShader (
+			const std::string & path
+		) {
+			std::vector<char> byteCode;
+			if (!ReadWholeFile (path.c_str (), byteCode)) {
+				return false;
+			}
+
+			CookShader (reinterpret_cast<const byte *>(byteCode.data ()), byteCode.size (), _blob);
+			return write (GetPathBaseName (path), CookedAssetType::Shader);
+		}
+
+		/// Adds the blob last cooked to the pack as the asset called name.  Fails if
+		/// another asset has the same name, or a name with the same hash.
+		bool write (
+			const std::string & name,
+			CookedAssetType type
+		) {
+			const std::string fileName = name + CookedExtension (type);
+			if (!_pack.add (fileName.c_str (), _blob.data (), _blob.size ())) {
+				std::fprintf (stderr, "Unable to add %s to pack\n", fileName.c_str ());
+				return false;
+			}
+
+			std::printf ("Cooked %s (%zu bytes)\n", fileName.c_str (), _blob.size ());
+			return true;
+		}
+
+		const std::string _assetDirectory;
+		JobSystem _jobSystem;
+		std::vector<byte> _blob;
+		PackWriter _pack;
+		uint _cooked;
+		uint _failed;
+	};
+}
+
+
+//---------------------------------------------------------------------------------------
+int main (
+	int argc,
+	char ** argv
+) {
+	if (argc < 3) {
+		std::fprintf (stderr, "Usage: AssetCooker <asset directory> <output directory> "
+			"[<compiled shader directory>]\n");
+		return 1;
+	}
+
+	// Windows Imaging Component, used to decode images, is a COM library.
+	if (FAILED (CoInitializeEx (nullptr, COINIT_MULTITHREADED))) {
+		std::fprintf (stderr, "Unable to initialize COM\n");
+		return 1;
+	}
+
+	const std::string assetDirectory (argv[1]);
+	const std::string outputDirectory (argv[2]);
+	CreateDirectoryA (outputDirectory.c_str (), nullptr);
+
+	uint cooked = 0;
+	uint failed = 0;
+	{
+		Cooker cooker (assetDirectory);
+		forEachFile (assetDirectory, [&cooker] (const std::string & path) {
+			cooker.cook (path);
+		});
+
+		if (argc > 3) {
+			forEachFile (argv[3], [&cooker] (const std::string & path) {
+				if (GetPathExtension (path) == "cso") {
+					cooker.cook (path);
+				}
+			});
+		}
+
+		cooked = cooker.cookedCount ();
+		failed = cooker.failedCount ();
+		if (!cooker.writePack (outputDirectory + "\\Assets.pack")) {
+			++failed;
+		}
+	}
+
+	// Write any errors the engine logged while cooking.
+	Logger::Flush ();
+	std::printf ("%u assets cooked, %u failed\n", cooked, failed);
+
+	CoUninitialize ();
+	return failed > 0 ? 1 : 0;
+}
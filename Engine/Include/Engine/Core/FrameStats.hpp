@@ -0,0 +1,211 @@
+//
+// FrameStats.hpp
+//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+
+/// Log-linear histogram of durations in microseconds, in the style of HdrHistogram.
+///
+/// Durations below 256 µs are counted exactly.  Above that each power of two is split
+/// into 128 equal buckets, so any reported value is within 0.8% of the recorded one
+/// while memory stays fixed however many values are recorded.
+class DurationHistogram {
+public:
+	/// Durations are clamped to this many microseconds, a little over an hour.
+	static const uint64 MAX_MICROSECONDS = 0xFFFFFFFF;
+
+	DurationHistogram ();
+
+	void record (
+		uint64 microseconds
+	);
+
+	/// Adds every value recorded in other.
+	void add (
+		const DurationHistogram & other
+	);
+
+	void reset ();
+
+	uint64 count () const;
+
+	uint64 maxValue () const;
+
+	double mean () const;
+
+	/// Smallest recorded value that percentile percent of values are less than or equal
+	/// to, to within the histogram's precision.
+	/// @param percentile - in the range [0, 100].
+	uint64 valueAtPercentile (
+		double percentile
+	) const;
+
+private:
+	std::vector<uint64> _counts;
+	uint64 _count;
+	uint64 _max;
+	uint64 _total;
+};
+
+
+/// Distribution of durations over a number of frames, in milliseconds.
+struct FrameStatsSummary {
+	uint64 frames;
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+	double p999;
+	double max;
+};
+
+
+/// Statistics for a contiguous run of frames, spanning the most recent intervals when
+/// it was completed.  Consecutive windows overlap by all but one interval.
+struct FrameStatsWindow {
+	uint64 firstFrame;
+
+	// Sum of frame durations within the window, in milliseconds.
+	double milliseconds;
+
+	FrameStatsSummary frame;
+	FrameStatsSummary tick;
+	uint64 hitches;
+};
+
+
+/// A single frame that took longer than the hitch threshold.
+struct FrameHitch {
+	uint64 frame;
+	double frameMilliseconds;
+	double tickMilliseconds;
+};
+
+
+/// Records the duration of every frame, and of the game tick within it, so that tail
+/// latency can be reported rather than an average that hides stutter.
+///
+/// Frames are grouped into intervals of roughly equal duration, each with its own
+/// histograms.  As each interval completes, the histograms of the most recent intervals
+/// are merged into a rolling window, so a stutter stays in view for the whole window
+/// rather than vanishing at the next boundary.  Percentiles are kept for the most recent
+/// completed windows and for the whole run, and frames exceeding the hitch thresholds
+/// are recorded individually.  Everything can be exported as CSV or JSON.
+class FrameStats {
+public:
+	/// Hitches recorded individually.  Later hitches are only counted.
+	static const uint32 MAX_HITCHES = 4096;
+
+	/// Completed windows kept, about 17 minutes of the default intervals.  Older windows
+	/// are overwritten, but stay counted in the whole-run summaries.
+	static const uint32 MAX_WINDOWS = 4096;
+
+	/// @param intervalMilliseconds - frame time summed into each interval, after which
+	/// a window is completed.
+	/// @param hitchMilliseconds - frames longer than this are hitches.
+	/// @param hitchMedianFactor - frames longer than this multiple of the previous
+	/// window's median are also hitches.  Zero disables the relative threshold.
+	/// @param windowIntervals - number of most recent intervals spanned by each window.
+	explicit FrameStats (
+		double intervalMilliseconds = 250.0,
+		double hitchMilliseconds = 50.0,
+		double hitchMedianFactor = 2.5,
+		uint windowIntervals = 4
+	);
+
+	void setHitchThresholds (
+		double hitchMilliseconds,
+		double hitchMedianFactor
+	);
+
+	/// Records one frame, returning true if it completed an interval, and so a window.
+	/// @param frameMilliseconds - time since the previous frame.
+	/// @param tickMilliseconds - portion of the frame spent updating the game.
+	bool recordFrame (
+		double frameMilliseconds,
+		double tickMilliseconds
+	);
+
+	uint64 frameCount () const;
+
+	/// Distribution of frame durations over every recorded frame.
+	FrameStatsSummary frameSummary () const;
+
+	/// Distribution of tick durations over every recorded frame.
+	FrameStatsSummary tickSummary () const;
+
+	/// Number of completed windows kept, at most MAX_WINDOWS.
+	uint windowCount () const;
+
+	/// Completed window at index, oldest first.
+	const FrameStatsWindow & window (
+		uint index
+	) const;
+
+	/// Total number of windows completed, including any overwritten.
+	uint64 completedWindowCount () const;
+
+	/// Total number of hitches, including any beyond MAX_HITCHES.
+	uint64 hitchCount () const;
+
+	const std::vector<FrameHitch> & hitches () const;
+
+	/// One row per completed window kept, numbered from the first window of the run.
+	std::string csv () const;
+
+	/// Whole-run summaries, completed windows and hitches as a single JSON object.
+	std::string json () const;
+
+	/// Writes csv() to the file at path, returning false on failure.
+	bool saveCsv (
+		const char * path
+	) const;
+
+	/// Writes json() to the file at path, returning false on failure.
+	bool saveJson (
+		const char * path
+	) const;
+
+private:
+	/// Frames recorded during one interval.
+	struct Interval {
+		DurationHistogram frames;
+		DurationHistogram ticks;
+		uint64 firstFrame;
+		double milliseconds;
+		uint64 hitches;
+	};
+
+	/// Merges the most recent intervals into a window, then starts the next interval.
+	void completeInterval ();
+
+	double _intervalMilliseconds;
+	double _hitchMilliseconds;
+	double _hitchMedianFactor;
+
+	DurationHistogram _frames;
+	DurationHistogram _ticks;
+
+	// Ring of the most recent intervals, the last of which is being recorded.
+	std::vector<Interval> _intervals;
+	uint _currentInterval;
+	uint64 _completedIntervals;
+
+	// Merged histograms of the intervals within a window, kept to reuse their storage.
+	DurationHistogram _windowFrames;
+	DurationHistogram _windowTicks;
+
+	uint64 _frameCount;
+
+	// Ring of the most recent windows.  Once full, the oldest is at
+	// _completedIntervals % MAX_WINDOWS.
+	std::vector<FrameStatsWindow> _windows;
+
+	uint64 _hitchCount;
+	std::vector<FrameHitch> _hitches;
+};
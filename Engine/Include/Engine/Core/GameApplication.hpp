@@ -11,7 +11,13 @@
 #include "Core/Types.hpp"
 #include "Core/InputHandler.hpp"
 
+class HotReloader;
 class IRenderer;
+class JobSystem;
+class RenderThread;
+class TaskGraph;
+struct InputEvent;
+template <typename T> class SpscQueue;
 
 class GameApplication {
 public:
@@ -21,6 +27,9 @@ public:
 		const char * windowTitle
 	);
 
+	/// Stops the render thread and job system, and unmounts the pack file.
+	~GameApplication ();
+
 	const char * getWindowTitle() const;
 
 	uint getWindowWidth () const;
@@ -31,10 +40,14 @@ public:
 		HWND hWindow
 	);
 
+	/// Queues a key event for the next update().  Must only be called from the thread
+	/// that runs the window's message loop.
 	void keyDown (
 		uint8 virtualKey
 	);
 
+	/// Queues a key event for the next update().  Must only be called from the thread
+	/// that runs the window's message loop.
 	void keyUp (
 		uint8 virtualKey
 	);
@@ -43,10 +56,43 @@ public:
 
 
 private:
+	/// Declares the tasks making up each frame and their dependencies.
+	void buildFrameGraph ();
+
+	/// Applies input events queued since the last frame.
+	void processInput ();
+
+	/// Saves a profile capture that has ended, then begins one if it was requested.
+	/// Called between frames.
+	void updateCapture ();
+
 	uint _windowWidth;
 	uint _windowHeight;
 	const char * _windowTitle;
 
 	InputHandler _inputHandler;
+
+	// Input events from the window thread, drained at the start of each update().
+	std::shared_ptr<SpscQueue<InputEvent>> _inputEvents;
 	std::shared_ptr<IRenderer> _renderer;
+	std::shared_ptr<JobSystem> _jobSystem;
+
+	// Declared after _renderer, so the render thread stops before the renderer is
+	// destroyed.
+	std::shared_ptr<RenderThread> _renderThread;
+
+	// Declared after _jobSystem, which executes it.
+	std::shared_ptr<TaskGraph> _frameGraph;
+
+#if defined(_DEBUG)
+	// Recooks source assets as they are saved, between frames.
+	std::shared_ptr<HotReloader> _hotReloader;
+#endif
+
+	uint64 _frameCount;
+
+	// Set by processInput() when a profile capture is requested, and while one is in
+	// progress.
+	bool _captureRequested;
+	bool _capturing;
 };
@@ -3,4 +3,5 @@
 //
 #pragma once
 
+#include "Core/FrameStats.hpp"
 #include "Core/GameApplication.hpp"
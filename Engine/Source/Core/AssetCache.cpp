@@ -0,0 +1,187 @@
+//
+// AssetCache.cpp
+//
+#include "pch.h"
+
+#include "Core/AssetCache.hpp"
+
+#include <cstring>
+
+const uint32 AssetCache::MAX_TYPES;
+const size_t AssetCache::UNLIMITED;
+
+
+//---------------------------------------------------------------------------------------
+AssetCache::AssetCache ()
+{
+	std::memset (_stats, 0, sizeof (_stats));
+	for (AssetCacheStats & stats : _stats) {
+		stats.budget = UNLIMITED;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+AssetCache::~AssetCache ()
+{
+	clear ();
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::setBudget (
+	uint32 type,
+	size_t bytes
+) {
+	assert (type < MAX_TYPES);
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		_stats[type].budget = bytes;
+	}
+	trim (type);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::setEvictionCallback (
+	uint32 type,
+	EvictionCallback callback
+) {
+	assert (type < MAX_TYPES);
+	std::lock_guard<std::mutex> lock (_mutex);
+	_callbacks[type] = std::move (callback);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::setSize (
+	uint64 key,
+	size_t size
+) {
+	std::lock_guard<std::mutex> lock (_mutex);
+	auto found = _index.find (key);
+	if (found == _index.end ()) {
+		return;
+	}
+
+	Entry & entry = *found->second;
+	AssetCacheStats & stats = _stats[entry.type];
+	stats.size = stats.size - entry.size + size;
+	entry.size = size;
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::trim ()
+{
+	for (uint32 type (0); type < MAX_TYPES; ++type) {
+		trim (type);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::trim (
+	uint32 type
+) {
+	std::vector<Evicted> evicted;
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		evict (type, evicted);
+	}
+	release (evicted);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::clear ()
+{
+	std::vector<Evicted> evicted;
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		for (uint32 type (0); type < MAX_TYPES; ++type) {
+			for (Entry & entry : _entries[type]) {
+				evicted.push_back (Evicted {entry.record, _callbacks[type]});
+			}
+			_entries[type].clear ();
+
+			AssetCacheStats & stats = _stats[type];
+			const size_t budget = stats.budget;
+			std::memset (&stats, 0, sizeof (stats));
+			stats.budget = budget;
+		}
+		_index.clear ();
+	}
+	release (evicted);
+}
+
+//---------------------------------------------------------------------------------------
+AssetCacheStats AssetCache::stats (
+	uint32 type
+) const {
+	assert (type < MAX_TYPES);
+	std::lock_guard<std::mutex> lock (_mutex);
+	return _stats[type];
+}
+
+//---------------------------------------------------------------------------------------
+AssetRecord * AssetCache::find (
+	uint64 key,
+	uint32 type
+) {
+	auto found = _index.find (key);
+	if (found == _index.end ()) {
+		++_stats[type].misses;
+		return nullptr;
+	}
+
+	std::list<Entry> & entries = _entries[type];
+	assert (found->second->type == type);
+	entries.splice (entries.begin (), entries, found->second);
+	++_stats[type].hits;
+	return found->second->record;
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::add (
+	uint64 key,
+	uint32 type,
+	AssetRecord * record
+) {
+	record->addReference ();
+	_entries[type].push_front (Entry {key, type, record, 0});
+	_index.emplace (key, _entries[type].begin ());
+	++_stats[type].numAssets;
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::evict (
+	uint32 type,
+	std::vector<Evicted> & evicted
+) {
+	AssetCacheStats & stats = _stats[type];
+	std::list<Entry> & entries = _entries[type];
+
+	auto entry = entries.end ();
+	while (stats.size > stats.budget && entry != entries.begin ()) {
+		--entry;
+
+		// Only the cache's reference remains, and no other can be taken without _mutex,
+		// as every handle to the record would add to the count.
+		if (entry->record->referenceCount () > 1) {
+			continue;
+		}
+
+		evicted.push_back (Evicted {entry->record, _callbacks[type]});
+		stats.size -= entry->size;
+		--stats.numAssets;
+		++stats.evictions;
+		_index.erase (entry->key);
+		entry = entries.erase (entry);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void AssetCache::release (
+	std::vector<Evicted> & evicted
+) {
+	for (Evicted & asset : evicted) {
+		if (asset.callback && asset.record->state () == AssetState::Ready) {
+			asset.callback (*asset.record);
+		}
+		asset.record->removeReference ();
+	}
+}
@@ -0,0 +1,167 @@
+//
+// AssetCache.hpp
+//
+#pragma once
+
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/AssetHandle.hpp"
+#include "Core/Types.hpp"
+
+
+/// Counters of one type of asset in an AssetCache.
+struct AssetCacheStats {
+	/// Acquires that found the asset cached.
+	uint64 hits;
+
+	/// Acquires that added the asset, to be loaded.
+	uint64 misses;
+
+	/// Assets evicted to keep within the budget.
+	uint64 evictions;
+
+	uint32 numAssets;
+
+	/// Bytes held by the assets cached, and the most they should hold.
+	size_t size;
+	size_t budget;
+};
+
+
+/// Keeps a reference to every asset loaded, keyed by a 64-bit hash, so that each is
+/// loaded once.  Each asset counts its size against the memory budget of its type.
+/// While a type is over its budget, assets of it that nothing else references are
+/// evicted, least recently acquired first, invoking the type's eviction callback so that
+/// resources made from them can be released.
+///
+/// Eviction happens when an asset is added to a type over its budget, or when trim()
+/// is called, on the calling thread.  An asset's size is only known once it has loaded,
+/// so a type can briefly exceed its budget until the next of either.
+///
+/// All methods are thread safe.
+class AssetCache {
+public:
+	/// Number of types of asset, each with its own budget.
+	static const uint32 MAX_TYPES = 8;
+
+	/// Budget of each type until one is set.
+	static const size_t UNLIMITED = ~size_t (0);
+
+	/// Invoked with each ready asset evicted, before the cache's reference to it is
+	/// removed.
+	typedef std::function<void (AssetRecord & record)> EvictionCallback;
+
+	AssetCache ();
+
+	~AssetCache ();
+
+	/// Sets the most bytes the assets of type should hold, evicting assets of it until
+	/// they do, if they can.
+	void setBudget (
+		uint32 type,
+		size_t bytes
+	);
+
+	void setEvictionCallback (
+		uint32 type,
+		EvictionCallback callback
+	);
+
+	/// Returns a handle to the asset cached under key, marking it most recently used.
+	/// If there is none, a new Loading record of type is added under key, and added is
+	/// set so that the caller loads it.
+	template <typename T>
+	AssetHandle<T> acquire (
+		uint64 key,
+		uint32 type,
+		bool & added
+	);
+
+	/// Returns a handle to the asset cached under key, or an invalid handle if there is
+	/// none, without counting a hit or marking it used.
+	template <typename T>
+	AssetHandle<T> cached (
+		uint64 key
+	) const;
+
+	/// Sets the size of the asset cached under key, once it has loaded or reloaded.  Does nothing if
+	/// it has already been evicted.
+	void setSize (
+		uint64 key,
+		size_t size
+	);
+
+	/// Evicts unreferenced assets from every type over its budget.
+	void trim ();
+
+	/// Removes every asset, referenced or not, invoking the eviction callback of each.
+	/// Counters other than the budget are reset.
+	void clear ();
+
+	AssetCacheStats stats (
+		uint32 type
+	) const;
+
+	/// Forbid copying of AssetCache objects.
+	AssetCache (const AssetCache & other) = delete;
+	AssetCache & operator = (const AssetCache & other) = delete;
+
+private:
+	struct Entry {
+		uint64 key;
+		uint32 type;
+		AssetRecord * record;
+		size_t size;
+	};
+
+	struct Evicted {
+		AssetRecord * record;
+		EvictionCallback callback;
+	};
+
+	// Called with _mutex held.  Returns the record cached under key, counting a hit, or
+	// nullptr, counting a miss.
+	AssetRecord * find (
+		uint64 key,
+		uint32 type
+	);
+
+	// Called with _mutex held.  Adds a reference to record, cached under key.
+	void add (
+		uint64 key,
+		uint32 type,
+		AssetRecord * record
+	);
+
+	// Called with _mutex held.  Moves unreferenced assets of type into evicted, least
+	// recently used first, until type is within its budget.
+	void evict (
+		uint32 type,
+		std::vector<Evicted> & evicted
+	);
+
+	// Invokes the callback of each record evicted, then removes the cache's reference.
+	static void release (
+		std::vector<Evicted> & evicted
+	);
+
+	void trim (
+		uint32 type
+	);
+
+	mutable std::mutex _mutex;
+
+	// Assets of each type, most recently used first.
+	std::list<Entry> _entries[MAX_TYPES];
+	std::unordered_map<uint64, std::list<Entry>::iterator> _index;
+
+	AssetCacheStats _stats[MAX_TYPES];
+	EvictionCallback _callbacks[MAX_TYPES];
+};
+
+
+#include "Core/AssetCache.inl"
@@ -0,0 +1,44 @@
+//
+// AssetCache.inl
+//
+#include <cassert>
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T> AssetCache::acquire (
+	uint64 key,
+	uint32 type,
+	bool & added
+) {
+	assert (type < MAX_TYPES);
+
+	AssetHandle<T> handle;
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		AssetRecord * record = find (key, type);
+		added = !record;
+		if (added) {
+			record = AssetRecordOf<T>::Create ();
+			add (key, type, record);
+		}
+		handle = AssetHandle<T> (static_cast<AssetRecordOf<T> *>(record));
+	}
+
+	if (added) {
+		trim (type);
+	}
+	return handle;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T> AssetCache::cached (
+	uint64 key
+) const {
+	std::lock_guard<std::mutex> lock (_mutex);
+	auto found = _index.find (key);
+	if (found == _index.end ()) {
+		return AssetHandle<T> ();
+	}
+	return AssetHandle<T> (static_cast<AssetRecordOf<T> *>(found->second->record));
+}
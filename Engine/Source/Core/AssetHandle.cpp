@@ -0,0 +1,99 @@
+//
+// AssetHandle.cpp
+//
+#include "pch.h"
+
+#include "Core/AssetHandle.hpp"
+
+
+//---------------------------------------------------------------------------------------
+AssetRecord::AssetRecord (
+	Destroy destroy
+)
+	: _destroy (destroy),
+	  _references (0),
+	  _state (AssetState::Loading),
+	  _version (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+AssetRecord::~AssetRecord ()
+{
+	assert (_references.load (std::memory_order_relaxed) == 0);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetRecord::addReference ()
+{
+	_references.fetch_add (1, std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetRecord::removeReference ()
+{
+	// Acquire, so the destroying thread sees every other thread's use of the asset.
+	if (_references.fetch_sub (1, std::memory_order_acq_rel) == 1) {
+		_destroy (this);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint32 AssetRecord::referenceCount () const
+{
+	return _references.load (std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------------------
+AssetState AssetRecord::state () const
+{
+	return _state.load (std::memory_order_acquire);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetRecord::complete (
+	bool loaded
+) {
+	std::vector<std::function<void ()>> continuations;
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		assert (_state.load (std::memory_order_relaxed) == AssetState::Loading);
+		_state.store (loaded ? AssetState::Ready : AssetState::Failed,
+			std::memory_order_release);
+		continuations.swap (_continuations);
+	}
+
+	for (std::function<void ()> & continuation : continuations) {
+		continuation ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void AssetRecord::then (
+	std::function<void ()> continuation
+) {
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		if (_state.load (std::memory_order_relaxed) == AssetState::Loading) {
+			_continuations.push_back (std::move (continuation));
+			return;
+		}
+	}
+
+	continuation ();
+}
+
+//---------------------------------------------------------------------------------------
+void AssetRecord::reloaded ()
+{
+	assert (_state.load (std::memory_order_relaxed) != AssetState::Loading);
+	_version.fetch_add (1, std::memory_order_release);
+	_state.store (AssetState::Ready, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+uint32 AssetRecord::version () const
+{
+	return _version.load (std::memory_order_acquire);
+}
@@ -0,0 +1,179 @@
+//
+// AssetHandle.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+
+enum class AssetState : uint8 {
+	Loading,
+	Ready,
+	Failed
+};
+
+
+/// Reference count, load state and continuations shared by every handle to an asset.
+/// The asset itself follows in the AssetRecordOf<T> derived from it, so an asset and
+/// its reference count take a single allocation.
+class AssetRecord {
+public:
+	void addReference ();
+
+	/// Removes a reference, destroying the record along with its asset if it was the
+	/// last.
+	void removeReference ();
+
+	uint32 referenceCount () const;
+
+	AssetState state () const;
+
+	/// Sets the state to Ready if loaded is true, or Failed otherwise, then invokes and
+	/// discards every continuation, on the calling thread.  Writes to the asset made
+	/// before complete() are visible to any thread that observes the new state.
+	void complete (
+		bool loaded
+	);
+
+	/// Invokes continuation once the record is complete.  If it already is,
+	/// continuation is invoked immediately on the calling thread.
+	void then (
+		std::function<void ()> continuation
+	);
+
+	/// Marks a complete record, whose asset has just been replaced in place by a newer
+	/// version, Ready, and increments its version.
+	void reloaded ();
+
+	/// Number of times the asset has been reloaded, so that users holding resources
+	/// made from it can tell when to remake them.
+	uint32 version () const;
+
+	/// Forbid copying of AssetRecord objects.
+	AssetRecord (const AssetRecord & other) = delete;
+	AssetRecord & operator = (const AssetRecord & other) = delete;
+
+protected:
+	typedef void (*Destroy) (AssetRecord * record);
+
+	/// Constructs a Loading record with no references, which destroy deletes.
+	explicit AssetRecord (
+		Destroy destroy
+	);
+
+	~AssetRecord ();
+
+private:
+	Destroy _destroy;
+	std::atomic<uint32> _references;
+	std::atomic<AssetState> _state;
+	std::atomic<uint32> _version;
+
+	std::mutex _mutex;
+	std::vector<std::function<void ()>> _continuations;
+};
+
+
+/// An AssetRecord holding an asset of type T.
+template <typename T>
+class AssetRecordOf : public AssetRecord {
+public:
+	/// Allocates a Loading record with a default constructed asset and no references.
+	static AssetRecordOf * Create ();
+
+	T asset;
+
+private:
+	AssetRecordOf ();
+
+	static void destroy (
+		AssetRecord * record
+	);
+};
+
+
+/// Intrusively reference counted handle to an asset of type T, which may still be
+/// loading.  Copying a handle adds a reference, and the asset is destroyed along with
+/// its last handle.  The asset can only be accessed once it is ready:
+///
+///     AssetHandle<ObjAsset> ship = AssetLoader::load<ObjAsset> (SHIP_MODEL);
+///     ship.then ([] (const AssetHandle<ObjAsset> & ship) {
+///         if (ship.isReady ()) { ... }
+///     });
+template <typename T>
+class AssetHandle {
+public:
+	/// Constructs a handle to no asset.
+	AssetHandle ();
+
+	/// Constructs a handle adding a reference to record.
+	explicit AssetHandle (
+		AssetRecordOf<T> * record
+	);
+
+	AssetHandle (
+		const AssetHandle & other
+	);
+
+	AssetHandle (
+		AssetHandle && other
+	);
+
+	~AssetHandle ();
+
+	AssetHandle & operator = (
+		AssetHandle other
+	);
+
+	/// Returns a handle to a new ready asset, default constructed rather than loaded.
+	static AssetHandle MakeReady ();
+
+	/// True if the handle refers to an asset, in any state.
+	bool isValid () const;
+
+	AssetState state () const;
+
+	bool isReady () const;
+
+	bool isLoading () const;
+
+	bool hasFailed () const;
+
+	/// Returns the asset if it is ready, or nullptr otherwise.  The asset stays at the
+	/// same address when it is reloaded.
+	const T * get () const;
+
+	const T * operator -> () const;
+
+	const T & operator * () const;
+
+	/// Invokes continuation with this handle once the asset has loaded or failed to,
+	/// on the thread that completes it, or immediately if it already has.
+	template <typename Function>
+	void then (
+		Function && continuation
+	) const;
+
+	uint32 version () const;
+
+	AssetRecordOf<T> * record () const;
+
+	bool operator == (
+		const AssetHandle & other
+	) const;
+
+	bool operator != (
+		const AssetHandle & other
+	) const;
+
+private:
+	AssetRecordOf<T> * _record;
+};
+
+
+#include "Core/AssetHandle.inl"
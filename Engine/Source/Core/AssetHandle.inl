@@ -0,0 +1,201 @@
+//
+// AssetHandle.inl
+//
+#include <cassert>
+#include <utility>
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetRecordOf<T> * AssetRecordOf<T>::Create ()
+{
+	return new AssetRecordOf<T> ();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetRecordOf<T>::AssetRecordOf ()
+	: AssetRecord (&AssetRecordOf<T>::destroy),
+	  asset ()
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+void AssetRecordOf<T>::destroy (
+	AssetRecord * record
+) {
+	delete static_cast<AssetRecordOf<T> *>(record);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T>::AssetHandle ()
+	: _record (nullptr)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T>::AssetHandle (
+	AssetRecordOf<T> * record
+)
+	: _record (record)
+{
+	if (_record) {
+		_record->addReference ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T>::AssetHandle (
+	const AssetHandle & other
+)
+	: AssetHandle (other._record)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T>::AssetHandle (
+	AssetHandle && other
+)
+	: _record (other._record)
+{
+	other._record = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T>::~AssetHandle ()
+{
+	if (_record) {
+		_record->removeReference ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T> & AssetHandle<T>::operator = (
+	AssetHandle other
+) {
+	std::swap (_record, other._record);
+	return *this;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetHandle<T> AssetHandle<T>::MakeReady ()
+{
+	AssetHandle handle (AssetRecordOf<T>::Create ());
+	handle._record->complete (true);
+	return handle;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::isValid () const
+{
+	return _record != nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetState AssetHandle<T>::state () const
+{
+	assert (_record);
+	return _record->state ();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::isReady () const
+{
+	return _record && _record->state () == AssetState::Ready;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::isLoading () const
+{
+	return _record && _record->state () == AssetState::Loading;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::hasFailed () const
+{
+	return _record && _record->state () == AssetState::Failed;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+const T * AssetHandle<T>::get () const
+{
+	return isReady () ? &_record->asset : nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+const T * AssetHandle<T>::operator -> () const
+{
+	assert (isReady ());
+	return &_record->asset;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+const T & AssetHandle<T>::operator * () const
+{
+	assert (isReady ());
+	return _record->asset;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+template <typename Function>
+void AssetHandle<T>::then (
+	Function && continuation
+) const {
+	assert (_record);
+
+	// The stored copy of the handle keeps the asset alive until continuation has run.
+	AssetHandle handle (*this);
+	_record->then ([handle, continuation] () {
+		continuation (handle);
+	});
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+uint32 AssetHandle<T>::version () const
+{
+	assert (_record);
+	return _record->version ();
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+AssetRecordOf<T> * AssetHandle<T>::record () const
+{
+	return _record;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::operator == (
+	const AssetHandle & other
+) const {
+	return _record == other._record;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetHandle<T>::operator != (
+	const AssetHandle & other
+) const {
+	return _record != other._record;
+}
@@ -0,0 +1,69 @@
+//
+// AssetId.cpp
+//
+#include "pch.h"
+
+#include "Core/AssetId.hpp"
+
+#if defined(_DEBUG)
+
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+	struct NameTable {
+		std::mutex mutex;
+		std::unordered_map<uint64, std::string> names;
+	};
+
+	NameTable & nameTable ()
+	{
+		static NameTable table;
+		return table;
+	}
+}
+
+#endif
+
+
+//---------------------------------------------------------------------------------------
+bool RegisterAssetName (
+	const AssetId & id
+) {
+#if defined(_DEBUG)
+	assert (id.name ());
+
+	NameTable & table = nameTable ();
+	std::lock_guard<std::mutex> lock (table.mutex);
+	auto inserted = table.names.emplace (id.hash (), id.name ());
+	if (!inserted.second && inserted.first->second != id.name ()) {
+		LOG_CATEGORY_ERROR (Assets, "Asset names %s and %s have the same hash.",
+			inserted.first->second.c_str (), id.name ());
+		return false;
+	}
+#else
+	// Names are only kept in debug builds.
+	(void) id;
+#endif
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+const char * FindAssetName (
+	uint64 hash
+) {
+#if defined(_DEBUG)
+	NameTable & table = nameTable ();
+	std::lock_guard<std::mutex> lock (table.mutex);
+	auto found = table.names.find (hash);
+	if (found != table.names.end ()) {
+		// Names are never removed, and node based maps do not move them, so the pointer
+		// remains valid.
+		return found->second.c_str ();
+	}
+#else
+	(void) hash;
+#endif
+	return nullptr;
+}
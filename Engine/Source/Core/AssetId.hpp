@@ -0,0 +1,101 @@
+//
+// AssetId.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+
+
+namespace asset_id
+{
+	const uint64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+	const uint64 FNV_PRIME = 1099511628211ull;
+
+	/// Continues the 64-bit FNV-1a hash of some text over text.  Evaluated at compile
+	/// time when text is a string literal in a constant expression.
+	constexpr uint64 Fnv1a (
+		const char * text,
+		uint64 hash = FNV_OFFSET_BASIS
+	) {
+		return *text == '\0' ? hash :
+			Fnv1a (text + 1, (hash ^ static_cast<byte>(*text)) * FNV_PRIME);
+	}
+}
+
+
+/// Identifies an asset by the hash of its name, so that looking one up compares a
+/// single integer.  Names given as string literals are hashed at compile time:
+///
+///     constexpr AssetId SHIP ("low_poly_ship");
+///
+/// Debug builds keep the name, and can find the name of any id they have registered.
+class AssetId {
+public:
+	constexpr AssetId (
+		const char * name
+	)
+		: _hash (asset_id::Fnv1a (name))
+#if defined(_DEBUG)
+		  , _name (name)
+#endif
+	{
+
+	}
+
+	constexpr uint64 hash () const
+	{
+		return _hash;
+	}
+
+	/// Hash of the name followed by extension, such as ".mesh", which is the key the
+	/// asset is stored under in a pack file.
+	constexpr uint64 hashWithExtension (
+		const char * extension
+	) const {
+		return asset_id::Fnv1a (extension, _hash);
+	}
+
+	/// The name the id was made from in debug builds, valid for as long as that string
+	/// is, and an empty string in release builds.
+	const char * name () const
+	{
+#if defined(_DEBUG)
+		return _name;
+#else
+		return "";
+#endif
+	}
+
+	constexpr bool operator == (
+		const AssetId & other
+	) const {
+		return _hash == other._hash;
+	}
+
+	constexpr bool operator != (
+		const AssetId & other
+	) const {
+		return _hash != other._hash;
+	}
+
+private:
+	uint64 _hash;
+
+#if defined(_DEBUG)
+	const char * _name;
+#endif
+};
+
+
+/// Records the name of id, so that FindAssetName can report it for the id's hash.  Logs
+/// an error, and returns false, if a different name with the same hash was registered
+/// before.  Does nothing in release builds.
+bool RegisterAssetName (
+	const AssetId & id
+);
+
+/// Returns the name registered for hash, or nullptr if there is none or this is a
+/// release build.
+const char * FindAssetName (
+	uint64 hash
+);
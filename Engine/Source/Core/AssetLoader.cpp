@@ -0,0 +1,124 @@
+//
+// AssetLoader.cpp
+//
+#include "pch.h"
+
+#include "Core/AssetLoader.hpp"
+
+
+//---------------------------------------------------------------------------------------
+AssetLoader::State::State ()
+	: jobSystem (nullptr)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+AssetLoader::State & AssetLoader::state ()
+{
+	static State loader;
+	return loader;
+}
+
+//---------------------------------------------------------------------------------------
+PackFile & AssetLoader::pack ()
+{
+	static PackFile packFile;
+	return packFile;
+}
+
+//---------------------------------------------------------------------------------------
+bool AssetLoader::mount (
+	const char * path
+) {
+	// Assets loaded from the pack mounted before lie in its mapping.
+	unmount ();
+	return pack ().open (path);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::unmount ()
+{
+	waitAll ();
+
+	State & loader = state ();
+	loader.assets.clear ();
+	{
+		std::lock_guard<std::mutex> lock (loader.replacedMutex);
+		loader.replaced.clear ();
+	}
+	pack ().close ();
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::setJobSystem (
+	JobSystem * jobSystem
+) {
+	waitAll ();
+	state ().jobSystem = jobSystem;
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::waitAll ()
+{
+	State & loader = state ();
+	if (loader.jobSystem) {
+		loader.jobSystem->wait (loader.loading);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::setBudget (
+	CookedAssetType type,
+	size_t bytes
+) {
+	state ().assets.setBudget (static_cast<uint32>(type), bytes);
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::trim ()
+{
+	state ().assets.trim ();
+}
+
+//---------------------------------------------------------------------------------------
+AssetCacheStats AssetLoader::stats (
+	CookedAssetType type
+) {
+	return state ().assets.stats (static_cast<uint32>(type));
+}
+
+//---------------------------------------------------------------------------------------
+void AssetLoader::replaceCooked (
+	AssetId assetId,
+	CookedAssetType type,
+	std::vector<byte> blob
+) {
+	State & loader = state ();
+	const uint64 key = assetId.hashWithExtension (CookedExtension (type));
+
+	// Moving a version into the list keeps its data where it is.
+	std::lock_guard<std::mutex> lock (loader.replacedMutex);
+	loader.replaced[key].push_back (std::move (blob));
+}
+
+//---------------------------------------------------------------------------------------
+const byte * AssetLoader::findCooked (
+	AssetId assetId,
+	CookedAssetType type,
+	size_t & size
+) {
+	State & loader = state ();
+	const uint64 key = assetId.hashWithExtension (CookedExtension (type));
+	{
+		std::lock_guard<std::mutex> lock (loader.replacedMutex);
+		auto found = loader.replaced.find (key);
+		if (found != loader.replaced.end ()) {
+			const std::vector<byte> & latest = found->second.back ();
+			size = latest.size ();
+			return latest.data ();
+		}
+	}
+
+	return pack ().find (key, size);
+}
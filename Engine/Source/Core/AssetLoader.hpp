@@ -3,21 +3,140 @@
 //
 #pragma once
 
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/AssetCache.hpp"
+#include "Core/AssetHandle.hpp"
+#include "Core/AssetId.hpp"
+#include "Core/CookedAsset.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/ObjParser.hpp"
+#include "Core/PackFile.hpp"
 #include "Graphics/RenderComponent.hpp"
 
 struct ObjAsset {
 	MeshComponent mesh;
 	Texture texture;
+	ObjMaterial material;
 };
 
-//TODO (Dustin) - Change all AssetIds to uint32 and hash Asset string names using CRC-32 algorithm.
-// Want to so something like AssetLoader::load(AssetId("shipModel"), ship);
-typedef const char * AssetId;
-
+/// Loads assets cooked by the AssetCooker from the mounted pack file.  Assets are used
+/// where they lie in the pack file's mapping, without being parsed or copied, so they
+/// remain valid until the pack file is unmounted.
+///
+/// load() returns a handle right away, while the asset is validated and prepared on the
+/// worker threads of the job system set with setJobSystem().  Callers poll the handle,
+/// or attach a continuation to it:
+///
+///     constexpr AssetId SHIP_MODEL ("low_poly_ship");
+///     AssetHandle<ObjAsset> ship = AssetLoader::load<ObjAsset> (SHIP_MODEL);
+///
+/// Each asset is loaded once, and cached while it is referenced.  Each type of cooked
+/// asset has a memory budget, counting the bytes of the pack file each asset is read
+/// from, and unreferenced assets are evicted once their type exceeds it:
+///
+///     AssetLoader::setBudget (CookedAssetType::Mesh, 64 << 20);
+///     AssetLoader::setEvictionCallback<ObjAsset> ([] (const ObjAsset & ship) { ... });
+///
+/// ObjAssets count against the Mesh budget, along with their material and texture.
 class AssetLoader {
 public:
-	template <typename AssetReturned>
-	static void load (AssetId assetId, AssetReturned * out);
+	/// Maps the pack file at path, from which all assets are loaded.  Returns false if
+	/// it could not be mapped.
+	static bool mount (const char * path);
+
+	/// Waits for every load to complete, evicts every asset loaded, referenced or not,
+	/// and unmaps the pack file.
+	static void unmount ();
+
+	/// Loads assets with jobs on jobSystem from now on, after waiting for those already
+	/// loading.  With no job system, assets are loaded by the thread calling load().
+	static void setJobSystem (JobSystem * jobSystem);
+
+	/// Begins loading the asset identified by assetId, returning a handle to it.  Loading
+	/// an asset already loaded, or loading, returns another handle to it.
+	///
+	/// Must be called from the thread that created the job system, or from a job.
+	template <typename T>
+	static AssetHandle<T> load (AssetId assetId);
+
+	/// Returns once handle has completed, executing jobs in the meantime, without
+	/// waiting for other loads.  Must not be called from a continuation.
+	template <typename T>
+	static void wait (const AssetHandle<T> & handle);
+
+	/// Returns once every load started has completed.
+	static void waitAll ();
+
+	/// Sets the most bytes the assets of type should hold, which is unlimited until set.
+	static void setBudget (CookedAssetType type, size_t bytes);
+
+	/// Sets the function invoked with each ready asset of type T as it is evicted, so
+	/// that resources made from it can be released.  Invoked on the thread that called
+	/// load() or trim().
+	template <typename T>
+	static void setEvictionCallback (std::function<void (const T & asset)> callback);
+
+	/// Evicts unreferenced assets of each type over its budget.  Called once a frame, so
+	/// that assets released during it are evicted even if no more are loaded.
+	static void trim ();
+
+	static AssetCacheStats stats (CookedAssetType type);
+
+	/// Reads the cooked asset assetId of type from blob, rather than from the pack file,
+	/// in every load and reload from now on.  Assets loaded from an earlier version
+	/// point into it, so every version is kept until the pack file is unmounted.
+	static void replaceCooked (AssetId assetId, CookedAssetType type, std::vector<byte> blob);
+
+	/// Reads the asset identified by assetId again, if it is loaded, and copies it over
+	/// the asset its handles refer to, which stays at the same address and becomes the
+	/// handles' next version.  Returns false if it is not loaded or could not be read,
+	/// leaving it as it was.
+	///
+	/// The asset is copied over while its handles may be read, so this must be called
+	/// between frames once no frame in flight reads it, such as after
+	/// RenderThread::flush(), from the thread that created the job system.
+	template <typename T>
+	static bool reload (AssetId assetId);
+
+private:
+	/// Type of the pack file entry each type of asset is loaded from.  Its extension
+	/// keys the asset in the loader's cache, and the type's budget holds the asset.
+	template <typename T>
+	static CookedAssetType cookedType ();
+
+	/// Reads the asset identified by assetId from the pack file into asset, and sets
+	/// size to the bytes of the pack file it was read from.  Returns false if it is
+	/// missing or invalid.
+	template <typename T>
+	static bool decode (AssetId assetId, T & asset, size_t & size);
+
+	static PackFile & pack ();
+
+	/// Returns the cooked asset assetId of type, from its latest replacement or from
+	/// the pack file, or nullptr if there is neither.
+	static const byte * findCooked (AssetId assetId, CookedAssetType type, size_t & size);
+
+	struct State {
+		State ();
+
+		JobSystem * jobSystem;
+
+		// Counts loading jobs on jobSystem.
+		JobCounter loading;
+
+		// Every asset loaded, keyed by the hash of its pack file entry.
+		AssetCache assets;
+
+		// Every version of each replaced pack file entry, latest last, keyed by its hash.
+		std::mutex replacedMutex;
+		std::unordered_map<uint64, std::vector<std::vector<byte>>> replaced;
+	};
+
+	static State & state ();
 
 };
 
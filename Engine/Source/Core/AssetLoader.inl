@@ -1,42 +1,187 @@
 //
 // AssetLoader.inl
 //
-#include <memory>
+#include <cstring>
+#include <thread>
 
 #include "Core/AssetLoader.hpp"
-#include "Core/AssetLocator.hpp"
+#include "Core/CookedAsset.hpp"
+#include "Core/DebugUtils.hpp"
+#include "Graphics/ShaderUtils.hpp"
 
 //---------------------------------------------------------------------------------------
-template <typename AssetReturned>
-void AssetLoader::load (
-	AssetId assetId,
-	AssetReturned * out
+template <typename T>
+AssetHandle<T> AssetLoader::load (
+	AssetId assetId
 ) {
+	RegisterAssetName (assetId);
+	State & loader = state ();
+	const CookedAssetType type = cookedType<T> ();
+	const uint64 key = assetId.hashWithExtension (CookedExtension (type));
+
+	bool added;
+	AssetHandle<T> handle = loader.assets.acquire<T> (key, static_cast<uint32>(type), added);
+	if (!added) {
+		return handle;
+	}
+
+	auto job = [handle, assetId, key] () {
+		AssetRecordOf<T> * record = handle.record ();
+		size_t size = 0;
+		const bool loaded = decode (assetId, record->asset, size);
+		state ().assets.setSize (key, size);
+		record->complete (loaded);
+	};
 
+	if (loader.jobSystem) {
+		loader.jobSystem->run (job, &loader.loading);
+	} else {
+		job ();
+	}
+	return handle;
 }
 
 //---------------------------------------------------------------------------------------
-#include "Graphics/ShaderUtils.hpp"
-#include <unordered_map>
+template <typename T>
+void AssetLoader::wait (
+	const AssetHandle<T> & handle
+) {
+	assert (handle.isValid ());
+
+	// Other loads, and other jobs, are only executed while this one is incomplete.
+	JobSystem * jobSystem = state ().jobSystem;
+	while (handle.isLoading ()) {
+		if (!jobSystem || !jobSystem->executeJob ()) {
+			std::this_thread::yield ();
+		}
+	}
+}
 
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool AssetLoader::reload (
+	AssetId assetId
+) {
+	State & loader = state ();
+	const uint64 key = assetId.hashWithExtension (CookedExtension (cookedType<T> ()));
+	AssetHandle<T> handle = loader.assets.cached<T> (key);
+	if (!handle.isValid ()) {
+		return false;
+	}
+
+	// A load in progress may have read the version before.
+	wait (handle);
+
+	T asset;
+	size_t size = 0;
+	if (!decode (assetId, asset, size)) {
+		return false;
+	}
+
+	AssetRecordOf<T> * record = handle.record ();
+	record->asset = asset;
+	loader.assets.setSize (key, size);
+	record->reloaded ();
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+void AssetLoader::setEvictionCallback (
+	std::function<void (const T & asset)> callback
+) {
+	AssetCache::EvictionCallback evicted;
+	if (callback) {
+		evicted = [callback] (AssetRecord & record) {
+			callback (static_cast<AssetRecordOf<T> &>(record).asset);
+		};
+	}
+	state ().assets.setEvictionCallback (static_cast<uint32>(cookedType<T> ()), evicted);
+}
+
+//---------------------------------------------------------------------------------------
 template <>
-inline void AssetLoader::load (
+inline CookedAssetType AssetLoader::cookedType<ObjAsset> ()
+{
+	return CookedAssetType::Mesh;
+}
+
+/// Reads "<assetId>.mesh", along with its cooked material and the material's diffuse
+/// texture if there are any.  The mesh and texture are read-only.
+template <>
+inline bool AssetLoader::decode (
 	AssetId assetId,
-	std::shared_ptr<CompiledShader> * outShader
+	ObjAsset & outObj,
+	size_t & outSize
 ) {
-	assert(outShader);
+	std::memset (&outObj, 0, sizeof (ObjAsset));
+	outObj.material.opacity = 1.0f;
 
-	// Store of previously loaded shaders
-	static std::unordered_map<AssetId, std::shared_ptr<CompiledShader>> loadedShaders;
+	size_t size;
 
-	if (loadedShaders.count (assetId) == 0) {
-		std::string byteCodePath = GetAssetPath (assetId);
-		LoadCompiledShaderFromFile (byteCodePath.c_str(), *outShader);
+	const byte * data = findCooked (assetId, CookedAssetType::Mesh, size);
+	if (!data || !ReadCookedMesh (data, size, outObj.mesh)) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to load mesh %s (%llx)", assetId.name (),
+			static_cast<unsigned long long>(assetId.hash ()));
+		return false;
+	}
+	outSize = size;
 
-		// Store a copy for future retrival
-		loadedShaders[assetId] = *outShader;
+	data = findCooked (assetId, CookedAssetType::Material, size);
+	const CookedMaterial * material = data ? ReadCookedMaterial (data, size) : nullptr;
+	if (!material) {
+		return true;
 	}
-	else {
-		*outShader = loadedShaders.at (assetId);
+	outSize += size;
+
+	ObjMaterial & out = outObj.material;
+	std::memcpy (out.ambient, material->ambient, sizeof (out.ambient));
+	std::memcpy (out.diffuse, material->diffuse, sizeof (out.diffuse));
+	std::memcpy (out.specular, material->specular, sizeof (out.specular));
+	std::memcpy (out.emissive, material->emissive, sizeof (out.emissive));
+	out.specularExponent = material->specularExponent;
+	out.opacity = material->opacity;
+	std::strcpy (out.diffuseMap, material->diffuseTexture);
+
+	if (material->diffuseTexture[0] != '\0') {
+		data = findCooked (AssetId (material->diffuseTexture), CookedAssetType::Texture,
+			size);
+		if (!data || !ReadCookedTexture (data, size, outObj.texture)) {
+			LOG_CATEGORY_WARNING (Assets, "Unable to load texture %s", material->diffuseTexture);
+		} else {
+			outSize += size;
+		}
 	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <>
+inline CookedAssetType AssetLoader::cookedType<CompiledShader> ()
+{
+	return CookedAssetType::Shader;
+}
+
+/// Reads "<assetId>.shader".  Byte code is used where it lies in the pack file, or in
+/// its replacement.
+template <>
+inline bool AssetLoader::decode (
+	AssetId assetId,
+	CompiledShader & outShader,
+	size_t & outSize
+) {
+	size_t size;
+	const byte * cooked = findCooked (assetId, CookedAssetType::Shader, size);
+	const D3D12_SHADER_BYTECODE byteCode = cooked ?
+		ReadCookedShader (cooked, size) : D3D12_SHADER_BYTECODE {nullptr, 0};
+	if (!byteCode.pShaderBytecode) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to load shader %s (%llx)", assetId.name (),
+			static_cast<unsigned long long>(assetId.hash ()));
+		return false;
+	}
+
+	outShader.byteCode = byteCode;
+	outShader.ownsByteCode = false;
+	outSize = size;
+	return true;
 }
@@ -7,6 +7,8 @@
 
 //---------------------------------------------------------------------------------------
 #include <libloaderapi.h>
+#include <algorithm>
+#include <cctype>
 #include <cstring>
 
 namespace
@@ -55,3 +57,36 @@ std::string GetAssetPath (
 
 	return result;
 }
+
+//---------------------------------------------------------------------------------------
+std::string GetPathExtension (
+	const std::string & path
+) {
+	const size_t dot = path.find_last_of ('.');
+	const size_t slash = path.find_last_of ("\\/");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+		return "";
+	}
+
+	std::string extension = path.substr (dot + 1);
+	std::transform (extension.begin (), extension.end (), extension.begin (),
+		[] (char c) { return static_cast<char>(std::tolower (c)); });
+	return extension;
+}
+
+//---------------------------------------------------------------------------------------
+std::string GetPathBaseName (
+	const std::string & path
+) {
+	const size_t slash = path.find_last_of ("\\/");
+	std::string name = slash == std::string::npos ? path : path.substr (slash + 1);
+	return name.substr (0, name.find_last_of ('.'));
+}
+
+//---------------------------------------------------------------------------------------
+std::string GetPathDirectory (
+	const std::string & path
+) {
+	const size_t slash = path.find_last_of ("\\/");
+	return slash == std::string::npos ? "." : path.substr (0, slash);
+}
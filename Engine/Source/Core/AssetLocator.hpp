@@ -8,3 +8,19 @@
 std::string GetAssetPath (
 	const char * assetName
 );
+
+/// Lower case extension of path, without the dot, or empty if it has none.
+std::string GetPathExtension (
+	const std::string & path
+);
+
+/// File name of path without its directory or extension, which is the name its asset
+/// is cooked under.
+std::string GetPathBaseName (
+	const std::string & path
+);
+
+/// Directory containing path, or "." if path has no directory.
+std::string GetPathDirectory (
+	const std::string & path
+);
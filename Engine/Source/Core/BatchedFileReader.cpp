@@ -0,0 +1,287 @@
+//
+// BatchedFileReader.cpp
+//
+#include "pch.h"
+
+#include "Core/BatchedFileReader.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+const uint32 BatchedFileReader::SECTOR_SIZE;
+
+namespace
+{
+	// Most completions collected from the port at once.
+	const ULONG MAX_COMPLETIONS = 64;
+
+	inline uint64 alignUp (
+		uint64 value
+	) {
+		return (value + BatchedFileReader::SECTOR_SIZE - 1) &
+			~uint64 (BatchedFileReader::SECTOR_SIZE - 1);
+	}
+}
+
+
+struct BatchedFileReader::Read {
+	// First, so the OVERLAPPED of a completion converts back to its Read.
+	OVERLAPPED overlapped;
+
+	byte * staging;
+	FileReadRequest * request;
+
+	// Set while the read is queued on the device.
+	bool pending;
+
+	// The read is for length bytes of request, from requestOffset within it.  Unbuffered
+	// reads start from the sector before, so these bytes start skip bytes into staging.
+	uint64 requestOffset;
+	uint32 length;
+	uint32 skip;
+};
+
+
+//---------------------------------------------------------------------------------------
+BatchedFileReader::BatchedFileReader (
+	Allocator & allocator,
+	uint maxReadsInFlight,
+	uint32 stagingBufferSize
+)
+	: _maxReadsInFlight (maxReadsInFlight),
+	  _stagingBufferSize (stagingBufferSize),
+	  _reads (new Read[maxReadsInFlight]),
+	  _file (INVALID_HANDLE_VALUE),
+	  _completionPort (nullptr),
+	  _mode (FileReadMode::Buffered),
+	  _nextRequest (0),
+	  _nextRequestOffset (0)
+{
+	assert (maxReadsInFlight > 0);
+	assert (stagingBufferSize > 0 && stagingBufferSize % SECTOR_SIZE == 0);
+
+	byte * staging = static_cast<byte *>(allocator.allocate (
+		size_t (maxReadsInFlight) * stagingBufferSize, SECTOR_SIZE));
+	assert (staging);
+	for (uint i (0); i < maxReadsInFlight; ++i) {
+		_reads[i].staging = staging + size_t (i) * stagingBufferSize;
+		_reads[i].pending = false;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+BatchedFileReader::~BatchedFileReader ()
+{
+	close ();
+	delete [] _reads;
+}
+
+//---------------------------------------------------------------------------------------
+bool BatchedFileReader::open (
+	const char * path,
+	FileReadMode mode
+) {
+	assert (path);
+	close ();
+
+	const DWORD flags = FILE_FLAG_OVERLAPPED |
+		(mode == FileReadMode::Unbuffered ? FILE_FLAG_NO_BUFFERING : 0);
+	_file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+	if (_file == INVALID_HANDLE_VALUE) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to open %s", path);
+		return false;
+	}
+
+	_completionPort = CreateIoCompletionPort (_file, nullptr, 0, 1);
+	if (!_completionPort) {
+		LOG_CATEGORY_WARNING (Assets, "Unable to create a completion port for %s, reads of it "
+			"will be made one at a time.", path);
+	}
+
+	_mode = mode;
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+void BatchedFileReader::close ()
+{
+	if (_completionPort) {
+		CloseHandle (_completionPort);
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle (_file);
+	}
+
+	_completionPort = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+}
+
+//---------------------------------------------------------------------------------------
+bool BatchedFileReader::isOpen () const
+{
+	return _file != INVALID_HANDLE_VALUE;
+}
+
+//---------------------------------------------------------------------------------------
+uint BatchedFileReader::read (
+	FileReadRequest * requests,
+	uint count
+) {
+	assert (isOpen ());
+	assert (requests || count == 0);
+
+	for (uint i (0); i < count; ++i) {
+		assert (requests[i].destination || requests[i].size == 0);
+		requests[i].succeeded = true;
+	}
+	_nextRequest = 0;
+	_nextRequestOffset = 0;
+
+	if (!_completionPort) {
+		Read & read = _reads[0];
+		while (issue (read, requests, count)) {
+			DWORD bytes = 0;
+			const BOOL transferred = GetOverlappedResult (_file, &read.overlapped, &bytes, TRUE);
+			complete (read, transferred != FALSE, bytes);
+		}
+	} else {
+		uint inFlight = 0;
+		while (inFlight < _maxReadsInFlight && issue (_reads[inFlight], requests, count)) {
+			++inFlight;
+		}
+
+		// Each read completed frees its staging buffer for the next to be issued.
+		OVERLAPPED_ENTRY completions[MAX_COMPLETIONS];
+		while (inFlight > 0) {
+			ULONG numCompletions = 0;
+			if (!GetQueuedCompletionStatusEx (_completionPort, completions,
+				std::min<ULONG> (MAX_COMPLETIONS, inFlight), &numCompletions, INFINITE, FALSE))
+			{
+				LOG_CATEGORY_ERROR (Assets, "Unable to wait for reads to complete, reads of the "
+					"file will be made one at a time.");
+				failOutstanding (requests, count);
+				break;
+			}
+
+			for (ULONG i (0); i < numCompletions; ++i) {
+				Read & read = *reinterpret_cast<Read *>(completions[i].lpOverlapped);
+				// Internal holds the read's status, which is zero on success.
+				complete (read, completions[i].Internal == 0,
+					completions[i].dwNumberOfBytesTransferred);
+				--inFlight;
+
+				if (issue (read, requests, count)) {
+					++inFlight;
+				}
+			}
+		}
+	}
+
+	uint succeeded = 0;
+	for (uint i (0); i < count; ++i) {
+		succeeded += requests[i].succeeded ? 1 : 0;
+	}
+	return succeeded;
+}
+
+//---------------------------------------------------------------------------------------
+bool BatchedFileReader::issue (
+	Read & read,
+	FileReadRequest * requests,
+	uint count
+) {
+	while (_nextRequest < count) {
+		FileReadRequest & request = requests[_nextRequest];
+		const uint64 remaining = request.size - _nextRequestOffset;
+		if (remaining == 0 || !request.succeeded) {
+			++_nextRequest;
+			_nextRequestOffset = 0;
+			continue;
+		}
+
+		const uint64 position = request.offset + _nextRequestOffset;
+		uint64 start;
+		uint32 size;
+		void * buffer;
+		if (_mode == FileReadMode::Unbuffered) {
+			start = position & ~uint64 (SECTOR_SIZE - 1);
+			read.skip = static_cast<uint32>(position - start);
+			read.length = static_cast<uint32>(std::min<uint64> (remaining,
+				_stagingBufferSize - read.skip));
+			size = static_cast<uint32>(alignUp (read.skip + read.length));
+			buffer = read.staging;
+		} else {
+			start = position;
+			read.skip = 0;
+			read.length = static_cast<uint32>(std::min<uint64> (remaining, _stagingBufferSize));
+			size = read.length;
+			buffer = static_cast<byte *>(request.destination) + _nextRequestOffset;
+		}
+
+		read.request = &request;
+		read.requestOffset = _nextRequestOffset;
+		std::memset (&read.overlapped, 0, sizeof (read.overlapped));
+		read.overlapped.Offset = static_cast<DWORD>(start);
+		read.overlapped.OffsetHigh = static_cast<DWORD>(start >> 32);
+		_nextRequestOffset += read.length;
+
+		// Reads that complete immediately still post a completion to the port.
+		if (ReadFile (_file, buffer, size, nullptr, &read.overlapped) ||
+			GetLastError () == ERROR_IO_PENDING)
+		{
+			read.pending = true;
+			return true;
+		}
+		request.succeeded = false;
+	}
+	return false;
+}
+
+//---------------------------------------------------------------------------------------
+void BatchedFileReader::complete (
+	Read & read,
+	bool transferred,
+	uint32 bytes
+) {
+	read.pending = false;
+
+	// Reads past the end of the file transfer fewer bytes than were asked for.
+	if (!transferred || bytes < read.skip + read.length) {
+		read.request->succeeded = false;
+		return;
+	}
+
+	if (_mode == FileReadMode::Unbuffered) {
+		std::memcpy (static_cast<byte *>(read.request->destination) + read.requestOffset,
+			read.staging + read.skip, read.length);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void BatchedFileReader::failOutstanding (
+	FileReadRequest * requests,
+	uint count
+) {
+	// Queued reads write to their buffers until they have completed.
+	CancelIoEx (_file, nullptr);
+	for (uint i (0); i < _maxReadsInFlight; ++i) {
+		Read & read = _reads[i];
+		if (read.pending) {
+			DWORD bytes = 0;
+			GetOverlappedResult (_file, &read.overlapped, &bytes, TRUE);
+			read.request->succeeded = false;
+			read.pending = false;
+		}
+	}
+
+	for (uint i (_nextRequest); i < count; ++i) {
+		requests[i].succeeded = false;
+	}
+	_nextRequest = count;
+
+	// Completions of the cancelled reads are still posted to the port, so later reads
+	// wait on each read itself instead.
+	CloseHandle (_completionPort);
+	_completionPort = nullptr;
+}
@@ -0,0 +1,129 @@
+//
+// BatchedFileReader.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+
+class Allocator;
+
+
+/// A read of size bytes at offset within a file, into destination.
+struct FileReadRequest {
+	uint64 offset;
+	uint64 size;
+	void * destination;
+
+	/// Set by BatchedFileReader::read() to whether every byte was read.
+	bool succeeded;
+};
+
+
+enum class FileReadMode : uint8 {
+	/// Reads through the system file cache.
+	Buffered,
+
+	/// Reads straight from the device into sector aligned staging buffers, bypassing
+	/// the system file cache, which only adds a copy for data read once.
+	Unbuffered
+};
+
+
+/// Reads batches of requests from a file with overlapped I/O, keeping many reads queued
+/// on the device at once and collecting their completions from an I/O completion port,
+/// so that loading many small assets is bound by the device rather than by the latency
+/// of each read.
+///
+/// The reader owns a fixed set of staging buffers, allocated once when it is
+/// constructed, so issuing a read never allocates.  Unbuffered reads, which must be
+/// sector aligned, are made into a staging buffer and copied to their destination.
+/// Buffered reads are made straight into their destination, one staging buffer's size
+/// at a time.
+///
+/// If the file cannot be associated with a completion port, reads are made one at a
+/// time instead.
+///
+/// The AssetLoader does not read through this.  Cooked assets are used in place in the
+/// pack file's mapping, which pages them in on first touch and never copies them, so
+/// reading them into buffers of their own would only add a copy.  The reader is for data
+/// that must land in a buffer chosen by the caller, such as an upload heap, where an
+/// unbuffered read skips the copy from the mapping.
+class BatchedFileReader {
+public:
+	/// Alignment of unbuffered reads.  A multiple of the sector size of every device
+	/// in use, both 512 byte and 4 KB.
+	static const uint32 SECTOR_SIZE = 4096;
+
+	/// Allocates maxReadsInFlight staging buffers of stagingBufferSize bytes each from
+	/// allocator, which must outlive the reader.  stagingBufferSize must be a multiple
+	/// of SECTOR_SIZE.
+	BatchedFileReader (
+		Allocator & allocator,
+		uint maxReadsInFlight = 32,
+		uint32 stagingBufferSize = 65536
+	);
+
+	~BatchedFileReader ();
+
+	/// Opens the file at path for reading, closing any file open before.  Returns false
+	/// if it could not be opened.
+	bool open (
+		const char * path,
+		FileReadMode mode
+	);
+
+	void close ();
+
+	bool isOpen () const;
+
+	/// Performs each of the count requests, returning once all have completed.  Returns
+	/// the number that succeeded.  If completions can no longer be collected from the
+	/// port, reads still queued are cancelled and fail, and later reads are made one at
+	/// a time.
+	uint read (
+		FileReadRequest * requests,
+		uint count
+	);
+
+	/// Forbid copying of BatchedFileReader objects.
+	BatchedFileReader (const BatchedFileReader & other) = delete;
+	BatchedFileReader & operator = (const BatchedFileReader & other) = delete;
+
+private:
+	/// One read queued on the device, defined with the platform's I/O types.
+	struct Read;
+
+	/// Queues the next part of the requests yet to be queued on read, failing any
+	/// request a read could not be queued for.  Returns false once none are left.
+	bool issue (
+		Read & read,
+		FileReadRequest * requests,
+		uint count
+	);
+
+	/// Completes read, given whether it succeeded and the bytes it transferred.
+	void complete (
+		Read & read,
+		bool transferred,
+		uint32 bytes
+	);
+
+	/// Cancels and waits for every read still queued, and fails their requests along
+	/// with those yet to be queued.
+	void failOutstanding (
+		FileReadRequest * requests,
+		uint count
+	);
+
+	const uint _maxReadsInFlight;
+	const uint32 _stagingBufferSize;
+	Read * _reads;
+
+	void * _file;
+	void * _completionPort;
+	FileReadMode _mode;
+
+	// Part of the requests being read that is yet to be queued.
+	uint _nextRequest;
+	uint64 _nextRequestOffset;
+};
@@ -0,0 +1,407 @@
+//
+// CookedAsset.cpp
+//
+#include "pch.h"
+
+#include "Core/CookedAsset.hpp"
+#include "Core/AssetLocator.hpp"
+#include "Core/Memory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+
+namespace
+{
+	inline size_t alignUp (
+		size_t value
+	) {
+		return (value + COOKED_ALIGNMENT - 1) & ~(COOKED_ALIGNMENT - 1);
+	}
+
+	/// Starts blob with a zeroed header of type T.
+	template <typename T>
+	void beginBlob (
+		std::vector<byte> & blob
+	) {
+		blob.assign (alignUp (sizeof (T)), 0);
+	}
+
+	/// Appends size bytes of data to blob at the next aligned offset, returning the offset.
+	size_t appendBytes (
+		std::vector<byte> & blob,
+		const void * data,
+		size_t size
+	) {
+		const size_t offset = alignUp (blob.size ());
+		blob.resize (offset + size);
+		if (size > 0) {
+			std::memcpy (blob.data () + offset, data, size);
+		}
+		return offset;
+	}
+
+	/// Pads blob to a multiple of COOKED_ALIGNMENT, then completes cooked's header and
+	/// writes it to the start of blob.
+	template <typename T>
+	void endBlob (
+		T & cooked,
+		CookedAssetType type,
+		std::vector<byte> & blob
+	) {
+		blob.resize (alignUp (blob.size ()));
+		cooked.header.magic = CookedHeader::MAGIC;
+		cooked.header.type = type;
+		cooked.header.version = T::VERSION;
+		cooked.header.size = blob.size ();
+		std::memcpy (blob.data (), &cooked, sizeof (T));
+	}
+
+	/// True if count elements of elementSize bytes at offset lie within size bytes.
+	inline bool inRange (
+		uint64 offset,
+		uint64 count,
+		uint64 elementSize,
+		uint64 size
+	) {
+		return offset <= size && count <= (size - offset) / elementSize;
+	}
+
+	/// Box filters an RGBA8 image to half its size in each dimension, to a minimum of one.
+	void downsample (
+		const byte * source,
+		uint32 width,
+		uint32 height,
+		byte * destination
+	) {
+		const uint32 halfWidth = std::max<uint32> (width / 2, 1);
+		const uint32 halfHeight = std::max<uint32> (height / 2, 1);
+		const uint32 stepX = width > 1 ? 1 : 0;
+		const uint32 stepY = height > 1 ? width : 0;
+
+		for (uint32 y (0); y < halfHeight; ++y) {
+			for (uint32 x (0); x < halfWidth; ++x) {
+				const byte * p = source + (size_t (y) * 2 * width + x * 2) * 4;
+				byte * out = destination + (size_t (y) * halfWidth + x) * 4;
+				for (uint32 c (0); c < 4; ++c) {
+					const uint32 sum = p[c] + p[stepX * 4 + c] + p[stepY * 4 + c] +
+						p[(stepX + stepY) * 4 + c];
+					out[c] = static_cast<byte>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+const char * CookedExtension (
+	CookedAssetType type
+) {
+	switch (type) {
+		case CookedAssetType::Mesh: return ".mesh";
+		case CookedAssetType::Texture: return ".texture";
+		case CookedAssetType::Material: return ".material";
+		case CookedAssetType::Shader: return ".shader";
+	}
+	return "";
+}
+
+//---------------------------------------------------------------------------------------
+void CookMesh (
+	const MeshComponent & mesh,
+	std::vector<byte> & blob
+) {
+	beginBlob<CookedMesh> (blob);
+
+	CookedMesh cooked = {};
+	cooked.numVertices = mesh.numVertices;
+	cooked.numIndices = mesh.numIndices;
+	cooked.verticesOffset = appendBytes (blob, mesh.vertices, mesh.numVertices * sizeof (Vertex));
+	cooked.indicesOffset = appendBytes (blob, mesh.indices, mesh.numIndices * sizeof (Index));
+
+	endBlob (cooked, CookedAssetType::Mesh, blob);
+}
+
+//---------------------------------------------------------------------------------------
+void CookTexture (
+	const byte * pixels,
+	uint32 width,
+	uint32 height,
+	std::vector<byte> & blob
+) {
+	assert (pixels);
+	assert (width > 0 && height > 0);
+	beginBlob<CookedTexture> (blob);
+
+	CookedTexture cooked = {};
+	cooked.width = width;
+	cooked.height = height;
+	cooked.format = CookedTextureFormat::RGBA8;
+
+	// Every level is a multiple of four bytes, so consecutive levels need no padding.
+	cooked.mipOffsets[0] = appendBytes (blob, pixels, size_t (width) * height * 4);
+	cooked.mipLevels = 1;
+	while ((width > 1 || height > 1) && cooked.mipLevels < CookedTexture::MAX_MIP_LEVELS) {
+		const uint32 halfWidth = std::max<uint32> (width / 2, 1);
+		const uint32 halfHeight = std::max<uint32> (height / 2, 1);
+
+		const size_t offset = blob.size ();
+		blob.resize (offset + size_t (halfWidth) * halfHeight * 4);
+		downsample (blob.data () + cooked.mipOffsets[cooked.mipLevels - 1], width, height,
+			blob.data () + offset);
+
+		cooked.mipOffsets[cooked.mipLevels++] = offset;
+		width = halfWidth;
+		height = halfHeight;
+	}
+
+	endBlob (cooked, CookedAssetType::Texture, blob);
+}
+
+//---------------------------------------------------------------------------------------
+void CookMaterial (
+	const ObjMaterial & material,
+	const char * diffuseTexture,
+	std::vector<byte> & blob
+) {
+	beginBlob<CookedMaterial> (blob);
+
+	CookedMaterial cooked = {};
+	std::memcpy (cooked.ambient, material.ambient, sizeof (cooked.ambient));
+	std::memcpy (cooked.diffuse, material.diffuse, sizeof (cooked.diffuse));
+	std::memcpy (cooked.specular, material.specular, sizeof (cooked.specular));
+	std::memcpy (cooked.emissive, material.emissive, sizeof (cooked.emissive));
+	cooked.specularExponent = material.specularExponent;
+	cooked.opacity = material.opacity;
+	if (diffuseTexture) {
+		std::strncpy (cooked.diffuseTexture, diffuseTexture,
+			CookedMaterial::MAX_NAME_LENGTH - 1);
+	}
+
+	endBlob (cooked, CookedAssetType::Material, blob);
+}
+
+//---------------------------------------------------------------------------------------
+void CookShader (
+	const byte * byteCode,
+	size_t length,
+	std::vector<byte> & blob
+) {
+	beginBlob<CookedShader> (blob);
+
+	CookedShader cooked = {};
+	cooked.byteCodeOffset = appendBytes (blob, byteCode, length);
+	cooked.byteCodeLength = length;
+
+	endBlob (cooked, CookedAssetType::Shader, blob);
+}
+
+//---------------------------------------------------------------------------------------
+bool CookObjFile (
+	const char * path,
+	const char * materialDirectory,
+	JobSystem * jobSystem,
+	std::vector<byte> & meshBlob,
+	std::vector<byte> & materialBlob
+) {
+	assert (path);
+	materialBlob.clear ();
+
+	std::vector<char> text;
+	if (!ReadWholeFile (path, text)) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to read %s", path);
+		return false;
+	}
+
+	std::vector<byte> storage (MaxObjMeshBytes (text.size ()));
+	LinearAllocator allocator (storage.data (), storage.size ());
+
+	MeshComponent mesh;
+	ObjReferences references;
+	const bool parsed = jobSystem ?
+		ParseObj (*jobSystem, text.data (), text.size (), allocator, mesh, &references) :
+		ParseObj (text.data (), text.size (), allocator, mesh, &references);
+	if (parsed) {
+		CookMesh (mesh, meshBlob);
+	}
+	allocator.reset ();
+	if (!parsed) {
+		return false;
+	}
+
+	if (references.materialLibrary[0] == '\0') {
+		return true;
+	}
+
+	// Material libraries are found beside the mesh, or in the material directory.
+	const std::string library = GetPathDirectory (path) + "\\" + references.materialLibrary;
+	bool read = ReadWholeFile (library.c_str (), text);
+	if (!read && materialDirectory) {
+		read = ReadWholeFile ((std::string (materialDirectory) + "\\" +
+			references.materialLibrary).c_str (), text);
+	}
+
+	ObjMaterial material;
+	if (!read || !ParseMtl (text.data (), text.size (), references.material, material)) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to read material %s for %s",
+			references.material, path);
+		return false;
+	}
+
+	// Textures are referred to by the name they are cooked under.
+	const std::string texture = material.diffuseMap[0] != '\0' ?
+		GetPathBaseName (material.diffuseMap) : std::string ();
+	CookMaterial (material, texture.c_str (), materialBlob);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+const CookedHeader * ValidateCookedAsset (
+	const byte * data,
+	size_t size,
+	CookedAssetType type,
+	uint16 version
+) {
+	const CookedHeader * header = reinterpret_cast<const CookedHeader *>(data);
+	if (!data || size < sizeof (CookedHeader) || header->magic != CookedHeader::MAGIC) {
+		LOG_CATEGORY_ERROR (Assets, "Not a cooked asset.");
+		return nullptr;
+	}
+	if (header->type != type) {
+		LOG_CATEGORY_ERROR (Assets, "Cooked asset is of type %u, not %u.",
+			uint32 (header->type), uint32 (type));
+		return nullptr;
+	}
+	if (header->version != version) {
+		LOG_CATEGORY_ERROR (Assets, "Cooked %s is version %u, not %u.  Cook it again.",
+			CookedExtension (type), uint32 (header->version), uint32 (version));
+		return nullptr;
+	}
+	if (header->size > size) {
+		LOG_CATEGORY_ERROR (Assets, "Cooked %s is truncated.", CookedExtension (type));
+		return nullptr;
+	}
+	return header;
+}
+
+//---------------------------------------------------------------------------------------
+bool ReadCookedMesh (
+	const byte * data,
+	size_t size,
+	MeshComponent & mesh
+) {
+	const CookedHeader * header = ValidateCookedAsset (data, size, CookedAssetType::Mesh,
+		CookedMesh::VERSION);
+	const CookedMesh * cooked = reinterpret_cast<const CookedMesh *>(data);
+	if (!header || header->size < sizeof (CookedMesh) ||
+		!inRange (cooked->verticesOffset, cooked->numVertices, sizeof (Vertex), header->size) ||
+		!inRange (cooked->indicesOffset, cooked->numIndices, sizeof (Index), header->size))
+	{
+		LOG_CATEGORY_ERROR (Assets, "Invalid cooked mesh.");
+		return false;
+	}
+
+	mesh.numVertices = cooked->numVertices;
+	mesh.numIndices = cooked->numIndices;
+	mesh.vertices = reinterpret_cast<Vertex *>(const_cast<byte *>(data + cooked->verticesOffset));
+	mesh.indices = reinterpret_cast<Index *>(const_cast<byte *>(data + cooked->indicesOffset));
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+bool ReadCookedTexture (
+	const byte * data,
+	size_t size,
+	Texture & texture
+) {
+	const CookedHeader * header = ValidateCookedAsset (data, size, CookedAssetType::Texture,
+		CookedTexture::VERSION);
+	const CookedTexture * cooked = reinterpret_cast<const CookedTexture *>(data);
+	if (!header || header->size < sizeof (CookedTexture) ||
+		cooked->format != CookedTextureFormat::RGBA8 ||
+		cooked->mipLevels == 0 || cooked->mipLevels > CookedTexture::MAX_MIP_LEVELS)
+	{
+		LOG_CATEGORY_ERROR (Assets, "Invalid cooked texture.");
+		return false;
+	}
+
+	uint32 width = cooked->width;
+	uint32 height = cooked->height;
+	for (uint32 level (0); level < cooked->mipLevels; ++level) {
+		if (!inRange (cooked->mipOffsets[level], uint64 (width) * height, 4, header->size)) {
+			LOG_CATEGORY_ERROR (Assets, "Invalid cooked texture.");
+			return false;
+		}
+		width = std::max<uint32> (width / 2, 1);
+		height = std::max<uint32> (height / 2, 1);
+	}
+
+	texture.width = cooked->width;
+	texture.height = cooked->height;
+	texture.bytesPerPixel = 4;
+	texture.mipLevels = cooked->mipLevels;
+	texture.imageData = const_cast<byte *>(data + cooked->mipOffsets[0]);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+const CookedMaterial * ReadCookedMaterial (
+	const byte * data,
+	size_t size
+) {
+	const CookedHeader * header = ValidateCookedAsset (data, size, CookedAssetType::Material,
+		CookedMaterial::VERSION);
+	const CookedMaterial * cooked = reinterpret_cast<const CookedMaterial *>(data);
+	if (!header || header->size < sizeof (CookedMaterial) ||
+		cooked->diffuseTexture[CookedMaterial::MAX_NAME_LENGTH - 1] != '\0')
+	{
+		LOG_CATEGORY_ERROR (Assets, "Invalid cooked material.");
+		return nullptr;
+	}
+	return cooked;
+}
+
+//---------------------------------------------------------------------------------------
+D3D12_SHADER_BYTECODE ReadCookedShader (
+	const byte * data,
+	size_t size
+) {
+	const CookedHeader * header = ValidateCookedAsset (data, size, CookedAssetType::Shader,
+		CookedShader::VERSION);
+	const CookedShader * cooked = reinterpret_cast<const CookedShader *>(data);
+	if (!header || header->size < sizeof (CookedShader) ||
+		!inRange (cooked->byteCodeOffset, cooked->byteCodeLength, 1, header->size))
+	{
+		LOG_CATEGORY_ERROR (Assets, "Invalid cooked shader.");
+		return D3D12_SHADER_BYTECODE {nullptr, 0};
+	}
+	return D3D12_SHADER_BYTECODE {data + cooked->byteCodeOffset,
+		static_cast<SIZE_T>(cooked->byteCodeLength)};
+}
+
+//---------------------------------------------------------------------------------------
+const byte * ReadFileInto (
+	const char * path,
+	Allocator & allocator,
+	size_t & size
+) {
+	// Open file, and advance read position to end of file to find its size.
+	std::ifstream file (path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open ()) {
+		return nullptr;
+	}
+
+	size = static_cast<size_t>(file.tellg ());
+	file.seekg (0, std::ios::beg);
+	if (size == 0) {
+		return nullptr;
+	}
+
+	byte * data = static_cast<byte *>(allocator.allocate (size, COOKED_ALIGNMENT));
+	if (!data || !file.read (reinterpret_cast<char *>(data), size)) {
+		return nullptr;
+	}
+	return data;
+}
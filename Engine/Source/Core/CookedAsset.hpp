@@ -0,0 +1,204 @@
+//
+// CookedAsset.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/ObjParser.hpp"
+#include "Graphics/RenderComponent.hpp"
+
+class Allocator;
+class JobSystem;
+
+
+/// Kinds of asset produced by the AssetCooker.
+enum class CookedAssetType : uint16 {
+	Mesh,
+	Texture,
+	Material,
+	Shader
+};
+
+
+/// Header at the start of every cooked asset.  The payload follows it, and offsets
+/// within the payload are relative to the start of the header.
+struct CookedHeader {
+	/// "SSCA" in a little endian file.
+	static const uint32 MAGIC = 0x41435353;
+
+	uint32 magic;
+	CookedAssetType type;
+
+	// Version of the type's layout.  Assets cooked with a different version must be
+	// cooked again.
+	uint16 version;
+
+	// Bytes in the asset, including this header.
+	uint64 size;
+};
+
+
+/// Vertices and indices of a mesh, ready to be uploaded as they are.
+struct CookedMesh {
+	// Version 2 widened indices to 32 bits.
+	static const uint16 VERSION = 2;
+
+	CookedHeader header;
+	uint32 numVertices;
+	uint32 numIndices;
+	uint64 verticesOffset;
+	uint64 indicesOffset;
+};
+
+
+enum class CookedTextureFormat : uint32 {
+	RGBA8
+};
+
+/// Pixels of a texture and each of its mip levels, largest first.
+struct CookedTexture {
+	static const uint16 VERSION = 1;
+	static const uint32 MAX_MIP_LEVELS = 16;
+
+	CookedHeader header;
+	uint32 width;
+	uint32 height;
+	CookedTextureFormat format;
+	uint32 mipLevels;
+
+	// Offset of each mip level.  Each level is half the size of the one before, to a
+	// minimum of one pixel, and immediately follows it.
+	uint64 mipOffsets[MAX_MIP_LEVELS];
+};
+
+
+/// Surface properties of a material, naming its diffuse texture by asset name.
+struct CookedMaterial {
+	static const uint16 VERSION = 1;
+	static const uint32 MAX_NAME_LENGTH = 64;
+
+	CookedHeader header;
+	float ambient[3];
+	float diffuse[3];
+	float specular[3];
+	float emissive[3];
+	float specularExponent;
+	float opacity;
+
+	// Asset name of the cooked diffuse texture, or empty.
+	char diffuseTexture[MAX_NAME_LENGTH];
+};
+
+
+/// Compiled shader bytecode.
+struct CookedShader {
+	static const uint16 VERSION = 1;
+
+	CookedHeader header;
+	uint64 byteCodeOffset;
+	uint64 byteCodeLength;
+};
+
+
+/// Alignment of cooked assets and of the arrays within them.
+const size_t COOKED_ALIGNMENT = 16;
+
+/// File extension of each type of cooked asset, including the dot.
+const char * CookedExtension (
+	CookedAssetType type
+);
+
+
+/// Writes mesh as a cooked asset to blob.
+void CookMesh (
+	const MeshComponent & mesh,
+	std::vector<byte> & blob
+);
+
+/// Writes width by height RGBA8 pixels as a cooked asset to blob, along with every mip
+/// level down to one pixel, each box filtered from the level before.
+void CookTexture (
+	const byte * pixels,
+	uint32 width,
+	uint32 height,
+	std::vector<byte> & blob
+);
+
+/// Writes material as a cooked asset to blob, with diffuseTexture as the asset name of
+/// its cooked diffuse texture.
+void CookMaterial (
+	const ObjMaterial & material,
+	const char * diffuseTexture,
+	std::vector<byte> & blob
+);
+
+/// Writes compiled shader bytecode as a cooked asset to blob.
+void CookShader (
+	const byte * byteCode,
+	size_t length,
+	std::vector<byte> & blob
+);
+
+/// Parses the OBJ file at path and writes its mesh as a cooked asset to meshBlob.  If
+/// the mesh uses a material, it is read from the material library beside the mesh, or
+/// else from materialDirectory, and written to materialBlob, which is otherwise left
+/// empty.  The material's diffuse texture is named by the asset its image is cooked
+/// into.  Returns false, after logging why, if the mesh or its material cannot be
+/// cooked.
+/// @param jobSystem - parses the mesh across its threads, unless nullptr.
+bool CookObjFile (
+	const char * path,
+	const char * materialDirectory,
+	JobSystem * jobSystem,
+	std::vector<byte> & meshBlob,
+	std::vector<byte> & materialBlob
+);
+
+
+/// Returns the header of the cooked asset of type in [data, data + size), or nullptr
+/// after logging why it cannot be used.  Checks its magic number, type, version and size.
+const CookedHeader * ValidateCookedAsset (
+	const byte * data,
+	size_t size,
+	CookedAssetType type,
+	uint16 version
+);
+
+/// Points mesh at the vertices and indices within a cooked mesh, which must outlive it.
+/// Returns false if data is not a valid cooked mesh.
+bool ReadCookedMesh (
+	const byte * data,
+	size_t size,
+	MeshComponent & mesh
+);
+
+/// Points texture at the pixels within a cooked texture, which must outlive it.  Returns
+/// false if data is not a valid cooked texture.
+bool ReadCookedTexture (
+	const byte * data,
+	size_t size,
+	Texture & texture
+);
+
+/// Returns the cooked material in data, or nullptr if it is not valid.
+const CookedMaterial * ReadCookedMaterial (
+	const byte * data,
+	size_t size
+);
+
+/// Returns the bytecode within a cooked shader, which must outlive it, or a null
+/// bytecode if data is not a valid cooked shader.
+D3D12_SHADER_BYTECODE ReadCookedShader (
+	const byte * data,
+	size_t size
+);
+
+/// Reads the file at path into memory allocated from allocator with COOKED_ALIGNMENT,
+/// in a single read.  Returns nullptr if it could not be read.
+const byte * ReadFileInto (
+	const char * path,
+	Allocator & allocator,
+	size_t & size
+);
@@ -0,0 +1,47 @@
+//
+// CpuFeatures.cpp
+//
+#include "pch.h"
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+#include "Core/CpuFeatures.hpp"
+
+namespace
+{
+	bool detectAvx2 ()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid (info, 0);
+		if (info[0] < 7) {
+			return false;
+		}
+
+		// AVX requires the OS to save YMM registers on context switches (OSXSAVE),
+		// which is confirmed by XCR0 enabling both XMM and YMM state.
+		__cpuid (info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv (0) & 0x6) != 0x6) {
+			return false;
+		}
+
+		__cpuidex (info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports ("avx2");
+#endif
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+bool CpuSupportsAvx2 ()
+{
+	static const bool supported = detectAvx2 ();
+	return supported;
+}
@@ -0,0 +1,11 @@
+//
+// CpuFeatures.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+
+
+/// Returns true if both the processor and operating system support AVX2 instructions.
+/// The result is computed once and cached.
+bool CpuSupportsAvx2 ();
@@ -6,53 +6,66 @@
 #include <debugapi.h>
 #include <winnt.h>
 
-// Max length for any logged message.
-#define LOG_BUFFER_LENGTH 512
+#include "Core/Logger.hpp"
 
 // Severity levels for logging:
-#define LOG_LEVEL_INFO "Log Info: "
-#define LOG_LEVEL_WARNING "Log Warning: "
-#define LOG_LEVEL_ERROR "Log Error: "
-
-#if defined(_DEBUG)
-#define LOG(message, format, ...) \
+#define LOG_LEVEL_INFO LogLevel::Info
+#define LOG_LEVEL_WARNING LogLevel::Warning
+#define LOG_LEVEL_ERROR LogLevel::Error
+
+// Queues a message for the Logger's background thread, which formats and writes it.
+// Enabled in all builds, as queuing a message only copies its arguments.  Calls below
+// the category's compiled minimum level are removed, and those below its runtime level
+// are skipped without evaluating their arguments.  Arguments are copied into
+// LogRecord::ARGUMENT_BYTES (100) bytes, so strings longer than what remains are
+// truncated, and end with "..." to show it.
+// @param category - LogCategory of the message.
+// @param level - LogLevel of the message.
+#define LOG_CATEGORY(category, level, format, ...) \
 	do { \
-		char buffer[LOG_BUFFER_LENGTH]; \
-		int charsWritten = snprintf (buffer, LOG_BUFFER_LENGTH, message); \
-		charsWritten += snprintf (buffer + charsWritten, LOG_BUFFER_LENGTH, format, __VA_ARGS__); \
-		snprintf (buffer + charsWritten, LOG_BUFFER_LENGTH, "\n"); \
-		OutputDebugString(buffer); \
+		if (LogCompiledIn (category, level) && Logger::IsEnabled (category, level)) { \
+			static LogSite logSite (category, level, format); \
+			Logger::Write (logSite, ##__VA_ARGS__); \
+		} \
 	} while(0)
-#else
-#define LOG(levelWString, format, ...)
-#endif
 
+#define LOG(level, format, ...) LOG_CATEGORY(LogCategory::General, level, format, ##__VA_ARGS__)
 
-#if defined(_DEBUG)
-// Logs information string to Output Window.
+
+// Logs information string.
 // @param format - string literal with optional formatting.
-#define LOG_INFO(format, ...) LOG(LOG_LEVEL_INFO, format, __VA_ARGS__)
-#else
-#define LOG_INFO(format, ...)
-#endif
+#define LOG_INFO(format, ...) LOG(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
 	
 
-#if defined(_DEBUG)
-// Logs warning string to Output Window.
+// Logs warning string.
 // @param format - string literal with optional formatting.
-#define LOG_WARNING(format, ...) LOG(LOG_LEVEL_WARNING, format, __VA_ARGS__)
-#else
-#define LOG_WARNING(format, ...)
-#endif
+#define LOG_WARNING(format, ...) LOG(LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
 
 
-#if defined(_DEBUG)
-// Logs error string to Output Window.
+// Logs error string.
 // @param format - string literal with optional formatting.
-#define LOG_ERROR(format, ...) LOG(LOG_LEVEL_ERROR, format, __VA_ARGS__)
-#else
-#define LOG_ERROR(format, ...)
-#endif
+#define LOG_ERROR(format, ...) LOG(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+
+// Logs information string within a category.
+// @param category - name of a LogCategory, such as Input.
+// @param format - string literal with optional formatting.
+#define LOG_CATEGORY_INFO(category, format, ...) \
+	LOG_CATEGORY(LogCategory::category, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+
+
+// Logs warning string within a category.
+// @param category - name of a LogCategory, such as Input.
+// @param format - string literal with optional formatting.
+#define LOG_CATEGORY_WARNING(category, format, ...) \
+	LOG_CATEGORY(LogCategory::category, LOG_LEVEL_WARNING, format, ##__VA_ARGS__)
+
+
+// Logs error string within a category.
+// @param category - name of a LogCategory, such as Input.
+// @param format - string literal with optional formatting.
+#define LOG_CATEGORY_ERROR(category, format, ...) \
+	LOG_CATEGORY(LogCategory::category, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
 
 
 #define toString(x) #x
@@ -64,6 +77,7 @@
 		HRESULT result = (x); \
 		if ( FAILED(result) ) { \
 			LOG_ERROR(toString(str) toString(__FILE__) ":" toString(__LINE__) "\n"); \
+			Logger::Flush(); \
 			__debugbreak(); \
 		} \
 	} \
@@ -128,6 +142,7 @@
 	do { \
 		if (message) { \
 			LOG_ERROR(message); \
+			Logger::Flush(); \
 		} \
 		__debugbreak(); \
 	} while(0)
@@ -0,0 +1,153 @@
+//
+// Fiber.cpp
+//
+#include "pch.h"
+
+#include "Core/Fiber.hpp"
+
+
+#if defined(WIN32)
+
+//---------------------------------------------------------------------------------------
+Fiber::Fiber ()
+	: _handle (nullptr),
+	  _isThread (false),
+	  _entryPoint (nullptr),
+	  _userData (nullptr)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+Fiber::~Fiber ()
+{
+	if (_handle && !_isThread) {
+		DeleteFiber (_handle);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::create (
+	size_t stackSize,
+	EntryPoint entryPoint,
+	void * userData
+) {
+	assert (!_handle);
+
+	_entryPoint = entryPoint;
+	_userData = userData;
+	_handle = CreateFiber (stackSize, &Fiber::Win32EntryPoint, this);
+	assert (_handle);
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::convertFromThread ()
+{
+	assert (!_handle);
+
+	_handle = ConvertThreadToFiber (nullptr);
+	_isThread = true;
+	assert (_handle);
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::convertToThread ()
+{
+	assert (_isThread);
+
+	ConvertFiberToThread ();
+	_handle = nullptr;
+	_isThread = false;
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::switchTo (
+	Fiber & target
+) {
+	assert (target._handle);
+	SwitchToFiber (target._handle);
+}
+
+//---------------------------------------------------------------------------------------
+void __stdcall Fiber::Win32EntryPoint (
+	void * fiber
+) {
+	Fiber * self = static_cast<Fiber *>(fiber);
+	self->_entryPoint (self->_userData);
+
+	// Returning from a fiber's entry point exits the thread running it.
+	ForceBreak ("Fiber entry point returned.");
+}
+
+#else
+
+//---------------------------------------------------------------------------------------
+Fiber::Fiber ()
+	: _context (),
+	  _entryPoint (nullptr),
+	  _userData (nullptr)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+Fiber::~Fiber ()
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::create (
+	size_t stackSize,
+	EntryPoint entryPoint,
+	void * userData
+) {
+	assert (!_stack);
+
+	_entryPoint = entryPoint;
+	_userData = userData;
+	_stack.reset (new byte[stackSize]);
+
+	getcontext (&_context);
+	_context.uc_stack.ss_sp = _stack.get ();
+	_context.uc_stack.ss_size = stackSize;
+	_context.uc_link = nullptr;
+
+	// makecontext() only passes int arguments, so the pointer is split in two.
+	const uint64 address = reinterpret_cast<uintptr_t>(this);
+	makecontext (&_context, reinterpret_cast<void (*) ()>(&Fiber::UcontextEntryPoint), 2,
+		static_cast<uint32>(address >> 32), static_cast<uint32>(address));
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::convertFromThread ()
+{
+	// The thread's context is captured by its first call to switchTo().
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::convertToThread ()
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::switchTo (
+	Fiber & target
+) {
+	swapcontext (&_context, &target._context);
+}
+
+//---------------------------------------------------------------------------------------
+void Fiber::UcontextEntryPoint (
+	uint32 fiberHigh,
+	uint32 fiberLow
+) {
+	Fiber * self = reinterpret_cast<Fiber *>((uint64 (fiberHigh) << 32) | fiberLow);
+	self->_entryPoint (self->_userData);
+
+	// With no uc_link, returning would exit the thread.
+	assert (false && "Fiber entry point returned.");
+}
+
+#endif
@@ -0,0 +1,73 @@
+//
+// Fiber.hpp
+//
+#pragma once
+
+#include <memory>
+
+#if !defined(WIN32)
+	#include <ucontext.h>
+#endif
+
+#include "Core/Types.hpp"
+
+
+/// A cooperatively scheduled execution context with its own stack.
+///
+/// Control moves between fibers only through explicit calls to switchTo().  A thread
+/// must first be converted into a fiber before it can switch to another.  Uses Win32
+/// fibers on Windows, and ucontext elsewhere.
+class Fiber {
+public:
+	typedef void (*EntryPoint) (void * userData);
+
+	Fiber ();
+
+	~Fiber ();
+
+	/// Creates a fiber that starts executing entryPoint(userData) on a new stack of
+	/// stackSize bytes when first switched to.  entryPoint must never return.
+	void create (
+		size_t stackSize,
+		EntryPoint entryPoint,
+		void * userData
+	);
+
+	/// Converts the calling thread into this fiber, so it can switch to others.
+	void convertFromThread ();
+
+	/// Converts this fiber, which must be running, back into a plain thread.
+	void convertToThread ();
+
+	/// Suspends this fiber, which must be running, and resumes target.  Returns once
+	/// another fiber switches back to this one, possibly on a different thread.
+	void switchTo (
+		Fiber & target
+	);
+
+
+	/// Forbid copying of Fiber objects.
+	Fiber (const Fiber & other) = delete;
+	Fiber & operator = (const Fiber & other) = delete;
+
+private:
+#if defined(WIN32)
+	static void __stdcall Win32EntryPoint (
+		void * fiber
+	);
+
+	void * _handle;
+	bool _isThread;
+#else
+	static void UcontextEntryPoint (
+		uint32 fiberHigh,
+		uint32 fiberLow
+	);
+
+	ucontext_t _context;
+	std::unique_ptr<byte[]> _stack;
+#endif
+
+	EntryPoint _entryPoint;
+	void * _userData;
+};
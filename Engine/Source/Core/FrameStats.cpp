@@ -0,0 +1,458 @@
+//
+// FrameStats.cpp
+//
+#include "pch.h"
+
+#include "Core/FrameStats.hpp"
+#include "Core/MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+
+namespace
+{
+	// Durations below 2^SUB_BUCKET_BITS µs are counted exactly.  Each power of two
+	// above that is split into 2^(SUB_BUCKET_BITS - 1) buckets.
+	const uint SUB_BUCKET_BITS = 8;
+	const uint SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	const uint SUB_BUCKET_HALF_BITS = SUB_BUCKET_BITS - 1;
+
+	const uint NUM_COUNTS = ((32 - SUB_BUCKET_BITS) << SUB_BUCKET_HALF_BITS) + SUB_BUCKET_COUNT;
+
+	uint bucketIndex (
+		uint32 microseconds
+	) {
+		if (microseconds < SUB_BUCKET_COUNT) {
+			return microseconds;
+		}
+
+		// Keep the SUB_BUCKET_BITS most significant bits, of which the top one is set.
+		const uint shift = math::highestSetBit (microseconds) - SUB_BUCKET_HALF_BITS;
+		return (shift << SUB_BUCKET_HALF_BITS) + (microseconds >> shift);
+	}
+
+	/// Largest duration counted in the bucket at index.
+	uint64 highestEquivalentValue (
+		uint index
+	) {
+		if (index < SUB_BUCKET_COUNT) {
+			return index;
+		}
+
+		const uint shift = (index >> SUB_BUCKET_HALF_BITS) - 1;
+		const uint64 subBucket = (index & ((1 << SUB_BUCKET_HALF_BITS) - 1)) +
+			(SUB_BUCKET_COUNT >> 1);
+		return ((subBucket + 1) << shift) - 1;
+	}
+
+	FrameStatsSummary summarize (
+		const DurationHistogram & histogram
+	) {
+		FrameStatsSummary summary;
+		summary.frames = histogram.count ();
+		summary.mean = histogram.mean () / 1000.0;
+		summary.p50 = histogram.valueAtPercentile (50.0) / 1000.0;
+		summary.p90 = histogram.valueAtPercentile (90.0) / 1000.0;
+		summary.p99 = histogram.valueAtPercentile (99.0) / 1000.0;
+		summary.p999 = histogram.valueAtPercentile (99.9) / 1000.0;
+		summary.max = histogram.maxValue () / 1000.0;
+		return summary;
+	}
+
+	uint64 toMicroseconds (
+		double milliseconds
+	) {
+		return milliseconds > 0.0 ? static_cast<uint64>(std::llround (milliseconds * 1000.0)) : 0;
+	}
+
+	void appendSummaryJson (
+		std::string & json,
+		const FrameStatsSummary & summary
+	) {
+		char buffer[256];
+		std::snprintf (buffer, sizeof (buffer),
+			"{\"frames\":%llu,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,"
+			"\"p99.9\":%.3f,\"max\":%.3f}",
+			static_cast<unsigned long long>(summary.frames), summary.mean, summary.p50,
+			summary.p90, summary.p99, summary.p999, summary.max);
+		json += buffer;
+	}
+
+	void appendSummaryCsv (
+		std::string & csv,
+		const FrameStatsSummary & summary
+	) {
+		char buffer[256];
+		std::snprintf (buffer, sizeof (buffer), ",%.3f,%.3f,%.3f,%.3f,%.3f,%.3f",
+			summary.mean, summary.p50, summary.p90, summary.p99, summary.p999, summary.max);
+		csv += buffer;
+	}
+
+	bool writeFile (
+		const char * path,
+		const std::string & contents
+	) {
+		std::ofstream file (path, std::ios::out | std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		file.write (contents.data (), contents.size ());
+		return static_cast<bool>(file);
+	}
+}
+
+
+const uint64 DurationHistogram::MAX_MICROSECONDS;
+const uint32 FrameStats::MAX_HITCHES;
+const uint32 FrameStats::MAX_WINDOWS;
+
+
+//---------------------------------------------------------------------------------------
+DurationHistogram::DurationHistogram ()
+	: _counts (NUM_COUNTS, 0),
+	  _count (0),
+	  _max (0),
+	  _total (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void DurationHistogram::record (
+	uint64 microseconds
+) {
+	if (microseconds > MAX_MICROSECONDS) {
+		microseconds = MAX_MICROSECONDS;
+	}
+
+	++_counts[bucketIndex (static_cast<uint32>(microseconds))];
+	++_count;
+	_max = std::max (_max, microseconds);
+	_total += microseconds;
+}
+
+//---------------------------------------------------------------------------------------
+void DurationHistogram::add (
+	const DurationHistogram & other
+) {
+	for (uint i (0); i < NUM_COUNTS; ++i) {
+		_counts[i] += other._counts[i];
+	}
+	_count += other._count;
+	_max = std::max (_max, other._max);
+	_total += other._total;
+}
+
+//---------------------------------------------------------------------------------------
+void DurationHistogram::reset ()
+{
+	std::fill (_counts.begin (), _counts.end (), 0);
+	_count = 0;
+	_max = 0;
+	_total = 0;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 DurationHistogram::count () const
+{
+	return _count;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 DurationHistogram::maxValue () const
+{
+	return _max;
+}
+
+//---------------------------------------------------------------------------------------
+double DurationHistogram::mean () const
+{
+	return _count > 0 ? double (_total) / _count : 0.0;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 DurationHistogram::valueAtPercentile (
+	double percentile
+) const {
+	if (_count == 0) {
+		return 0;
+	}
+
+	percentile = std::min (std::max (percentile, 0.0), 100.0);
+	const uint64 rank = std::max<uint64> (1,
+		static_cast<uint64>(std::ceil (percentile / 100.0 * _count)));
+
+	uint64 seen = 0;
+	for (uint i (0); i < NUM_COUNTS; ++i) {
+		seen += _counts[i];
+		if (seen >= rank) {
+			// The bucket's upper bound may exceed every value recorded in it.
+			return std::min (highestEquivalentValue (i), _max);
+		}
+	}
+	return _max;
+}
+
+//---------------------------------------------------------------------------------------
+FrameStats::FrameStats (
+	double intervalMilliseconds,
+	double hitchMilliseconds,
+	double hitchMedianFactor,
+	uint windowIntervals
+)
+	: _intervalMilliseconds (intervalMilliseconds),
+	  _hitchMilliseconds (hitchMilliseconds),
+	  _hitchMedianFactor (hitchMedianFactor),
+	  _intervals (windowIntervals),
+	  _currentInterval (0),
+	  _completedIntervals (0),
+	  _frameCount (0),
+	  _hitchCount (0)
+{
+	assert (intervalMilliseconds > 0.0);
+	assert (windowIntervals > 0);
+
+	_windows.reserve (MAX_WINDOWS);
+
+	Interval & interval = _intervals[_currentInterval];
+	interval.firstFrame = 0;
+	interval.milliseconds = 0.0;
+	interval.hitches = 0;
+}
+
+//---------------------------------------------------------------------------------------
+void FrameStats::setHitchThresholds (
+	double hitchMilliseconds,
+	double hitchMedianFactor
+) {
+	_hitchMilliseconds = hitchMilliseconds;
+	_hitchMedianFactor = hitchMedianFactor;
+}
+
+//---------------------------------------------------------------------------------------
+bool FrameStats::recordFrame (
+	double frameMilliseconds,
+	double tickMilliseconds
+) {
+	const uint64 frameMicroseconds = toMicroseconds (frameMilliseconds);
+	const uint64 tickMicroseconds = toMicroseconds (tickMilliseconds);
+	_frames.record (frameMicroseconds);
+	_ticks.record (tickMicroseconds);
+
+	Interval & interval = _intervals[_currentInterval];
+	interval.frames.record (frameMicroseconds);
+	interval.ticks.record (tickMicroseconds);
+
+	// The relative threshold needs a median from a previous window to compare against.
+	bool hitch = frameMilliseconds > _hitchMilliseconds;
+	if (!hitch && _hitchMedianFactor > 0.0 && !_windows.empty ()) {
+		hitch = frameMilliseconds > _hitchMedianFactor * window (windowCount () - 1).frame.p50;
+	}
+
+	if (hitch) {
+		++_hitchCount;
+		++interval.hitches;
+		if (_hitches.size () < MAX_HITCHES) {
+			_hitches.push_back ({_frameCount, frameMilliseconds, tickMilliseconds});
+		}
+	}
+
+	++_frameCount;
+	interval.milliseconds += frameMilliseconds;
+	if (interval.milliseconds < _intervalMilliseconds) {
+		return false;
+	}
+
+	completeInterval ();
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+void FrameStats::completeInterval ()
+{
+	const uint numIntervals = static_cast<uint>(_intervals.size ());
+	const uint64 windowIndex = _completedIntervals++;
+
+	// Until the ring has filled, windows span every interval completed so far.
+	const uint windowIntervals = static_cast<uint>(
+		std::min<uint64> (_completedIntervals, numIntervals));
+	const uint oldest = (_currentInterval + numIntervals + 1 - windowIntervals) % numIntervals;
+
+	FrameStatsWindow window;
+	window.firstFrame = _intervals[oldest].firstFrame;
+	window.milliseconds = 0.0;
+	window.hitches = 0;
+
+	_windowFrames.reset ();
+	_windowTicks.reset ();
+	for (uint i (0); i < windowIntervals; ++i) {
+		const Interval & interval = _intervals[(oldest + i) % numIntervals];
+		_windowFrames.add (interval.frames);
+		_windowTicks.add (interval.ticks);
+		window.milliseconds += interval.milliseconds;
+		window.hitches += interval.hitches;
+	}
+
+	window.frame = summarize (_windowFrames);
+	window.tick = summarize (_windowTicks);
+	if (_windows.size () < MAX_WINDOWS) {
+		_windows.push_back (window);
+	} else {
+		_windows[windowIndex % MAX_WINDOWS] = window;
+	}
+
+	// The next interval replaces the oldest, which has now left every later window.
+	_currentInterval = (_currentInterval + 1) % numIntervals;
+	Interval & next = _intervals[_currentInterval];
+	next.frames.reset ();
+	next.ticks.reset ();
+	next.firstFrame = _frameCount;
+	next.milliseconds = 0.0;
+	next.hitches = 0;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 FrameStats::frameCount () const
+{
+	return _frameCount;
+}
+
+//---------------------------------------------------------------------------------------
+FrameStatsSummary FrameStats::frameSummary () const
+{
+	return summarize (_frames);
+}
+
+//---------------------------------------------------------------------------------------
+FrameStatsSummary FrameStats::tickSummary () const
+{
+	return summarize (_ticks);
+}
+
+//---------------------------------------------------------------------------------------
+uint FrameStats::windowCount () const
+{
+	return static_cast<uint>(_windows.size ());
+}
+
+//---------------------------------------------------------------------------------------
+const FrameStatsWindow & FrameStats::window (
+	uint index
+) const {
+	assert (index < _windows.size ());
+
+	const uint64 oldest = _windows.size () < MAX_WINDOWS ? 0 : _completedIntervals;
+	return _windows[(oldest + index) % MAX_WINDOWS];
+}
+
+//---------------------------------------------------------------------------------------
+uint64 FrameStats::completedWindowCount () const
+{
+	return _completedIntervals;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 FrameStats::hitchCount () const
+{
+	return _hitchCount;
+}
+
+//---------------------------------------------------------------------------------------
+const std::vector<FrameHitch> & FrameStats::hitches () const
+{
+	return _hitches;
+}
+
+//---------------------------------------------------------------------------------------
+std::string FrameStats::csv () const
+{
+	std::string csv =
+		"window,first_frame,frames,milliseconds,"
+		"frame_mean_ms,frame_p50_ms,frame_p90_ms,frame_p99_ms,frame_p99.9_ms,frame_max_ms,"
+		"tick_mean_ms,tick_p50_ms,tick_p90_ms,tick_p99_ms,tick_p99.9_ms,tick_max_ms,"
+		"hitches\n";
+
+	char buffer[128];
+	const uint64 firstWindow = _completedIntervals - _windows.size ();
+	for (uint i (0); i < windowCount (); ++i) {
+		const FrameStatsWindow & window = this->window (i);
+		std::snprintf (buffer, sizeof (buffer), "%llu,%llu,%llu,%.3f",
+			static_cast<unsigned long long>(firstWindow + i),
+			static_cast<unsigned long long>(window.firstFrame),
+			static_cast<unsigned long long>(window.frame.frames),
+			window.milliseconds);
+		csv += buffer;
+		appendSummaryCsv (csv, window.frame);
+		appendSummaryCsv (csv, window.tick);
+		std::snprintf (buffer, sizeof (buffer), ",%llu\n",
+			static_cast<unsigned long long>(window.hitches));
+		csv += buffer;
+	}
+	return csv;
+}
+
+//---------------------------------------------------------------------------------------
+std::string FrameStats::json () const
+{
+	char buffer[256];
+
+	std::string json = "{\"frame\":";
+	appendSummaryJson (json, frameSummary ());
+	json += ",\n\"tick\":";
+	appendSummaryJson (json, tickSummary ());
+
+	std::snprintf (buffer, sizeof (buffer),
+		",\n\"hitchThresholds\":{\"milliseconds\":%.3f,\"medianFactor\":%.3f},"
+		"\n\"hitchCount\":%llu,\n\"windows\":[",
+		_hitchMilliseconds, _hitchMedianFactor,
+		static_cast<unsigned long long>(_hitchCount));
+	json += buffer;
+
+	for (uint i (0); i < windowCount (); ++i) {
+		const FrameStatsWindow & window = this->window (i);
+		std::snprintf (buffer, sizeof (buffer),
+			"%s\n{\"firstFrame\":%llu,\"milliseconds\":%.3f,\"hitches\":%llu,\"frame\":",
+			i == 0 ? "" : ",",
+			static_cast<unsigned long long>(window.firstFrame),
+			window.milliseconds,
+			static_cast<unsigned long long>(window.hitches));
+		json += buffer;
+		appendSummaryJson (json, window.frame);
+		json += ",\"tick\":";
+		appendSummaryJson (json, window.tick);
+		json += "}";
+	}
+
+	json += "],\n\"hitches\":[";
+	for (size_t i (0); i < _hitches.size (); ++i) {
+		const FrameHitch & hitch = _hitches[i];
+		std::snprintf (buffer, sizeof (buffer),
+			"%s\n{\"frame\":%llu,\"frameMilliseconds\":%.3f,\"tickMilliseconds\":%.3f}",
+			i == 0 ? "" : ",",
+			static_cast<unsigned long long>(hitch.frame),
+			hitch.frameMilliseconds,
+			hitch.tickMilliseconds);
+		json += buffer;
+	}
+
+	json += "]}\n";
+	return json;
+}
+
+//---------------------------------------------------------------------------------------
+bool FrameStats::saveCsv (
+	const char * path
+) const {
+	return writeFile (path, csv ());
+}
+
+//---------------------------------------------------------------------------------------
+bool FrameStats::saveJson (
+	const char * path
+) const {
+	return writeFile (path, json ());
+}
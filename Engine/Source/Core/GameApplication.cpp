@@ -5,10 +5,37 @@
 #include "pch.h"
 
 #include "Core/GameApplication.hpp"
-#include "Core/GameObject.hpp"
 #include "Core/AssetLoader.hpp"
+#include "Core/AssetLocator.hpp"
+#include "Core/HotReloader.hpp"
+#include "Core/InputEvent.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/SpscQueue.hpp"
+#include "Core/TaskGraph.hpp"
 
 #include "Graphics/D3D12Renderer.hpp"
+#include "Graphics/RenderThread.hpp"
+
+namespace
+{
+	// Input events that can be queued between updates before new ones are dropped.
+	const uint32 INPUT_EVENT_CAPACITY = 256;
+
+	// Frames between logging the frame graph's critical path.
+	const uint64 FRAME_GRAPH_REPORT_INTERVAL = 600;
+
+	// Most bytes of cooked meshes, with their materials and textures, and of shaders
+	// kept loaded.  Unreferenced assets beyond these are evicted between frames.
+	const size_t MESH_BUDGET = 256 << 20;
+	const size_t SHADER_BUDGET = 16 << 20;
+
+	// Key that captures a profile of the next PROFILE_CAPTURE_FRAMES frames, saved to
+	// PROFILE_CAPTURE_PATH for chrome://tracing or Perfetto.
+	const uint8 PROFILE_CAPTURE_KEY = VK_F11;
+	const uint32 PROFILE_CAPTURE_FRAMES = 300;
+	const char * const PROFILE_CAPTURE_PATH = "ProfileCapture.json";
+}
 
 
 //---------------------------------------------------------------------------------------
@@ -19,11 +46,36 @@ GameApplication::GameApplication (
 ) 
 	: _windowWidth(windowWidth),
 	  _windowHeight(windowHeight),
-	  _windowTitle(windowTitle)
+	  _windowTitle(windowTitle),
+	  _inputEvents(std::make_shared<SpscQueue<InputEvent>> (INPUT_EVENT_CAPACITY)),
+	  _frameCount(0),
+	  _captureRequested(false),
+	  _capturing(false)
 {
 
 }
 
+//---------------------------------------------------------------------------------------
+GameApplication::~GameApplication ()
+{
+	if (!_jobSystem) {
+		return;
+	}
+
+	// Torn down in the reverse order of initialze(), so that the asset loader never
+	// refers to the job system once it has been destroyed.
+	_frameGraph.reset ();
+	_renderThread.reset ();
+	_renderer.reset ();
+#if defined(_DEBUG)
+	_hotReloader.reset ();
+#endif
+
+	AssetLoader::setJobSystem (nullptr);
+	_jobSystem.reset ();
+	AssetLoader::unmount ();
+}
+
 //---------------------------------------------------------------------------------------
 const char * GameApplication::getWindowTitle () const
 {
@@ -46,48 +98,145 @@ uint GameApplication::getWindowHeight () const
 void GameApplication::initialze (
 	HWND hWindow
 ) {
+	Profiler::SetThreadName ("Main");
+
+	// Every asset is loaded from the one pack file, mapped for the life of the game.
+	if (!AssetLoader::mount (GetAssetPath ("Assets.pack").c_str ())) {
+		ForceBreak ("Unable to mount Assets.pack");
+	}
+	AssetLoader::setBudget (CookedAssetType::Mesh, MESH_BUDGET);
+	AssetLoader::setBudget (CookedAssetType::Shader, SHADER_BUDGET);
+
+	// One worker thread per remaining core.
+	_jobSystem = std::make_shared<JobSystem> (JobSystem::DefaultWorkerThreadCount ());
+	AssetLoader::setJobSystem (_jobSystem.get ());
+
+#if defined(_DEBUG)
+	// The executable is built to Game\bin\<Platform>\<Configuration>, beside the
+	// shaders compiled from Game\Assets\Shaders.
+	_hotReloader = std::make_shared<HotReloader> ();
+	_hotReloader->watch (GetAssetPath ("..\\..\\..\\Assets").c_str (), true);
+	_hotReloader->watch (GetAssetPath (".").c_str (), false);
+
+	// Assets are reloaded in place, once the render thread no longer reads them.
+	_hotReloader->setReloadBarrier ([this] { _renderThread->flush (); });
+#endif
+
 	// Allocate instance for D3D12Renderer.
 	_renderer = std::make_shared<D3D12Renderer> ();
 	_renderer->initialize (hWindow);
 
-	GameObject ship;
-
-	ObjAsset objAsset;
-	AssetLoader::load ("low_poly_ship", &objAsset);
+	// The renderer is only used by the render thread from here on.
+	_renderThread = std::make_shared<RenderThread> (*_renderer);
 
-	ShaderGroup shader;
+	buildFrameGraph ();
+}
 
-	//AssetLoader::load ("defaultVS", &shader.vertexShader);
-	//AssetLoader::load ("defaultPS", &shader.pixelShader);
+//---------------------------------------------------------------------------------------
+void GameApplication::buildFrameGraph ()
+{
+	_frameGraph = std::make_shared<TaskGraph> (*_jobSystem);
+	TaskGraph & graph = *_frameGraph;
 
-	//Material material;
-	//material.shader = shader;
-	//material.texture = objAsset.texture;
+	const TaskId input = graph.addTask ("input", [this] { processInput (); });
 
-	//ship.addComponent (objAsset.mesh);
-	//ship.addComponent (material);
+	// Simulation, collision and extraction of the packet's draw calls are added
+	// between these as each exists.
+	graph.addTask ("submit", [this] { _renderThread->submitPacket (); }, {input});
 
-	//_renderer->addGameObject (ship);
+	graph.compile ();
 }
 
 //---------------------------------------------------------------------------------------
 void GameApplication::keyDown (
 	uint8 virtualKey
 ) {
-	_inputHandler.keyDown(virtualKey);
+	const InputEvent event = {InputEventType::KeyDown, virtualKey, InputEvent::Now ()};
+	if (!_inputEvents->tryPush (event)) {
+		LOG_CATEGORY_WARNING (Input, "Input event queue full, dropped %c Key Pressed",
+			static_cast<char>(virtualKey));
+	}
 }
 
 //---------------------------------------------------------------------------------------
 void GameApplication::keyUp (
 	uint8 virtualKey
 ) {
-	_inputHandler.keyUp(virtualKey);
+	const InputEvent event = {InputEventType::KeyUp, virtualKey, InputEvent::Now ()};
+	if (!_inputEvents->tryPush (event)) {
+		LOG_CATEGORY_WARNING (Input, "Input event queue full, dropped %c Key Up",
+			static_cast<char>(virtualKey));
+	}
 }
 
 //---------------------------------------------------------------------------------------
 void GameApplication::update ()
 {
-	_renderer->render ();
-	_renderer->present ();
+	{
+		PROFILE_ZONE ("Frame");
+
+		// Blocks only while the render thread is NUM_BUFFERED_FRAMES - 1 frames behind.
+		// Simulation of this frame then overlaps rendering of the previous one.
+		_renderThread->beginPacket ();
+
+		_frameGraph->execute ();
+
+		// No jobs remain in flight at the end of a frame.
+		_jobSystem->resetScratchAllocators ();
+
+		AssetLoader::trim ();
+#if defined(_DEBUG)
+		_hotReloader->update ();
+#endif
+	}
+
+	if (++_frameCount % FRAME_GRAPH_REPORT_INTERVAL == 0) {
+		LOG_INFO ("%s", _frameGraph->report ().c_str ());
+	}
+
+	Profiler::NextFrame ();
+	updateCapture ();
+}
+
+//---------------------------------------------------------------------------------------
+void GameApplication::processInput ()
+{
+	InputEvent event;
+	while (_inputEvents->tryPop (event)) {
+		switch (event.type) {
+			case InputEventType::KeyDown: _inputHandler.keyDown (event.virtualKey); break;
+			case InputEventType::KeyUp: _inputHandler.keyUp (event.virtualKey); break;
+		}
+
+		if (event.type == InputEventType::KeyDown &&
+			event.virtualKey == PROFILE_CAPTURE_KEY)
+		{
+			_captureRequested = true;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void GameApplication::updateCapture ()
+{
+	// Saved once the capture's last frame has ended, so no zones are still recording.
+	if (_capturing && !Profiler::IsCapturing ()) {
+		_capturing = false;
+		if (Profiler::SaveChromeTrace (PROFILE_CAPTURE_PATH)) {
+			LOG_INFO ("Saved profile capture of %u zones to %s",
+				static_cast<uint>(Profiler::ZoneCount ()), PROFILE_CAPTURE_PATH);
+		} else {
+			LOG_ERROR ("Unable to save profile capture to %s", PROFILE_CAPTURE_PATH);
+		}
+	}
+
+	// Captures start on a frame boundary, and requests during one are ignored.
+	if (_captureRequested) {
+		_captureRequested = false;
+		if (!_capturing) {
+			Profiler::BeginCapture (PROFILE_CAPTURE_FRAMES);
+			_capturing = true;
+		}
+	}
 }
 
@@ -0,0 +1,255 @@
+//
+// HotReloader.cpp
+//
+#include "pch.h"
+
+#include "Core/HotReloader.hpp"
+
+#include <cstring>
+
+#include "Core/AssetLoader.hpp"
+#include "Core/AssetLocator.hpp"
+#include "Core/CookedAsset.hpp"
+#include "Core/ObjParser.hpp"
+
+namespace
+{
+	// Changes read from a directory at once.  Changes made while a directory's buffer
+	// is full are lost.
+	const DWORD CHANGE_BUFFER_SIZE = 64 * 1024;
+}
+
+
+struct HotReloader::Directory {
+	// First, so that the read's completion can be found from the directory.
+	OVERLAPPED overlapped;
+
+	HANDLE handle;
+	std::string path;
+	bool recursive;
+
+	// FILE_NOTIFY_INFORMATION records, which must be DWORD aligned.
+	DWORD changes[CHANGE_BUFFER_SIZE / sizeof (DWORD)];
+};
+
+
+//---------------------------------------------------------------------------------------
+HotReloader::HotReloader (
+	Clock::duration debounce
+)
+	: _debounce (debounce)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+HotReloader::~HotReloader ()
+{
+	for (std::unique_ptr<Directory> & directory : _directories) {
+		// The pending read writes to the directory until it is cancelled.
+		if (CancelIoEx (directory->handle, &directory->overlapped) ||
+			GetLastError () != ERROR_NOT_FOUND)
+		{
+			DWORD bytes;
+			GetOverlappedResult (directory->handle, &directory->overlapped, &bytes, TRUE);
+		}
+		CloseHandle (directory->handle);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool HotReloader::watch (
+	const char * path,
+	bool recursive
+) {
+	assert (path);
+
+	std::unique_ptr<Directory> directory (new Directory);
+	directory->handle = CreateFileA (path, FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (directory->handle == INVALID_HANDLE_VALUE) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to watch %s for changes", path);
+		return false;
+	}
+
+	directory->path = path;
+	directory->recursive = recursive;
+	if (!listen (*directory)) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to watch %s for changes", path);
+		CloseHandle (directory->handle);
+		return false;
+	}
+
+	if (recursive && _materialDirectory.empty ()) {
+		_materialDirectory = directory->path + "\\Materials";
+	}
+	_directories.push_back (std::move (directory));
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+void HotReloader::notify (
+	const std::string & path,
+	Clock::time_point time
+) {
+	const std::string extension = GetPathExtension (path);
+	if (extension == "obj" || extension == "cso") {
+		_pending[path] = time;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void HotReloader::setReloadBarrier (
+	std::function<void ()> barrier
+) {
+	_barrier = std::move (barrier);
+}
+
+//---------------------------------------------------------------------------------------
+uint HotReloader::update (
+	Clock::time_point now
+) {
+	for (std::unique_ptr<Directory> & directory : _directories) {
+		poll (*directory, now);
+	}
+
+	uint reloaded = 0;
+	bool waited = false;
+	for (auto source = _pending.begin (); source != _pending.end ();) {
+		if (now - source->second < _debounce) {
+			++source;
+			continue;
+		}
+
+		if (!waited && _barrier) {
+			_barrier ();
+		}
+		waited = true;
+
+		if (reload (source->first)) {
+			LOG_CATEGORY_INFO (Assets, "Reloaded %s", source->first.c_str ());
+			++reloaded;
+		}
+		source = _pending.erase (source);
+	}
+	return reloaded;
+}
+
+//---------------------------------------------------------------------------------------
+bool HotReloader::listen (
+	Directory & directory
+) {
+	std::memset (&directory.overlapped, 0, sizeof (directory.overlapped));
+	return ReadDirectoryChangesW (directory.handle, directory.changes,
+		sizeof (directory.changes), directory.recursive,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr,
+		&directory.overlapped, nullptr) != FALSE;
+}
+
+//---------------------------------------------------------------------------------------
+void HotReloader::poll (
+	Directory & directory,
+	Clock::time_point now
+) {
+	DWORD bytes = 0;
+	if (!GetOverlappedResult (directory.handle, &directory.overlapped, &bytes, FALSE)) {
+		if (GetLastError () != ERROR_IO_INCOMPLETE) {
+			LOG_CATEGORY_WARNING (Assets, "Stopped watching %s for changes",
+				directory.path.c_str ());
+		}
+		return;
+	}
+
+	if (bytes == 0) {
+		LOG_CATEGORY_WARNING (Assets, "Too many changes to %s at once, some were not "
+			"reloaded", directory.path.c_str ());
+	}
+
+	const byte * next = reinterpret_cast<const byte *>(directory.changes);
+	while (bytes > 0) {
+		const FILE_NOTIFY_INFORMATION & change =
+			*reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(next);
+
+		// Editors that save to a temporary file rename it over the source.
+		if (change.Action == FILE_ACTION_ADDED || change.Action == FILE_ACTION_MODIFIED ||
+			change.Action == FILE_ACTION_RENAMED_NEW_NAME)
+		{
+			char name[MAX_PATH];
+			const int length = WideCharToMultiByte (CP_UTF8, 0, change.FileName,
+				change.FileNameLength / sizeof (WCHAR), name, sizeof (name) - 1, nullptr, nullptr);
+			if (length > 0) {
+				notify (directory.path + "\\" + std::string (name, length), now);
+			}
+		}
+
+		if (change.NextEntryOffset == 0) {
+			break;
+		}
+		next += change.NextEntryOffset;
+	}
+
+	if (!listen (directory)) {
+		LOG_CATEGORY_WARNING (Assets, "Stopped watching %s for changes",
+			directory.path.c_str ());
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool HotReloader::reload (
+	const std::string & path
+) {
+	const std::string extension = GetPathExtension (path);
+	if (extension == "obj") {
+		return reloadMesh (path);
+	} else if (extension == "cso") {
+		return reloadShader (path);
+	}
+	return false;
+}
+
+//---------------------------------------------------------------------------------------
+bool HotReloader::reloadMesh (
+	const std::string & path
+) {
+	std::vector<byte> meshBlob;
+	std::vector<byte> materialBlob;
+	if (!CookObjFile (path.c_str (),
+		_materialDirectory.empty () ? nullptr : _materialDirectory.c_str (), nullptr,
+		meshBlob, materialBlob))
+	{
+		return false;
+	}
+
+	const std::string name = GetPathBaseName (path);
+	const AssetId assetId (name.c_str ());
+	AssetLoader::replaceCooked (assetId, CookedAssetType::Mesh, std::move (meshBlob));
+	if (!materialBlob.empty ()) {
+		AssetLoader::replaceCooked (assetId, CookedAssetType::Material,
+			std::move (materialBlob));
+	}
+
+	// Meshes not loaded yet are read from the replacement once they are.
+	AssetLoader::reload<ObjAsset> (assetId);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+bool HotReloader::reloadShader (
+	const std::string & path
+) {
+	std::vector<char> byteCode;
+	if (!ReadWholeFile (path.c_str (), byteCode)) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to read %s", path.c_str ());
+		return false;
+	}
+
+	std::vector<byte> blob;
+	CookShader (reinterpret_cast<const byte *>(byteCode.data ()), byteCode.size (), blob);
+
+	const std::string name = GetPathBaseName (path);
+	const AssetId assetId (name.c_str ());
+	AssetLoader::replaceCooked (assetId, CookedAssetType::Shader, std::move (blob));
+	AssetLoader::reload<CompiledShader> (assetId);
+	return true;
+}
@@ -0,0 +1,112 @@
+//
+// HotReloader.hpp
+//
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+
+/// Watches directories of source assets while the game runs, and recooks each source
+/// that changes into the AssetLoader, which swaps the new version into the handles
+/// already loaded:
+///     .obj  The mesh and its material, replacing the ObjAsset of the same name.
+///     .cso  The shader's byte code, replacing the CompiledShader of the same name.
+///
+/// Editors often save a file several times in quick succession, so a source is only
+/// recooked once it has gone unchanged for the debounce interval, and only once for
+/// every change in that time.
+///
+/// update() collects changes and recooks sources on the calling thread, and must be
+/// called between frames.  Assets are replaced in place, so nothing may read them
+/// while they are: the barrier set by setReloadBarrier() is invoked before the first
+/// reload of each update(), and must wait for every frame in flight to finish.
+class HotReloader {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	explicit HotReloader (
+		Clock::duration debounce = std::chrono::milliseconds (250)
+	);
+
+	~HotReloader ();
+
+	/// Watches the files in directory, and those in directories below it if recursive
+	/// is true.  Material libraries are found beside the mesh that uses them, or in the
+	/// Materials directory of the first directory watched recursively.  Returns false
+	/// if directory could not be watched.
+	bool watch (
+		const char * directory,
+		bool recursive
+	);
+
+	/// Records that the source at path changed at time, if it is of a kind that can be
+	/// reloaded.  Called by update() for each change in a directory watched.
+	void notify (
+		const std::string & path,
+		Clock::time_point time
+	);
+
+	/// Sets the function invoked on the calling thread before the first source is
+	/// reloaded by update(), which returns once nothing reads the assets reloaded.
+	void setReloadBarrier (
+		std::function<void ()> barrier
+	);
+
+	/// Collects changes to the directories watched, then recooks and reloads each
+	/// source unchanged since now less the debounce interval.  Returns the number of
+	/// sources recooked.
+	uint update (
+		Clock::time_point now = Clock::now ()
+	);
+
+	/// Forbid copying of HotReloader objects.
+	HotReloader (const HotReloader & other) = delete;
+	HotReloader & operator = (const HotReloader & other) = delete;
+
+private:
+	/// A directory watched, with a read of its changes pending.
+	struct Directory;
+
+	/// Begins reading the next changes to directory.  Returns false if it could not.
+	bool listen (
+		Directory & directory
+	);
+
+	/// Notifies each change read from directory, then begins reading the next.
+	void poll (
+		Directory & directory,
+		Clock::time_point now
+	);
+
+	/// Recooks the source at path, and reloads the asset it was cooked into.  Returns
+	/// false, after logging the reason, if it could not.
+	bool reload (
+		const std::string & path
+	);
+
+	bool reloadMesh (
+		const std::string & path
+	);
+
+	bool reloadShader (
+		const std::string & path
+	);
+
+	const Clock::duration _debounce;
+	std::vector<std::unique_ptr<Directory>> _directories;
+
+	// Directory searched for material libraries not beside their mesh.
+	std::string _materialDirectory;
+
+	std::function<void ()> _barrier;
+
+	// Time each source changed last, until it is reloaded.
+	std::unordered_map<std::string, Clock::time_point> _pending;
+};
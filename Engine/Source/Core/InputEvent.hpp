@@ -0,0 +1,30 @@
+//
+// InputEvent.hpp
+//
+#pragma once
+
+#include <chrono>
+
+#include "Core/Types.hpp"
+
+
+enum class InputEventType : uint8 {
+	KeyDown,
+	KeyUp
+};
+
+/// An input message sent from the window thread to the simulation, stamped with the
+/// time it was received so the simulation can order and age events within a frame.
+struct InputEvent {
+	InputEventType type;
+	uint8 virtualKey;
+
+	/// Microseconds on the steady clock, as returned by Now().
+	uint64 timestamp;
+
+	static uint64 Now ()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds> (
+			std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+	}
+};
@@ -31,7 +31,7 @@ void InputHandler::keyDown (
 		default: break;
 	}
 
-	LOG_INFO("%c Key Pressed", static_cast<char>(virtualKey));
+	LOG_CATEGORY_INFO (Input, "%c Key Pressed", static_cast<char>(virtualKey));
 }
 
 //---------------------------------------------------------------------------------------
@@ -47,5 +47,5 @@ void InputHandler::keyUp (
 		default: break;
 	}
 
-	LOG_INFO("%c Key Up", static_cast<char>(virtualKey));
+	LOG_CATEGORY_INFO (Input, "%c Key Up", static_cast<char>(virtualKey));
 }
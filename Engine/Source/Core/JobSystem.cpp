@@ -0,0 +1,432 @@
+//
+// JobSystem.cpp
+//
+#include "pch.h"
+
+#include "Core/JobSystem.hpp"
+#include "Core/Profiler.hpp"
+
+// Fibers migrate between threads, so thread_local addresses must not be cached across
+// fiber switches.  MSVC guarantees this when building with /GT, and keeping the lookup
+// out of line prevents other compilers from hoisting it.
+#if defined(_MSC_VER)
+	#define NOINLINE __declspec(noinline)
+#else
+	#define NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+	// Failed attempts to find a job before an idle worker goes to sleep.
+	const uint IDLE_SPIN_COUNT = 64;
+
+	// JobSystem that spawned the current thread, and the thread's context within it.
+	thread_local const JobSystem * t_jobSystem = nullptr;
+	thread_local void * t_context = nullptr;
+}
+
+
+//---------------------------------------------------------------------------------------
+JobCounter::JobCounter ()
+	: _pending (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+bool JobCounter::isDone () const
+{
+	return _pending.load (std::memory_order_acquire) == 0;
+}
+
+//---------------------------------------------------------------------------------------
+JobSystem::ThreadContext::ThreadContext (
+	uint index,
+	size_t scratchBytes
+)
+	: index (index),
+	  queue (MAX_JOBS_PER_THREAD),
+	  jobs (new Job[MAX_JOBS_PER_THREAD]),
+	  nextJob (0),
+	  scratchMemory (new byte[scratchBytes]),
+	  scratch (scratchMemory.get (), scratchBytes),
+	  currentFiber (&threadFiber),
+	  startFiber (nullptr),
+	  pendingAction (FiberAction::None),
+	  pendingFiber (nullptr),
+	  pendingCounter (nullptr)
+{
+	for (uint32 i (0); i < MAX_JOBS_PER_THREAD; ++i) {
+		jobs[i].inUse.store (false, std::memory_order_relaxed);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+JobSystem::JobSystem (
+	uint numWorkerThreads,
+	JobWaitMode waitMode,
+	size_t scratchBytesPerThread
+)
+	: _ownerThreadId (std::this_thread::get_id ()),
+	  _waitMode (waitMode),
+	  _queuedJobs (0),
+	  _sleepingWorkers (0),
+	  _shutdown (false),
+	  _parkedFiberCount (0)
+{
+	// Contexts must all exist before any worker starts stealing.
+	for (uint i (0); i <= numWorkerThreads; ++i) {
+		_contexts.emplace_back (new ThreadContext (i, scratchBytesPerThread));
+	}
+
+	if (waitMode == JobWaitMode::SwitchFibers) {
+		// Each worker needs a fiber to run its scheduler on.
+		assert (numWorkerThreads < NUM_FIBERS);
+
+		for (uint i (0); i < NUM_FIBERS; ++i) {
+			_fibers.emplace_back (new Fiber ());
+			_fibers.back ()->create (FIBER_STACK_SIZE, &JobSystem::FiberMain, this);
+			_fiberPool.push_back (_fibers.back ().get ());
+		}
+
+		// Workers may start after jobs submitted meanwhile have parked the rest.
+		for (uint i (1); i <= numWorkerThreads; ++i) {
+			_contexts[i]->startFiber = acquireFiber ();
+		}
+	}
+
+	_threads.reserve (numWorkerThreads);
+	for (uint i (1); i <= numWorkerThreads; ++i) {
+		_threads.emplace_back (&JobSystem::workerMain, this, i);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+JobSystem::~JobSystem ()
+{
+	{
+		std::lock_guard<std::mutex> lock (_mutex);
+		_shutdown = true;
+	}
+	_jobsAvailable.notify_all ();
+
+	for (std::thread & thread : _threads) {
+		thread.join ();
+	}
+
+	resetScratchAllocators ();
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::wait (
+	JobCounter & counter
+) {
+	while (!counter.isDone ()) {
+		// Fibers migrate between threads, so the context is looked up each iteration.
+		ThreadContext & context = currentContext ();
+
+		// Jobs running on a worker's fiber park it, freeing the worker for other jobs.
+		if (context.currentFiber != &context.threadFiber) {
+			Fiber * next = takeReadyFiber ();
+			if (!next) {
+				next = acquireFiber ();
+			}
+			if (next) {
+				// Resumes once counter has reached zero.
+				switchFiber (context, next, FiberAction::Park, &counter);
+				continue;
+			}
+		}
+
+		if (!executeNextJob (context)) {
+			std::this_thread::yield ();
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool JobSystem::executeJob ()
+{
+	return executeNextJob (currentContext ());
+}
+
+//---------------------------------------------------------------------------------------
+LinearAllocator & JobSystem::scratchAllocator ()
+{
+	return currentContext ().scratch;
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::resetScratchAllocators ()
+{
+	for (auto & context : _contexts) {
+		context->scratch.reset ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint JobSystem::threadCount () const
+{
+	return static_cast<uint>(_contexts.size ());
+}
+
+//---------------------------------------------------------------------------------------
+uint JobSystem::threadIndex () const
+{
+	return currentContext ().index;
+}
+
+//---------------------------------------------------------------------------------------
+uint JobSystem::DefaultWorkerThreadCount ()
+{
+	const uint hardwareThreads = std::thread::hardware_concurrency ();
+	return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+//---------------------------------------------------------------------------------------
+NOINLINE JobSystem::ThreadContext & JobSystem::currentContext () const
+{
+	if (t_jobSystem == this) {
+		return *static_cast<ThreadContext *>(t_context);
+	}
+
+	// Assert caller is the constructing thread, as only it and workers can run jobs.
+	assert (std::this_thread::get_id () == _ownerThreadId);
+	return *_contexts[0];
+}
+
+//---------------------------------------------------------------------------------------
+Job * JobSystem::allocateJob ()
+{
+	while (true) {
+		ThreadContext & context = currentContext ();
+		for (uint32 i (0); i < MAX_JOBS_PER_THREAD; ++i) {
+			Job * job = &context.jobs[context.nextJob++ & (MAX_JOBS_PER_THREAD - 1)];
+			if (!job->inUse.load (std::memory_order_acquire)) {
+				job->inUse.store (true, std::memory_order_relaxed);
+				return job;
+			}
+		}
+
+		// Every job of this thread is incomplete, so help complete some.
+		if (!executeNextJob (context)) {
+			std::this_thread::yield ();
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::submit (
+	Job * job
+) {
+	// Count the job before it can be taken, so the count never drops below zero.
+	_queuedJobs.fetch_add (1, std::memory_order_seq_cst);
+	currentContext ().queue.push (job);
+
+	// Sleeping workers check _queuedJobs while holding _mutex, so taking it here
+	// ensures the notification cannot slip in before they wait.
+	if (_sleepingWorkers.load (std::memory_order_seq_cst) > 0) {
+		std::lock_guard<std::mutex> lock (_mutex);
+		_jobsAvailable.notify_one ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool JobSystem::executeNextJob (
+	ThreadContext & context
+) {
+	Job * job = findJob (context);
+	if (!job) {
+		return false;
+	}
+	_queuedJobs.fetch_sub (1, std::memory_order_relaxed);
+
+	JobCounter * counter = job->counter;
+	job->execute (*job);
+	job->inUse.store (false, std::memory_order_release);
+
+	if (counter) {
+		counter->_pending.fetch_sub (1, std::memory_order_release);
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+Job * JobSystem::findJob (
+	ThreadContext & context
+) {
+	if (Job * job = context.queue.pop ()) {
+		return job;
+	}
+
+	// Steal from the other threads, starting with the next one along so that thieves
+	// spread out across victims.
+	const uint numContexts = threadCount ();
+	for (uint i (1); i < numContexts; ++i) {
+		ThreadContext & victim = *_contexts[(context.index + i) % numContexts];
+		if (Job * job = victim.queue.steal ()) {
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::workerMain (
+	uint index
+) {
+	ThreadContext & context = *_contexts[index];
+	t_jobSystem = this;
+	t_context = &context;
+	Profiler::SetThreadName (("Worker " + std::to_string (index)).c_str ());
+
+	if (_waitMode == JobWaitMode::SwitchFibers) {
+		context.threadFiber.convertFromThread ();
+		switchFiber (context, context.startFiber, FiberAction::None, nullptr);
+
+		// Switched back to by the last fiber to run on this thread after shutdown.
+		context.threadFiber.convertToThread ();
+	}
+	else {
+		runScheduler ();
+	}
+
+	t_jobSystem = nullptr;
+	t_context = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::runScheduler ()
+{
+	uint idleCount = 0;
+	while (!_shutdown.load (std::memory_order_relaxed)) {
+		// Fibers migrate between threads, so the context is looked up each iteration.
+		ThreadContext & context = currentContext ();
+
+		if (Fiber * fiber = takeReadyFiber ()) {
+			switchFiber (context, fiber, FiberAction::Release, nullptr);
+			idleCount = 0;
+			continue;
+		}
+
+		if (executeNextJob (context)) {
+			idleCount = 0;
+			continue;
+		}
+
+		if (++idleCount < IDLE_SPIN_COUNT) {
+			std::this_thread::yield ();
+			continue;
+		}
+
+		// Parked fibers are resumed by polling their counters, so workers stay awake
+		// while any remain.
+		std::unique_lock<std::mutex> lock (_mutex);
+		_sleepingWorkers.fetch_add (1, std::memory_order_seq_cst);
+		_jobsAvailable.wait (lock, [this] {
+			return _shutdown ||
+				_queuedJobs.load (std::memory_order_seq_cst) > 0 ||
+				_parkedFiberCount.load (std::memory_order_relaxed) > 0;
+		});
+		_sleepingWorkers.fetch_sub (1, std::memory_order_relaxed);
+		idleCount = 0;
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::FiberMain (
+	void * jobSystem
+) {
+	JobSystem * self = static_cast<JobSystem *>(jobSystem);
+	self->completeFiberAction (self->currentContext ());
+
+	while (true) {
+		self->runScheduler ();
+
+		// Shutting down, so return to the thread this fiber finished on.  Workers that
+		// start late may still acquire the fiber again after it has been released.
+		ThreadContext & context = self->currentContext ();
+		self->switchFiber (context, &context.threadFiber, FiberAction::Release, nullptr);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::switchFiber (
+	ThreadContext & context,
+	Fiber * target,
+	FiberAction action,
+	const JobCounter * counter
+) {
+	assert (target);
+
+	Fiber * current = context.currentFiber;
+	context.pendingAction = action;
+	context.pendingFiber = current;
+	context.pendingCounter = counter;
+	context.currentFiber = target;
+
+	current->switchTo (*target);
+
+	// Resumed, possibly on a different thread.
+	completeFiberAction (currentContext ());
+}
+
+//---------------------------------------------------------------------------------------
+void JobSystem::completeFiberAction (
+	ThreadContext & context
+) {
+	switch (context.pendingAction) {
+	case FiberAction::Release: {
+		std::lock_guard<std::mutex> lock (_fiberMutex);
+		_fiberPool.push_back (context.pendingFiber);
+		break;
+	}
+	case FiberAction::Park: {
+		std::lock_guard<std::mutex> lock (_fiberMutex);
+		_parkedFibers.push_back ({context.pendingFiber, context.pendingCounter});
+		_parkedFiberCount.fetch_add (1, std::memory_order_relaxed);
+		break;
+	}
+	case FiberAction::None:
+		break;
+	}
+
+	context.pendingAction = FiberAction::None;
+	context.pendingFiber = nullptr;
+	context.pendingCounter = nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+Fiber * JobSystem::acquireFiber ()
+{
+	std::lock_guard<std::mutex> lock (_fiberMutex);
+	if (_fiberPool.empty ()) {
+		return nullptr;
+	}
+
+	Fiber * fiber = _fiberPool.back ();
+	_fiberPool.pop_back ();
+	return fiber;
+}
+
+//---------------------------------------------------------------------------------------
+Fiber * JobSystem::takeReadyFiber ()
+{
+	if (_parkedFiberCount.load (std::memory_order_relaxed) == 0) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock (_fiberMutex);
+	for (size_t i (0); i < _parkedFibers.size (); ++i) {
+		if (_parkedFibers[i].counter->isDone ()) {
+			Fiber * fiber = _parkedFibers[i].fiber;
+			_parkedFibers[i] = _parkedFibers.back ();
+			_parkedFibers.pop_back ();
+			_parkedFiberCount.fetch_sub (1, std::memory_order_relaxed);
+			return fiber;
+		}
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,272 @@
+//
+// JobSystem.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/Fiber.hpp"
+#include "Core/Memory.hpp"
+#include "Core/WorkStealingQueue.hpp"
+
+class JobCounter;
+
+
+/// A unit of work queued on a JobSystem.  Jobs store their function object inline, so
+/// submitting one never allocates.
+struct Job {
+	/// Maximum size of a job's function object, including its captures.
+	static const size_t DATA_SIZE = 40;
+
+	/// Invokes, then destroys, the function object stored in data.
+	void (*execute) (Job & job);
+
+	/// Decremented once the job completes, or nullptr.
+	JobCounter * counter;
+
+	alignas(16) byte data[DATA_SIZE];
+
+	/// Set from submission until the job has completed, after which it may be reused.
+	std::atomic<bool> inUse;
+};
+
+
+/// Counts jobs that have been submitted but not yet completed, so a group of jobs can
+/// be waited on together.
+class JobCounter {
+public:
+	JobCounter ();
+
+	/// Returns true once every job associated with the counter has completed.
+	bool isDone () const;
+
+	/// Forbid copying of JobCounter objects.
+	JobCounter (const JobCounter & other) = delete;
+	JobCounter & operator = (const JobCounter & other) = delete;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32> _pending;
+};
+
+
+/// How a job waiting on a JobCounter occupies its worker thread.
+enum class JobWaitMode : uint8 {
+	/// The waiting job stays on the thread's stack while the thread executes other
+	/// jobs on top of it.
+	ExecuteJobs,
+
+	/// Worker threads execute jobs on fibers.  A waiting job suspends its fiber, and
+	/// the worker switches to another fiber to continue executing jobs.  The suspended
+	/// fiber resumes, on any worker, once its counter reaches zero.
+	SwitchFibers
+};
+
+
+/// Executes jobs across one worker thread per core, balancing load by work stealing.
+///
+/// Each thread owns a WorkStealingQueue.  Jobs are pushed onto the submitting thread's
+/// queue, and threads that run out of work steal from the queues of others.  Threads
+/// waiting on a JobCounter execute pending jobs rather than blocking, while idle
+/// worker threads sleep until new jobs are submitted.
+///
+/// Jobs may be submitted from within other jobs, or from the thread that constructed
+/// the JobSystem, which participates in executing jobs whenever it waits.  A thread
+/// with MAX_JOBS_PER_THREAD incomplete jobs executes pending jobs until one of its own
+/// completes before submitting another.
+///
+/// The constructing thread never switches fibers, so jobs it executes always wait as
+/// in JobWaitMode::ExecuteJobs.
+class JobSystem {
+public:
+	/// Maximum number of incomplete jobs submitted by a single thread.
+	static const uint32 MAX_JOBS_PER_THREAD = 4096;
+
+	/// Number of fibers available to worker threads in JobWaitMode::SwitchFibers,
+	/// which bounds the number of jobs that can be waiting at once.  One is reserved
+	/// for each worker to start on, and jobs that wait once every other fiber is in use
+	/// fall back to executing other jobs.
+	static const uint NUM_FIBERS = 128;
+
+	/// Stack size of each fiber, in bytes.
+	static const size_t FIBER_STACK_SIZE = 65536;
+
+	/// Spawns numWorkerThreads threads in addition to the calling thread.
+	JobSystem (
+		uint numWorkerThreads,
+		JobWaitMode waitMode = JobWaitMode::ExecuteJobs,
+		size_t scratchBytesPerThread = 1048576
+	);
+
+	/// Stops all worker threads.  Submitted jobs must have been waited on.
+	~JobSystem ();
+
+	/// Queues function to be invoked with no arguments on any thread.  If counter is
+	/// not nullptr, it remains non-zero until function has returned.
+	///
+	/// Function objects are stored within the Job, so must be no larger than
+	/// Job::DATA_SIZE.  Capture large state by reference.
+	template <typename Function>
+	void run (
+		Function && function,
+		JobCounter * counter = nullptr
+	);
+
+	/// Returns once counter reaches zero, executing pending jobs or switching fibers in
+	/// the meantime according to the JobWaitMode.
+	void wait (
+		JobCounter & counter
+	);
+
+	/// Executes one pending job on the calling thread, returning false if none could be
+	/// found.  For waiting on conditions other than a JobCounter.
+	bool executeJob ();
+
+	/// Returns the calling thread's scratch allocator, for memory needed only until
+	/// the next call to resetScratchAllocators().
+	LinearAllocator & scratchAllocator ();
+
+	/// Deallocates everything allocated from every thread's scratch allocator.  Must
+	/// not be called while jobs are executing, such as at the end of a frame.
+	void resetScratchAllocators ();
+
+	/// Number of threads that execute jobs, including the constructing thread.
+	uint threadCount () const;
+
+	/// Index of the calling thread within [0, threadCount()), where 0 is the thread
+	/// that constructed the JobSystem.
+	uint threadIndex () const;
+
+	/// Returns one worker thread per core, leaving a core for the constructing thread.
+	static uint DefaultWorkerThreadCount ();
+
+
+	/// Forbid copying of JobSystem objects.
+	JobSystem (const JobSystem & other) = delete;
+	JobSystem & operator = (const JobSystem & other) = delete;
+
+private:
+	/// Work to finish on behalf of a fiber once it has been switched away from, and
+	/// its stack is no longer in use.
+	enum class FiberAction : uint8 {
+		None,
+		Release,  ///< Return the fiber to the pool.
+		Park      ///< Suspend the fiber until its counter reaches zero.
+	};
+
+	/// A fiber suspended within wait().
+	struct ParkedFiber {
+		Fiber * fiber;
+		const JobCounter * counter;
+	};
+
+	/// State owned by each thread executing jobs.
+	struct ThreadContext {
+		ThreadContext (
+			uint index,
+			size_t scratchBytes
+		);
+
+		const uint index;
+		WorkStealingQueue queue;
+
+		// Pool from which this thread's jobs are allocated, searched round-robin for
+		// completed jobs.
+		std::unique_ptr<Job[]> jobs;
+		uint32 nextJob;
+
+		std::unique_ptr<byte[]> scratchMemory;
+		LinearAllocator scratch;
+
+		// The thread's own fiber, and the fiber it is currently running.
+		Fiber threadFiber;
+		Fiber * currentFiber;
+
+		// Fiber reserved for a worker to start its scheduler on, taken from the pool at
+		// construction so that jobs parking every other fiber cannot leave it without.
+		Fiber * startFiber;
+
+		// Set by switchFiber() for the fiber being switched to to complete.
+		FiberAction pendingAction;
+		Fiber * pendingFiber;
+		const JobCounter * pendingCounter;
+	};
+
+	ThreadContext & currentContext () const;
+
+	Job * allocateJob ();
+
+	void submit (
+		Job * job
+	);
+
+	/// Executes one pending job, returning false if none could be found.
+	bool executeNextJob (
+		ThreadContext & context
+	);
+
+	Job * findJob (
+		ThreadContext & context
+	);
+
+	void workerMain (
+		uint index
+	);
+
+	/// Executes jobs, and in JobWaitMode::SwitchFibers resumes parked fibers, until
+	/// the JobSystem shuts down.
+	void runScheduler ();
+
+	static void FiberMain (
+		void * jobSystem
+	);
+
+	/// Switches the calling thread from its current fiber to target, leaving action
+	/// to be applied to the current fiber once target is running.
+	void switchFiber (
+		ThreadContext & context,
+		Fiber * target,
+		FiberAction action,
+		const JobCounter * counter
+	);
+
+	void completeFiberAction (
+		ThreadContext & context
+	);
+
+	/// Removes a fiber from the pool, or returns nullptr if none remain.
+	Fiber * acquireFiber ();
+
+	/// Removes a parked fiber whose counter has reached zero, or returns nullptr.
+	Fiber * takeReadyFiber ();
+
+	const std::thread::id _ownerThreadId;
+	const JobWaitMode _waitMode;
+	std::vector<std::unique_ptr<ThreadContext>> _contexts;
+	std::vector<std::thread> _threads;
+
+	// Idle workers sleep on _jobsAvailable until _queuedJobs becomes non-zero.
+	std::mutex _mutex;
+	std::condition_variable _jobsAvailable;
+	std::atomic<uint32> _queuedJobs;
+	std::atomic<uint32> _sleepingWorkers;
+	std::atomic<bool> _shutdown;
+
+	std::vector<std::unique_ptr<Fiber>> _fibers;
+
+	// Pool of idle fibers, and fibers parked until their counters reach zero.
+	std::mutex _fiberMutex;
+	std::vector<Fiber *> _fiberPool;
+	std::vector<ParkedFiber> _parkedFibers;
+	std::atomic<uint32> _parkedFiberCount;
+};
+
+
+#include "Core/JobSystem.inl"
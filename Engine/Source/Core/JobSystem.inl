@@ -0,0 +1,34 @@
+//
+// JobSystem.inl
+//
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//---------------------------------------------------------------------------------------
+template <typename Function>
+void JobSystem::run (
+	Function && function,
+	JobCounter * counter
+) {
+	typedef typename std::decay<Function>::type FunctionType;
+	static_assert (sizeof (FunctionType) <= Job::DATA_SIZE,
+		"Job function is too large, capture its state by reference.");
+	static_assert (alignof (FunctionType) <= alignof (Job),
+		"Job function is over-aligned.");
+
+	Job * job = allocateJob ();
+	new (job->data) FunctionType (std::forward<Function> (function));
+	job->execute = [] (Job & job) {
+		FunctionType & function = *reinterpret_cast<FunctionType *>(job.data);
+		function ();
+		function.~FunctionType ();
+	};
+	job->counter = counter;
+
+	if (counter) {
+		counter->_pending.fetch_add (1, std::memory_order_relaxed);
+	}
+
+	submit (job);
+}
@@ -0,0 +1,383 @@
+//
+// Logger.cpp
+//
+#include "pch.h"
+
+#include "Core/Logger.hpp"
+#include "Core/SpscQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+	// Longest formatted message.  Longer messages are truncated.
+	const size_t MESSAGE_LENGTH = 512;
+
+	// How often the background thread drains the queues when not asked to flush.
+	const std::chrono::milliseconds DRAIN_INTERVAL (5);
+
+	const char * levelPrefix (
+		LogLevel level
+	) {
+		switch (level) {
+			case LogLevel::Info: return "Log Info: ";
+			case LogLevel::Warning: return "Log Warning: ";
+			case LogLevel::Error: return "Log Error: ";
+			case LogLevel::Off: break;
+		}
+		return "";
+	}
+
+	const char * categoryName (
+		LogCategory category
+	) {
+		switch (category) {
+			case LogCategory::General: return "General";
+			case LogCategory::Input: return "Input";
+			case LogCategory::Render: return "Render";
+			case LogCategory::Assets: return "Assets";
+			case LogCategory::Memory: return "Memory";
+			case LogCategory::Jobs: return "Jobs";
+			case LogCategory::Count: break;
+		}
+		return "";
+	}
+
+	struct ThreadQueue {
+		ThreadQueue ()
+			: records (Logger::RECORDS_PER_THREAD),
+			  dropped (0),
+			  retired (false)
+		{
+
+		}
+
+		SpscQueue<LogRecord> records;
+		std::atomic<uint64> dropped;
+
+		// Set once the owning thread has exited, so no more records will be pushed.
+		std::atomic<bool> retired;
+	};
+
+	/// Owns the calling thread's queue, retiring it when the thread exits.
+	struct ThreadQueueOwner {
+		~ThreadQueueOwner ()
+		{
+			if (queue) {
+				queue->retired.store (true, std::memory_order_release);
+			}
+		}
+
+		std::shared_ptr<ThreadQueue> queue;
+	};
+
+	thread_local ThreadQueueOwner t_queueOwner;
+
+	class LogWriter {
+	public:
+		LogWriter ()
+			: _stopping (false),
+			  _flushRequested (0),
+			  _flushCompleted (0),
+			  _dropped (0),
+			  _output (nullptr),
+			  _startTicks (__rdtsc ()),
+			  _startTime (std::chrono::steady_clock::now ())
+		{
+			_thread = std::thread (&LogWriter::writerMain, this);
+		}
+
+		~LogWriter ()
+		{
+			{
+				std::lock_guard<std::mutex> lock (_mutex);
+				_stopping = true;
+			}
+			_wake.notify_one ();
+			_thread.join ();
+		}
+
+		std::shared_ptr<ThreadQueue> registerThread ()
+		{
+			std::lock_guard<std::mutex> lock (_mutex);
+			_queues.push_back (std::make_shared<ThreadQueue> ());
+			return _queues.back ();
+		}
+
+		void flush ()
+		{
+			std::unique_lock<std::mutex> lock (_mutex);
+			const uint64 ticket = ++_flushRequested;
+			_wake.notify_one ();
+			_flushed.wait (lock, [&] { return _flushCompleted >= ticket; });
+		}
+
+		bool setOutputFile (
+			const char * path
+		) {
+			flush ();
+
+			std::unique_ptr<std::ofstream> output;
+			if (path) {
+				output.reset (new std::ofstream (path, std::ios::out | std::ios::binary));
+				if (!*output) {
+					return false;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock (_outputMutex);
+			_output = std::move (output);
+			return true;
+		}
+
+		uint64 droppedCount ()
+		{
+			std::lock_guard<std::mutex> lock (_mutex);
+			uint64 dropped = _dropped;
+			for (auto & queue : _queues) {
+				dropped += queue->dropped.load (std::memory_order_relaxed);
+			}
+			return dropped;
+		}
+
+	private:
+		void writerMain ()
+		{
+			std::unique_lock<std::mutex> lock (_mutex);
+			while (true) {
+				_wake.wait_for (lock, DRAIN_INTERVAL, [&] {
+					return _stopping || _flushRequested > _flushCompleted;
+				});
+
+				// Records pushed before a flush was requested are visible once the
+				// mutex has been reacquired, so draining now completes the request.
+				const uint64 request = _flushRequested;
+				const bool stopping = _stopping;
+
+				std::vector<std::shared_ptr<ThreadQueue>> queues = _queues;
+				lock.unlock ();
+
+				drain (queues);
+
+				lock.lock ();
+				retireQueues ();
+				_flushCompleted = request;
+				_flushed.notify_all ();
+
+				if (stopping) {
+					break;
+				}
+			}
+		}
+
+		/// Writes every queued record in timestamp order.  Each thread's records are
+		/// already in order, and a stable sort keeps records with equal timestamps in
+		/// the order they were queued.
+		void drain (
+			const std::vector<std::shared_ptr<ThreadQueue>> & queues
+		) {
+			_batch.clear ();
+			uint64 dropped = 0;
+			LogRecord record;
+			for (auto & queue : queues) {
+				while (queue->records.tryPop (record)) {
+					_batch.push_back (record);
+				}
+				dropped += queue->dropped.exchange (0, std::memory_order_relaxed);
+			}
+
+			std::stable_sort (_batch.begin (), _batch.end (),
+				[] (const LogRecord & a, const LogRecord & b) { return a.ticks < b.ticks; });
+
+			std::lock_guard<std::mutex> lock (_outputMutex);
+			const double ticksPerSecond = measureTickRate ();
+			for (const LogRecord & record : _batch) {
+				write (record, ticksPerSecond);
+			}
+
+			if (dropped > 0) {
+				char line[MESSAGE_LENGTH];
+				std::snprintf (line, sizeof (line),
+					"%s%llu messages dropped, log queue full.\n",
+					levelPrefix (LogLevel::Warning), static_cast<unsigned long long>(dropped));
+				writeLine (line);
+
+				std::lock_guard<std::mutex> droppedLock (_mutex);
+				_dropped += dropped;
+			}
+
+			if (_output) {
+				_output->flush ();
+			} else {
+				std::fflush (stdout);
+			}
+		}
+
+		void write (
+			const LogRecord & record,
+			double ticksPerSecond
+		) {
+			char line[MESSAGE_LENGTH];
+			const double seconds = int64 (record.ticks - _startTicks) / ticksPerSecond;
+			int length = std::snprintf (line, sizeof (line), "[%10.6f] %s",
+				seconds, levelPrefix (record.site->level));
+
+			// Messages without a category are written as before categories existed.
+			if (record.site->category != LogCategory::General) {
+				length += std::snprintf (line + length, sizeof (line) - length, "[%s] ",
+					categoryName (record.site->category));
+			}
+
+			const int messageLength = record.formatFunction (record, line + length,
+				sizeof (line) - length - 1);
+			length = std::min<int> (length + std::max (messageLength, 0),
+				int (sizeof (line)) - 2);
+
+			if (record.suppressed > 0) {
+				const int noteLength = std::snprintf (line + length, sizeof (line) - length - 1,
+					" (%u similar messages suppressed)", record.suppressed);
+				length = std::min<int> (length + std::max (noteLength, 0),
+					int (sizeof (line)) - 2);
+			}
+
+			line[length] = '\n';
+			line[length + 1] = '\0';
+			writeLine (line);
+		}
+
+		void writeLine (
+			const char * line
+		) {
+			if (_output) {
+				*_output << line;
+			} else {
+				std::fputs (line, stdout);
+			}
+
+#if defined(WIN32)
+			OutputDebugString (line);
+#endif
+		}
+
+		/// Timestamp counter ticks per second, measured since the writer started.
+		double measureTickRate () const
+		{
+			const double seconds = std::chrono::duration<double> (
+				std::chrono::steady_clock::now () - _startTime).count ();
+			const uint64 ticks = __rdtsc () - _startTicks;
+			return seconds > 0.0 && ticks > 0 ? ticks / seconds : 1.0;
+		}
+
+		/// Removes queues whose threads have exited and whose records have been written.
+		void retireQueues ()
+		{
+			_queues.erase (std::remove_if (_queues.begin (), _queues.end (),
+				[] (const std::shared_ptr<ThreadQueue> & queue) {
+					return queue->retired.load (std::memory_order_acquire) &&
+						queue->records.size () == 0 &&
+						queue->dropped.load (std::memory_order_relaxed) == 0;
+				}), _queues.end ());
+		}
+
+		std::thread _thread;
+
+		// Guards the members up to _outputMutex.
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::condition_variable _flushed;
+		bool _stopping;
+		uint64 _flushRequested;
+		uint64 _flushCompleted;
+		uint64 _dropped;
+		std::vector<std::shared_ptr<ThreadQueue>> _queues;
+
+		// Guards the output, which is only otherwise used by the writer thread.
+		std::mutex _outputMutex;
+		std::unique_ptr<std::ofstream> _output;
+
+		std::vector<LogRecord> _batch;
+		const uint64 _startTicks;
+		const std::chrono::steady_clock::time_point _startTime;
+	};
+
+	/// Starts the background thread on first use, and stops it after writing any
+	/// remaining records at exit.
+	LogWriter & writer ()
+	{
+		static LogWriter instance;
+		return instance;
+	}
+}
+
+
+std::atomic<uint8> Logger::_levels[size_t (LogCategory::Count)];
+std::atomic<uint32> Logger::_rateLimitBurst (Logger::DEFAULT_RATE_LIMIT_BURST);
+std::atomic<uint32> Logger::_rateLimitMilliseconds (Logger::DEFAULT_RATE_LIMIT_MILLISECONDS);
+
+
+//---------------------------------------------------------------------------------------
+void Logger::Push (
+	const LogRecord & record
+) {
+	ThreadQueueOwner & owner = t_queueOwner;
+	if (!owner.queue) {
+		owner.queue = writer ().registerThread ();
+	}
+
+	if (!owner.queue->records.tryPush (record)) {
+		owner.queue->dropped.fetch_add (1, std::memory_order_relaxed);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void Logger::Flush ()
+{
+	writer ().flush ();
+}
+
+//---------------------------------------------------------------------------------------
+bool Logger::SetOutputFile (
+	const char * path
+) {
+	return writer ().setOutputFile (path);
+}
+
+//---------------------------------------------------------------------------------------
+uint64 Logger::DroppedCount ()
+{
+	return writer ().droppedCount ();
+}
+
+//---------------------------------------------------------------------------------------
+void Logger::SetLevel (
+	LogCategory category,
+	LogLevel level
+) {
+	_levels[uint8 (category)].store (uint8 (level), std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------------------
+LogLevel Logger::Level (
+	LogCategory category
+) {
+	return LogLevel (_levels[uint8 (category)].load (std::memory_order_relaxed));
+}
+
+//---------------------------------------------------------------------------------------
+void Logger::SetRateLimit (
+	uint32 burst,
+	uint32 milliseconds
+) {
+	_rateLimitBurst.store (burst, std::memory_order_relaxed);
+	_rateLimitMilliseconds.store (milliseconds, std::memory_order_relaxed);
+}
@@ -0,0 +1,241 @@
+//
+// Logger.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#else
+	#include <x86intrin.h>
+#endif
+
+#include "Core/Types.hpp"
+
+
+enum class LogLevel : uint8 {
+	Info,
+	Warning,
+	Error,
+
+	// Only used as a minimum level, to disable every message.
+	Off
+};
+
+
+/// Subsystem a message comes from, so that each can be filtered separately.
+enum class LogCategory : uint8 {
+	General,
+	Input,
+	Render,
+	Assets,
+	Memory,
+	Jobs,
+
+	Count
+};
+
+
+// Minimum level compiled in for each category, as a LogLevel value.  Calls to log below
+// it are constant false conditions, so are removed along with their arguments.  Define
+// LOG_MIN_LEVEL to change every category, or LOG_MIN_LEVEL_<CATEGORY> for one.
+#ifndef LOG_MIN_LEVEL
+	#define LOG_MIN_LEVEL 0
+#endif
+#ifndef LOG_MIN_LEVEL_GENERAL
+	#define LOG_MIN_LEVEL_GENERAL LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_INPUT
+	#define LOG_MIN_LEVEL_INPUT LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_RENDER
+	#define LOG_MIN_LEVEL_RENDER LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_ASSETS
+	#define LOG_MIN_LEVEL_ASSETS LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_MEMORY
+	#define LOG_MIN_LEVEL_MEMORY LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_JOBS
+	#define LOG_MIN_LEVEL_JOBS LOG_MIN_LEVEL
+#endif
+
+namespace logging
+{
+	constexpr uint8 COMPILED_LEVELS[] = {
+		LOG_MIN_LEVEL_GENERAL,
+		LOG_MIN_LEVEL_INPUT,
+		LOG_MIN_LEVEL_RENDER,
+		LOG_MIN_LEVEL_ASSETS,
+		LOG_MIN_LEVEL_MEMORY,
+		LOG_MIN_LEVEL_JOBS
+	};
+
+	static_assert (sizeof (COMPILED_LEVELS) == size_t (LogCategory::Count),
+		"Every LogCategory needs a compiled minimum level.");
+}
+
+/// True if messages of level in category are compiled in.
+constexpr bool LogCompiledIn (
+	LogCategory category,
+	LogLevel level
+) {
+	return uint8 (level) >= logging::COMPILED_LEVELS[uint8 (category)];
+}
+
+
+/// A single logging statement.  Each call site owns a static LogSite, whose address
+/// identifies the statement within its queued records.
+struct LogSite {
+	/// Constant initialized, so a function's static site is ready before it first runs.
+	constexpr LogSite (
+		LogCategory category,
+		LogLevel level,
+		const char * format
+	)
+		: category (category),
+		  level (level),
+		  format (format),
+		  windowCount (0),
+		  windowStart (0),
+		  suppressed (0)
+	{
+
+	}
+
+	LogCategory category;
+	LogLevel level;
+
+	// printf style format string.  Must outlive the logger.
+	const char * format;
+
+	// Rate limiting state, shared by every thread logging from the site.  Messages
+	// counted since the current window started, the time in milliseconds it started,
+	// and messages suppressed within it.
+	std::atomic<uint32> windowCount;
+	std::atomic<uint64> windowStart;
+	std::atomic<uint32> suppressed;
+};
+
+
+struct LogRecord;
+
+/// Formats a record's arguments with its site's format string into buffer, returning the
+/// number of characters snprintf would have written.
+typedef int (* LogFormatFunction) (
+	const LogRecord & record,
+	char * buffer,
+	size_t bufferSize
+);
+
+
+/// Raw, unformatted arguments of one logging statement.
+struct LogRecord {
+	/// Bytes available for arguments.  Strings are truncated to fit, ending in "...".
+	static const uint32 ARGUMENT_BYTES = 100;
+
+	const LogSite * site;
+	LogFormatFunction formatFunction;
+	uint64 ticks;
+
+	// Messages from the same site suppressed by rate limiting since the last one written.
+	uint32 suppressed;
+
+	byte arguments[ARGUMENT_BYTES];
+};
+
+
+/// Deferred logger.
+///
+/// Logging a message copies the call site's address, a timestamp and the raw arguments
+/// into a lock-free queue owned by the calling thread, without formatting anything.
+/// A background thread drains every thread's queue, formats the records in timestamp
+/// order and writes them to the output, so logging costs tens of nanoseconds on the
+/// calling thread.  String arguments are copied, so may be temporaries.
+///
+/// Messages are written to standard output unless an output file is set, and also to
+/// the debugger's output window on Windows.
+///
+/// Each message has a category, whose minimum level can be raised at compile time to
+/// remove calls entirely, or at runtime to skip them.  Each call site may write a burst
+/// of messages per interval, after which its messages are suppressed and counted until
+/// the interval has passed, so a statement hit every frame cannot flood the output.
+class Logger {
+public:
+	/// Records that each thread can queue before the background thread catches up.
+	/// Later records are dropped and counted.
+	static const uint32 RECORDS_PER_THREAD = 1024;
+
+	static const uint32 DEFAULT_RATE_LIMIT_BURST = 10;
+	static const uint32 DEFAULT_RATE_LIMIT_MILLISECONDS = 1000;
+
+	/// Queues a message unless its site has exceeded the rate limit.  Use through the
+	/// LOG_ macros in DebugUtils.hpp.
+	template <typename... Args>
+	static void Write (
+		LogSite & site,
+		Args... args
+	);
+
+	/// True if messages of level in category are currently written.
+	static bool IsEnabled (
+		LogCategory category,
+		LogLevel level
+	);
+
+	/// Sets the minimum level of messages written in category.  Has no effect on levels
+	/// below those compiled in.
+	static void SetLevel (
+		LogCategory category,
+		LogLevel level
+	);
+
+	static LogLevel Level (
+		LogCategory category
+	);
+
+	/// Allows each call site to write burst messages every milliseconds.  A burst of
+	/// zero disables rate limiting.
+	static void SetRateLimit (
+		uint32 burst,
+		uint32 milliseconds
+	);
+
+	/// Blocks until every message queued before the call has been written.
+	static void Flush ();
+
+	/// Writes later messages to the file at path, or to standard output if path is
+	/// nullptr.  Returns false if the file could not be opened.
+	static bool SetOutputFile (
+		const char * path
+	);
+
+	/// Number of messages dropped because a thread's queue was full.
+	static uint64 DroppedCount ();
+
+	/// Appends record to the calling thread's queue.
+	static void Push (
+		const LogRecord & record
+	);
+
+private:
+	/// Counts a message against site's rate limit, returning false if it should be
+	/// suppressed.  Otherwise sets suppressed to the number of messages suppressed since
+	/// the site's last message was written.
+	static bool Admit (
+		LogSite & site,
+		uint32 & suppressed
+	);
+
+	static std::atomic<uint8> _levels[size_t (LogCategory::Count)];
+	static std::atomic<uint32> _rateLimitBurst;
+	static std::atomic<uint32> _rateLimitMilliseconds;
+};
+
+
+#include "Core/Logger.inl"
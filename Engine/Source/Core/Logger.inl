@@ -0,0 +1,239 @@
+//
+// Logger.inl
+//
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+
+namespace logging
+{
+	/// Copies a value argument into a record, and back out again when formatting.
+	template <typename T>
+	struct Argument {
+		static_assert (std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+			std::is_pointer<T>::value, "Log arguments must be numbers, pointers or strings.");
+
+		typedef T Decoded;
+
+		/// Bytes the argument needs however long it is.
+		static const size_t FIXED_BYTES = sizeof (T);
+
+		static void encode (
+			byte *& cursor,
+			size_t &,
+			T value
+		) {
+			std::memcpy (cursor, &value, sizeof (T));
+			cursor += sizeof (T);
+		}
+
+		static T decode (
+			const byte *& cursor
+		) {
+			T value;
+			std::memcpy (&value, cursor, sizeof (T));
+			cursor += sizeof (T);
+			return value;
+		}
+	};
+
+	/// Copies a null terminated string into a record as its length followed by its
+	/// characters, truncated to the record's spare bytes.  A truncated string ends in
+	/// "..." so the output shows that it was cut short.  Decodes as a pointer into the
+	/// record.
+	template <typename Char>
+	struct StringArgument {
+		typedef const Char * Decoded;
+
+		static const size_t FIXED_BYTES = sizeof (uint16) + sizeof (Char);
+
+		static const uint16 TRUNCATION_MARK_LENGTH = 3;
+
+		static void encode (
+			byte *& cursor,
+			size_t & spareBytes,
+			const Char * value
+		) {
+			static const Char NULL_STRING[] = {'(', 'n', 'u', 'l', 'l', ')', 0};
+			if (!value) {
+				value = NULL_STRING;
+			}
+
+			const size_t maxLength = spareBytes / sizeof (Char);
+			byte * characters = cursor + sizeof (uint16);
+			uint16 length = 0;
+			while (length < maxLength && value[length] != 0) {
+				std::memcpy (characters + length * sizeof (Char), &value[length], sizeof (Char));
+				++length;
+			}
+			if (value[length] != 0) {
+				// Overwrite the last characters that fit with the mark.
+				const Char mark = '.';
+				const uint16 markLength = length < TRUNCATION_MARK_LENGTH ?
+					length : TRUNCATION_MARK_LENGTH;
+				for (uint16 i (length - markLength); i < length; ++i) {
+					std::memcpy (characters + i * sizeof (Char), &mark, sizeof (Char));
+				}
+			}
+			spareBytes -= length * sizeof (Char);
+
+			std::memcpy (cursor, &length, sizeof (uint16));
+			cursor = characters + length * sizeof (Char);
+			const Char terminator = 0;
+			std::memcpy (cursor, &terminator, sizeof (Char));
+			cursor += sizeof (Char);
+		}
+
+		static const Char * decode (
+			const byte *& cursor
+		) {
+			uint16 length;
+			std::memcpy (&length, cursor, sizeof (uint16));
+			const Char * value = reinterpret_cast<const Char *>(cursor + sizeof (uint16));
+			cursor += sizeof (uint16) + (length + 1) * sizeof (Char);
+			return value;
+		}
+	};
+
+	template <> struct Argument<char *> : StringArgument<char> { };
+	template <> struct Argument<const char *> : StringArgument<char> { };
+	template <> struct Argument<wchar_t *> : StringArgument<wchar_t> { };
+	template <> struct Argument<const wchar_t *> : StringArgument<wchar_t> { };
+
+	template <typename... Args>
+	struct FixedBytes;
+
+	template <>
+	struct FixedBytes<> {
+		static const size_t VALUE = 0;
+	};
+
+	template <typename T, typename... Args>
+	struct FixedBytes<T, Args...> {
+		static const size_t VALUE = Argument<T>::FIXED_BYTES + FixedBytes<Args...>::VALUE;
+	};
+
+	/// Decodes each argument in turn, then formats them all.
+	template <typename... Args>
+	struct Formatter;
+
+	template <>
+	struct Formatter<> {
+		template <typename... Values>
+		static int format (
+			const char * formatString,
+			char * buffer,
+			size_t bufferSize,
+			const byte *,
+			Values... values
+		) {
+			return std::snprintf (buffer, bufferSize, formatString, values...);
+		}
+	};
+
+	template <typename T, typename... Args>
+	struct Formatter<T, Args...> {
+		template <typename... Values>
+		static int format (
+			const char * formatString,
+			char * buffer,
+			size_t bufferSize,
+			const byte * cursor,
+			Values... values
+		) {
+			const typename Argument<T>::Decoded value = Argument<T>::decode (cursor);
+			return Formatter<Args...>::format (formatString, buffer, bufferSize, cursor, values...,
+				value);
+		}
+	};
+
+	template <typename... Args>
+	int FormatRecord (
+		const LogRecord & record,
+		char * buffer,
+		size_t bufferSize
+	) {
+		return Formatter<Args...>::format (record.site->format, buffer, bufferSize,
+			record.arguments);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+template <typename... Args>
+void Logger::Write (
+	LogSite & site,
+	Args... args
+) {
+	static_assert (logging::FixedBytes<Args...>::VALUE <= LogRecord::ARGUMENT_BYTES,
+		"Too many log arguments to fit in a LogRecord.");
+
+	uint32 suppressed;
+	if (!Admit (site, suppressed)) {
+		return;
+	}
+
+	LogRecord record;
+	record.site = &site;
+	record.formatFunction = &logging::FormatRecord<Args...>;
+	record.ticks = __rdtsc ();
+	record.suppressed = suppressed;
+
+	byte * cursor = record.arguments;
+	size_t spareBytes = LogRecord::ARGUMENT_BYTES - logging::FixedBytes<Args...>::VALUE;
+
+	const int expand[] = {0, (logging::Argument<Args>::encode (cursor, spareBytes, args), 0)...};
+	(void) expand;
+	(void) cursor;
+	(void) spareBytes;
+
+	Push (record);
+}
+
+//---------------------------------------------------------------------------------------
+inline bool Logger::IsEnabled (
+	LogCategory category,
+	LogLevel level
+) {
+	return uint8 (level) >= _levels[uint8 (category)].load (std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------------------
+inline bool Logger::Admit (
+	LogSite & site,
+	uint32 & suppressed
+) {
+	suppressed = 0;
+
+	const uint32 burst = _rateLimitBurst.load (std::memory_order_relaxed);
+	if (burst == 0) {
+		return true;
+	}
+
+	// The clock is only read for a site's first message and once it exceeds its burst,
+	// so messages within the limit stay cheap.  Concurrent callers may briefly let a few
+	// more messages through than the burst allows.
+	typedef std::chrono::steady_clock Clock;
+	const uint32 count = site.windowCount.fetch_add (1, std::memory_order_relaxed);
+	if (count == 0) {
+		site.windowStart.store (std::chrono::duration_cast<std::chrono::milliseconds> (
+			Clock::now ().time_since_epoch ()).count (), std::memory_order_relaxed);
+	}
+	if (count < burst) {
+		return true;
+	}
+
+	const uint64 now = std::chrono::duration_cast<std::chrono::milliseconds> (
+		Clock::now ().time_since_epoch ()).count ();
+	const uint64 interval = _rateLimitMilliseconds.load (std::memory_order_relaxed);
+	if (now - site.windowStart.load (std::memory_order_relaxed) < interval) {
+		site.suppressed.fetch_add (1, std::memory_order_relaxed);
+		return false;
+	}
+
+	// Start a new window with this message.
+	site.windowStart.store (now, std::memory_order_relaxed);
+	site.windowCount.store (1, std::memory_order_relaxed);
+	suppressed = site.suppressed.exchange (0, std::memory_order_relaxed);
+	return true;
+}
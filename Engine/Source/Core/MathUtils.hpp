@@ -0,0 +1,218 @@
+//
+// MathUtils.hpp
+//
+#pragma once
+
+#include <cmath>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#include "Core/Types.hpp"
+
+/// 4x4 row-major matrix.
+///
+/// Follows the same conventions as DirectXMath so matrices can be passed straight to
+/// shaders: points are row vectors transformed as p' = p * M, the coordinate system is
+/// left-handed, and projections map depth into [0, 1].
+struct Matrix4 {
+	float m[4][4];
+};
+
+namespace math
+{
+	/// Index of the lowest set bit within value, which must be non-zero.
+	inline uint countTrailingZeros (
+		uint32 value
+	) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward (&index, value);
+		return index;
+#else
+		return __builtin_ctz (value);
+#endif
+	}
+
+	/// Index of the highest set bit within value, which must be non-zero.
+	inline uint highestSetBit (
+		uint32 value
+	) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse (&index, value);
+		return index;
+#else
+		return 31 - __builtin_clz (value);
+#endif
+	}
+
+	inline Matrix4 identity ()
+	{
+		Matrix4 result = {{
+			{1.0f, 0.0f, 0.0f, 0.0f},
+			{0.0f, 1.0f, 0.0f, 0.0f},
+			{0.0f, 0.0f, 1.0f, 0.0f},
+			{0.0f, 0.0f, 0.0f, 1.0f}
+		}};
+		return result;
+	}
+
+	/// Returns a * b, which applies a then b when transforming row vectors.
+	inline Matrix4 multiply (
+		const Matrix4 & a,
+		const Matrix4 & b
+	) {
+		Matrix4 result;
+		for (uint row (0); row < 4; ++row) {
+			for (uint col (0); col < 4; ++col) {
+				result.m[row][col] =
+					a.m[row][0] * b.m[0][col] +
+					a.m[row][1] * b.m[1][col] +
+					a.m[row][2] * b.m[2][col] +
+					a.m[row][3] * b.m[3][col];
+			}
+		}
+		return result;
+	}
+
+	/// Expands an affine transform stored without its constant (0, 0, 0, 1) column.
+	inline Matrix4 affine (
+		const float m[4][3]
+	) {
+		Matrix4 result = {{
+			{m[0][0], m[0][1], m[0][2], 0.0f},
+			{m[1][0], m[1][1], m[1][2], 0.0f},
+			{m[2][0], m[2][1], m[2][2], 0.0f},
+			{m[3][0], m[3][1], m[3][2], 1.0f}
+		}};
+		return result;
+	}
+
+	inline Matrix4 translation (
+		float x,
+		float y,
+		float z
+	) {
+		Matrix4 result = identity ();
+		result.m[3][0] = x;
+		result.m[3][1] = y;
+		result.m[3][2] = z;
+		return result;
+	}
+
+	inline Matrix4 scaling (
+		float x,
+		float y,
+		float z
+	) {
+		Matrix4 result = identity ();
+		result.m[0][0] = x;
+		result.m[1][1] = y;
+		result.m[2][2] = z;
+		return result;
+	}
+
+	/// Rotation about the y-axis by angle radians.
+	inline Matrix4 rotationY (
+		float angle
+	) {
+		const float s = std::sin (angle);
+		const float c = std::cos (angle);
+
+		Matrix4 result = identity ();
+		result.m[0][0] = c;
+		result.m[0][2] = -s;
+		result.m[2][0] = s;
+		result.m[2][2] = c;
+		return result;
+	}
+
+	/// Left-handed view matrix looking from eye towards target.
+	inline Matrix4 lookAtLH (
+		const float eye[3],
+		const float target[3],
+		const float up[3]
+	) {
+		float zAxis[3] = {target[0] - eye[0], target[1] - eye[1], target[2] - eye[2]};
+		float length = std::sqrt (zAxis[0] * zAxis[0] + zAxis[1] * zAxis[1] + zAxis[2] * zAxis[2]);
+		zAxis[0] /= length; zAxis[1] /= length; zAxis[2] /= length;
+
+		// xAxis = normalize (cross (up, zAxis))
+		float xAxis[3] = {
+			up[1] * zAxis[2] - up[2] * zAxis[1],
+			up[2] * zAxis[0] - up[0] * zAxis[2],
+			up[0] * zAxis[1] - up[1] * zAxis[0]
+		};
+		length = std::sqrt (xAxis[0] * xAxis[0] + xAxis[1] * xAxis[1] + xAxis[2] * xAxis[2]);
+		xAxis[0] /= length; xAxis[1] /= length; xAxis[2] /= length;
+
+		// yAxis = cross (zAxis, xAxis)
+		const float yAxis[3] = {
+			zAxis[1] * xAxis[2] - zAxis[2] * xAxis[1],
+			zAxis[2] * xAxis[0] - zAxis[0] * xAxis[2],
+			zAxis[0] * xAxis[1] - zAxis[1] * xAxis[0]
+		};
+
+		Matrix4 result = identity ();
+		for (uint i (0); i < 3; ++i) {
+			result.m[i][0] = xAxis[i];
+			result.m[i][1] = yAxis[i];
+			result.m[i][2] = zAxis[i];
+		}
+		result.m[3][0] = -(xAxis[0] * eye[0] + xAxis[1] * eye[1] + xAxis[2] * eye[2]);
+		result.m[3][1] = -(yAxis[0] * eye[0] + yAxis[1] * eye[1] + yAxis[2] * eye[2]);
+		result.m[3][2] = -(zAxis[0] * eye[0] + zAxis[1] * eye[1] + zAxis[2] * eye[2]);
+		return result;
+	}
+
+	/// Left-handed perspective projection mapping [nearZ, farZ] to depth [0, 1].
+	inline Matrix4 perspectiveFovLH (
+		float fovAngleY,
+		float aspectRatio,
+		float nearZ,
+		float farZ
+	) {
+		const float yScale = 1.0f / std::tan (0.5f * fovAngleY);
+		const float xScale = yScale / aspectRatio;
+		const float range = farZ / (farZ - nearZ);
+
+		Matrix4 result = {{
+			{xScale, 0.0f,   0.0f,            0.0f},
+			{0.0f,   yScale, 0.0f,            0.0f},
+			{0.0f,   0.0f,   range,           1.0f},
+			{0.0f,   0.0f,   -range * nearZ,  0.0f}
+		}};
+		return result;
+	}
+
+	/// Transforms point (x, y, z, 1) by matrix, writing homogeneous result to out.
+	inline void transformPoint (
+		const float point[3],
+		const Matrix4 & matrix,
+		float out[4]
+	) {
+		for (uint col (0); col < 4; ++col) {
+			out[col] =
+				point[0] * matrix.m[0][col] +
+				point[1] * matrix.m[1][col] +
+				point[2] * matrix.m[2][col] +
+				matrix.m[3][col];
+		}
+	}
+
+	/// Transforms direction (x, y, z, 0) by the upper 3x3 of matrix.
+	inline void transformDirection (
+		const float direction[3],
+		const Matrix4 & matrix,
+		float out[3]
+	) {
+		for (uint col (0); col < 3; ++col) {
+			out[col] =
+				direction[0] * matrix.m[0][col] +
+				direction[1] * matrix.m[1][col] +
+				direction[2] * matrix.m[2][col];
+		}
+	}
+}
@@ -8,6 +8,9 @@
 // Allocation storage to reserve from bss segment of executable.
 #define BSS_ARENA_RESERVED  20971520  // 20 MiB
 
+// Allocation storage to reserve from bss segment for per-frame allocations.
+#define FRAME_ARENA_RESERVED  33554432  // 32 MiB
+
 
 //---------------------------------------------------------------------------------------
 LinearAllocator::LinearAllocator (
@@ -38,6 +41,9 @@ void * LinearAllocator::allocate (
 	// Bump free pointer
 	_free = reinterpret_cast<byte *>(result) + size;
 
+	// Assert arena has not been exhausted.
+	assert (_free <= _end);
+
 	return result;
 }
 
@@ -64,12 +70,64 @@ void LinearAllocator::reset ()
 	_free = _start;
 }
 
+//---------------------------------------------------------------------------------------
+FrameAllocator::FrameAllocator (
+	byte * backingStore,
+	size_t size
+)
+	: _arenas {
+		{backingStore, size / NUM_FRAMES},
+		{backingStore + size / NUM_FRAMES, size / NUM_FRAMES}
+	  },
+	  _frameIndex (0)
+{
+	static_assert (NUM_FRAMES == 2, "Update _arenas initializer to match NUM_FRAMES.");
+}
+
+//---------------------------------------------------------------------------------------
+FrameAllocator::~FrameAllocator ()
+{
+	// Per-frame allocations are never individually freed, so release them all here
+	// rather than tripping the leak check of each arena.
+	for (LinearAllocator & arena : _arenas) {
+		arena.reset ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void * FrameAllocator::allocate (
+	size_t size,
+	size_t align
+) {
+	return _arenas[_frameIndex].allocate (size, align);
+}
+
+//---------------------------------------------------------------------------------------
+size_t FrameAllocator::allocatedSize (
+	void * ptr
+) {
+	return _arenas[_frameIndex].allocatedSize (ptr);
+}
+
+//---------------------------------------------------------------------------------------
+size_t FrameAllocator::totalAllocated ()
+{
+	return _arenas[_frameIndex].totalAllocated ();
+}
+
+//---------------------------------------------------------------------------------------
+void FrameAllocator::nextFrame ()
+{
+	_frameIndex = (_frameIndex + 1) % NUM_FRAMES;
+	_arenas[_frameIndex].reset ();
+}
+
 //---------------------------------------------------------------------------------------
 namespace
 {
 	struct MemoryGlobals {
 		// Statically allocated memory for storing global allocators.
-		static const uint32 ALLOCATOR_MEMORY = sizeof (LinearAllocator);
+		static const uint32 ALLOCATOR_MEMORY = sizeof (LinearAllocator) + sizeof (FrameAllocator);
 
 		// Bootstrap memory to hold memory_global allocators.
 		byte buffer[ALLOCATOR_MEMORY];
@@ -77,9 +135,13 @@ namespace
 		// Allocation arena witin .bss segment of executable.
 		byte bssArena[BSS_ARENA_RESERVED];
 
+		// Allocation arena for per-frame data within .bss segment of executable.
+		byte frameArena[FRAME_ARENA_RESERVED];
+
 		LinearAllocator * linearAllocator;
+		FrameAllocator * frameAllocator;
 
-		MemoryGlobals () : linearAllocator (nullptr) { }
+		MemoryGlobals () : linearAllocator (nullptr), frameAllocator (nullptr) { }
 	};
 
 	MemoryGlobals _memory_globals;
@@ -100,6 +162,9 @@ namespace memory_globals
 		_memory_globals.linearAllocator = 
 			new (p) LinearAllocator (backingStore, BSS_ARENA_RESERVED);
 
+		p += sizeof (LinearAllocator);
+		_memory_globals.frameAllocator =
+			new (p) FrameAllocator (_memory_globals.frameArena, FRAME_ARENA_RESERVED);
 	}
 
 	LinearAllocator & linearAllocator ()
@@ -107,8 +172,14 @@ namespace memory_globals
 		return *_memory_globals.linearAllocator;
 	}
 
+	FrameAllocator & frameAllocator ()
+	{
+		return *_memory_globals.frameAllocator;
+	}
+
 	void shutdown ()
 	{
+		_memory_globals.frameAllocator->~FrameAllocator ();
 		_memory_globals.linearAllocator->~LinearAllocator ();
 		new (&_memory_globals) MemoryGlobals (); // Reset members
 	}
@@ -68,6 +68,47 @@ private:
 };
 
 
+/// A ring buffer of linear allocators, one per in-flight frame.
+///
+/// Ideal for transient per-frame data such as draw lists.  The backing store is split
+/// evenly into NUM_FRAMES arenas.  Allocations are made from the current frame's arena,
+/// and remain valid until nextFrame() has been called NUM_FRAMES times, which allows
+/// data built during one frame to be consumed during the next.
+class FrameAllocator : public Allocator {
+public:
+	/// Number of frames an allocation remains valid for.
+	static const uint NUM_FRAMES = 2;
+
+	/// Constructs allocator using pre-allocated memory as its backing storage.
+	FrameAllocator (
+		byte * backingStore, ///< Pointer to backing memory arena.
+		size_t size          ///< Size in bytes of backing store.
+	);
+
+	~FrameAllocator ();
+
+	void * allocate (
+		size_t size,
+		size_t align
+	) override;
+
+	size_t allocatedSize (
+		void * ptr
+	) override;
+
+	/// Total bytes allocated from the current frame's arena.
+	size_t totalAllocated () override;
+
+	/// Advances to the next frame's arena, deallocating everything that was allocated
+	/// from it NUM_FRAMES frames ago.
+	void nextFrame ();
+
+private:
+	LinearAllocator _arenas[NUM_FRAMES];
+	uint _frameIndex;
+};
+
+
 
 /// Creates a new object of type T using the supplied memory allocator.
 #define make_new(a, T, ...)  (new ((a).allocate(sizeof(T), alignof(T))) T(__VA_ARGS__))
@@ -104,16 +145,10 @@ namespace memory_globals
 	/// available.
 	LinearAllocator & linearAllocator ();
 
-
-#if false 
-
-	//TODO Dustin - Implement frameAllocator based on ring buffer.
-
 	/// Returns the default frame allocator for per frame data.
 	///
 	/// You need to call init() for this allocator to be available.
 	FrameAllocator & frameAllocator ();
-#endif
 
 	/// Shuts down the global memory allocators created by init().
 	void shutdown ();
@@ -0,0 +1,62 @@
+//
+// MpmcQueue.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Core/Types.hpp"
+
+
+/// Fixed capacity lock-free ring buffer that any number of threads may push to and pop
+/// from concurrently.
+///
+/// Each slot carries a sequence number recording whether it is ready to be written or
+/// read for the current lap of the ring, so producers and consumers only contend on
+/// their own index, which they claim with a compare-and-swap.  Based on Dmitry Vyukov's
+/// bounded MPMC queue.
+template <typename T>
+class MpmcQueue {
+public:
+	/// capacity must be a power of two.
+	explicit MpmcQueue (
+		uint32 capacity
+	);
+
+	/// Copies value to the back of the queue, or returns false if the queue is full.
+	bool tryPush (
+		const T & value
+	);
+
+	/// Moves the front of the queue into value, or returns false if the queue is empty.
+	bool tryPop (
+		T & value
+	);
+
+	/// Approximate number of queued values.
+	uint32 size () const;
+
+	uint32 capacity () const;
+
+
+	/// Forbid copying of MpmcQueue objects.
+	MpmcQueue (const MpmcQueue & other) = delete;
+	MpmcQueue & operator = (const MpmcQueue & other) = delete;
+
+private:
+	struct Slot {
+		std::atomic<uint64> sequence;
+		T value;
+	};
+
+	// Producers and consumers each contend on their own cache line.
+	alignas(64) std::atomic<uint64> _enqueueIndex;
+	alignas(64) std::atomic<uint64> _dequeueIndex;
+
+	alignas(64) std::unique_ptr<Slot[]> _slots;
+	const uint64 _mask;
+};
+
+
+#include "Core/MpmcQueue.inl"
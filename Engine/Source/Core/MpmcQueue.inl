@@ -0,0 +1,109 @@
+//
+// MpmcQueue.inl
+//
+#include <cassert>
+#include <utility>
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+MpmcQueue<T>::MpmcQueue (
+	uint32 capacity
+)
+	: _enqueueIndex (0),
+	  _dequeueIndex (0),
+	  _slots (new Slot[capacity]),
+	  _mask (capacity - 1)
+{
+	assert (capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+	// Slot i is first written by the producer claiming index i.
+	for (uint32 i (0); i < capacity; ++i) {
+		_slots[i].sequence.store (i, std::memory_order_relaxed);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool MpmcQueue<T>::tryPush (
+	const T & value
+) {
+	uint64 index = _enqueueIndex.load (std::memory_order_relaxed);
+	Slot * slot;
+	while (true) {
+		slot = &_slots[index & _mask];
+		const uint64 sequence = slot->sequence.load (std::memory_order_acquire);
+		const int64 difference = static_cast<int64>(sequence - index);
+
+		if (difference == 0) {
+			// Slot is free for this lap, so try to claim the index.
+			if (_enqueueIndex.compare_exchange_weak (index, index + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (difference < 0) {
+			// Slot still holds a value from the previous lap.
+			return false;
+		}
+		else {
+			// Another producer claimed the index first.
+			index = _enqueueIndex.load (std::memory_order_relaxed);
+		}
+	}
+
+	slot->value = value;
+
+	// Publish the value to the consumer that claims this index.
+	slot->sequence.store (index + 1, std::memory_order_release);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool MpmcQueue<T>::tryPop (
+	T & value
+) {
+	uint64 index = _dequeueIndex.load (std::memory_order_relaxed);
+	Slot * slot;
+	while (true) {
+		slot = &_slots[index & _mask];
+		const uint64 sequence = slot->sequence.load (std::memory_order_acquire);
+		const int64 difference = static_cast<int64>(sequence - (index + 1));
+
+		if (difference == 0) {
+			// Slot holds a value for this lap, so try to claim the index.
+			if (_dequeueIndex.compare_exchange_weak (index, index + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (difference < 0) {
+			// Slot has not been written yet.
+			return false;
+		}
+		else {
+			// Another consumer claimed the index first.
+			index = _dequeueIndex.load (std::memory_order_relaxed);
+		}
+	}
+
+	value = std::move (slot->value);
+
+	// Free the slot for the producer that claims this index on the next lap.
+	slot->sequence.store (index + _mask + 1, std::memory_order_release);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+uint32 MpmcQueue<T>::size () const
+{
+	const uint64 dequeueIndex = _dequeueIndex.load (std::memory_order_acquire);
+	const uint64 enqueueIndex = _enqueueIndex.load (std::memory_order_acquire);
+	return enqueueIndex > dequeueIndex ? static_cast<uint32>(enqueueIndex - dequeueIndex) : 0;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+uint32 MpmcQueue<T>::capacity () const
+{
+	return static_cast<uint32>(_mask + 1);
+}
@@ -0,0 +1,966 @@
+//
+// ObjParser.cpp
+//
+#include "pch.h"
+
+#include "Core/ObjParser.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+
+namespace
+{
+	using obj_parser::Corner;
+
+	// Powers of ten exactly representable as doubles.
+	const double POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const int32 MAX_EXACT_POWER = 22;
+
+	// Integers up to 2^53 are exactly representable as doubles.
+	const uint64 MAX_EXACT_MANTISSA = uint64 (1) << 53;
+
+	// Significant digits accumulated into a 64-bit mantissa without overflow.
+	const uint32 MAX_SIGNIFICANT_DIGITS = 19;
+
+	// Distinct vertices in a mesh, which keeps a CornerTable's 32-bit capacity within
+	// 2^31.
+	const uint32 MAX_VERTICES = 1 << 30;
+
+	// Set in a corner element that refers to a relative index recorded while parsing a
+	// chunk, rather than to an element.  Absolute indices are always below it.
+	const uint32 DEFERRED = 0x80000000;
+	const uint32 MAX_RELATIVE_INDICES = 0x7FFFFFFF;
+
+	// Chunks per thread, so that threads finishing early can take on more.
+	const uint32 CHUNKS_PER_THREAD = 4;
+
+	const char * TOO_MANY_VERTICES = "OBJ mesh has more than 2^30 distinct vertices.";
+	const char * MISSING_ELEMENT = "OBJ face refers to a missing vertex element.";
+
+	inline bool isBlank (
+		char c
+	) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline bool isDigit (
+		char c
+	) {
+		return static_cast<uint8>(c - '0') < 10;
+	}
+
+	inline const char * skipBlanks (
+		const char * p,
+		const char * end
+	) {
+		while (p < end && isBlank (*p)) {
+			++p;
+		}
+		return p;
+	}
+
+	/// Returns a pointer to the start of the next line.
+	inline const char * skipLine (
+		const char * p,
+		const char * end
+	) {
+		const char * newline = static_cast<const char *>(std::memchr (p, '\n', end - p));
+		return newline ? newline + 1 : end;
+	}
+
+	/// True if [p, end) starts with keyword followed by a blank.
+	inline bool isKeyword (
+		const char * p,
+		const char * end,
+		const char * keyword,
+		size_t length
+	) {
+		return size_t (end - p) > length && std::memcmp (p, keyword, length) == 0 &&
+			isBlank (p[length]);
+	}
+
+	/// Parses a possibly negative integer.  Returns a pointer past it, or nullptr if
+	/// there is none.
+	const char * parseIndex (
+		const char * p,
+		const char * end,
+		int64 & value
+	) {
+		const bool negative = p < end && *p == '-';
+		if (negative) {
+			++p;
+		}
+
+		if (p == end || !isDigit (*p)) {
+			return nullptr;
+		}
+
+		int64 result = 0;
+		while (p < end && isDigit (*p)) {
+			result = std::min<int64> (result * 10 + (*p - '0'), INT32_MAX);
+			++p;
+		}
+
+		value = negative ? -result : result;
+		return p;
+	}
+
+	/// Converts a one-based or negative relative index to a zero-based index.  Positive
+	/// indices are checked against the element count when the mesh is built, as they may
+	/// refer to elements defined later in the file.
+	///
+	/// If relativeIndices is not nullptr, negative indices are instead appended to it
+	/// relative to count, to be resolved once the elements preceding the text are known,
+	/// and resolved becomes DEFERRED along with the position they were appended at.
+	bool resolveIndex (
+		int64 index,
+		size_t count,
+		std::vector<int32> * relativeIndices,
+		uint32 & resolved
+	) {
+		if (index > 0) {
+			resolved = static_cast<uint32>(index - 1);
+			return true;
+		}
+		if (index < 0 && relativeIndices) {
+			if (relativeIndices->size () >= MAX_RELATIVE_INDICES) {
+				return false;
+			}
+			resolved = DEFERRED | static_cast<uint32>(relativeIndices->size ());
+			relativeIndices->push_back (static_cast<int32>(int64 (count) + index));
+			return true;
+		}
+		if (index < 0 && int64 (count) + index >= 0) {
+			resolved = static_cast<uint32>(int64 (count) + index);
+			return true;
+		}
+		return false;
+	}
+
+	/// Replaces a DEFERRED element with the element it refers to, given the number of
+	/// elements preceding the chunk it was parsed from.
+	inline bool resolveDeferred (
+		uint32 & element,
+		uint32 base,
+		const std::vector<int32> & relativeIndices
+	) {
+		if (element == Corner::NONE || (element & DEFERRED) == 0) {
+			return true;
+		}
+
+		const int64 resolved = int64 (base) + relativeIndices[element & ~DEFERRED];
+		element = static_cast<uint32>(resolved);
+		return resolved >= 0;
+	}
+
+	/// Copies the remainder of the line, without surrounding blanks, into name.
+	void copyRestOfLine (
+		const char * p,
+		const char * end,
+		char * name,
+		size_t nameSize
+	) {
+		p = skipBlanks (p, end);
+		const char * lineEnd = p;
+		while (lineEnd < end && *lineEnd != '\n') {
+			++lineEnd;
+		}
+		while (lineEnd > p && isBlank (lineEnd[-1])) {
+			--lineEnd;
+		}
+
+		const size_t length = std::min<size_t> (lineEnd - p, nameSize - 1);
+		std::memcpy (name, p, length);
+		name[length] = '\0';
+	}
+
+	/// Parses count floats into values.  Returns a pointer past the last, or nullptr.
+	const char * parseFloats (
+		const char * p,
+		const char * end,
+		float * values,
+		uint count
+	) {
+		for (uint i (0); i < count && p; ++i) {
+			p = obj_parser::ParseFloat (p, end, values[i]);
+		}
+		return p;
+	}
+
+	/// Parses a face corner of the form v, v/vt, v//vn or v/vt/vn.
+	const char * parseCorner (
+		const char * p,
+		const char * end,
+		const obj_parser::Geometry & geometry,
+		std::vector<int32> * relativeIndices,
+		Corner & corner
+	) {
+		int64 index;
+		p = parseIndex (p, end, index);
+		if (!p || !resolveIndex (index, geometry.positions.size () / 3, relativeIndices,
+			corner.position))
+		{
+			return nullptr;
+		}
+
+		corner.texcoord = Corner::NONE;
+		corner.normal = Corner::NONE;
+		if (p == end || *p != '/') {
+			return p;
+		}
+
+		++p;
+		if (p < end && *p != '/') {
+			p = parseIndex (p, end, index);
+			if (!p || !resolveIndex (index, geometry.texcoords.size () / 2, relativeIndices,
+				corner.texcoord))
+			{
+				return nullptr;
+			}
+		}
+
+		if (p == end || *p != '/') {
+			return p;
+		}
+
+		++p;
+		p = parseIndex (p, end, index);
+		if (!p || !resolveIndex (index, geometry.normals.size () / 3, relativeIndices,
+			corner.normal))
+		{
+			return nullptr;
+		}
+		return p;
+	}
+
+	/// Parses the corners of a face, appending it to geometry as a fan of triangles.
+	const char * parseFace (
+		const char * p,
+		const char * end,
+		obj_parser::Geometry & geometry,
+		std::vector<int32> * relativeIndices
+	) {
+		Corner first;
+		Corner previous;
+		uint count = 0;
+		while (true) {
+			p = skipBlanks (p, end);
+			if (p == end || *p == '\n') {
+				break;
+			}
+
+			Corner corner;
+			p = parseCorner (p, end, geometry, relativeIndices, corner);
+			if (!p || (p < end && !isBlank (*p) && *p != '\n')) {
+				return nullptr;
+			}
+
+			if (count == 0) {
+				first = corner;
+			} else if (count >= 2) {
+				geometry.corners.push_back (first);
+				geometry.corners.push_back (previous);
+				geometry.corners.push_back (corner);
+			}
+			previous = corner;
+			++count;
+		}
+
+		return count >= 3 ? p : nullptr;
+	}
+
+	/// Parses OBJ text, appending to geometry.  Returns nullptr, or a description of the
+	/// first line that could not be parsed along with its line number within the text.
+	const char * parseLines (
+		const char * text,
+		size_t length,
+		obj_parser::Geometry & geometry,
+		ObjReferences * references,
+		std::vector<int32> * relativeIndices,
+		uint32 & errorLine
+	) {
+		const char * p = text;
+		const char * const end = text + length;
+
+		uint32 line = 1;
+		for (; p < end; p = skipLine (p, end), ++line) {
+			p = skipBlanks (p, end);
+			if (p == end) {
+				break;
+			}
+
+			const char * error = nullptr;
+			if (isKeyword (p, end, "v", 1)) {
+				float position[3];
+				p = parseFloats (p + 1, end, position, 3);
+				if (p) {
+					geometry.positions.insert (geometry.positions.end (), position, position + 3);
+				} else {
+					error = "Expected three vertex coordinates.";
+				}
+			}
+			else if (isKeyword (p, end, "vt", 2)) {
+				// The second texture coordinate is optional, and any third is ignored.
+				float texcoord[2] = {0.0f, 0.0f};
+				p = obj_parser::ParseFloat (p + 2, end, texcoord[0]);
+				if (p) {
+					const char * next = obj_parser::ParseFloat (p, end, texcoord[1]);
+					p = next ? next : p;
+					geometry.texcoords.insert (geometry.texcoords.end (), texcoord, texcoord + 2);
+				} else {
+					error = "Expected a texture coordinate.";
+				}
+			}
+			else if (isKeyword (p, end, "vn", 2)) {
+				float normal[3];
+				p = parseFloats (p + 2, end, normal, 3);
+				if (p) {
+					geometry.normals.insert (geometry.normals.end (), normal, normal + 3);
+				} else {
+					error = "Expected three normal coordinates.";
+				}
+			}
+			else if (isKeyword (p, end, "f", 1)) {
+				p = parseFace (p + 1, end, geometry, relativeIndices);
+				if (!p) {
+					error = "Expected a face of at least three valid v/vt/vn corners.";
+				}
+			}
+			else if (references && isKeyword (p, end, "mtllib", 6)) {
+				if (references->materialLibrary[0] == '\0') {
+					copyRestOfLine (p + 6, end, references->materialLibrary,
+						sizeof (references->materialLibrary));
+				}
+			}
+			else if (references && isKeyword (p, end, "usemtl", 6)) {
+				if (references->material[0] == '\0') {
+					copyRestOfLine (p + 6, end, references->material,
+						sizeof (references->material));
+				}
+			}
+			// Comments, objects, groups, smoothing groups, lines and points are skipped.
+
+			if (error) {
+				errorLine = line;
+				return error;
+			}
+		}
+
+		return nullptr;
+	}
+
+	inline uint32 hashCorner (
+		const Corner & corner
+	) {
+		uint64 hash = corner.position * 0x9E3779B97F4A7C15ull;
+		hash ^= corner.texcoord * 0xC2B2AE3D27D4EB4Full;
+		hash ^= corner.normal * 0x165667B19E3779F9ull;
+		return static_cast<uint32>(hash >> 32) ^ static_cast<uint32>(hash);
+	}
+
+	inline bool operator == (
+		const Corner & a,
+		const Corner & b
+	) {
+		return a.position == b.position && a.texcoord == b.texcoord && a.normal == b.normal;
+	}
+
+	/// Open addressing table of distinct corners, with linear probing.  Sized by
+	/// ObjCornerTableCapacity().
+	class CornerTable {
+	public:
+		static const uint32 EMPTY = 0xFFFFFFFF;
+
+		explicit CornerTable (
+			size_t maxCorners
+		) {
+			const uint32 capacity = ObjCornerTableCapacity (maxCorners);
+			_mask = capacity - 1;
+			_slots.assign (capacity, Slot {{0, 0, 0}, EMPTY});
+		}
+
+		/// Returns the value stored for corner.  If corner is new it is inserted, and its
+		/// value is EMPTY for the caller to set.
+		uint32 & lookup (
+			const Corner & corner
+		) {
+			for (uint32 slot (hashCorner (corner) & _mask); ; slot = (slot + 1) & _mask) {
+				Slot & entry = _slots[slot];
+				if (entry.value == EMPTY) {
+					entry.corner = corner;
+					return entry.value;
+				}
+				if (entry.corner == corner) {
+					return entry.value;
+				}
+			}
+		}
+
+	private:
+		struct Slot {
+			Corner corner;
+			uint32 value;
+		};
+
+		std::vector<Slot> _slots;
+		uint32 _mask;
+	};
+
+	/// True if every element of corner is within the elements of geometry.
+	inline bool hasElements (
+		const Corner & corner,
+		const obj_parser::Geometry & geometry
+	) {
+		return corner.position < geometry.positions.size () / 3 &&
+			(corner.texcoord == Corner::NONE || corner.texcoord < geometry.texcoords.size () / 2) &&
+			(corner.normal == Corner::NONE || corner.normal < geometry.normals.size () / 3);
+	}
+
+	/// Copies count floats starting at element index of elements, or zeros if index is
+	/// Corner::NONE.
+	inline void copyElement (
+		const std::vector<float> & elements,
+		uint32 index,
+		uint count,
+		float * out
+	) {
+		if (index == Corner::NONE) {
+			std::fill (out, out + count, 0.0f);
+		} else {
+			std::memcpy (out, &elements[size_t (index) * count], count * sizeof (float));
+		}
+	}
+
+	void fillVertices (
+		const obj_parser::Geometry & geometry,
+		const Corner * corners,
+		size_t numCorners,
+		Vertex * vertices
+	) {
+		for (size_t i (0); i < numCorners; ++i) {
+			copyElement (geometry.positions, corners[i].position, 3, vertices[i].position);
+			copyElement (geometry.normals, corners[i].normal, 3, vertices[i].normal);
+			copyElement (geometry.texcoords, corners[i].texcoord, 2, vertices[i].uv_diffuse);
+		}
+	}
+
+	/// A range of lines parsed on its own, along with its distinct vertices.
+	struct Chunk {
+		const char * begin;
+		const char * end;
+
+		obj_parser::Geometry geometry;
+		std::vector<int32> relativeIndices;
+		ObjReferences references;
+
+		const char * error;
+		uint32 errorLine;
+
+		// Elements, corners and distinct vertices in the chunks before this one.
+		uint32 firstPosition;
+		uint32 firstTexcoord;
+		uint32 firstNormal;
+		size_t firstCorner;
+		uint32 firstVertex;
+
+		// Distinct corners in order of first use, the index within them of each corner,
+		// and the mesh vertex of each.
+		std::vector<Corner> vertices;
+		std::vector<uint32> localIndices;
+		std::vector<uint32> meshVertices;
+	};
+
+	/// Invokes body(chunkIndex) for every chunk, spread across the threads of jobSystem.
+	template <typename Function>
+	void runChunks (
+		JobSystem & jobSystem,
+		size_t numChunks,
+		const Function & body
+	) {
+		JobCounter counter;
+		for (size_t i (1); i < numChunks; ++i) {
+			jobSystem.run ([&body, i] { body (i); }, &counter);
+		}
+		body (0);
+		jobSystem.wait (counter);
+	}
+
+	/// Resolves the chunk's deferred indices, copies its elements into geometry, and finds
+	/// its distinct vertices.  Returns nullptr, or a description of the error.
+	const char * buildChunk (
+		Chunk & chunk,
+		obj_parser::Geometry & geometry
+	) {
+		std::copy (chunk.geometry.positions.begin (), chunk.geometry.positions.end (),
+			geometry.positions.begin () + size_t (chunk.firstPosition) * 3);
+		std::copy (chunk.geometry.texcoords.begin (), chunk.geometry.texcoords.end (),
+			geometry.texcoords.begin () + size_t (chunk.firstTexcoord) * 2);
+		std::copy (chunk.geometry.normals.begin (), chunk.geometry.normals.end (),
+			geometry.normals.begin () + size_t (chunk.firstNormal) * 3);
+
+		const std::vector<Corner> & corners = chunk.geometry.corners;
+		CornerTable table (corners.size ());
+		chunk.localIndices.resize (corners.size ());
+		for (size_t i (0); i < corners.size (); ++i) {
+			Corner corner = corners[i];
+			if (!resolveDeferred (corner.position, chunk.firstPosition, chunk.relativeIndices) ||
+				!resolveDeferred (corner.texcoord, chunk.firstTexcoord, chunk.relativeIndices) ||
+				!resolveDeferred (corner.normal, chunk.firstNormal, chunk.relativeIndices))
+			{
+				return MISSING_ELEMENT;
+			}
+
+			uint32 & vertex = table.lookup (corner);
+			if (vertex == CornerTable::EMPTY) {
+				if (chunk.vertices.size () == MAX_VERTICES) {
+					return TOO_MANY_VERTICES;
+				}
+				if (!hasElements (corner, geometry)) {
+					return MISSING_ELEMENT;
+				}
+				vertex = static_cast<uint32>(chunk.vertices.size ());
+				chunk.vertices.push_back (corner);
+			}
+			chunk.localIndices[i] = vertex;
+		}
+
+		return nullptr;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+const char * obj_parser::ParseFloat (
+	const char * p,
+	const char * end,
+	float & value
+) {
+	p = skipBlanks (p, end);
+
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+
+	// Accumulate up to MAX_SIGNIFICANT_DIGITS digits, scaling by the decimal exponent.
+	uint64 mantissa = 0;
+	int32 exponent = 0;
+	uint32 significantDigits = 0;
+	bool hasDigits = false;
+
+	while (p < end && isDigit (*p)) {
+		if (significantDigits < MAX_SIGNIFICANT_DIGITS) {
+			mantissa = mantissa * 10 + (*p - '0');
+			significantDigits += mantissa != 0;
+		} else {
+			++exponent;
+		}
+		hasDigits = true;
+		++p;
+	}
+
+	if (p < end && *p == '.') {
+		++p;
+		while (p < end && isDigit (*p)) {
+			if (significantDigits < MAX_SIGNIFICANT_DIGITS) {
+				mantissa = mantissa * 10 + (*p - '0');
+				significantDigits += mantissa != 0;
+				--exponent;
+			}
+			hasDigits = true;
+			++p;
+		}
+	}
+
+	if (!hasDigits) {
+		return nullptr;
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char * q = p + 1;
+		bool negativeExponent = false;
+		if (q < end && (*q == '-' || *q == '+')) {
+			negativeExponent = *q == '-';
+			++q;
+		}
+
+		if (q < end && isDigit (*q)) {
+			int32 explicitExponent = 0;
+			while (q < end && isDigit (*q)) {
+				explicitExponent = std::min (explicitExponent * 10 + (*q - '0'), 100000);
+				++q;
+			}
+			exponent += negativeExponent ? -explicitExponent : explicitExponent;
+			p = q;
+		}
+	}
+
+	// Both the mantissa and power of ten are exact in the common case, so a single
+	// rounded multiply or divide gives the correctly rounded double.
+	double result = double (mantissa);
+	if (mantissa != 0 && exponent != 0) {
+		if (mantissa <= MAX_EXACT_MANTISSA && exponent >= -MAX_EXACT_POWER &&
+			exponent <= MAX_EXACT_POWER)
+		{
+			result = exponent < 0 ? result / POWERS_OF_TEN[-exponent] :
+				result * POWERS_OF_TEN[exponent];
+		} else {
+			result *= std::pow (10.0, exponent);
+		}
+	}
+
+	value = static_cast<float>(negative ? -result : result);
+	return p;
+}
+
+//---------------------------------------------------------------------------------------
+bool obj_parser::ParseGeometry (
+	const char * text,
+	size_t length,
+	Geometry & geometry,
+	ObjReferences * references
+) {
+	uint32 errorLine;
+	const char * error = parseLines (text, length, geometry, references, nullptr, errorLine);
+	if (error) {
+		LOG_CATEGORY_ERROR (Assets, "OBJ line %u: %s", errorLine, error);
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+bool obj_parser::BuildMesh (
+	const Geometry & geometry,
+	Allocator & allocator,
+	MeshComponent & mesh
+) {
+	mesh = {0, 0, nullptr, nullptr};
+
+	const size_t numCorners = geometry.corners.size ();
+	if (numCorners == 0) {
+		return true;
+	}
+
+	CornerTable table (numCorners);
+	std::vector<Corner> vertices;
+	vertices.reserve (std::min<size_t> (numCorners, MAX_VERTICES));
+	std::vector<Index> indices (numCorners);
+
+	for (size_t i (0); i < numCorners; ++i) {
+		const Corner & corner = geometry.corners[i];
+		uint32 & vertex = table.lookup (corner);
+		if (vertex == CornerTable::EMPTY) {
+			if (vertices.size () == MAX_VERTICES) {
+				LOG_CATEGORY_ERROR (Assets, "%s", TOO_MANY_VERTICES);
+				return false;
+			}
+			if (!hasElements (corner, geometry)) {
+				LOG_CATEGORY_ERROR (Assets, "%s", MISSING_ELEMENT);
+				return false;
+			}
+			vertex = static_cast<uint32>(vertices.size ());
+			vertices.push_back (corner);
+		}
+		indices[i] = static_cast<Index>(vertex);
+	}
+
+	mesh.numVertices = static_cast<uint32>(vertices.size ());
+	mesh.numIndices = static_cast<uint32>(numCorners);
+	mesh.vertices = static_cast<Vertex *>(
+		allocator.allocate (mesh.numVertices * sizeof (Vertex), alignof (Vertex)));
+	mesh.indices = static_cast<Index *>(
+		allocator.allocate (mesh.numIndices * sizeof (Index), alignof (Index)));
+
+	fillVertices (geometry, vertices.data (), vertices.size (), mesh.vertices);
+	std::memcpy (mesh.indices, indices.data (), numCorners * sizeof (Index));
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+size_t MaxObjMeshBytes (
+	size_t length
+) {
+	// Every corner takes at least two characters, so there are fewer distinct vertices
+	// than length / 2.  A polygon with n corners becomes fewer than 3n triangle corners,
+	// so there are fewer indices than 3 * length / 2.
+	const size_t maxCorners = length / 2;
+	return maxCorners * sizeof (Vertex) + 3 * maxCorners * sizeof (Index) +
+		alignof (Vertex) + alignof (Index);
+}
+
+//---------------------------------------------------------------------------------------
+uint32 ObjCornerTableCapacity (
+	size_t maxCorners
+) {
+	// A mesh has at most MAX_VERTICES distinct corners.  The one past them that fails
+	// the mesh is inserted before it is found to be one too many, which leaves the table
+	// just over half full, but with slots still empty to end every probe.
+	const uint32 corners = static_cast<uint32>(std::min<size_t> (maxCorners, MAX_VERTICES));
+	uint32 capacity = 16;
+	while (capacity < 2 * corners) {
+		capacity *= 2;
+	}
+	return capacity;
+}
+
+//---------------------------------------------------------------------------------------
+bool ParseObj (
+	const char * text,
+	size_t length,
+	Allocator & allocator,
+	MeshComponent & mesh,
+	ObjReferences * references
+) {
+	if (references) {
+		references->materialLibrary[0] = '\0';
+		references->material[0] = '\0';
+	}
+
+	obj_parser::Geometry geometry;
+	return obj_parser::ParseGeometry (text, length, geometry, references) &&
+		obj_parser::BuildMesh (geometry, allocator, mesh);
+}
+
+//---------------------------------------------------------------------------------------
+bool ParseObj (
+	JobSystem & jobSystem,
+	const char * text,
+	size_t length,
+	Allocator & allocator,
+	MeshComponent & mesh,
+	ObjReferences * references,
+	size_t minChunkSize
+) {
+	PROFILE_ZONE ("ParseObj");
+
+	mesh = {0, 0, nullptr, nullptr};
+	if (references) {
+		references->materialLibrary[0] = '\0';
+		references->material[0] = '\0';
+	}
+
+	// Split the text into chunks of whole lines.
+	const size_t numChunks = std::max<size_t> (1, std::min<size_t> (
+		jobSystem.threadCount () * CHUNKS_PER_THREAD, length / std::max<size_t> (minChunkSize, 1)));
+	std::vector<Chunk> chunks (numChunks);
+	const char * const end = text + length;
+	const char * chunkBegin = text;
+	for (size_t i (0); i < numChunks; ++i) {
+		Chunk & chunk = chunks[i];
+		chunk.begin = chunkBegin;
+		chunk.end = end;
+		if (i + 1 < numChunks) {
+			chunk.end = std::max (chunkBegin, text + length / numChunks * (i + 1));
+			chunk.end = chunk.end > text && chunk.end[-1] == '\n' ? chunk.end : skipLine (chunk.end, end);
+		}
+		chunkBegin = chunk.end;
+	}
+
+	// Parse every chunk, deferring negative indices as the elements before each chunk
+	// are not yet known.
+	runChunks (jobSystem, numChunks, [&chunks] (size_t i) {
+		PROFILE_ZONE ("ParseObj chunk");
+		Chunk & chunk = chunks[i];
+		chunk.references.materialLibrary[0] = '\0';
+		chunk.references.material[0] = '\0';
+		chunk.error = parseLines (chunk.begin, chunk.end - chunk.begin, chunk.geometry,
+			&chunk.references, &chunk.relativeIndices, chunk.errorLine);
+	});
+
+	// Number the elements and corners of each chunk after those of the chunks before it.
+	obj_parser::Geometry geometry;
+	size_t numPositions = 0;
+	size_t numTexcoords = 0;
+	size_t numNormals = 0;
+	size_t numCorners = 0;
+	for (Chunk & chunk : chunks) {
+		if (chunk.error) {
+			const uint32 line = static_cast<uint32>(std::count (text, chunk.begin, '\n')) +
+				chunk.errorLine;
+			LOG_CATEGORY_ERROR (Assets, "OBJ line %u: %s", line, chunk.error);
+			return false;
+		}
+
+		if (references && references->materialLibrary[0] == '\0') {
+			std::memcpy (references->materialLibrary, chunk.references.materialLibrary,
+				sizeof (references->materialLibrary));
+		}
+		if (references && references->material[0] == '\0') {
+			std::memcpy (references->material, chunk.references.material,
+				sizeof (references->material));
+		}
+
+		chunk.firstPosition = static_cast<uint32>(numPositions);
+		chunk.firstTexcoord = static_cast<uint32>(numTexcoords);
+		chunk.firstNormal = static_cast<uint32>(numNormals);
+		chunk.firstCorner = numCorners;
+		numPositions += chunk.geometry.positions.size () / 3;
+		numTexcoords += chunk.geometry.texcoords.size () / 2;
+		numNormals += chunk.geometry.normals.size () / 3;
+		numCorners += chunk.geometry.corners.size ();
+	}
+
+	if (numCorners == 0) {
+		return true;
+	}
+
+	geometry.positions.resize (numPositions * 3);
+	geometry.texcoords.resize (numTexcoords * 2);
+	geometry.normals.resize (numNormals * 3);
+
+	runChunks (jobSystem, numChunks, [&chunks, &geometry] (size_t i) {
+		PROFILE_ZONE ("ParseObj dedup");
+		chunks[i].error = buildChunk (chunks[i], geometry);
+	});
+
+	// Merge the distinct vertices of each chunk in order.  A vertex is first used in the
+	// earliest chunk using it, so vertices are numbered in order of first use throughout
+	// the file, exactly as by BuildMesh.
+	size_t numLocalVertices = 0;
+	for (const Chunk & chunk : chunks) {
+		if (chunk.error) {
+			LOG_CATEGORY_ERROR (Assets, "%s", chunk.error);
+			return false;
+		}
+		numLocalVertices += chunk.vertices.size ();
+	}
+
+	CornerTable table (numLocalVertices);
+	uint32 numVertices = 0;
+	for (Chunk & chunk : chunks) {
+		chunk.firstVertex = numVertices;
+		chunk.meshVertices.resize (chunk.vertices.size ());
+		for (size_t i (0); i < chunk.vertices.size (); ++i) {
+			uint32 & vertex = table.lookup (chunk.vertices[i]);
+			if (vertex == CornerTable::EMPTY) {
+				if (numVertices == MAX_VERTICES) {
+					LOG_CATEGORY_ERROR (Assets, "%s", TOO_MANY_VERTICES);
+					return false;
+				}
+				vertex = numVertices++;
+			}
+			chunk.meshVertices[i] = vertex;
+		}
+	}
+
+	mesh.numVertices = numVertices;
+	mesh.numIndices = static_cast<uint32>(numCorners);
+	mesh.vertices = static_cast<Vertex *>(
+		allocator.allocate (mesh.numVertices * sizeof (Vertex), alignof (Vertex)));
+	mesh.indices = static_cast<Index *>(
+		allocator.allocate (mesh.numIndices * sizeof (Index), alignof (Index)));
+
+	// Vertices first used in a chunk are numbered consecutively from its firstVertex, in
+	// the order of its own distinct vertices.
+	runChunks (jobSystem, numChunks, [&chunks, &geometry, &mesh] (size_t i) {
+		PROFILE_ZONE ("ParseObj fill");
+		const Chunk & chunk = chunks[i];
+		Index * indices = mesh.indices + chunk.firstCorner;
+		for (size_t corner (0); corner < chunk.localIndices.size (); ++corner) {
+			indices[corner] = static_cast<Index>(chunk.meshVertices[chunk.localIndices[corner]]);
+		}
+
+		for (size_t vertex (0); vertex < chunk.vertices.size (); ++vertex) {
+			const uint32 meshVertex = chunk.meshVertices[vertex];
+			if (meshVertex >= chunk.firstVertex) {
+				fillVertices (geometry, &chunk.vertices[vertex], 1, &mesh.vertices[meshVertex]);
+			}
+		}
+	});
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+bool ParseMtl (
+	const char * text,
+	size_t length,
+	const char * name,
+	ObjMaterial & material
+) {
+	const char * p = text;
+	const char * const end = text + length;
+
+	bool found = false;
+	for (; p < end; p = skipLine (p, end)) {
+		p = skipBlanks (p, end);
+
+		if (isKeyword (p, end, "newmtl", 6)) {
+			if (found) {
+				break;
+			}
+
+			char materialName[ObjMaterial::MAX_NAME_LENGTH];
+			copyRestOfLine (p + 6, end, materialName, sizeof (materialName));
+			if (name && name[0] != '\0' && std::strcmp (name, materialName) != 0) {
+				continue;
+			}
+
+			found = true;
+			std::memset (&material, 0, sizeof (ObjMaterial));
+			std::memcpy (material.name, materialName, sizeof (materialName));
+			material.opacity = 1.0f;
+		}
+		else if (!found) {
+			continue;
+		}
+		else if (isKeyword (p, end, "Ka", 2)) {
+			parseFloats (p + 2, end, material.ambient, 3);
+		}
+		else if (isKeyword (p, end, "Kd", 2)) {
+			parseFloats (p + 2, end, material.diffuse, 3);
+		}
+		else if (isKeyword (p, end, "Ks", 2)) {
+			parseFloats (p + 2, end, material.specular, 3);
+		}
+		else if (isKeyword (p, end, "Ke", 2)) {
+			parseFloats (p + 2, end, material.emissive, 3);
+		}
+		else if (isKeyword (p, end, "Ns", 2)) {
+			obj_parser::ParseFloat (p + 2, end, material.specularExponent);
+		}
+		else if (isKeyword (p, end, "d", 1)) {
+			obj_parser::ParseFloat (p + 1, end, material.opacity);
+		}
+		else if (isKeyword (p, end, "Tr", 2)) {
+			float transparency;
+			if (obj_parser::ParseFloat (p + 2, end, transparency)) {
+				material.opacity = 1.0f - transparency;
+			}
+		}
+		else if (isKeyword (p, end, "map_Kd", 6)) {
+			copyRestOfLine (p + 6, end, material.diffuseMap, sizeof (material.diffuseMap));
+		}
+	}
+
+	return found;
+}
+
+//---------------------------------------------------------------------------------------
+bool ReadWholeFile (
+	const char * path,
+	std::vector<char> & contents
+) {
+	// Open file, and advance read position to end of file to find its size.
+	std::ifstream file (path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open ()) {
+		return false;
+	}
+
+	const std::streamsize size = file.tellg ();
+	file.seekg (0, std::ios::beg);
+
+	contents.resize (static_cast<size_t>(size));
+	return size == 0 || static_cast<bool>(file.read (contents.data (), size));
+}
@@ -0,0 +1,154 @@
+//
+// ObjParser.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Graphics/RenderComponent.hpp"
+
+class Allocator;
+class JobSystem;
+
+
+/// Names referenced by an OBJ file.
+struct ObjReferences {
+	static const uint32 MAX_NAME_LENGTH = 260;
+
+	// File named by the first mtllib statement, or empty.
+	char materialLibrary[MAX_NAME_LENGTH];
+
+	// Material named by the first usemtl statement, or empty.
+	char material[MAX_NAME_LENGTH];
+};
+
+
+/// Material properties read from a Wavefront MTL file.
+struct ObjMaterial {
+	static const uint32 MAX_NAME_LENGTH = 260;
+
+	char name[MAX_NAME_LENGTH];
+
+	float ambient[3];
+	float diffuse[3];
+	float specular[3];
+	float emissive[3];
+	float specularExponent;
+	float opacity;
+
+	// Texture file named by map_Kd, or empty.
+	char diffuseMap[MAX_NAME_LENGTH];
+};
+
+
+namespace obj_parser
+{
+	/// Smallest chunk of text parsed by a single job.
+	const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+	/// Zero-based indices of the position, texture coordinate and normal of a face
+	/// corner.  Missing elements are NONE.
+	struct Corner {
+		static const uint32 NONE = 0xFFFFFFFF;
+
+		uint32 position;
+		uint32 texcoord;
+		uint32 normal;
+	};
+
+	/// Vertex elements and triangulated faces of an OBJ file, before vertices are
+	/// deduplicated.
+	struct Geometry {
+		std::vector<float> positions;
+		std::vector<float> texcoords;
+		std::vector<float> normals;
+
+		// Three corners per triangle.
+		std::vector<Corner> corners;
+	};
+
+	/// Parses the first number in [p, end), skipping leading spaces.  Returns a pointer
+	/// past the number, or nullptr if there is none.
+	const char * ParseFloat (
+		const char * p,
+		const char * end,
+		float & value
+	);
+
+	/// Parses OBJ text, appending to geometry.  Returns false after logging the first
+	/// line that could not be parsed.
+	/// @param references - receives named files and materials if not nullptr.
+	bool ParseGeometry (
+		const char * text,
+		size_t length,
+		Geometry & geometry,
+		ObjReferences * references
+	);
+
+	/// Builds a mesh in which each distinct combination of position, texture coordinate
+	/// and normal becomes one vertex, in order of first use.  Returns false if the mesh
+	/// has more than 2^30 vertices.
+	bool BuildMesh (
+		const Geometry & geometry,
+		Allocator & allocator,
+		MeshComponent & mesh
+	);
+}
+
+
+/// Most bytes ParseObj allocates for the mesh parsed from length bytes of text.
+size_t MaxObjMeshBytes (
+	size_t length
+);
+
+/// Slots in the table ParseObj finds the distinct corners of a mesh of up to maxCorners
+/// corners with.  A power of two, at least twice the corners a mesh can have distinct,
+/// so the table is never more than half full, and at most 2^31.
+uint32 ObjCornerTableCapacity (
+	size_t maxCorners
+);
+
+/// Parses Wavefront OBJ text into an indexed triangle mesh, whose vertices and indices
+/// are allocated from allocator.  Polygons are triangulated as fans.  Indices are 32-bit,
+/// so a mesh may have up to 2^30 distinct vertices.  Returns false after logging the
+/// first error.
+/// @param references - receives named files and materials if not nullptr.
+bool ParseObj (
+	const char * text,
+	size_t length,
+	Allocator & allocator,
+	MeshComponent & mesh,
+	ObjReferences * references = nullptr
+);
+
+/// Parses Wavefront OBJ text as ParseObj, spread across the threads of jobSystem.  The
+/// text is split at line boundaries into chunks of at least minChunkSize bytes, which
+/// are parsed and deduplicated in parallel then merged, giving a mesh identical to that
+/// of the single threaded ParseObj.
+///
+/// Must be called from the thread that constructed jobSystem or from within a job.
+bool ParseObj (
+	JobSystem & jobSystem,
+	const char * text,
+	size_t length,
+	Allocator & allocator,
+	MeshComponent & mesh,
+	ObjReferences * references = nullptr,
+	size_t minChunkSize = obj_parser::MIN_CHUNK_SIZE
+);
+
+/// Parses the material named name from Wavefront MTL text, or the first material if name
+/// is nullptr or empty.  Returns false if there is no such material.
+bool ParseMtl (
+	const char * text,
+	size_t length,
+	const char * name,
+	ObjMaterial & material
+);
+
+/// Reads the file at path in a single read.  Returns false if it could not be read.
+bool ReadWholeFile (
+	const char * path,
+	std::vector<char> & contents
+);
@@ -0,0 +1,247 @@
+//
+// PackFile.cpp
+//
+#include "pch.h"
+
+#include "Core/PackFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+const uint64 PackWriter::ALIGNMENT;
+
+namespace
+{
+	inline uint64 alignUp (
+		uint64 value
+	) {
+		return (value + PackWriter::ALIGNMENT - 1) & ~(PackWriter::ALIGNMENT - 1);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+uint64 HashAssetName (
+	const char * name,
+	const char * extension
+) {
+	assert (name && extension);
+	return AssetId (name).hashWithExtension (extension);
+}
+
+//---------------------------------------------------------------------------------------
+bool PackWriter::add (
+	const char * name,
+	const byte * data,
+	size_t size
+) {
+	const uint64 hash = HashAssetName (name);
+	auto inserted = _hashes.emplace (hash, _assets.size ());
+	if (!inserted.second) {
+		const std::string & other = _assets[inserted.first->second].name;
+		if (other == name) {
+			LOG_CATEGORY_ERROR (Assets, "Asset %s is added to the pack twice.", name);
+		} else {
+			LOG_CATEGORY_ERROR (Assets, "Asset names %s and %s have the same hash.  Rename one.",
+				name, other.c_str ());
+		}
+		return false;
+	}
+
+	_assets.push_back (Asset {hash, name, std::vector<byte> (data, data + size)});
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+uint PackWriter::numAssets () const
+{
+	return static_cast<uint>(_assets.size ());
+}
+
+//---------------------------------------------------------------------------------------
+bool PackWriter::write (
+	const char * path
+) const {
+	PackHeader header = {};
+	header.magic = PackHeader::MAGIC;
+	header.version = PackHeader::VERSION;
+	header.numEntries = static_cast<uint32>(_assets.size ());
+
+	// Lay assets out in the order they were added, after the table of contents.
+	std::vector<PackEntry> entries (_assets.size ());
+	uint64 offset = sizeof (PackHeader) + entries.size () * sizeof (PackEntry);
+	for (size_t i (0); i < _assets.size (); ++i) {
+		offset = alignUp (offset);
+		entries[i] = PackEntry {_assets[i].hash, offset, _assets[i].data.size ()};
+		offset += _assets[i].data.size ();
+	}
+
+	std::vector<PackEntry> table (entries);
+	std::sort (table.begin (), table.end (), [] (const PackEntry & a, const PackEntry & b) {
+		return a.hash < b.hash;
+	});
+
+	std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write (reinterpret_cast<const char *>(&header), sizeof (header));
+	file.write (reinterpret_cast<const char *>(table.data ()), table.size () * sizeof (PackEntry));
+
+	const char padding[ALIGNMENT] = {};
+	uint64 written = sizeof (PackHeader) + table.size () * sizeof (PackEntry);
+	for (size_t i (0); i < _assets.size (); ++i) {
+		file.write (padding, entries[i].offset - written);
+		file.write (reinterpret_cast<const char *>(_assets[i].data.data ()), entries[i].size);
+		written = entries[i].offset + entries[i].size;
+	}
+
+	if (!file) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to write pack file %s", path);
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+PackFile::PackFile ()
+	: _file (INVALID_HANDLE_VALUE),
+	  _mapping (nullptr),
+	  _view (nullptr),
+	  _size (0),
+	  _entries (nullptr),
+	  _numEntries (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+PackFile::~PackFile ()
+{
+	close ();
+}
+
+//---------------------------------------------------------------------------------------
+bool PackFile::open (
+	const char * path
+) {
+	assert (path);
+	close ();
+
+	_file = CreateFileA (path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (_file == INVALID_HANDLE_VALUE) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to open pack file %s", path);
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx (_file, &size) || uint64 (size.QuadPart) < sizeof (PackHeader)) {
+		LOG_CATEGORY_ERROR (Assets, "Pack file %s is truncated.", path);
+		close ();
+		return false;
+	}
+	_size = size.QuadPart;
+
+	_mapping = CreateFileMappingA (_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	_view = _mapping ?
+		static_cast<const byte *>(MapViewOfFile (_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (!_view) {
+		LOG_CATEGORY_ERROR (Assets, "Unable to map pack file %s", path);
+		close ();
+		return false;
+	}
+
+	const PackHeader * header = reinterpret_cast<const PackHeader *>(_view);
+	if (header->magic != PackHeader::MAGIC || header->version != PackHeader::VERSION ||
+		header->numEntries > (_size - sizeof (PackHeader)) / sizeof (PackEntry))
+	{
+		LOG_CATEGORY_ERROR (Assets, "%s is not a version %u pack file.", path,
+			PackHeader::VERSION);
+		close ();
+		return false;
+	}
+
+	// Every entry must lie within the file, in order of hash for find() to search.
+	const PackEntry * entries = reinterpret_cast<const PackEntry *>(header + 1);
+	for (uint32 i (0); i < header->numEntries; ++i) {
+		if (entries[i].offset > _size || entries[i].size > _size - entries[i].offset ||
+			(i > 0 && entries[i].hash <= entries[i - 1].hash))
+		{
+			LOG_CATEGORY_ERROR (Assets, "Pack file %s has an invalid table of contents.", path);
+			close ();
+			return false;
+		}
+	}
+
+	_entries = entries;
+	_numEntries = header->numEntries;
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+void PackFile::close ()
+{
+	if (_view) {
+		UnmapViewOfFile (_view);
+	}
+	if (_mapping) {
+		CloseHandle (_mapping);
+	}
+	if (_file != INVALID_HANDLE_VALUE) {
+		CloseHandle (_file);
+	}
+
+	_file = INVALID_HANDLE_VALUE;
+	_mapping = nullptr;
+	_view = nullptr;
+	_size = 0;
+	_entries = nullptr;
+	_numEntries = 0;
+}
+
+//---------------------------------------------------------------------------------------
+bool PackFile::isOpen () const
+{
+	return _view != nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+uint PackFile::numAssets () const
+{
+	return _numEntries;
+}
+
+//---------------------------------------------------------------------------------------
+const PackEntry * PackFile::findEntry (
+	uint64 hash
+) const {
+	const PackEntry * end = _entries + _numEntries;
+	const PackEntry * entry = std::lower_bound (_entries, end, hash,
+		[] (const PackEntry & entry, uint64 hash) {
+			return entry.hash < hash;
+		});
+	return entry != end && entry->hash == hash ? entry : nullptr;
+}
+
+//---------------------------------------------------------------------------------------
+const byte * PackFile::find (
+	uint64 hash,
+	size_t & size
+) const {
+	const PackEntry * entry = findEntry (hash);
+	if (!entry) {
+		size = 0;
+		return nullptr;
+	}
+
+	size = static_cast<size_t>(entry->size);
+	return _view + entry->offset;
+}
+
+//---------------------------------------------------------------------------------------
+const byte * PackFile::find (
+	const AssetId & id,
+	const char * extension,
+	size_t & size
+) const {
+	return find (id.hashWithExtension (extension), size);
+}
@@ -0,0 +1,133 @@
+//
+// PackFile.hpp
+//
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Core/AssetId.hpp"
+#include "Core/Types.hpp"
+
+
+/// Hashes an asset's name followed by extension, such as "low_poly_ship" and ".mesh",
+/// to the key it is stored under in a pack file.  The same as the AssetId of the name's
+/// hashWithExtension (extension).
+uint64 HashAssetName (
+	const char * name,
+	const char * extension = ""
+);
+
+
+/// Header at the start of a pack file.  The table of contents follows it, then the
+/// contents of each asset.
+struct PackHeader {
+	/// "SSPK" in a little endian file.
+	static const uint32 MAGIC = 0x4B505353;
+	static const uint32 VERSION = 1;
+
+	uint32 magic;
+	uint32 version;
+	uint32 numEntries;
+	uint32 reserved;
+};
+
+/// Location of an asset within a pack file.  Entries are sorted by hash.
+struct PackEntry {
+	uint64 hash;
+	uint64 offset;
+	uint64 size;
+};
+
+
+/// Collects assets and writes them to a pack file, each at an offset aligned to
+/// PackWriter::ALIGNMENT.
+class PackWriter {
+public:
+	/// Alignment of assets within the file.  Mapped views are page aligned, so assets
+	/// are aligned in memory as they are in the file.
+	static const uint64 ALIGNMENT = 16;
+
+	/// Adds a copy of size bytes of data as the asset called name.  Returns false,
+	/// without adding it, if the name is already in the pack, or collides with the hash
+	/// of a different name.
+	bool add (
+		const char * name,
+		const byte * data,
+		size_t size
+	);
+
+	uint numAssets () const;
+
+	/// Writes every asset added to the file at path.  Returns false on failure.
+	bool write (
+		const char * path
+	) const;
+
+private:
+	struct Asset {
+		uint64 hash;
+		std::string name;
+		std::vector<byte> data;
+	};
+
+	std::vector<Asset> _assets;
+
+	// Index in _assets of each hash.
+	std::unordered_map<uint64, size_t> _hashes;
+};
+
+
+/// Read-only view of every asset in a pack file, mapped into memory.  Assets are used
+/// where they lie in the mapping, so pointers returned by find() remain valid until
+/// the pack file is closed.
+class PackFile {
+public:
+	PackFile ();
+
+	~PackFile ();
+
+	/// Maps the pack file at path, closing any file open before.  Returns false if it
+	/// could not be opened or is not a valid pack file.
+	bool open (
+		const char * path
+	);
+
+	void close ();
+
+	bool isOpen () const;
+
+	uint numAssets () const;
+
+	/// Returns the entry of the asset stored under hash, or nullptr if there is none.
+	const PackEntry * findEntry (
+		uint64 hash
+	) const;
+
+	/// Returns the asset stored under hash, setting size to its size in bytes, or
+	/// nullptr if there is none.
+	const byte * find (
+		uint64 hash,
+		size_t & size
+	) const;
+
+	/// Returns the asset identified by id, of the type with extension.
+	const byte * find (
+		const AssetId & id,
+		const char * extension,
+		size_t & size
+	) const;
+
+	/// Forbid copying of PackFile objects.
+	PackFile (const PackFile & other) = delete;
+	PackFile & operator = (const PackFile & other) = delete;
+
+private:
+	void * _file;
+	void * _mapping;
+	const byte * _view;
+	uint64 _size;
+	const PackEntry * _entries;
+	uint32 _numEntries;
+};
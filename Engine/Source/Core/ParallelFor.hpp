@@ -0,0 +1,47 @@
+//
+// ParallelFor.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+#include "Core/JobSystem.hpp"
+
+
+/// Invokes body(rangeBegin, rangeEnd) over disjoint sub-ranges covering [begin, end),
+/// spread across the threads of jobSystem.  Returns once every sub-range has completed.
+///
+/// The grain size is chosen adaptively.  A short prefix of the range is executed on the
+/// calling thread while timing it, and the measured cost per index sets how many
+/// indices each job receives.  Loops too cheap to amortize a job complete on the
+/// calling thread, while the rest are split recursively in halves, so that thieves
+/// steal large pieces and split them further themselves.
+///
+/// Must be called from the thread that constructed jobSystem or from within a job.
+template <typename Function>
+void ParallelFor (
+	JobSystem & jobSystem,
+	uint32 begin,
+	uint32 end,
+	const Function & body
+);
+
+/// Combines map(rangeBegin, rangeEnd) over disjoint sub-ranges covering [begin, end)
+/// using reduce(lower, upper), spread across the threads of jobSystem, and returns the
+/// result.  Returns identity for an empty range.
+///
+/// Sub-ranges are split as by ParallelFor, and reduce is always passed the results of
+/// adjacent ranges in index order, so it must be associative but need not be
+/// commutative.  Split points depend on measured timings, so floating-point results may
+/// differ in their last bits between calls.
+template <typename T, typename Map, typename Reduce>
+T ParallelReduce (
+	JobSystem & jobSystem,
+	uint32 begin,
+	uint32 end,
+	const T & identity,
+	const Map & map,
+	const Reduce & reduce
+);
+
+
+#include "Core/ParallelFor.inl"
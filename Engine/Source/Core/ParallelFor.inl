@@ -0,0 +1,177 @@
+//
+// ParallelFor.inl
+//
+#include <algorithm>
+#include <chrono>
+
+namespace parallel_for
+{
+	/// Duration each job should run for.  Long enough to amortize the cost of
+	/// submitting and stealing it, short enough to leave work for idle threads.
+	const uint64 TARGET_JOB_NANOSECONDS = 20000;
+
+	/// Duration of the prefix timed on the calling thread to measure cost per index.
+	const uint64 PROBE_NANOSECONDS = 2000;
+
+	/// Executes body over doubling batches from the start of [begin, end) until
+	/// PROBE_NANOSECONDS have elapsed.  Returns the first index not yet executed, and
+	/// sets grainSize to the number of indices expected to take TARGET_JOB_NANOSECONDS.
+	template <typename Function>
+	uint32 Probe (
+		uint32 begin,
+		uint32 end,
+		const Function & body,
+		uint32 & grainSize
+	) {
+		typedef std::chrono::high_resolution_clock Clock;
+
+		uint32 index = begin;
+		uint32 batchSize = 1;
+		uint64 elapsed = 0;
+		while (index < end && elapsed < PROBE_NANOSECONDS) {
+			const uint32 batchEnd = index + std::min (batchSize, end - index);
+
+			const Clock::time_point start = Clock::now ();
+			body (index, batchEnd);
+			elapsed += std::chrono::duration_cast<std::chrono::nanoseconds> (Clock::now () - start).count ();
+
+			index = batchEnd;
+			batchSize *= 2;
+		}
+
+		const uint64 executed = index - begin;
+		const uint64 grain = TARGET_JOB_NANOSECONDS * executed / std::max<uint64> (elapsed, 1);
+		grainSize = static_cast<uint32>(std::min<uint64> (std::max<uint64> (grain, 1), UINT32_MAX));
+		return index;
+	}
+
+	template <typename Function>
+	struct ForState {
+		ForState (
+			JobSystem & jobSystem,
+			const Function & body,
+			uint32 grainSize
+		)
+			: jobSystem (jobSystem),
+			  body (body),
+			  grainSize (grainSize)
+		{
+
+		}
+
+		JobSystem & jobSystem;
+		const Function & body;
+		const uint32 grainSize;
+		JobCounter counter;
+	};
+
+	template <typename Function>
+	void SplitFor (
+		ForState<Function> & state,
+		uint32 begin,
+		uint32 end
+	) {
+		// Hand off upper halves until a single job's worth remains.
+		while (end - begin > state.grainSize) {
+			const uint32 middle = begin + (end - begin) / 2;
+			state.jobSystem.run ([&state, middle, end] {
+				SplitFor (state, middle, end);
+			}, &state.counter);
+			end = middle;
+		}
+
+		state.body (begin, end);
+	}
+
+	template <typename T, typename Map, typename Reduce>
+	struct ReduceState {
+		JobSystem & jobSystem;
+		const T & identity;
+		const Map & map;
+		const Reduce & reduce;
+		uint32 grainSize;
+	};
+
+	template <typename T, typename Map, typename Reduce>
+	T SplitReduce (
+		const ReduceState<T, Map, Reduce> & state,
+		uint32 begin,
+		uint32 end
+	) {
+		if (end - begin <= state.grainSize) {
+			return state.map (begin, end);
+		}
+
+		const uint32 middle = begin + (end - begin) / 2;
+		T upper (state.identity);
+		JobCounter counter;
+		state.jobSystem.run ([&state, &upper, middle, end] {
+			upper = SplitReduce (state, middle, end);
+		}, &counter);
+
+		const T lower = SplitReduce (state, begin, middle);
+		state.jobSystem.wait (counter);
+		return state.reduce (lower, upper);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+template <typename Function>
+void ParallelFor (
+	JobSystem & jobSystem,
+	uint32 begin,
+	uint32 end,
+	const Function & body
+) {
+	if (begin >= end) {
+		return;
+	}
+	if (jobSystem.threadCount () == 1) {
+		body (begin, end);
+		return;
+	}
+
+	uint32 grainSize;
+	begin = parallel_for::Probe (begin, end, body, grainSize);
+	if (end - begin <= grainSize) {
+		// Cheaper to finish here than to hand off.
+		if (begin < end) {
+			body (begin, end);
+		}
+		return;
+	}
+
+	parallel_for::ForState<Function> state (jobSystem, body, grainSize);
+	parallel_for::SplitFor (state, begin, end);
+	jobSystem.wait (state.counter);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T, typename Map, typename Reduce>
+T ParallelReduce (
+	JobSystem & jobSystem,
+	uint32 begin,
+	uint32 end,
+	const T & identity,
+	const Map & map,
+	const Reduce & reduce
+) {
+	if (begin >= end) {
+		return identity;
+	}
+	if (jobSystem.threadCount () == 1) {
+		return map (begin, end);
+	}
+
+	T result (identity);
+	uint32 grainSize;
+	begin = parallel_for::Probe (begin, end, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		result = reduce (result, map (rangeBegin, rangeEnd));
+	}, grainSize);
+
+	if (begin < end) {
+		const parallel_for::ReduceState<T, Map, Reduce> state = {jobSystem, identity, map, reduce, grainSize};
+		result = reduce (result, parallel_for::SplitReduce (state, begin, end));
+	}
+	return result;
+}
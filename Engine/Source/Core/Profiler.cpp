@@ -0,0 +1,264 @@
+//
+// Profiler.cpp
+//
+#include "pch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Core/Profiler.hpp"
+
+namespace
+{
+	struct ZoneEvent {
+		const char * name;
+		uint64 startTicks;
+		uint64 endTicks;
+	};
+
+	/// Zones recorded by a single thread.  Only the owning thread writes events, and it
+	/// publishes each one by incrementing count.
+	struct ThreadBuffer {
+		uint32 threadIndex;
+		std::string name;
+
+		// Allocated on recording the first zone, as naming a thread also registers it.
+		std::unique_ptr<ZoneEvent[]> events;
+
+		// Capture the events belong to.  The owning thread clears its buffer on
+		// recording the first zone of a new capture.
+		std::atomic<uint32> captureId;
+		std::atomic<uint32> count;
+	};
+
+	/// Buffers of every thread that has recorded a zone.  Buffers outlive their threads
+	/// so that zones remain available for export.
+	struct Registry {
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+	};
+
+	Registry & registry ()
+	{
+		static Registry instance;
+		return instance;
+	}
+
+	std::atomic<uint32> g_captureId (0);
+	std::atomic<uint32> g_framesRemaining (0);
+
+	// Timestamp counter and wall clock at the start and end of the capture, used to
+	// convert ticks to microseconds.
+	uint64 g_startTicks = 0;
+	uint64 g_endTicks = 0;
+	std::chrono::steady_clock::time_point g_startTime;
+	std::chrono::steady_clock::time_point g_endTime;
+
+	thread_local ThreadBuffer * t_buffer = nullptr;
+
+	ThreadBuffer & currentThreadBuffer ()
+	{
+		if (!t_buffer) {
+			Registry & instance = registry ();
+			std::lock_guard<std::mutex> lock (instance.mutex);
+
+			ThreadBuffer * buffer = new ThreadBuffer ();
+			buffer->threadIndex = static_cast<uint32>(instance.buffers.size ());
+			buffer->name = "Thread " + std::to_string (buffer->threadIndex);
+			buffer->captureId.store (0, std::memory_order_relaxed);
+			buffer->count.store (0, std::memory_order_relaxed);
+			instance.buffers.emplace_back (buffer);
+
+			t_buffer = buffer;
+		}
+		return *t_buffer;
+	}
+
+	/// Appends text to json as a quoted string literal.
+	void appendJsonString (
+		std::string & json,
+		const char * text
+	) {
+		json += '"';
+		for (const char * c (text); *c; ++c) {
+			if (*c == '"' || *c == '\\') {
+				json += '\\';
+			}
+			json += *c;
+		}
+		json += '"';
+	}
+}
+
+std::atomic<bool> Profiler::_capturing (false);
+
+
+//---------------------------------------------------------------------------------------
+void Profiler::BeginCapture (
+	uint32 frameCount
+) {
+	EndCapture ();
+
+	g_framesRemaining.store (frameCount, std::memory_order_relaxed);
+	g_captureId.fetch_add (1, std::memory_order_relaxed);
+	g_startTime = std::chrono::steady_clock::now ();
+	g_startTicks = Ticks ();
+
+	_capturing.store (true, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+void Profiler::EndCapture ()
+{
+	if (!_capturing.exchange (false, std::memory_order_acq_rel)) {
+		return;
+	}
+
+	g_endTicks = Ticks ();
+	g_endTime = std::chrono::steady_clock::now ();
+}
+
+//---------------------------------------------------------------------------------------
+void Profiler::NextFrame ()
+{
+	// Captures begun without a frame count have none remaining to count down.
+	if (!IsCapturing () || g_framesRemaining.load (std::memory_order_relaxed) == 0) {
+		return;
+	}
+
+	if (g_framesRemaining.fetch_sub (1, std::memory_order_relaxed) == 1) {
+		EndCapture ();
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool Profiler::IsCapturing ()
+{
+	return _capturing.load (std::memory_order_relaxed);
+}
+
+//---------------------------------------------------------------------------------------
+void Profiler::SetThreadName (
+	const char * name
+) {
+	ThreadBuffer & buffer = currentThreadBuffer ();
+
+	// Names are read during export while holding the registry's mutex.
+	std::lock_guard<std::mutex> lock (registry ().mutex);
+	buffer.name = name;
+}
+
+//---------------------------------------------------------------------------------------
+void Profiler::RecordZone (
+	const char * name,
+	uint64 startTicks,
+	uint64 endTicks
+) {
+	if (!IsCapturing ()) {
+		return;
+	}
+
+	ThreadBuffer & buffer = currentThreadBuffer ();
+
+	const uint32 captureId = g_captureId.load (std::memory_order_relaxed);
+	if (buffer.captureId.load (std::memory_order_relaxed) != captureId) {
+		if (!buffer.events) {
+			buffer.events.reset (new ZoneEvent[EVENTS_PER_THREAD]);
+		}
+		buffer.count.store (0, std::memory_order_relaxed);
+		buffer.captureId.store (captureId, std::memory_order_release);
+	}
+
+	const uint32 count = buffer.count.load (std::memory_order_relaxed);
+	if (count == EVENTS_PER_THREAD) {
+		return;
+	}
+
+	buffer.events[count] = {name, startTicks, endTicks};
+
+	// Release so that an exporter observing the new count also observes the event.
+	buffer.count.store (count + 1, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+uint64 Profiler::ZoneCount ()
+{
+	Registry & instance = registry ();
+	std::lock_guard<std::mutex> lock (instance.mutex);
+
+	const uint32 captureId = g_captureId.load (std::memory_order_relaxed);
+	uint64 total = 0;
+	for (auto & buffer : instance.buffers) {
+		if (buffer->captureId.load (std::memory_order_acquire) == captureId) {
+			total += buffer->count.load (std::memory_order_acquire);
+		}
+	}
+	return total;
+}
+
+//---------------------------------------------------------------------------------------
+std::string Profiler::ChromeTrace ()
+{
+	assert (!IsCapturing ());
+
+	const double microseconds =
+		std::chrono::duration<double, std::micro> (g_endTime - g_startTime).count ();
+	const double ticksPerMicrosecond = microseconds > 0.0 ?
+		double (g_endTicks - g_startTicks) / microseconds : 1.0;
+
+	Registry & instance = registry ();
+	std::lock_guard<std::mutex> lock (instance.mutex);
+
+	const uint32 captureId = g_captureId.load (std::memory_order_relaxed);
+	std::string json = "{\"traceEvents\":[";
+	bool first = true;
+	char buffer[128];
+
+	for (auto & thread : instance.buffers) {
+		if (thread->captureId.load (std::memory_order_acquire) != captureId) {
+			continue;
+		}
+
+		std::snprintf (buffer, sizeof (buffer),
+			"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+			first ? "" : ",", thread->threadIndex);
+		json += buffer;
+		appendJsonString (json, thread->name.c_str ());
+		json += "}}";
+		first = false;
+
+		const uint32 count = thread->count.load (std::memory_order_acquire);
+		for (uint32 i (0); i < count; ++i) {
+			const ZoneEvent & event = thread->events[i];
+			json += ",\n{\"name\":";
+			appendJsonString (json, event.name);
+			std::snprintf (buffer, sizeof (buffer),
+				",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				thread->threadIndex,
+				int64 (event.startTicks - g_startTicks) / ticksPerMicrosecond,
+				(event.endTicks - event.startTicks) / ticksPerMicrosecond);
+			json += buffer;
+		}
+	}
+
+	json += "\n]}\n";
+	return json;
+}
+
+//---------------------------------------------------------------------------------------
+bool Profiler::SaveChromeTrace (
+	const char * path
+) {
+	std::ofstream file (path, std::ios::out | std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	const std::string json = ChromeTrace ();
+	file.write (json.data (), json.size ());
+	return static_cast<bool>(file);
+}
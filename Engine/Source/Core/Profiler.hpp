@@ -0,0 +1,118 @@
+//
+// Profiler.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#else
+	#include <x86intrin.h>
+#endif
+
+#include "Core/Types.hpp"
+
+
+#define PROFILER_CONCATENATE_(a, b) a##b
+#define PROFILER_CONCATENATE(a, b) PROFILER_CONCATENATE_(a, b)
+
+/// Records the enclosing scope as a zone named name, which must be a string literal or
+/// otherwise outlive the capture.
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCATENATE(profileZone, __LINE__) (name)
+
+
+/// Instrumentation profiler recording named zones of CPU time on every thread.
+///
+/// Zones are only recorded while a capture is in progress, and are written to a
+/// fixed-size buffer owned by the recording thread, so recording takes no locks.
+/// Timestamps are read with rdtsc and converted to microseconds when the trace is
+/// exported, using the tick rate measured across the capture.  Traces are exported as
+/// Chrome trace-event JSON, which can be opened in chrome://tracing or Perfetto.
+class Profiler {
+public:
+	/// Zones each thread can record per capture.  Later zones are dropped.
+	static const uint32 EVENTS_PER_THREAD = 65536;
+
+	/// Discards the previous capture, and records zones until NextFrame() has been
+	/// called frameCount times or EndCapture() is called.  A frameCount of 0 records
+	/// until EndCapture() is called.
+	static void BeginCapture (
+		uint32 frameCount
+	);
+
+	static void EndCapture ();
+
+	/// Marks the end of a frame, ending the capture after its last frame.  Must only be
+	/// called from one thread.
+	static void NextFrame ();
+
+	static bool IsCapturing ();
+
+	/// Names the calling thread within exported traces.
+	static void SetThreadName (
+		const char * name
+	);
+
+	/// Number of zones recorded during the last capture, across all threads.
+	static uint64 ZoneCount ();
+
+	/// Returns the last capture as Chrome trace-event JSON.  Must not be called while
+	/// capturing.
+	static std::string ChromeTrace ();
+
+	/// Writes ChromeTrace() to the file at path, returning false on failure.
+	static bool SaveChromeTrace (
+		const char * path
+	);
+
+	/// Appends a completed zone to the calling thread's buffer.
+	static void RecordZone (
+		const char * name,
+		uint64 startTicks,
+		uint64 endTicks
+	);
+
+	/// Current value of the processor's timestamp counter.
+	static uint64 Ticks ()
+	{
+		return __rdtsc ();
+	}
+
+private:
+	friend class ProfileZone;
+
+	// Set while a capture is in progress.
+	static std::atomic<bool> _capturing;
+};
+
+
+/// Records its lifetime as a zone if a capture was in progress when it was constructed.
+/// Use through PROFILE_ZONE.
+class ProfileZone {
+public:
+	explicit ProfileZone (
+		const char * name
+	)
+		: _name (Profiler::_capturing.load (std::memory_order_relaxed) ? name : nullptr),
+		  _startTicks (_name ? Profiler::Ticks () : 0)
+	{
+
+	}
+
+	~ProfileZone ()
+	{
+		if (_name) {
+			Profiler::RecordZone (_name, _startTicks, Profiler::Ticks ());
+		}
+	}
+
+	/// Forbid copying of ProfileZone objects.
+	ProfileZone (const ProfileZone & other) = delete;
+	ProfileZone & operator = (const ProfileZone & other) = delete;
+
+private:
+	const char * const _name;
+	const uint64 _startTicks;
+};
@@ -0,0 +1,129 @@
+//
+// RadixSort.cpp
+//
+#include "pch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Core/RadixSort.hpp"
+#include "Core/ParallelFor.hpp"
+
+namespace
+{
+	const uint RADIX_BITS = 8;
+	const uint NUM_BUCKETS = 1 << RADIX_BITS;
+	const uint NUM_PASSES = 64 / RADIX_BITS;
+
+	// Blocks smaller than this are not worth handing to another thread.
+	const uint32 MIN_ENTRIES_PER_BLOCK = 16384;
+
+	inline uint digitOf (
+		uint64 key,
+		uint shift
+	) {
+		return static_cast<uint>(key >> shift) & (NUM_BUCKETS - 1);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+void RadixSort (
+	SortEntry * entries,
+	SortEntry * scratch,
+	uint32 count,
+	JobSystem & jobSystem
+) {
+	if (count < 2) {
+		return;
+	}
+	assert (entries && scratch);
+
+	const uint32 numBlocks = std::max (1u,
+		std::min<uint32> (jobSystem.threadCount (), count / MIN_ENTRIES_PER_BLOCK));
+	const uint32 blockSize = (count + numBlocks - 1) / numBlocks;
+
+	auto blockRange = [&] (uint32 block, uint32 & begin, uint32 & end) {
+		begin = block * blockSize;
+		end = std::min (begin + blockSize, count);
+	};
+
+	//-- Find which key bits differ between entries, so constant bytes can be skipped.
+	std::vector<uint64> blockVaryingBits (numBlocks);
+	ParallelFor (jobSystem, 0, numBlocks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 block (rangeBegin); block < rangeEnd; ++block) {
+			uint32 begin, end;
+			blockRange (block, begin, end);
+
+			const uint64 firstKey = entries[0].key;
+			uint64 varyingBits = 0;
+			for (uint32 i (begin); i < end; ++i) {
+				varyingBits |= entries[i].key ^ firstKey;
+			}
+			blockVaryingBits[block] = varyingBits;
+		}
+	});
+
+	uint64 varyingBits = 0;
+	for (uint64 bits : blockVaryingBits) {
+		varyingBits |= bits;
+	}
+
+	// Per-block bucket counts, converted in place into per-block scatter offsets.
+	std::vector<uint32> blockOffsets (numBlocks * NUM_BUCKETS);
+
+	SortEntry * src = entries;
+	SortEntry * dst = scratch;
+
+	for (uint pass (0); pass < NUM_PASSES; ++pass) {
+		const uint shift = pass * RADIX_BITS;
+		if (digitOf (varyingBits, shift) == 0) {
+			continue;
+		}
+
+		//-- Histogram each block.
+		ParallelFor (jobSystem, 0, numBlocks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+			for (uint32 block (rangeBegin); block < rangeEnd; ++block) {
+				uint32 begin, end;
+				blockRange (block, begin, end);
+
+				uint32 * histogram = &blockOffsets[block * NUM_BUCKETS];
+				std::memset (histogram, 0, NUM_BUCKETS * sizeof (uint32));
+				for (uint32 i (begin); i < end; ++i) {
+					++histogram[digitOf (src[i].key, shift)];
+				}
+			}
+		});
+
+		//-- Exclusive prefix sum in (bucket, block) order keeps the sort stable.
+		uint32 offset = 0;
+		for (uint bucket (0); bucket < NUM_BUCKETS; ++bucket) {
+			for (uint32 block (0); block < numBlocks; ++block) {
+				uint32 & blockOffset = blockOffsets[block * NUM_BUCKETS + bucket];
+				const uint32 bucketCount = blockOffset;
+				blockOffset = offset;
+				offset += bucketCount;
+			}
+		}
+
+		//-- Scatter each block into its reserved ranges of dst.
+		ParallelFor (jobSystem, 0, numBlocks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+			for (uint32 block (rangeBegin); block < rangeEnd; ++block) {
+				uint32 begin, end;
+				blockRange (block, begin, end);
+
+				uint32 * offsets = &blockOffsets[block * NUM_BUCKETS];
+				for (uint32 i (begin); i < end; ++i) {
+					dst[offsets[digitOf (src[i].key, shift)]++] = src[i];
+				}
+			}
+		});
+
+		std::swap (src, dst);
+	}
+
+	if (src != entries) {
+		std::memcpy (entries, src, count * sizeof (SortEntry));
+	}
+}
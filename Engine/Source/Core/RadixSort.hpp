@@ -0,0 +1,28 @@
+//
+// RadixSort.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+
+class JobSystem;
+
+/// A 64-bit sort key paired with the index of the item it was generated for.
+struct SortEntry {
+	uint64 key;
+	uint32 index;
+};
+
+/// Sorts entries in ascending key order using a stable least-significant-digit radix
+/// sort, splitting each pass across the threads of jobSystem.  Must be called from the
+/// thread that constructed jobSystem, or from within a job.
+///
+/// scratch must point to storage for count entries, and may be overwritten.  Passes over
+/// bytes in which every key is identical are skipped, so keys that leave bits unused
+/// sort faster.
+void RadixSort (
+	SortEntry * entries,
+	SortEntry * scratch,
+	uint32 count,
+	JobSystem & jobSystem
+);
@@ -0,0 +1,62 @@
+//
+// SpscQueue.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Core/Types.hpp"
+
+
+/// Fixed capacity lock-free ring buffer for passing values from a single producer
+/// thread to a single consumer thread.
+///
+/// Each side keeps a private copy of the other side's index and only reloads it when
+/// the queue appears full or empty, so in the steady state pushes and pops touch no
+/// cache lines written by the other thread other than the slots themselves.
+template <typename T>
+class SpscQueue {
+public:
+	/// capacity must be a power of two.
+	explicit SpscQueue (
+		uint32 capacity
+	);
+
+	/// Copies value to the back of the queue, or returns false if the queue is full.
+	/// Only called by the producer thread.
+	bool tryPush (
+		const T & value
+	);
+
+	/// Moves the front of the queue into value, or returns false if the queue is empty.
+	/// Only called by the consumer thread.
+	bool tryPop (
+		T & value
+	);
+
+	/// Approximate number of queued values.
+	uint32 size () const;
+
+	uint32 capacity () const;
+
+
+	/// Forbid copying of SpscQueue objects.
+	SpscQueue (const SpscQueue & other) = delete;
+	SpscQueue & operator = (const SpscQueue & other) = delete;
+
+private:
+	// Indices are written by different threads, so each side's state is kept on its own
+	// cache line.
+	alignas(64) std::atomic<uint64> _head;
+	uint64 _cachedTail;
+
+	alignas(64) std::atomic<uint64> _tail;
+	uint64 _cachedHead;
+
+	alignas(64) std::unique_ptr<T[]> _values;
+	const uint64 _mask;
+};
+
+
+#include "Core/SpscQueue.inl"
@@ -0,0 +1,76 @@
+//
+// SpscQueue.inl
+//
+#include <cassert>
+#include <utility>
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+SpscQueue<T>::SpscQueue (
+	uint32 capacity
+)
+	: _head (0),
+	  _cachedTail (0),
+	  _tail (0),
+	  _cachedHead (0),
+	  _values (new T[capacity]),
+	  _mask (capacity - 1)
+{
+	assert (capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool SpscQueue<T>::tryPush (
+	const T & value
+) {
+	const uint64 tail = _tail.load (std::memory_order_relaxed);
+	if (tail - _cachedHead > _mask) {
+		_cachedHead = _head.load (std::memory_order_acquire);
+		if (tail - _cachedHead > _mask) {
+			return false;
+		}
+	}
+
+	_values[tail & _mask] = value;
+
+	// Release so that the consumer observing the new tail also observes the value.
+	_tail.store (tail + 1, std::memory_order_release);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+bool SpscQueue<T>::tryPop (
+	T & value
+) {
+	const uint64 head = _head.load (std::memory_order_relaxed);
+	if (head == _cachedTail) {
+		_cachedTail = _tail.load (std::memory_order_acquire);
+		if (head == _cachedTail) {
+			return false;
+		}
+	}
+
+	value = std::move (_values[head & _mask]);
+
+	// Release so that the producer only reuses the slot once the value has been read.
+	_head.store (head + 1, std::memory_order_release);
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+uint32 SpscQueue<T>::size () const
+{
+	const uint64 head = _head.load (std::memory_order_acquire);
+	const uint64 tail = _tail.load (std::memory_order_acquire);
+	return tail > head ? static_cast<uint32>(tail - head) : 0;
+}
+
+//---------------------------------------------------------------------------------------
+template <typename T>
+uint32 SpscQueue<T>::capacity () const
+{
+	return static_cast<uint32>(_mask + 1);
+}
@@ -0,0 +1,202 @@
+//
+// TaskGraph.cpp
+//
+#include "pch.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "Core/Profiler.hpp"
+#include "Core/TaskGraph.hpp"
+
+
+//---------------------------------------------------------------------------------------
+TaskGraph::TaskGraph (
+	JobSystem & jobSystem
+)
+	: _jobSystem (jobSystem),
+	  _compiled (false),
+	  _frameMilliseconds (0.0),
+	  _criticalPathMilliseconds (0.0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+TaskId TaskGraph::addTask (
+	const char * name,
+	TaskFunction function,
+	std::initializer_list<TaskId> dependencies
+) {
+	assert (!_compiled);
+
+	const TaskId id = static_cast<TaskId>(_tasks.size ());
+	for (TaskId dependency : dependencies) {
+		// Assert dependency was added before this task, which rules out cycles.
+		assert (dependency < id);
+		_tasks[dependency].dependents.push_back (id);
+	}
+
+	Task task;
+	task.name = name;
+	task.function = std::move (function);
+	task.dependencies.assign (dependencies.begin (), dependencies.end ());
+	_tasks.push_back (std::move (task));
+	return id;
+}
+
+//---------------------------------------------------------------------------------------
+void TaskGraph::compile ()
+{
+	assert (!_compiled);
+	_compiled = true;
+
+	const uint32 count = taskCount ();
+	_pendingDependencies.reset (new std::atomic<uint32>[count]);
+	_timings.assign (count, TaskTiming {0.0, 0.0});
+
+	for (TaskId id (0); id < count; ++id) {
+		if (_tasks[id].dependencies.empty ()) {
+			_roots.push_back (id);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void TaskGraph::execute ()
+{
+	assert (_compiled);
+
+	for (TaskId id (0); id < taskCount (); ++id) {
+		_pendingDependencies[id].store (
+			static_cast<uint32>(_tasks[id].dependencies.size ()), std::memory_order_relaxed);
+	}
+
+	_frameStart = Clock::now ();
+	for (TaskId root : _roots) {
+		_jobSystem.run ([this, root] { runTask (root); }, &_counter);
+	}
+	_jobSystem.wait (_counter);
+
+	_frameMilliseconds = std::chrono::duration<double, std::milli> (Clock::now () - _frameStart).count ();
+	findCriticalPath ();
+}
+
+//---------------------------------------------------------------------------------------
+uint32 TaskGraph::taskCount () const
+{
+	return static_cast<uint32>(_tasks.size ());
+}
+
+//---------------------------------------------------------------------------------------
+const char * TaskGraph::taskName (
+	TaskId task
+) const {
+	return _tasks[task].name;
+}
+
+//---------------------------------------------------------------------------------------
+const TaskTiming & TaskGraph::taskTiming (
+	TaskId task
+) const {
+	return _timings[task];
+}
+
+//---------------------------------------------------------------------------------------
+const std::vector<TaskId> & TaskGraph::criticalPath () const
+{
+	return _criticalPath;
+}
+
+//---------------------------------------------------------------------------------------
+double TaskGraph::criticalPathMilliseconds () const
+{
+	return _criticalPathMilliseconds;
+}
+
+//---------------------------------------------------------------------------------------
+double TaskGraph::frameMilliseconds () const
+{
+	return _frameMilliseconds;
+}
+
+//---------------------------------------------------------------------------------------
+std::string TaskGraph::report () const
+{
+	char buffer[128];
+	std::snprintf (buffer, sizeof (buffer), "Critical path %.3f ms of %.3f ms frame:",
+		_criticalPathMilliseconds, _frameMilliseconds);
+	std::string result (buffer);
+
+	for (size_t i (0); i < _criticalPath.size (); ++i) {
+		const TaskTiming & timing = _timings[_criticalPath[i]];
+		std::snprintf (buffer, sizeof (buffer), "%s %s %.3f", i == 0 ? "" : " >",
+			_tasks[_criticalPath[i]].name, timing.end - timing.start);
+		result += buffer;
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------------------
+void TaskGraph::runTask (
+	TaskId id
+) {
+	Task & task = _tasks[id];
+
+	_timings[id].start = std::chrono::duration<double, std::milli> (Clock::now () - _frameStart).count ();
+	{
+		PROFILE_ZONE (task.name);
+		task.function ();
+	}
+	_timings[id].end = std::chrono::duration<double, std::milli> (Clock::now () - _frameStart).count ();
+
+	// The last dependency to complete starts the dependent.  Acquire and release so the
+	// dependent observes the results of every one of its dependencies.
+	for (TaskId dependent : task.dependents) {
+		if (_pendingDependencies[dependent].fetch_sub (1, std::memory_order_acq_rel) == 1) {
+			_jobSystem.run ([this, dependent] { runTask (dependent); }, &_counter);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void TaskGraph::findCriticalPath ()
+{
+	_criticalPath.clear ();
+	_criticalPathMilliseconds = 0.0;
+
+	const uint32 count = taskCount ();
+	if (count == 0) {
+		return;
+	}
+
+	// Tasks are stored in dependency order, so a single forward pass finds the longest
+	// chain of durations ending at each task.
+	std::vector<double> pathLength (count);
+	std::vector<TaskId> previous (count);
+	TaskId last = 0;
+	for (TaskId id (0); id < count; ++id) {
+		double longest = 0.0;
+		previous[id] = id;
+		for (TaskId dependency : _tasks[id].dependencies) {
+			if (pathLength[dependency] > longest || previous[id] == id) {
+				longest = pathLength[dependency];
+				previous[id] = dependency;
+			}
+		}
+
+		pathLength[id] = longest + (_timings[id].end - _timings[id].start);
+		if (pathLength[id] > pathLength[last]) {
+			last = id;
+		}
+	}
+
+	for (TaskId id (last); ; id = previous[id]) {
+		_criticalPath.push_back (id);
+		if (previous[id] == id) {
+			break;
+		}
+	}
+	std::reverse (_criticalPath.begin (), _criticalPath.end ());
+	_criticalPathMilliseconds = pathLength[last];
+}
@@ -0,0 +1,125 @@
+//
+// TaskGraph.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/JobSystem.hpp"
+
+typedef uint32 TaskId;
+
+
+/// Start and end of a task's execution, in milliseconds since the start of the frame.
+struct TaskTiming {
+	double start;
+	double end;
+};
+
+
+/// A frame's work declared as named tasks with explicit dependencies, executed on a
+/// JobSystem.
+///
+/// Tasks are added in an order where every dependency precedes its dependents, so the
+/// graph is acyclic by construction.  Once compile() has been called the graph is fixed,
+/// and each call to execute() runs every task once, starting each as soon as its
+/// dependencies have completed.  Tasks without a dependency between them may run
+/// concurrently.
+///
+/// Each execution records when every task started and ended, from which the critical
+/// path is found: the chain of dependent tasks with the longest total duration, which
+/// bounds the frame time however many threads are available.
+class TaskGraph {
+public:
+	typedef std::function<void ()> TaskFunction;
+
+	explicit TaskGraph (
+		JobSystem & jobSystem
+	);
+
+	/// Adds a task that runs function once all dependencies have completed.
+	/// @param name - must outlive the graph.
+	/// @param dependencies - tasks previously added to this graph.
+	TaskId addTask (
+		const char * name,
+		TaskFunction function,
+		std::initializer_list<TaskId> dependencies = {}
+	);
+
+	/// Prepares the graph for execution.  No tasks may be added afterwards.
+	void compile ();
+
+	/// Runs every task, returning once all have completed.  Must be called from the
+	/// thread that constructed the JobSystem, or from within a job.
+	void execute ();
+
+	uint32 taskCount () const;
+
+	const char * taskName (
+		TaskId task
+	) const;
+
+	/// Timing of task during the last execute().
+	const TaskTiming & taskTiming (
+		TaskId task
+	) const;
+
+	/// Tasks on the critical path of the last execute(), in dependency order.
+	const std::vector<TaskId> & criticalPath () const;
+
+	/// Sum of the durations of tasks on the critical path, in milliseconds.
+	double criticalPathMilliseconds () const;
+
+	/// Duration of the last execute(), in milliseconds.
+	double frameMilliseconds () const;
+
+	/// Single line summary of the last execute(), listing each task on the critical path
+	/// with its duration.
+	std::string report () const;
+
+
+	/// Forbid copying of TaskGraph objects.
+	TaskGraph (const TaskGraph & other) = delete;
+	TaskGraph & operator = (const TaskGraph & other) = delete;
+
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct Task {
+		const char * name;
+		TaskFunction function;
+		std::vector<TaskId> dependencies;
+		std::vector<TaskId> dependents;
+	};
+
+	void runTask (
+		TaskId task
+	);
+
+	void findCriticalPath ();
+
+	JobSystem & _jobSystem;
+	std::vector<Task> _tasks;
+	bool _compiled;
+
+	// Tasks without dependencies, which start each execution.
+	std::vector<TaskId> _roots;
+
+	// Dependencies of each task yet to complete during the current execution.
+	std::unique_ptr<std::atomic<uint32>[]> _pendingDependencies;
+	JobCounter _counter;
+
+	Clock::time_point _frameStart;
+	double _frameMilliseconds;
+	std::vector<TaskTiming> _timings;
+
+	std::vector<TaskId> _criticalPath;
+	double _criticalPathMilliseconds;
+};
@@ -0,0 +1,94 @@
+//
+// WorkStealingQueue.cpp
+//
+#include "pch.h"
+
+#include "Core/WorkStealingQueue.hpp"
+
+
+//---------------------------------------------------------------------------------------
+WorkStealingQueue::WorkStealingQueue (
+	uint32 capacity
+)
+	: _top (0),
+	  _bottom (0),
+	  _jobs (new std::atomic<Job *>[capacity]),
+	  _mask (capacity - 1)
+{
+	assert (capacity > 0 && (capacity & (capacity - 1)) == 0);
+}
+
+//---------------------------------------------------------------------------------------
+void WorkStealingQueue::push (
+	Job * job
+) {
+	const int64 bottom = _bottom.load (std::memory_order_relaxed);
+	const int64 top = _top.load (std::memory_order_acquire);
+
+	// Assert queue is not full.
+	assert (bottom - top <= _mask);
+
+	_jobs[bottom & _mask].store (job, std::memory_order_relaxed);
+
+	// Release so that thieves observing the new bottom also observe the job.
+	_bottom.store (bottom + 1, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+Job * WorkStealingQueue::pop ()
+{
+	// Reserve the bottom job before checking whether a thief has taken it.
+	const int64 bottom = _bottom.load (std::memory_order_relaxed) - 1;
+	_bottom.store (bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_seq_cst);
+	int64 top = _top.load (std::memory_order_relaxed);
+
+	if (top > bottom) {
+		// Queue was empty.
+		_bottom.store (bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job * job = _jobs[bottom & _mask].load (std::memory_order_relaxed);
+	if (top == bottom) {
+		// Last job in the queue, so race thieves for it.
+		if (!_top.compare_exchange_strong (top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		_bottom.store (bottom + 1, std::memory_order_relaxed);
+	}
+
+	return job;
+}
+
+//---------------------------------------------------------------------------------------
+Job * WorkStealingQueue::steal ()
+{
+	int64 top = _top.load (std::memory_order_acquire);
+	std::atomic_thread_fence (std::memory_order_seq_cst);
+	const int64 bottom = _bottom.load (std::memory_order_acquire);
+
+	if (top >= bottom) {
+		return nullptr;
+	}
+
+	Job * job = _jobs[top & _mask].load (std::memory_order_relaxed);
+	if (!_top.compare_exchange_strong (top, top + 1,
+		std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		// Lost the race to the owner or another thief.
+		return nullptr;
+	}
+
+	return job;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 WorkStealingQueue::size () const
+{
+	const int64 bottom = _bottom.load (std::memory_order_relaxed);
+	const int64 top = _top.load (std::memory_order_relaxed);
+	return bottom > top ? static_cast<uint32>(bottom - top) : 0;
+}
@@ -0,0 +1,55 @@
+//
+// WorkStealingQueue.hpp
+//
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "Core/Types.hpp"
+
+struct Job;
+
+
+/// Fixed capacity Chase-Lev work-stealing deque of jobs.
+///
+/// The owning thread pushes and pops jobs at the bottom in LIFO order, while any other
+/// thread may steal from the top in FIFO order.  All operations are lock-free.  Based on
+/// "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., 2013).
+class WorkStealingQueue {
+public:
+	/// capacity must be a power of two.
+	explicit WorkStealingQueue (
+		uint32 capacity
+	);
+
+	/// Adds job to the bottom of the queue.  Only called by the owning thread.
+	void push (
+		Job * job
+	);
+
+	/// Removes the most recently pushed job, or returns nullptr if the queue is empty.
+	/// Only called by the owning thread.
+	Job * pop ();
+
+	/// Removes the least recently pushed job, or returns nullptr if the queue is empty
+	/// or another thread won the race for it.  May be called by any thread.
+	Job * steal ();
+
+	/// Approximate number of queued jobs.
+	uint32 size () const;
+
+
+	/// Forbid copying of WorkStealingQueue objects.
+	WorkStealingQueue (const WorkStealingQueue & other) = delete;
+	WorkStealingQueue & operator = (const WorkStealingQueue & other) = delete;
+
+private:
+	// Top and bottom are written by different threads, so are kept on separate cache
+	// lines.
+	alignas(64) std::atomic<int64> _top;
+	alignas(64) std::atomic<int64> _bottom;
+
+	alignas(64) std::unique_ptr<std::atomic<Job *>[]> _jobs;
+	const int64 _mask;
+};
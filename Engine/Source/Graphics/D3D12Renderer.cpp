@@ -7,6 +7,7 @@
 #include <dxgi1_4.h>
 #include <d3dcompiler.h>
 #include <string>
+#include <cstddef>
 #include <cstring>
 
 #include "Core/AssetLoader.hpp"
@@ -16,6 +17,9 @@
 
 namespace
 {
+	constexpr AssetId VERTEX_SHADER ("VertexShader");
+	constexpr AssetId PIXEL_SHADER ("PixelShader");
+
 	void waitForGpuFence (
 		ID3D12Fence * fence,
 		uint64 completionValue,
@@ -70,7 +74,7 @@ void D3D12Renderer::initialize (
 	// Enable the D3D12 debug layer.
 	ComPtr<ID3D12Debug> debugController;
 	if ( SUCCEEDED (D3D12GetDebugInterface (IID_PPV_ARGS (&debugController))) ) {
-		LOG_INFO ("D3D12 Debug Layer Enabled.");
+		LOG_CATEGORY_INFO (Render, "D3D12 Debug Layer Enabled.");
 		debugController->EnableDebugLayer ();
 	}
 #endif
@@ -101,26 +105,14 @@ void D3D12Renderer::initialize (
 
 	createDrawCommandLists ();
 
-	ComPtr<ID3D12CommandAllocator> cmdAllocator;
-	ComPtr<ID3D12GraphicsCommandList> uploadCmdList;
-	createCommandList (uploadCmdList, cmdAllocator);
-
-	// Temporary resource buffer to aid in uploading data to default heap.
-	// Resource will be released at end of scope.
-	ComPtr<ID3D12Resource> uploadBuffer;
-
-	loadAssets (uploadCmdList.Get (), uploadBuffer);
-
-	// Close upload command list and execute it on the direct command queue. 
-	{
-		CHECK_D3D_RESULT (
-			uploadCmdList->Close ()
-		);
-		ID3D12CommandList * commandLists[] = {uploadCmdList.Get ()};
-		m_directCmdQueue->ExecuteCommandLists (_countof (commandLists), commandLists);
+	loadAssets ();
+}
 
-		waitForGpuCompletion (m_directCmdQueue.Get ());
-	}
+//---------------------------------------------------------------------------------------
+void D3D12Renderer::submit (
+	const DrawCall & drawCall
+) {
+	m_drawCalls.push_back (drawCall);
 }
 
 //---------------------------------------------------------------------------------------
@@ -140,6 +132,12 @@ void D3D12Renderer::render ()
 		WaitForSingleObject (m_frameLatencyWaitableObject, INFINITE);
 	}
 
+	// The GPU has finished every frame that could use a pipeline state retired while
+	// this one was last built.
+	m_retiredPipelineState[m_frameIndex].Reset ();
+	m_retiredMeshBuffers[m_frameIndex].clear ();
+	reloadPipelineState ();
+
 	// Acquire commandList and command allocator for current frame.
 	auto drawCmdList = m_drawCmdList[m_frameIndex].Get ();
 	auto commandAllocator = m_directCmdAllocator[m_frameIndex].Get ();
@@ -149,6 +147,9 @@ void D3D12Renderer::render ()
 	recordDrawingCommands (drawCmdList);
 
 	finalizeRender (drawCmdList, m_directCmdQueue.Get ());
+
+	// Draw calls only live for the frame they were submitted in.
+	m_drawCalls.clear ();
 }
 
 //---------------------------------------------------------------------------------------
@@ -240,10 +241,97 @@ void D3D12Renderer::recordDrawingCommands (
 	drawCmdList->SetGraphicsRootSignature (m_rootSignature.Get ());
 
 	drawCmdList->IASetPrimitiveTopology (D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	drawCmdList->IASetVertexBuffers (0, 1, &m_vertexBufferView);
-	drawCmdList->IASetIndexBuffer (&m_indexBufferView);
 
-	drawCmdList->DrawIndexedInstanced (m_indexCount, 1, 0, 0, 0);
+	// Draw calls arrive in the order they were sorted, so consecutive draws often share
+	// a mesh.
+	const MeshComponent * boundMesh = nullptr;
+	for (const DrawCall & drawCall : m_drawCalls) {
+		assert (drawCall.mesh);
+
+		if (drawCall.mesh != boundMesh) {
+			const MeshBuffer * buffer = meshBuffer (*drawCall.mesh);
+			if (!buffer) {
+				continue;
+			}
+
+			drawCmdList->IASetVertexBuffers (0, 1, &buffer->vertexBufferView);
+			drawCmdList->IASetIndexBuffer (&buffer->indexBufferView);
+			boundMesh = drawCall.mesh;
+		}
+
+		drawCmdList->DrawIndexedInstanced (drawCall.mesh->numIndices,
+			drawCall.instanceCount, 0, 0, drawCall.firstInstance);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+const D3D12Renderer::MeshBuffer * D3D12Renderer::meshBuffer (
+	const MeshComponent & mesh
+) {
+	auto found = m_meshBuffers.find (&mesh);
+	if (found != m_meshBuffers.end ()) {
+		const MeshBuffer & buffer = found->second;
+		if (buffer.vertices == mesh.vertices && buffer.indices == mesh.indices &&
+			buffer.numVertices == mesh.numVertices && buffer.numIndices == mesh.numIndices)
+		{
+			return &buffer;
+		}
+
+		// Reloaded in place.  Frames still in flight may read the copy before.
+		m_retiredMeshBuffers[m_frameIndex].push_back (buffer.resource);
+		m_meshBuffers.erase (found);
+	}
+
+	const uint64 vertexBytes = uint64 (mesh.numVertices) * sizeof (Vertex);
+	const uint64 indexBytes = uint64 (mesh.numIndices) * sizeof (Index);
+	if (indexBytes == 0) {
+		return nullptr;
+	}
+
+	// Meshes are static, so the GPU reads them from the upload heap rather than from a
+	// copy in the default heap.
+	MeshBuffer buffer;
+	const auto uploadHeapProperties = CD3DX12_HEAP_PROPERTIES (D3D12_HEAP_TYPE_UPLOAD);
+	const auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer (vertexBytes + indexBytes);
+	const HRESULT result = m_device->CreateCommittedResource (
+		&uploadHeapProperties,
+		D3D12_HEAP_FLAG_NONE,
+		&bufferDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS (&buffer.resource)
+	);
+	if (FAILED (result)) {
+		LOG_CATEGORY_ERROR (Render, "Unable to create a buffer for a mesh of %u vertices",
+			mesh.numVertices);
+		return nullptr;
+	}
+	SET_D3D_DEBUG_NAME (buffer.resource);
+
+	// Set read range to zero, since data is only written to the buffer.
+	void * p;
+	D3D12_RANGE readRange = {0, 0};
+	CHECK_D3D_RESULT (
+		buffer.resource->Map (0, &readRange, &p)
+	);
+	::memcpy (p, mesh.vertices, vertexBytes);
+	::memcpy (static_cast<byte *>(p) + vertexBytes, mesh.indices, indexBytes);
+	buffer.resource->Unmap (0, nullptr);
+
+	buffer.vertexBufferView.BufferLocation = buffer.resource->GetGPUVirtualAddress ();
+	buffer.vertexBufferView.SizeInBytes = static_cast<UINT>(vertexBytes);
+	buffer.vertexBufferView.StrideInBytes = sizeof (Vertex);
+
+	buffer.indexBufferView.BufferLocation =
+		buffer.vertexBufferView.BufferLocation + vertexBytes;
+	buffer.indexBufferView.SizeInBytes = static_cast<UINT>(indexBytes);
+	buffer.indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+
+	buffer.vertices = mesh.vertices;
+	buffer.indices = mesh.indices;
+	buffer.numVertices = mesh.numVertices;
+	buffer.numIndices = mesh.numIndices;
+	return &m_meshBuffers.emplace (&mesh, buffer).first->second;
 }
 
 //---------------------------------------------------------------------------------------
@@ -399,7 +487,7 @@ void D3D12Renderer::createHardwareDevice (
 	// Display hardware adapter name.
 	DXGI_ADAPTER_DESC1 adapterDesc = {};
 	hardwareAdapter->GetDesc1 (&adapterDesc);
-	LOG_INFO ("Adapter: %ls", adapterDesc.Description);
+	LOG_CATEGORY_INFO (Render, "Adapter: %ls", adapterDesc.Description);
 }
 
 //---------------------------------------------------------------------------------------
@@ -603,26 +691,31 @@ void D3D12Renderer::createCommandList (
 //---------------------------------------------------------------------------------------
 #include "Core/AssetLoader.hpp"
 
-void D3D12Renderer::loadAssets (
-	ID3D12GraphicsCommandList * uploadCmdList,
-	ComPtr<ID3D12Resource> & uploadBuffer
-) {
+void D3D12Renderer::loadAssets ()
+{
 	// Create an empty root signature.
 	createRootSignature ();
 
 	// Load shader bytecode.
-	AssetLoader::load ("VertexShader.cso", &m_shaderGroup.vertexShader);
-	AssetLoader::load ("PixelShader.cso", &m_shaderGroup.pixelShader);
-
-
-	createPipelineState (m_shaderGroup);
+	m_shaderGroup.vertexShader = AssetLoader::load<CompiledShader> (VERTEX_SHADER);
+	m_shaderGroup.pixelShader = AssetLoader::load<CompiledShader> (PIXEL_SHADER);
+	AssetLoader::wait (m_shaderGroup.vertexShader);
+	AssetLoader::wait (m_shaderGroup.pixelShader);
+	if (!m_shaderGroup.vertexShader.isReady () || !m_shaderGroup.pixelShader.isReady ()) {
+		ForceBreak ("Unable to load shaders");
+	}
 
-	uploadVertexDataToDefaultHeap (uploadCmdList, uploadBuffer);
+	m_vertexShaderVersion = m_shaderGroup.vertexShader.version ();
+	m_pixelShaderVersion = m_shaderGroup.pixelShader.version ();
+	CHECK_D3D_RESULT (
+		createPipelineState (m_shaderGroup, m_pipelineState)
+	);
 }
 
 //---------------------------------------------------------------------------------------
-void D3D12Renderer::createPipelineState (
-	const ShaderGroup & shaderGroup
+HRESULT D3D12Renderer::createPipelineState (
+	const ShaderGroup & shaderGroup,
+	ComPtr<ID3D12PipelineState> & pipelineState
 ) {
 	// Define the vertex input layout.
 	D3D12_INPUT_ELEMENT_DESC inputElementDescriptor[2];
@@ -632,16 +725,16 @@ void D3D12Renderer::createPipelineState (
 	inputElementDescriptor[0].SemanticIndex = 0;
 	inputElementDescriptor[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
 	inputElementDescriptor[0].InputSlot = 0;
-	inputElementDescriptor[0].AlignedByteOffset = 0;
+	inputElementDescriptor[0].AlignedByteOffset = offsetof (Vertex, position);
 	inputElementDescriptor[0].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
 	inputElementDescriptor[0].InstanceDataStepRate = 0;
 
-	// Colors
+	// Colors, shaded by each Vertex's normal.
 	inputElementDescriptor[1].SemanticName = "COLOR";
 	inputElementDescriptor[1].SemanticIndex = 0;
 	inputElementDescriptor[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
 	inputElementDescriptor[1].InputSlot = 0;
-	inputElementDescriptor[1].AlignedByteOffset = sizeof (float) * 3;
+	inputElementDescriptor[1].AlignedByteOffset = offsetof (Vertex, normal);
 	inputElementDescriptor[1].InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
 	inputElementDescriptor[1].InstanceDataStepRate = 0;
 
@@ -674,135 +767,40 @@ void D3D12Renderer::createPipelineState (
 	psoDesc.SampleDesc.Count = 1;
 
 	// Create the Pipeline State Object.
-	CHECK_D3D_RESULT (
-		m_device->CreateGraphicsPipelineState ( &psoDesc, IID_PPV_ARGS (&m_pipelineState))
-	);
-	SET_D3D_DEBUG_NAME (m_pipelineState);
+	ComPtr<ID3D12PipelineState> created;
+	const HRESULT result =
+		m_device->CreateGraphicsPipelineState (&psoDesc, IID_PPV_ARGS (&created));
+	if (SUCCEEDED (result)) {
+		pipelineState = created;
+		SET_D3D_DEBUG_NAME (pipelineState);
+	}
+	return result;
 }
 
 //---------------------------------------------------------------------------------------
-void D3D12Renderer::uploadVertexDataToDefaultHeap (
-	ID3D12GraphicsCommandList * uploadCmdList,
-	ComPtr<ID3D12Resource> & uploadBuffer
-) {
-	const float aspectRatio = static_cast<float>(m_framebufferWidth) / m_framebufferHeight;
-
-	// Define vertices for a square.
-	const Vertex vertices[] =
-	{
-		// Positions                          Colors
-		{{0.25f, 0.25f * aspectRatio, 0.0f}, {1.0f, 0.0f, 0.0f, 1.0f}},
-		{{0.25f, -0.25f * aspectRatio, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}},
-		{{-0.25f, -0.25f * aspectRatio, 0.0f}, {0.0f, 0.0f, 1.0f, 1.0f}},
-		{{-0.25f, 0.25f * aspectRatio, 0.0f}, {1.0f, 0.0f, 1.0f, 1.0f}}
-	};
-
-	const ushort indices[] = {2,1,0, 2,0,3};
-	m_indexCount = _countof (indices);
-
-	const int uploadBufferSize = sizeof (vertices) + sizeof (indices);
-	const auto uploadHeapProperties = CD3DX12_HEAP_PROPERTIES (D3D12_HEAP_TYPE_UPLOAD);
-	const auto uploadBufferDesc = CD3DX12_RESOURCE_DESC::Buffer (uploadBufferSize);
-
-	// Create upload buffer.
-	m_device->CreateCommittedResource (
-		&uploadHeapProperties,
-		D3D12_HEAP_FLAG_NONE,
-		&uploadBufferDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS (&uploadBuffer)
-	);
-
-	// Allocate vertex and index buffers within the default heap
-	{
-		const auto defaultHeapProperties = CD3DX12_HEAP_PROPERTIES (D3D12_HEAP_TYPE_DEFAULT);
-
-		const auto vertexBufferDesc = CD3DX12_RESOURCE_DESC::Buffer (sizeof (vertices));
-		m_device->CreateCommittedResource (
-			&defaultHeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&vertexBufferDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS (&m_vertexBuffer)
-		);
-		SET_D3D_DEBUG_NAME (m_vertexBuffer);
-
-		const auto indexBufferDesc = CD3DX12_RESOURCE_DESC::Buffer (sizeof (indices));
-		m_device->CreateCommittedResource (
-			&defaultHeapProperties,
-			D3D12_HEAP_FLAG_NONE,
-			&indexBufferDesc,
-			D3D12_RESOURCE_STATE_COPY_DEST,
-			nullptr,
-			IID_PPV_ARGS (&m_indexBuffer)
-		);
-		SET_D3D_DEBUG_NAME (m_indexBuffer);
-	}
-
-	// Create buffer views
-	m_vertexBufferView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress ();
-	m_vertexBufferView.SizeInBytes = sizeof (vertices);
-	m_vertexBufferView.StrideInBytes = sizeof (Vertex);
-
-	m_indexBufferView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress ();
-	m_indexBufferView.SizeInBytes = sizeof (indices);
-	m_indexBufferView.Format = DXGI_FORMAT_R16_UINT;
-
-	// Copy data in CPU memory to upload buffer.
-	{
-		void * p;
-		// Set read range to zero, since we are only going to upload data to upload buffer
-		// rather than read data from it.
-		D3D12_RANGE readRange = {0, 0};
-		uploadBuffer->Map (0, &readRange, &p);
-		::memcpy (p, vertices, sizeof (vertices));
-		::memcpy (static_cast<byte *>(p) + sizeof (vertices), indices, sizeof (indices));
-
-		// Finished uploading data to uploadBuffer, so unmap it.
-		D3D12_RANGE writtenRange = {0, sizeof (vertices) + sizeof (indices)};
-		uploadBuffer->Unmap (0, &writtenRange);
-	}
-
-	// Copy data from upload buffer on CPU into the index/vertex buffer on 
-	// the GPU.
+void D3D12Renderer::reloadPipelineState ()
+{
+	// Shaders are only reloaded between frames, once the render thread has been flushed.
+	const uint32 vertexShaderVersion = m_shaderGroup.vertexShader.version ();
+	const uint32 pixelShaderVersion = m_shaderGroup.pixelShader.version ();
+	if (vertexShaderVersion == m_vertexShaderVersion &&
+		pixelShaderVersion == m_pixelShaderVersion)
 	{
-		uint64 dstOffset = 0;
-		uint64 srcOffset = 0;
-		uploadCmdList->CopyBufferRegion (
-			m_vertexBuffer.Get (), dstOffset, uploadBuffer.Get (), srcOffset, sizeof (vertices)
-		);
-
-		dstOffset = 0;
-		srcOffset = sizeof (vertices);
-		uploadCmdList->CopyBufferRegion (
-			m_indexBuffer.Get (), dstOffset, uploadBuffer.Get (), srcOffset, sizeof (indices)
-		);
+		return;
 	}
-
-	// Batch resource barriers marking state transitions.
-	{
-		const CD3DX12_RESOURCE_BARRIER barriers[2] = {
-
-			CD3DX12_RESOURCE_BARRIER::Transition (
-				m_vertexBuffer.Get (),
-				D3D12_RESOURCE_STATE_COPY_DEST,
-				D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER
-			),
-
-			CD3DX12_RESOURCE_BARRIER::Transition (
-				m_indexBuffer.Get (),
-				D3D12_RESOURCE_STATE_COPY_DEST,
-				D3D12_RESOURCE_STATE_INDEX_BUFFER
-			)
-		};
-
-		uploadCmdList->ResourceBarrier (2, barriers);
+	m_vertexShaderVersion = vertexShaderVersion;
+	m_pixelShaderVersion = pixelShaderVersion;
+
+	// Frames still in flight refer to the pipeline state being replaced.
+	ComPtr<ID3D12PipelineState> previous = m_pipelineState;
+	if (FAILED (createPipelineState (m_shaderGroup, m_pipelineState))) {
+		LOG_CATEGORY_ERROR (Render, "Unable to create a pipeline state from the reloaded "
+			"shaders, keeping the previous one");
+		return;
 	}
+	m_retiredPipelineState[m_frameIndex] = previous;
 }
 
-
 //---------------------------------------------------------------------------------------
 void D3D12Renderer::createRootSignature ()
 {
@@ -836,18 +834,3 @@ void D3D12Renderer::createRootSignature ()
 	);
 }
 
-//---------------------------------------------------------------------------------------
-void D3D12Renderer::waitForGpuCompletion (
-	ID3D12CommandQueue * commandQueue
-)
-{
-	CHECK_D3D_RESULT (
-		commandQueue->Signal (m_frameFence[m_frameIndex].Get (), m_currentFenceValue)
-	);
-	m_fenceValue[m_frameIndex] = m_currentFenceValue;
-	++m_currentFenceValue;
-
-	::waitForGpuFence (m_frameFence[m_frameIndex].Get (),
-		m_fenceValue[m_frameIndex], m_frameFenceEvent[m_frameIndex]);
-}
-
@@ -7,8 +7,11 @@
 #include <d3d12.h>
 #include <dxgi1_4.h>
 #include <DirectXMath.h>
+#include <unordered_map>
+#include <vector>
 
 #include "Core/Types.hpp"
+#include "Graphics/DrawCall.hpp"
 #include "Graphics/IRenderer.hpp"
 #include "Graphics/ShaderUtils.hpp"
 
@@ -22,6 +25,10 @@ public:
 		HWND hWindow
 	) override;
 
+	void submit (
+		const DrawCall & drawCall
+	) override;
+
 	void render () override;
 
 	void present () override;
@@ -33,8 +40,7 @@ private:
 
 	bool m_vsyncEnabled = true;
 
-	// Number of rendered frames to pre-flight for execution on the GPU.
-	static const uint NUM_BUFFERED_FRAMES = 3;
+	// Index within [0, NUM_BUFFERED_FRAMES) of the frame being rendered.
 	uint m_frameIndex;
 
 	uint m_framebufferWidth;
@@ -51,19 +57,34 @@ private:
 	ComPtr<IDXGISwapChain3> m_swapChain;
 	HANDLE m_frameLatencyWaitableObject;
 
-	// Vertex data
-	struct Vertex {
-		DirectX::XMFLOAT3 position;
-		DirectX::XMFLOAT4 color;
+	// Vertices and indices of a mesh drawn, copied to a buffer in the upload heap that
+	// the GPU reads them from.
+	struct MeshBuffer {
+		ComPtr<ID3D12Resource> resource;
+		D3D12_VERTEX_BUFFER_VIEW vertexBufferView;
+		D3D12_INDEX_BUFFER_VIEW indexBufferView;
+
+		// Data copied, so that a mesh reloaded in place is copied again.
+		const Vertex * vertices;
+		const Index * indices;
+		uint32 numVertices;
+		uint32 numIndices;
 	};
-	ComPtr<ID3D12Resource> m_vertexBuffer;
-	ComPtr<ID3D12Resource> m_indexBuffer;
-	ushort m_indexCount;
-	D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
-	D3D12_INDEX_BUFFER_VIEW m_indexBufferView;
+	std::unordered_map<const MeshComponent *, MeshBuffer> m_meshBuffers;
+
+	// Mesh buffers replaced while building each frame, released once the GPU has
+	// finished it, along with the frames before it that may still use them.
+	std::vector<ComPtr<ID3D12Resource>> m_retiredMeshBuffers[NUM_BUFFERED_FRAMES];
 
 	ShaderGroup m_shaderGroup;
 
+	// Versions of the shaders m_pipelineState was created from.
+	uint32 m_vertexShaderVersion;
+	uint32 m_pixelShaderVersion;
+
+	// Draw calls queued by submit() for the frame currently being built.
+	std::vector<DrawCall> m_drawCalls;
+
 
 	// Resources that are referenced by descriptor handles (a.k.a. resource views).
 	struct HandledResource {
@@ -96,6 +117,10 @@ private:
 	ComPtr<ID3D12RootSignature> m_rootSignature;
 	ComPtr<ID3D12PipelineState> m_pipelineState;
 
+	// Pipeline states replaced while building each frame, released once the GPU has
+	// finished it, along with the frames before it that may still use them.
+	ComPtr<ID3D12PipelineState> m_retiredPipelineState[NUM_BUFFERED_FRAMES];
+
 	void createDeviceAndSwapChain (
 		HWND hWindow,
 		uint framebufferWidth,
@@ -128,8 +153,11 @@ private:
 		ComPtr<ID3D12CommandAllocator> & cmdAllocator
 	);
 
-	void createPipelineState (
-		const ShaderGroup & shaderGroup
+	/// Creates pipelineState from the shaders of shaderGroup, leaving it as it was if
+	/// that fails.
+	HRESULT createPipelineState (
+		const ShaderGroup & shaderGroup,
+		ComPtr<ID3D12PipelineState> & pipelineState
 	);
 
 	void createRootSignature ();
@@ -142,9 +170,12 @@ private:
 	void initViewportAndScissorRect ();
 
 
-	void loadAssets (
-		ID3D12GraphicsCommandList * uploadCmdList,
-		ComPtr<ID3D12Resource> & uploadBuffer
+	void loadAssets ();
+
+	/// Returns the buffer holding mesh, copying it there first if it has not been
+	/// drawn or has changed since, or nullptr if the buffer could not be created.
+	const MeshBuffer * meshBuffer (
+		const MeshComponent & mesh
 	);
 
 	void prepareRender (
@@ -158,17 +189,11 @@ private:
 		ID3D12GraphicsCommandList * drawCmdList
 	);
 
-	bool swapChainWaitableObjectIsSignaled ();
-
-	void uploadVertexDataToDefaultHeap (
-		ID3D12GraphicsCommandList * uploadCmdList,
-		ComPtr<ID3D12Resource> & uploadBuffer
-	);
+	/// Recreates the pipeline state if either shader has been reloaded since it was
+	/// created.
+	void reloadPipelineState ();
 
-	/// Blocks current thread until GPU signals fence on command queue.
-	void D3D12Renderer::waitForGpuCompletion (
-		ID3D12CommandQueue * commandQueue
-	);
+	bool swapChainWaitableObjectIsSignaled ();
 
 };
 	
@@ -0,0 +1,31 @@
+//
+// DrawCall.hpp
+//
+#pragma once
+
+#include "Core/Types.hpp"
+#include "Graphics/RenderComponent.hpp"
+
+/// Per-instance data consumed by instanced draw calls.
+struct InstanceData {
+	/// Affine model-to-world transform, with an implied (0, 0, 0, 1) fourth column.
+	float world[4][3];
+};
+
+/// A request to draw one or more instances of a mesh using a material.
+///
+/// DrawCalls only reference the data they draw, so the mesh, material and instance data
+/// must all outlive the frame in which the DrawCall was submitted.
+struct DrawCall {
+	const MeshComponent * mesh = nullptr;
+	const Material * material = nullptr;
+
+	uint32 instanceCount = 1;
+
+	/// Offset of this draw's instances within the frame's instance buffer.
+	uint32 firstInstance = 0;
+
+	/// instanceCount entries of per-instance data, or nullptr to draw every instance
+	/// with an identity world transform.
+	const InstanceData * instances = nullptr;
+};
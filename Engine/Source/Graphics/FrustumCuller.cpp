@@ -0,0 +1,297 @@
+//
+// FrustumCuller.cpp
+//
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER) || defined(__AVX2__)
+	#include <immintrin.h>
+	#define FRUSTUM_CULLER_AVX2
+#endif
+
+#include "Core/CpuFeatures.hpp"
+#include "Core/ParallelFor.hpp"
+#include "Graphics/FrustumCuller.hpp"
+
+namespace
+{
+	const uint32 SIMD_WIDTH = 8;
+
+	// Culls spheres [begin, end) one at a time, writing visible indices to out.
+	uint32 cullRangeScalar (
+		const Frustum & frustum,
+		const BoundingSpheres & spheres,
+		uint32 begin,
+		uint32 end,
+		uint32 * out
+	) {
+		const float * centerX = spheres.centerX ();
+		const float * centerY = spheres.centerY ();
+		const float * centerZ = spheres.centerZ ();
+		const float * radius = spheres.radius ();
+
+		uint32 count = 0;
+		for (uint32 i (begin); i < end; ++i) {
+			bool visible = true;
+			for (uint p (0); p < Frustum::NUM_PLANES; ++p) {
+				const float * plane = frustum.planes[p];
+				const float distance =
+					plane[0] * centerX[i] + plane[1] * centerY[i] + plane[2] * centerZ[i] + plane[3];
+				if (distance < -radius[i]) {
+					visible = false;
+					break;
+				}
+			}
+			if (visible) {
+				out[count++] = i;
+			}
+		}
+		return count;
+	}
+
+#if defined(FRUSTUM_CULLER_AVX2)
+	// Culls spheres [begin, end) 8 at a time, writing visible indices to out.  Evaluates
+	// plane distances in the same order as cullRangeScalar() so both agree exactly.
+	uint32 cullRangeAvx2 (
+		const Frustum & frustum,
+		const BoundingSpheres & spheres,
+		uint32 begin,
+		uint32 end,
+		uint32 * out
+	) {
+		const float * centerX = spheres.centerX ();
+		const float * centerY = spheres.centerY ();
+		const float * centerZ = spheres.centerZ ();
+		const float * radius = spheres.radius ();
+
+		__m256 planeA[Frustum::NUM_PLANES];
+		__m256 planeB[Frustum::NUM_PLANES];
+		__m256 planeC[Frustum::NUM_PLANES];
+		__m256 planeD[Frustum::NUM_PLANES];
+		for (uint p (0); p < Frustum::NUM_PLANES; ++p) {
+			planeA[p] = _mm256_set1_ps (frustum.planes[p][0]);
+			planeB[p] = _mm256_set1_ps (frustum.planes[p][1]);
+			planeC[p] = _mm256_set1_ps (frustum.planes[p][2]);
+			planeD[p] = _mm256_set1_ps (frustum.planes[p][3]);
+		}
+		const __m256 signBit = _mm256_set1_ps (-0.0f);
+
+		uint32 count = 0;
+		uint32 i = begin;
+		for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+			const __m256 x = _mm256_loadu_ps (centerX + i);
+			const __m256 y = _mm256_loadu_ps (centerY + i);
+			const __m256 z = _mm256_loadu_ps (centerZ + i);
+			const __m256 negRadius = _mm256_xor_ps (_mm256_loadu_ps (radius + i), signBit);
+
+			__m256 inside = _mm256_castsi256_ps (_mm256_set1_epi32 (-1));
+			for (uint p (0); p < Frustum::NUM_PLANES; ++p) {
+				__m256 distance = _mm256_mul_ps (planeA[p], x);
+				distance = _mm256_add_ps (distance, _mm256_mul_ps (planeB[p], y));
+				distance = _mm256_add_ps (distance, _mm256_mul_ps (planeC[p], z));
+				distance = _mm256_add_ps (distance, planeD[p]);
+				inside = _mm256_and_ps (inside, _mm256_cmp_ps (distance, negRadius, _CMP_NLT_UQ));
+			}
+
+			// Compact indices of visible lanes.
+			uint32 mask = static_cast<uint32>(_mm256_movemask_ps (inside));
+			while (mask) {
+				out[count++] = i + math::countTrailingZeros (mask);
+				mask &= mask - 1;
+			}
+		}
+
+		return count + cullRangeScalar (frustum, spheres, i, end, out + count);
+	}
+#endif
+}
+
+
+//---------------------------------------------------------------------------------------
+Frustum Frustum::FromViewProjection (
+	const Matrix4 & viewProjection
+) {
+	// Points are row vectors, so clip coordinate j is the dot product of (x, y, z, 1)
+	// with column j.  Planes follow from -w <= x <= w, -w <= y <= w and 0 <= z <= w.
+	const Matrix4 & m = viewProjection;
+	auto column = [&] (uint j, float out[4]) {
+		for (uint i (0); i < 4; ++i) {
+			out[i] = m.m[i][j];
+		}
+	};
+
+	float x[4], y[4], z[4], w[4];
+	column (0, x);
+	column (1, y);
+	column (2, z);
+	column (3, w);
+
+	Frustum frustum;
+	for (uint i (0); i < 4; ++i) {
+		frustum.planes[Left][i] = w[i] + x[i];
+		frustum.planes[Right][i] = w[i] - x[i];
+		frustum.planes[Bottom][i] = w[i] + y[i];
+		frustum.planes[Top][i] = w[i] - y[i];
+		frustum.planes[Near][i] = z[i];
+		frustum.planes[Far][i] = w[i] - z[i];
+	}
+
+	// Normalize so plane equations yield signed distances.
+	for (uint p (0); p < NUM_PLANES; ++p) {
+		float * plane = frustum.planes[p];
+		const float length = std::sqrt (plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		for (uint i (0); i < 4; ++i) {
+			plane[i] /= length;
+		}
+	}
+
+	return frustum;
+}
+
+//---------------------------------------------------------------------------------------
+void BoundingSpheres::clear ()
+{
+	m_centerX.clear ();
+	m_centerY.clear ();
+	m_centerZ.clear ();
+	m_radius.clear ();
+}
+
+//---------------------------------------------------------------------------------------
+void BoundingSpheres::reserve (
+	uint32 capacity
+) {
+	m_centerX.reserve (capacity);
+	m_centerY.reserve (capacity);
+	m_centerZ.reserve (capacity);
+	m_radius.reserve (capacity);
+}
+
+//---------------------------------------------------------------------------------------
+uint32 BoundingSpheres::add (
+	float centerX,
+	float centerY,
+	float centerZ,
+	float radius
+) {
+	m_centerX.push_back (centerX);
+	m_centerY.push_back (centerY);
+	m_centerZ.push_back (centerZ);
+	m_radius.push_back (radius);
+	return size () - 1;
+}
+
+//---------------------------------------------------------------------------------------
+void BoundingSpheres::set (
+	uint32 index,
+	float centerX,
+	float centerY,
+	float centerZ,
+	float radius
+) {
+	assert (index < size ());
+	m_centerX[index] = centerX;
+	m_centerY[index] = centerY;
+	m_centerZ[index] = centerZ;
+	m_radius[index] = radius;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 BoundingSpheres::size () const
+{
+	return static_cast<uint32>(m_radius.size ());
+}
+
+//---------------------------------------------------------------------------------------
+const float * BoundingSpheres::centerX () const
+{
+	return m_centerX.data ();
+}
+
+//---------------------------------------------------------------------------------------
+const float * BoundingSpheres::centerY () const
+{
+	return m_centerY.data ();
+}
+
+//---------------------------------------------------------------------------------------
+const float * BoundingSpheres::centerZ () const
+{
+	return m_centerZ.data ();
+}
+
+//---------------------------------------------------------------------------------------
+const float * BoundingSpheres::radius () const
+{
+	return m_radius.data ();
+}
+
+//---------------------------------------------------------------------------------------
+FrustumCuller::FrustumCuller (
+	JobSystem & jobSystem
+)
+	: m_jobSystem (jobSystem),
+	  m_useAvx2 (false)
+{
+	setAvx2Enabled (true);
+}
+
+//---------------------------------------------------------------------------------------
+void FrustumCuller::setAvx2Enabled (
+	bool enabled
+) {
+#if defined(FRUSTUM_CULLER_AVX2)
+	m_useAvx2 = enabled && CpuSupportsAvx2 ();
+#else
+	m_useAvx2 = false;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+uint32 FrustumCuller::cull (
+	const Frustum & frustum,
+	const BoundingSpheres & spheres,
+	uint32 * visibleIndices
+) {
+	const uint32 count = spheres.size ();
+	const uint32 numBlocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	m_blockCounts.resize (numBlocks);
+
+	// Each block compacts its visible indices in place at the start of its own range of
+	// visibleIndices, so blocks can be culled without synchronization.
+	ParallelFor (m_jobSystem, 0, numBlocks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 block (rangeBegin); block < rangeEnd; ++block) {
+			const uint32 begin = block * BLOCK_SIZE;
+			const uint32 end = std::min (begin + BLOCK_SIZE, count);
+#if defined(FRUSTUM_CULLER_AVX2)
+			if (m_useAvx2) {
+				m_blockCounts[block] = cullRangeAvx2 (frustum, spheres, begin, end, visibleIndices + begin);
+				continue;
+			}
+#endif
+			m_blockCounts[block] = cullRangeScalar (frustum, spheres, begin, end, visibleIndices + begin);
+		}
+	});
+
+	// Close the gaps between blocks.
+	uint32 visibleCount = numBlocks ? m_blockCounts[0] : 0;
+	for (uint32 block (1); block < numBlocks; ++block) {
+		std::memmove (visibleIndices + visibleCount, visibleIndices + block * BLOCK_SIZE,
+			m_blockCounts[block] * sizeof (uint32));
+		visibleCount += m_blockCounts[block];
+	}
+
+	return visibleCount;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 FrustumCuller::CullScalar (
+	const Frustum & frustum,
+	const BoundingSpheres & spheres,
+	uint32 * visibleIndices
+) {
+	return cullRangeScalar (frustum, spheres, 0, spheres.size (), visibleIndices);
+}
@@ -0,0 +1,126 @@
+//
+// FrustumCuller.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/MathUtils.hpp"
+
+class JobSystem;
+
+
+/// Six planes bounding the visible volume of a view.
+///
+/// Each plane is stored as (a, b, c, d) with a unit length normal pointing into the
+/// frustum, so a point p lies inside when a * p.x + b * p.y + c * p.z + d >= 0.
+struct Frustum {
+	enum Plane {
+		Left,
+		Right,
+		Bottom,
+		Top,
+		Near,
+		Far,
+		NUM_PLANES
+	};
+
+	float planes[NUM_PLANES][4];
+
+	/// Extracts the planes of a view-projection transform mapping depth into [0, 1].
+	static Frustum FromViewProjection (
+		const Matrix4 & viewProjection
+	);
+};
+
+
+/// World space bounding spheres stored as a structure of arrays, so that several
+/// spheres can be loaded into a single SIMD register.
+class BoundingSpheres {
+public:
+	void clear ();
+
+	void reserve (
+		uint32 capacity
+	);
+
+	/// Appends a sphere, returning its index.
+	uint32 add (
+		float centerX,
+		float centerY,
+		float centerZ,
+		float radius
+	);
+
+	void set (
+		uint32 index,
+		float centerX,
+		float centerY,
+		float centerZ,
+		float radius
+	);
+
+	uint32 size () const;
+
+	const float * centerX () const;
+	const float * centerY () const;
+	const float * centerZ () const;
+	const float * radius () const;
+
+private:
+	std::vector<float> m_centerX;
+	std::vector<float> m_centerY;
+	std::vector<float> m_centerZ;
+	std::vector<float> m_radius;
+};
+
+
+/// Tests bounding spheres against a view frustum, producing the indices of spheres that
+/// are at least partially inside.
+///
+/// Spheres are tested 8 at a time using AVX2 when the processor supports it, and
+/// large sets are split into blocks culled in parallel across the threads of a
+/// JobSystem.  Output is identical regardless of instruction set or thread count.
+///
+/// cull() must be called from the thread that constructed the JobSystem, or from within
+/// a job.
+class FrustumCuller {
+public:
+	/// Spheres per block handed to a worker thread, a multiple of the SIMD width.
+	static const uint32 BLOCK_SIZE = 8192;
+
+	explicit FrustumCuller (
+		JobSystem & jobSystem
+	);
+
+	/// Writes the indices of visible spheres to visibleIndices in increasing order,
+	/// returning their count.  visibleIndices must have room for spheres.size()
+	/// entries.
+	uint32 cull (
+		const Frustum & frustum,
+		const BoundingSpheres & spheres,
+		uint32 * visibleIndices
+	);
+
+	/// Enables or disables the AVX2 code path, which is otherwise used whenever the
+	/// processor supports it.  Has no effect if AVX2 is unsupported.
+	void setAvx2Enabled (
+		bool enabled
+	);
+
+	/// Single threaded, one sphere at a time reference implementation of cull().
+	static uint32 CullScalar (
+		const Frustum & frustum,
+		const BoundingSpheres & spheres,
+		uint32 * visibleIndices
+	);
+
+
+private:
+	JobSystem & m_jobSystem;
+	bool m_useAvx2;
+
+	// Number of visible spheres found by each block.
+	std::vector<uint32> m_blockCounts;
+};
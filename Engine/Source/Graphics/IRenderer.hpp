@@ -5,9 +5,17 @@
 
 #include <windef.h>
 
+#include "Core/Types.hpp"
+
+struct DrawCall;
+
 ///	Interface representing a rendering system.
 class IRenderer {
 public:
+	/// Number of frames that may be in flight at once, counting those being built by
+	/// the CPU and those queued for execution on the GPU.
+	static const uint NUM_BUFFERED_FRAMES = 3;
+
 	virtual ~IRenderer () {}
 
 	virtual
@@ -15,6 +23,12 @@ public:
 		HWND hWindow
 	) = 0;
 
+	/// Queues drawCall for execution during the next call to render().
+	virtual
+	void submit (
+		const DrawCall & drawCall
+	) = 0;
+
 	/// Submits rendering of scene to attached framebuffer.
 	virtual
 	void render () = 0;
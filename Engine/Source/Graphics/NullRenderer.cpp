@@ -0,0 +1,196 @@
+//
+// NullRenderer.cpp
+//
+#include "pch.h"
+
+#include "Graphics/NullRenderer.hpp"
+
+namespace
+{
+	RenderCommand makeCommand (
+		RenderCommandType type
+	) {
+		RenderCommand command = {};
+		command.type = type;
+		return command;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+NullRenderer::NullRenderer ()
+	: m_frameCount (0)
+{
+	resetBoundState ();
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::initialize (
+	HWND
+) {
+	m_recordingStream.clear ();
+	m_completedStream.clear ();
+	m_recordingStats = RenderStats ();
+	m_completedStats = RenderStats ();
+	m_uploadedMeshes.clear ();
+	m_frameCount = 0;
+
+	resetBoundState ();
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::submit (
+	const DrawCall & drawCall
+) {
+	assert (drawCall.mesh);
+	assert (drawCall.material);
+
+	const Material * material = drawCall.material;
+	const MeshComponent * mesh = drawCall.mesh;
+
+	//-- Pipeline state is keyed on the shaders it was built from.
+	const CompiledShader * vertexShader = material->shaderGroup.vertexShader.get ();
+	const CompiledShader * pixelShader = material->shaderGroup.pixelShader.get ();
+	if (!m_boundMaterial ||
+		vertexShader != m_boundVertexShader ||
+		pixelShader != m_boundPixelShader
+	) {
+		RenderCommand command = makeCommand (RenderCommandType::SetPipelineState);
+		command.material = material;
+		m_recordingStream.push_back (command);
+		++m_recordingStats.stateChanges;
+
+		m_boundVertexShader = vertexShader;
+		m_boundPixelShader = pixelShader;
+	}
+
+	if (material != m_boundMaterial) {
+		RenderCommand command = makeCommand (RenderCommandType::SetMaterial);
+		command.material = material;
+		m_recordingStream.push_back (command);
+		++m_recordingStats.stateChanges;
+
+		m_boundMaterial = material;
+	}
+
+	if (mesh != m_boundMesh) {
+		// Mesh data must be resident before its buffers can be bound.
+		if (m_uploadedMeshes.insert (mesh).second) {
+			RenderCommand command = makeCommand (RenderCommandType::UploadMesh);
+			command.mesh = mesh;
+			command.byteCount =
+				uint64 (mesh->numVertices) * sizeof (Vertex) +
+				uint64 (mesh->numIndices) * sizeof (Index);
+			m_recordingStream.push_back (command);
+			m_recordingStats.bytesUploaded += command.byteCount;
+		}
+
+		RenderCommand command = makeCommand (RenderCommandType::SetMesh);
+		command.mesh = mesh;
+		m_recordingStream.push_back (command);
+		++m_recordingStats.stateChanges;
+
+		m_boundMesh = mesh;
+	}
+
+	if (drawCall.instances) {
+		RenderCommand command = makeCommand (RenderCommandType::UploadInstances);
+		command.instances = drawCall.instances;
+		command.byteCount = uint64 (drawCall.instanceCount) * sizeof (InstanceData);
+		m_recordingStream.push_back (command);
+		m_recordingStats.bytesUploaded += command.byteCount;
+	}
+
+	RenderCommand command = makeCommand (RenderCommandType::DrawIndexed);
+	command.instances = drawCall.instances;
+	command.indexCount = mesh->numIndices;
+	command.instanceCount = drawCall.instanceCount;
+	command.firstInstance = drawCall.firstInstance;
+	m_recordingStream.push_back (command);
+
+	++m_recordingStats.drawCalls;
+	m_recordingStats.instances += drawCall.instanceCount;
+	m_recordingStats.triangles += (mesh->numIndices / 3) * drawCall.instanceCount;
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::render ()
+{
+	// Swap rather than copy so the recording stream keeps its capacity between frames.
+	m_completedStream.swap (m_recordingStream);
+	m_recordingStream.clear ();
+
+	m_completedStats = m_recordingStats;
+	m_recordingStats = RenderStats ();
+
+	// Each frame starts recording into a fresh command list with no state bound.
+	resetBoundState ();
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::present ()
+{
+	++m_frameCount;
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::replay (
+	const RenderCommandStream & stream
+) {
+	DrawCall drawCall;
+
+	for (const RenderCommand & command : stream) {
+		switch (command.type) {
+			case RenderCommandType::SetPipelineState:
+			case RenderCommandType::SetMaterial:
+				drawCall.material = command.material;
+				break;
+
+			case RenderCommandType::SetMesh:
+				drawCall.mesh = command.mesh;
+				break;
+
+			case RenderCommandType::DrawIndexed:
+				drawCall.instanceCount = command.instanceCount;
+				drawCall.firstInstance = command.firstInstance;
+				drawCall.instances = command.instances;
+				submit (drawCall);
+				break;
+
+			default: break;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::evictUploadedMeshes ()
+{
+	m_uploadedMeshes.clear ();
+}
+
+//---------------------------------------------------------------------------------------
+const RenderCommandStream & NullRenderer::commandStream () const
+{
+	return m_completedStream;
+}
+
+//---------------------------------------------------------------------------------------
+const RenderStats & NullRenderer::frameStats () const
+{
+	return m_completedStats;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 NullRenderer::frameCount () const
+{
+	return m_frameCount;
+}
+
+//---------------------------------------------------------------------------------------
+void NullRenderer::resetBoundState ()
+{
+	m_boundVertexShader = nullptr;
+	m_boundPixelShader = nullptr;
+	m_boundMaterial = nullptr;
+	m_boundMesh = nullptr;
+}
@@ -0,0 +1,122 @@
+//
+// NullRenderer.hpp
+//
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Graphics/IRenderer.hpp"
+#include "Graphics/DrawCall.hpp"
+
+
+enum class RenderCommandType : uint8 {
+	SetPipelineState, ///< Binds the shader pipeline of a Material.
+	SetMaterial,      ///< Binds the remaining Material resources (textures).
+	SetMesh,          ///< Binds vertex and index buffers of a MeshComponent.
+	UploadMesh,       ///< Copies MeshComponent data into GPU memory on first use.
+	UploadInstances,  ///< Copies per-instance data of a draw into GPU memory.
+	DrawIndexed       ///< Issues an instanced, indexed draw of the bound mesh.
+};
+
+/// A single entry within a recorded command stream.
+struct RenderCommand {
+	RenderCommandType type;
+
+	// SetPipelineState, SetMaterial
+	const Material * material;
+
+	// SetMesh, UploadMesh
+	const MeshComponent * mesh;
+
+	// UploadMesh, UploadInstances
+	uint64 byteCount;
+
+	// UploadInstances, DrawIndexed
+	const InstanceData * instances;
+
+	// DrawIndexed
+	uint32 indexCount;
+	uint32 instanceCount;
+	uint32 firstInstance;
+};
+
+typedef std::vector<RenderCommand> RenderCommandStream;
+
+/// Counters accumulated over a single frame of submitted draw calls.
+struct RenderStats {
+	uint32 drawCalls = 0;
+	uint32 instances = 0;
+	uint32 triangles = 0;
+
+	/// Number of pipeline, material and mesh bindings that differed from the
+	/// previously bound state.
+	uint32 stateChanges = 0;
+
+	uint64 bytesUploaded = 0;
+};
+
+
+/// Renderer that performs no GPU work.
+///
+/// Each submitted DrawCall is translated into the commands a hardware renderer would
+/// need to record, with redundant state bindings filtered out, and appended to an
+/// in-memory command stream.  This allows the CPU side of rendering to be profiled and
+/// tested without a window or graphics device.
+class NullRenderer : public IRenderer {
+public:
+	NullRenderer ();
+
+	/// hWindow is ignored and may be nullptr.
+	void initialize (
+		HWND hWindow
+	) override;
+
+	void submit (
+		const DrawCall & drawCall
+	) override;
+
+	/// Completes the current frame, making its command stream and stats available.
+	void render () override;
+
+	void present () override;
+
+	/// Re-submits every draw recorded within stream, as if each had been passed to
+	/// submit() in the same order.
+	void replay (
+		const RenderCommandStream & stream
+	);
+
+	/// Forgets all uploaded meshes, so that their next use is counted as an upload.
+	void evictUploadedMeshes ();
+
+	/// Command stream recorded during the last completed frame.
+	const RenderCommandStream & commandStream () const;
+
+	/// Stats accumulated during the last completed frame.
+	const RenderStats & frameStats () const;
+
+	uint64 frameCount () const;
+
+
+private:
+	void resetBoundState ();
+
+	RenderCommandStream m_recordingStream;
+	RenderCommandStream m_completedStream;
+
+	RenderStats m_recordingStats;
+	RenderStats m_completedStats;
+
+	// Currently bound state, used to filter redundant bindings.
+	const CompiledShader * m_boundVertexShader;
+	const CompiledShader * m_boundPixelShader;
+	const Material * m_boundMaterial;
+	const MeshComponent * m_boundMesh;
+
+	// Meshes whose data has already been copied to (simulated) GPU memory.
+	std::unordered_set<const MeshComponent *> m_uploadedMeshes;
+
+	uint64 m_frameCount;
+};
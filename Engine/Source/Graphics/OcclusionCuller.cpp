@@ -0,0 +1,432 @@
+//
+// OcclusionCuller.cpp
+//
+#include "pch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "Core/ParallelFor.hpp"
+#include "Graphics/OcclusionCuller.hpp"
+
+namespace
+{
+	// Number of occludees tested by a single task within cull().
+	const uint32 OCCLUDEES_PER_TASK = 1024;
+
+	// Geometry with a vertex closer than this to the eye plane is not rasterized, and
+	// occludees reaching it are always visible.
+	const float MIN_CLIP_W = 1e-5f;
+
+	const float CLEAR_DEPTH = 1.0f;
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double millisecondsSince (
+		Clock::time_point start
+	) {
+		return std::chrono::duration<double, std::milli> (Clock::now () - start).count ();
+	}
+
+	// Mask selecting the lanes of the 4 pixels starting at x that lie within [minX, maxX].
+	__m128 laneMask (
+		int x,
+		int minX,
+		int maxX
+	) {
+		const __m128i lanes = _mm_add_epi32 (_mm_set1_epi32 (x), _mm_setr_epi32 (0, 1, 2, 3));
+		return _mm_castsi128_ps (_mm_andnot_si128 (
+			_mm_cmplt_epi32 (lanes, _mm_set1_epi32 (minX)),
+			_mm_cmplt_epi32 (lanes, _mm_set1_epi32 (maxX + 1))
+		));
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+OcclusionCuller::OcclusionCuller (
+	uint width,
+	uint height,
+	JobSystem & jobSystem
+)
+	: m_jobSystem (jobSystem),
+	  m_width (width),
+	  m_height (height),
+	  m_tileCountX (width / TILE_SIZE),
+	  m_tileCountY (height / TILE_SIZE),
+	  m_depthBuffer (width * height, CLEAR_DEPTH),
+	  m_tileDepths (m_tileCountX * m_tileCountY, CLEAR_DEPTH),
+	  m_viewProjection (math::identity ()),
+	  m_stats ()
+{
+	assert (width % TILE_SIZE == 0 && height % TILE_SIZE == 0);
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::begin (
+	const Matrix4 & viewProjection
+) {
+	m_viewProjection = viewProjection;
+	m_occluders.clear ();
+	m_stats = OcclusionStats ();
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::addOccluder (
+	const MeshComponent & mesh,
+	const Matrix4 & world
+) {
+	m_occluders.push_back ({&mesh, math::multiply (world, m_viewProjection)});
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::rasterizeOccluders ()
+{
+	const Clock::time_point start = Clock::now ();
+
+	if (m_occluderTriangles.size () < m_occluders.size ()) {
+		m_occluderTriangles.resize (m_occluders.size ());
+	}
+
+	const uint32 numOccluders = static_cast<uint32>(m_occluders.size ());
+	ParallelFor (m_jobSystem, 0, numOccluders, [this] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 i (rangeBegin); i < rangeEnd; ++i) {
+			setupTriangles (m_occluders[i], m_occluderTriangles[i]);
+		}
+	});
+
+	m_stats.occluderTriangles = 0;
+	for (size_t i (0); i < m_occluders.size (); ++i) {
+		m_stats.occluderTriangles += static_cast<uint32>(m_occluderTriangles[i].size ());
+	}
+
+	ParallelFor (m_jobSystem, 0, m_tileCountY, [this] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 tileRow (rangeBegin); tileRow < rangeEnd; ++tileRow) {
+			rasterizeBand (tileRow);
+		}
+	});
+
+	m_stats.rasterizeMilliseconds = millisecondsSince (start);
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::setupTriangles (
+	const Occluder & occluder,
+	std::vector<OccluderTriangle> & triangles
+) const {
+	triangles.clear ();
+
+	const float width = static_cast<float>(m_width);
+	const float height = static_cast<float>(m_height);
+	const MeshComponent & mesh = *occluder.mesh;
+
+	for (uint32 t (0); t + 2 < mesh.numIndices; t += 3) {
+		float clip[3][4];
+		for (uint k (0); k < 3; ++k) {
+			math::transformPoint (mesh.vertices[mesh.indices[t + k]].position,
+				occluder.worldViewProjection, clip[k]);
+		}
+
+		//-- Skip triangles crossing the near plane, or entirely outside the frustum.
+		if (clip[0][3] < MIN_CLIP_W || clip[1][3] < MIN_CLIP_W || clip[2][3] < MIN_CLIP_W) {
+			continue;
+		}
+		bool outside = false;
+		for (uint axis (0); axis < 2 && !outside; ++axis) {
+			outside =
+				(clip[0][axis] > clip[0][3] && clip[1][axis] > clip[1][3] && clip[2][axis] > clip[2][3]) ||
+				(clip[0][axis] < -clip[0][3] && clip[1][axis] < -clip[1][3] && clip[2][axis] < -clip[2][3]);
+		}
+		if (outside) {
+			continue;
+		}
+
+		//-- Project to screen space, culling back faces.
+		float x[3], y[3], z[3];
+		for (uint k (0); k < 3; ++k) {
+			const float invW = 1.0f / clip[k][3];
+			x[k] = (clip[k][0] * invW * 0.5f + 0.5f) * width;
+			y[k] = (0.5f - clip[k][1] * invW * 0.5f) * height;
+			z[k] = clip[k][2] * invW;
+		}
+
+		// Front faces have negative signed area once y points down the screen.
+		const float signedArea = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if (signedArea >= 0.0f) {
+			continue;
+		}
+
+		OccluderTriangle triangle;
+		triangle.minX = std::max (0, static_cast<int>(std::floor (std::min ({x[0], x[1], x[2]}))));
+		triangle.minY = std::max (0, static_cast<int>(std::floor (std::min ({y[0], y[1], y[2]}))));
+		triangle.maxX = std::min (static_cast<int>(m_width) - 1,
+			static_cast<int>(std::floor (std::max ({x[0], x[1], x[2]}))));
+		triangle.maxY = std::min (static_cast<int>(m_height) - 1,
+			static_cast<int>(std::floor (std::max ({y[0], y[1], y[2]}))));
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+			continue;
+		}
+
+		// Reversing the winding to {0, 2, 1} gives positive area, with edge k lying
+		// opposite vertex k so that E_k / area is the barycentric weight of vertex k.
+		const uint order[3] = {0, 2, 1};
+		for (uint k (0); k < 3; ++k) {
+			const uint a = order[(k + 1) % 3];
+			const uint b = order[(k + 2) % 3];
+			triangle.edgeA[k] = y[a] - y[b];
+			triangle.edgeB[k] = x[b] - x[a];
+			triangle.edgeC[k] = -(triangle.edgeA[k] * x[a] + triangle.edgeB[k] * y[a]);
+		}
+
+		// z = z0 + (E_1 * (z1 - z0) + E_2 * (z2 - z0)) / area, expanded into a plane.
+		const float invArea = 1.0f / -signedArea;
+		const float dz1 = (z[order[1]] - z[0]) * invArea;
+		const float dz2 = (z[order[2]] - z[0]) * invArea;
+		triangle.depthA = triangle.edgeA[1] * dz1 + triangle.edgeA[2] * dz2;
+		triangle.depthB = triangle.edgeB[1] * dz1 + triangle.edgeB[2] * dz2;
+		triangle.depthC = z[0] + triangle.edgeC[1] * dz1 + triangle.edgeC[2] * dz2;
+
+		triangles.push_back (triangle);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::rasterizeBand (
+	uint32 tileRow
+) {
+	const int minY = tileRow * TILE_SIZE;
+	const int maxY = minY + TILE_SIZE - 1;
+
+	for (int y (minY); y <= maxY; ++y) {
+		std::fill_n (&m_depthBuffer[size_t (y) * m_width], m_width, CLEAR_DEPTH);
+	}
+
+	for (size_t i (0); i < m_occluders.size (); ++i) {
+		for (const OccluderTriangle & triangle : m_occluderTriangles[i]) {
+			if (triangle.maxY >= minY && triangle.minY <= maxY) {
+				rasterizeTriangle (triangle, minY, maxY);
+			}
+		}
+	}
+
+	//-- Record the furthest depth of each tile in the band.
+	for (uint tx (0); tx < m_tileCountX; ++tx) {
+		__m128 tileDepth = _mm_setzero_ps ();
+		for (int y (minY); y <= maxY; ++y) {
+			const float * depthRow = &m_depthBuffer[size_t (y) * m_width + tx * TILE_SIZE];
+			for (uint x (0); x < TILE_SIZE; x += 4) {
+				tileDepth = _mm_max_ps (tileDepth, _mm_loadu_ps (depthRow + x));
+			}
+		}
+		alignas(16) float lanes[4];
+		_mm_store_ps (lanes, tileDepth);
+		m_tileDepths[tileRow * m_tileCountX + tx] =
+			std::max (std::max (lanes[0], lanes[1]), std::max (lanes[2], lanes[3]));
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void OcclusionCuller::rasterizeTriangle (
+	const OccluderTriangle & triangle,
+	int bandMinY,
+	int bandMaxY
+) {
+	// Rows are a multiple of 4 pixels wide, so 4-pixel groups never cross a row end.
+	// Pixels outside the triangle's bounds are rejected by the edge tests.
+	const int minX = triangle.minX & ~3;
+	const int maxX = triangle.maxX;
+	const int minY = std::max (triangle.minY, bandMinY);
+	const int maxY = std::min (triangle.maxY, bandMaxY);
+
+	const __m128 laneOffsets = _mm_setr_ps (0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps ();
+
+	__m128 edgeA[3];
+	for (uint k (0); k < 3; ++k) {
+		edgeA[k] = _mm_set1_ps (triangle.edgeA[k]);
+	}
+	const __m128 depthA = _mm_set1_ps (triangle.depthA);
+
+	for (int y (minY); y <= maxY; ++y) {
+		const float py = y + 0.5f;
+
+		// Edge function and depth values at x = 0 for this row.
+		__m128 rowEdge[3];
+		for (uint k (0); k < 3; ++k) {
+			rowEdge[k] = _mm_set1_ps (triangle.edgeB[k] * py + triangle.edgeC[k]);
+		}
+		const __m128 rowDepth = _mm_set1_ps (triangle.depthB * py + triangle.depthC);
+
+		float * depthRow = &m_depthBuffer[size_t (y) * m_width];
+
+		for (int x (minX); x <= maxX; x += 4) {
+			const __m128 px = _mm_add_ps (_mm_set1_ps (static_cast<float>(x)), laneOffsets);
+
+			__m128 coverage = _mm_cmpge_ps (_mm_add_ps (_mm_mul_ps (edgeA[0], px), rowEdge[0]), zero);
+			for (uint k (1); k < 3; ++k) {
+				coverage = _mm_and_ps (coverage,
+					_mm_cmpge_ps (_mm_add_ps (_mm_mul_ps (edgeA[k], px), rowEdge[k]), zero));
+			}
+			if (_mm_movemask_ps (coverage) == 0) {
+				continue;
+			}
+
+			const __m128 z = _mm_add_ps (_mm_mul_ps (depthA, px), rowDepth);
+			const __m128 depth = _mm_loadu_ps (&depthRow[x]);
+			const __m128 nearest = _mm_min_ps (depth, z);
+			_mm_storeu_ps (&depthRow[x],
+				_mm_or_ps (_mm_and_ps (coverage, nearest), _mm_andnot_ps (coverage, depth)));
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+bool OcclusionCuller::isOccluded (
+	const BoundingBox & box
+) const {
+	//-- Find the box's screen space bounds and nearest depth.
+	float minX = static_cast<float>(m_width);
+	float minY = static_cast<float>(m_height);
+	float maxX = 0.0f;
+	float maxY = 0.0f;
+	float minZ = 1.0f;
+
+	for (uint corner (0); corner < 8; ++corner) {
+		const float point[3] = {
+			(corner & 1) ? box.max[0] : box.min[0],
+			(corner & 2) ? box.max[1] : box.min[1],
+			(corner & 4) ? box.max[2] : box.min[2]
+		};
+		float clip[4];
+		math::transformPoint (point, m_viewProjection, clip);
+
+		// Boxes reaching the eye plane cannot be projected, so are assumed visible.
+		if (clip[3] < MIN_CLIP_W) {
+			return false;
+		}
+
+		const float invW = 1.0f / clip[3];
+		const float x = (clip[0] * invW * 0.5f + 0.5f) * m_width;
+		const float y = (0.5f - clip[1] * invW * 0.5f) * m_height;
+		minX = std::min (minX, x);
+		maxX = std::max (maxX, x);
+		minY = std::min (minY, y);
+		maxY = std::max (maxY, y);
+		minZ = std::min (minZ, clip[2] * invW);
+	}
+
+	const int pixelMinX = std::max (0, static_cast<int>(std::floor (minX)));
+	const int pixelMinY = std::max (0, static_cast<int>(std::floor (minY)));
+	const int pixelMaxX = std::min (static_cast<int>(m_width) - 1, static_cast<int>(std::floor (maxX)));
+	const int pixelMaxY = std::min (static_cast<int>(m_height) - 1, static_cast<int>(std::floor (maxY)));
+
+	// Off screen boxes are left to frustum culling.
+	if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY) {
+		return false;
+	}
+
+	const __m128 boxDepth = _mm_set1_ps (minZ);
+
+	for (int ty (pixelMinY / TILE_SIZE); ty <= pixelMaxY / int (TILE_SIZE); ++ty) {
+		for (int tx (pixelMinX / TILE_SIZE); tx <= pixelMaxX / int (TILE_SIZE); ++tx) {
+			// Occluders cover the whole tile in front of the box.
+			if (m_tileDepths[ty * m_tileCountX + tx] < minZ) {
+				continue;
+			}
+
+			//-- Compare against each pixel of the tile overlapped by the box.
+			const int x0 = std::max (pixelMinX, tx * int (TILE_SIZE));
+			const int x1 = std::min (pixelMaxX, tx * int (TILE_SIZE) + int (TILE_SIZE) - 1);
+			const int y0 = std::max (pixelMinY, ty * int (TILE_SIZE));
+			const int y1 = std::min (pixelMaxY, ty * int (TILE_SIZE) + int (TILE_SIZE) - 1);
+
+			for (int y (y0); y <= y1; ++y) {
+				const float * depthRow = &m_depthBuffer[size_t (y) * m_width];
+				for (int x (x0 & ~3); x <= x1; x += 4) {
+					const __m128 visible = _mm_and_ps (laneMask (x, x0, x1),
+						_mm_cmpge_ps (_mm_loadu_ps (&depthRow[x]), boxDepth));
+					if (_mm_movemask_ps (visible)) {
+						return false;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 OcclusionCuller::cull (
+	const BoundingBox * boxes,
+	const uint32 * candidates,
+	uint32 count,
+	uint32 * visibleIndices
+) {
+	const Clock::time_point start = Clock::now ();
+
+	const uint32 numBlocks = (count + OCCLUDEES_PER_TASK - 1) / OCCLUDEES_PER_TASK;
+	m_blockCounts.resize (numBlocks);
+
+	// Each block compacts its visible candidates at the start of its own range of
+	// visibleIndices.  Writes never pass the candidate being read, so visibleIndices
+	// may alias candidates.
+	ParallelFor (m_jobSystem, 0, numBlocks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 block (rangeBegin); block < rangeEnd; ++block) {
+			const uint32 begin = block * OCCLUDEES_PER_TASK;
+			const uint32 end = std::min (begin + OCCLUDEES_PER_TASK, count);
+
+			uint32 visibleCount = 0;
+			for (uint32 i (begin); i < end; ++i) {
+				const uint32 candidate = candidates[i];
+				if (!isOccluded (boxes[candidate])) {
+					visibleIndices[begin + visibleCount++] = candidate;
+				}
+			}
+			m_blockCounts[block] = visibleCount;
+		}
+	});
+
+	// Close the gaps between blocks.
+	uint32 visibleCount = numBlocks ? m_blockCounts[0] : 0;
+	for (uint32 block (1); block < numBlocks; ++block) {
+		std::memmove (visibleIndices + visibleCount, visibleIndices + block * OCCLUDEES_PER_TASK,
+			m_blockCounts[block] * sizeof (uint32));
+		visibleCount += m_blockCounts[block];
+	}
+
+	m_stats.occludeesTested += count;
+	m_stats.occludeesCulled += count - visibleCount;
+	m_stats.culledPercentage = m_stats.occludeesTested ?
+		100.0f * m_stats.occludeesCulled / m_stats.occludeesTested : 0.0f;
+	m_stats.testMilliseconds += millisecondsSince (start);
+
+	return visibleCount;
+}
+
+//---------------------------------------------------------------------------------------
+const OcclusionStats & OcclusionCuller::stats () const
+{
+	return m_stats;
+}
+
+//---------------------------------------------------------------------------------------
+uint OcclusionCuller::width () const
+{
+	return m_width;
+}
+
+//---------------------------------------------------------------------------------------
+uint OcclusionCuller::height () const
+{
+	return m_height;
+}
+
+//---------------------------------------------------------------------------------------
+const float * OcclusionCuller::depthBuffer () const
+{
+	return m_depthBuffer.data ();
+}
@@ -0,0 +1,161 @@
+//
+// OcclusionCuller.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/MathUtils.hpp"
+#include "Graphics/RenderComponent.hpp"
+
+class JobSystem;
+
+
+/// World space axis-aligned bounding box.
+struct BoundingBox {
+	float min[3];
+	float max[3];
+};
+
+/// Results of the most recent occlusion culling pass.
+struct OcclusionStats {
+	uint32 occluderTriangles;     ///< Triangles rasterized into the depth buffer.
+	uint32 occludeesTested;
+	uint32 occludeesCulled;
+	float culledPercentage;
+	double rasterizeMilliseconds; ///< Time spent in rasterizeOccluders().
+	double testMilliseconds;      ///< Time spent in cull().
+};
+
+
+/// Culls objects hidden behind large occluders using a low resolution depth buffer
+/// rasterized on the CPU.
+///
+/// Each frame, a few selected occluder meshes are rasterized into the depth buffer with
+/// SSE, in bands of tile rows spread across the threads of a JobSystem.  The furthest
+/// depth within each TILE_SIZE x TILE_SIZE tile is then kept alongside the buffer, so
+/// that occludee bounding boxes can usually be accepted from the tile depths alone,
+/// falling back to a per-pixel comparison only for tiles the box may be visible
+/// through.
+///
+/// Depth follows the conventions of SoftwareRenderer: [0, 1] with 1 furthest, and
+/// counter-clockwise front faces.  Occluder triangles crossing the near plane are
+/// skipped, which can only make culling less aggressive.  Occluders cover only the
+/// pixels whose centers they contain, so an occludee peeking less than a pixel past an
+/// occluder's silhouette may be culled.
+///
+/// Methods must be called from the thread that constructed the JobSystem, or from
+/// within a job.
+class OcclusionCuller {
+public:
+	/// Width and height of the tiles holding the furthest depth of their pixels.
+	static const uint TILE_SIZE = 8;
+
+	/// Depth buffer dimensions must be multiples of TILE_SIZE.
+	OcclusionCuller (
+		uint width,
+		uint height,
+		JobSystem & jobSystem
+	);
+
+	/// Starts a new frame viewed through viewProjection, discarding all occluders.
+	void begin (
+		const Matrix4 & viewProjection
+	);
+
+	/// Adds mesh, transformed by world, as an occluder.  mesh must remain valid until
+	/// rasterizeOccluders() returns.
+	void addOccluder (
+		const MeshComponent & mesh,
+		const Matrix4 & world
+	);
+
+	/// Clears the depth buffer, then rasterizes every occluder added since begin().
+	void rasterizeOccluders ();
+
+	/// Returns true if box is entirely hidden behind the rasterized occluders.
+	bool isOccluded (
+		const BoundingBox & box
+	) const;
+
+	/// Tests boxes[candidates[i]] for i in [0, count), writing the candidates that are
+	/// not occluded to visibleIndices, in order, and returning their count.
+	/// visibleIndices may alias candidates.
+	uint32 cull (
+		const BoundingBox * boxes,
+		const uint32 * candidates,
+		uint32 count,
+		uint32 * visibleIndices
+	);
+
+	const OcclusionStats & stats () const;
+
+	uint width () const;
+
+	uint height () const;
+
+	/// Depth buffer, stored row by row with width() pixels per row.
+	const float * depthBuffer () const;
+
+
+private:
+	/// Occluder triangle in screen space.
+	struct OccluderTriangle {
+		// Edge function coefficients: E(x, y) = A * x + B * y + C.
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+
+		// Depth plane: z(x, y) = A * x + B * y + C.
+		float depthA;
+		float depthB;
+		float depthC;
+
+		// Inclusive pixel bounds.
+		int minX, minY, maxX, maxY;
+	};
+
+	struct Occluder {
+		const MeshComponent * mesh;
+		Matrix4 worldViewProjection;
+	};
+
+	void setupTriangles (
+		const Occluder & occluder,
+		std::vector<OccluderTriangle> & triangles
+	) const;
+
+	void rasterizeBand (
+		uint32 tileRow
+	);
+
+	void rasterizeTriangle (
+		const OccluderTriangle & triangle,
+		int bandMinY,
+		int bandMaxY
+	);
+
+	JobSystem & m_jobSystem;
+
+	uint m_width;
+	uint m_height;
+	uint m_tileCountX;
+	uint m_tileCountY;
+
+	std::vector<float> m_depthBuffer;
+
+	// Furthest depth within each tile.
+	std::vector<float> m_tileDepths;
+
+	Matrix4 m_viewProjection;
+	std::vector<Occluder> m_occluders;
+
+	// Screen space triangles of each occluder.
+	std::vector<std::vector<OccluderTriangle>> m_occluderTriangles;
+
+	// Number of visible candidates found by each block within cull().
+	std::vector<uint32> m_blockCounts;
+
+	OcclusionStats m_stats;
+};
@@ -3,8 +3,7 @@
 //
 #pragma once
 
-#include <memory>
-
+#include "Core/AssetHandle.hpp"
 #include "Core/Types.hpp"
 #include "Graphics/ShaderUtils.hpp"
 
@@ -14,14 +13,17 @@ struct Texture {
 	uint height;
 
 	uint bytesPerPixel;
+
+	// Pixels of each mip level, largest first, each immediately following the one before.
+	uint mipLevels;
 	void * imageData;
 };
 
 /// A grouping of compiled shader programs that make up a shader pipeline.
 /// Each CompiledShader member is reference counted for automatic memory cleanup.
 struct ShaderGroup {
-	std::shared_ptr<CompiledShader> vertexShader;
-	std::shared_ptr<CompiledShader> pixelShader;
+	AssetHandle<CompiledShader> vertexShader;
+	AssetHandle<CompiledShader> pixelShader;
 };
 
 struct Material {
@@ -35,8 +37,9 @@ struct Vertex {
 	float uv_diffuse[2];
 };
 
-// Support 2^16 -> 65536 unique indices per MeshComponent.
-typedef ushort Index;
+// Support 2^32 unique indices per MeshComponent, so meshes are not limited to the 65536
+// vertices a 16-bit index can address.
+typedef uint32 Index;
 
 
 struct MeshComponent {
@@ -46,9 +49,11 @@ struct MeshComponent {
 	Index * indices;
 };
 
+/// References the mesh and material used to draw an object.  Both are owned elsewhere
+/// so that objects of the same type can share them, and be drawn together as instances.
 struct RenderComponent {
-	MeshComponent mesh;
-	Material material;
+	const MeshComponent * mesh;
+	const Material * material;
 };
 
 
@@ -0,0 +1,113 @@
+//
+// RenderExtractor.cpp
+//
+#include "pch.h"
+
+#include <cstring>
+#include <functional>
+
+#include "Core/GameObject.hpp"
+#include "Core/Memory.hpp"
+#include "Graphics/RenderExtractor.hpp"
+#include "Graphics/RenderQueue.hpp"
+
+
+//---------------------------------------------------------------------------------------
+size_t RenderExtractor::GroupKeyHash::operator () (
+	const GroupKey & key
+) const {
+	const size_t meshHash = std::hash<const MeshComponent *> () (key.first);
+	const size_t materialHash = std::hash<const Material *> () (key.second);
+	return meshHash ^ (materialHash + 0x9e3779b9 + (meshHash << 6) + (meshHash >> 2));
+}
+
+//---------------------------------------------------------------------------------------
+RenderExtractor::RenderExtractor ()
+	: m_instances (nullptr),
+	  m_instanceCount (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+uint32 RenderExtractor::extract (
+	const GameObject * objects,
+	const uint32 * visibleIndices,
+	uint32 objectCount,
+	Allocator & frameAllocator,
+	RenderQueue & queue
+) {
+	m_groupIndices.clear ();
+	m_groups.clear ();
+	m_objectGroups.resize (objectCount);
+
+	// Assign each object to a group, counting instances per group.
+	for (uint32 i (0); i < objectCount; ++i) {
+		const GameObject & object = objects[visibleIndices ? visibleIndices[i] : i];
+		const GroupKey key (object.render.mesh, object.render.material);
+
+		auto result = m_groupIndices.emplace (key, uint32 (m_groups.size ()));
+		if (result.second) {
+			m_groups.push_back ({key.first, key.second, 0, 0});
+		}
+
+		const uint32 groupIndex = result.first->second;
+		m_objectGroups[i] = groupIndex;
+		++m_groups[groupIndex].instanceCount;
+	}
+
+	// Exclusive prefix sum of counts gives each group's offset in the instance buffer.
+	uint32 instanceOffset = 0;
+	for (InstanceGroup & group : m_groups) {
+		group.firstInstance = instanceOffset;
+		instanceOffset += group.instanceCount;
+		group.instanceCount = 0;
+	}
+
+	m_instances = static_cast<InstanceData *>(
+		frameAllocator.allocate (objectCount * sizeof (InstanceData), alignof (InstanceData)));
+	m_instanceCount = objectCount;
+
+	for (uint32 i (0); i < objectCount; ++i) {
+		const GameObject & object = objects[visibleIndices ? visibleIndices[i] : i];
+		InstanceGroup & group = m_groups[m_objectGroups[i]];
+
+		InstanceData & instance = m_instances[group.firstInstance + group.instanceCount];
+		++group.instanceCount;
+
+		const float world[4][3] = {
+			{1.0f, 0.0f, 0.0f},
+			{0.0f, 1.0f, 0.0f},
+			{0.0f, 0.0f, 1.0f},
+			{object.position[0], object.position[1], object.position[2]}
+		};
+		std::memcpy (instance.world, world, sizeof (world));
+	}
+
+	for (const InstanceGroup & group : m_groups) {
+		DrawCall drawCall;
+		drawCall.mesh = group.mesh;
+		drawCall.material = group.material;
+		drawCall.instanceCount = group.instanceCount;
+		drawCall.firstInstance = group.firstInstance;
+		drawCall.instances = m_instances + group.firstInstance;
+
+		// Instances of a group span a range of depths, so opaque groups are ordered by
+		// state alone.
+		queue.push (drawCall, RenderLayer::World, RenderPass::Opaque, 0.0f);
+	}
+
+	return static_cast<uint32>(m_groups.size ());
+}
+
+//---------------------------------------------------------------------------------------
+const InstanceData * RenderExtractor::instances () const
+{
+	return m_instances;
+}
+
+//---------------------------------------------------------------------------------------
+uint32 RenderExtractor::instanceCount () const
+{
+	return m_instanceCount;
+}
@@ -0,0 +1,74 @@
+//
+// RenderExtractor.hpp
+//
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Graphics/DrawCall.hpp"
+
+class Allocator;
+class RenderQueue;
+struct GameObject;
+
+
+/// Builds instanced draw calls from game objects.
+///
+/// Objects sharing both a mesh and a material are merged into a single DrawCall, with
+/// one InstanceData entry per object.  Instance data for all groups is written
+/// contiguously into a single buffer allocated from the frame allocator, so each
+/// DrawCall's firstInstance is its offset within that buffer.
+class RenderExtractor {
+public:
+	RenderExtractor ();
+
+	/// Pushes one DrawCall per distinct (mesh, material) pair among the given objects
+	/// into queue, which must have room for them.  Groups are ordered by their first
+	/// object, and instances within a group keep the order of their objects.
+	///
+	/// @param visibleIndices - indices into objects of the objects to draw, or nullptr
+	/// to draw all objectCount objects.
+	///
+	/// @return the number of draw calls pushed.
+	uint32 extract (
+		const GameObject * objects,
+		const uint32 * visibleIndices,
+		uint32 objectCount,
+		Allocator & frameAllocator,
+		RenderQueue & queue
+	);
+
+	/// Instance data written by the last call to extract().
+	const InstanceData * instances () const;
+
+	/// Number of instances written by the last call to extract().
+	uint32 instanceCount () const;
+
+
+private:
+	typedef std::pair<const MeshComponent *, const Material *> GroupKey;
+
+	struct GroupKeyHash {
+		size_t operator () (
+			const GroupKey & key
+		) const;
+	};
+
+	struct InstanceGroup {
+		const MeshComponent * mesh;
+		const Material * material;
+		uint32 instanceCount;
+		uint32 firstInstance;
+	};
+
+	// Persist across frames so their storage is reused.
+	std::unordered_map<GroupKey, uint32, GroupKeyHash> m_groupIndices;
+	std::vector<InstanceGroup> m_groups;
+	std::vector<uint32> m_objectGroups;
+
+	InstanceData * m_instances;
+	uint32 m_instanceCount;
+};
@@ -0,0 +1,183 @@
+//
+// RenderQueue.cpp
+//
+#include "pch.h"
+
+#include "Graphics/IRenderer.hpp"
+#include "Graphics/RenderQueue.hpp"
+
+namespace
+{
+	const uint DEPTH_SHIFT = 4;
+	const uint MATERIAL_SHIFT = DEPTH_SHIFT + RenderQueue::DEPTH_BITS;
+	const uint PIPELINE_SHIFT = MATERIAL_SHIFT + RenderQueue::MATERIAL_BITS;
+	const uint PASS_SHIFT = PIPELINE_SHIFT + RenderQueue::PIPELINE_BITS;
+	const uint LAYER_SHIFT = PASS_SHIFT + RenderQueue::PASS_BITS;
+
+	static_assert (LAYER_SHIFT + RenderQueue::LAYER_BITS == 64, "Sort key fields must fill 64 bits.");
+
+	// Transparent keys swap depth with the combined pipeline and material fields.
+	const uint TRANSPARENT_STATE_SHIFT = DEPTH_SHIFT;
+	const uint TRANSPARENT_DEPTH_SHIFT = PIPELINE_SHIFT + RenderQueue::PIPELINE_BITS - RenderQueue::DEPTH_BITS;
+
+	inline uint64 mask (
+		uint bits
+	) {
+		return (uint64 (1) << bits) - 1;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+RenderQueue::RenderQueue (
+	JobSystem & jobSystem
+)
+	: m_jobSystem (jobSystem),
+	  m_drawCalls (nullptr),
+	  m_entries (nullptr),
+	  m_scratch (nullptr),
+	  m_count (0),
+	  m_capacity (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+void RenderQueue::begin (
+	Allocator & frameAllocator,
+	uint32 capacity
+) {
+	m_drawCalls = static_cast<DrawCall *>(
+		frameAllocator.allocate (capacity * sizeof (DrawCall), alignof (DrawCall)));
+	m_entries = static_cast<SortEntry *>(
+		frameAllocator.allocate (capacity * sizeof (SortEntry), alignof (SortEntry)));
+	m_scratch = static_cast<SortEntry *>(
+		frameAllocator.allocate (capacity * sizeof (SortEntry), alignof (SortEntry)));
+
+	m_count = 0;
+	m_capacity = capacity;
+
+	m_materialIds.clear ();
+	m_pipelineIds.clear ();
+}
+
+//---------------------------------------------------------------------------------------
+void RenderQueue::push (
+	const DrawCall & drawCall,
+	RenderLayer layer,
+	RenderPass pass,
+	float depth
+) {
+	assert (drawCall.material);
+
+	const MaterialIds & ids = idsForMaterial (drawCall.material);
+	push (drawCall, MakeSortKey (layer, pass, ids.pipelineId, ids.materialId, depth));
+}
+
+//---------------------------------------------------------------------------------------
+void RenderQueue::push (
+	const DrawCall & drawCall,
+	uint64 sortKey
+) {
+	assert (m_count < m_capacity);
+
+	m_drawCalls[m_count] = drawCall;
+	m_entries[m_count].key = sortKey;
+	m_entries[m_count].index = m_count;
+	++m_count;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderQueue::sort ()
+{
+	RadixSort (m_entries, m_scratch, m_count, m_jobSystem);
+}
+
+//---------------------------------------------------------------------------------------
+void RenderQueue::submit (
+	IRenderer & renderer
+) const {
+	for (uint32 i (0); i < m_count; ++i) {
+		renderer.submit (m_drawCalls[m_entries[i].index]);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint32 RenderQueue::size () const
+{
+	return m_count;
+}
+
+//---------------------------------------------------------------------------------------
+const DrawCall & RenderQueue::drawCall (
+	uint32 i
+) const {
+	assert (i < m_count);
+	return m_drawCalls[m_entries[i].index];
+}
+
+//---------------------------------------------------------------------------------------
+uint64 RenderQueue::sortKey (
+	uint32 i
+) const {
+	assert (i < m_count);
+	return m_entries[i].key;
+}
+
+//---------------------------------------------------------------------------------------
+uint64 RenderQueue::MakeSortKey (
+	RenderLayer layer,
+	RenderPass pass,
+	uint32 pipelineId,
+	uint32 materialId,
+	float depth
+) {
+	depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+	const uint64 quantizedDepth = static_cast<uint64>(depth * mask (DEPTH_BITS));
+
+	uint64 key =
+		((uint64 (layer) & mask (LAYER_BITS)) << LAYER_SHIFT) |
+		((uint64 (pass) & mask (PASS_BITS)) << PASS_SHIFT);
+
+	const uint64 state =
+		((pipelineId & mask (PIPELINE_BITS)) << MATERIAL_BITS) |
+		(materialId & mask (MATERIAL_BITS));
+
+	if (pass == RenderPass::Transparent) {
+		// Farthest first.
+		key |= (mask (DEPTH_BITS) - quantizedDepth) << TRANSPARENT_DEPTH_SHIFT;
+		key |= state << TRANSPARENT_STATE_SHIFT;
+	}
+	else {
+		key |= state << MATERIAL_SHIFT;
+		key |= quantizedDepth << DEPTH_SHIFT;
+	}
+
+	return key;
+}
+
+//---------------------------------------------------------------------------------------
+const RenderQueue::MaterialIds & RenderQueue::idsForMaterial (
+	const Material * material
+) {
+	auto found = m_materialIds.find (material);
+	if (found != m_materialIds.end ()) {
+		return found->second;
+	}
+
+	// Pipelines are identified by the shaders they were built from.
+	const auto shaders = std::make_pair (
+		material->shaderGroup.vertexShader.get (),
+		material->shaderGroup.pixelShader.get ()
+	);
+	auto pipeline = m_pipelineIds.find (shaders);
+	if (pipeline == m_pipelineIds.end ()) {
+		const uint32 pipelineId = static_cast<uint32>(m_pipelineIds.size ());
+		pipeline = m_pipelineIds.emplace (shaders, pipelineId).first;
+	}
+
+	MaterialIds ids;
+	ids.pipelineId = pipeline->second;
+	ids.materialId = static_cast<uint32>(m_materialIds.size ());
+	return m_materialIds.emplace (material, ids).first->second;
+}
@@ -0,0 +1,136 @@
+//
+// RenderQueue.hpp
+//
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "Core/Types.hpp"
+#include "Core/RadixSort.hpp"
+#include "Graphics/DrawCall.hpp"
+
+class Allocator;
+class IRenderer;
+class JobSystem;
+
+
+/// Coarse grouping of draws.  Layers are drawn in increasing order.
+enum class RenderLayer : uint8 {
+	World,
+	Effects,
+	Overlay
+};
+
+/// Passes are drawn in increasing order within each layer.
+enum class RenderPass : uint8 {
+	Opaque,      ///< Sorted by pipeline, then material, then front-to-back.
+	Transparent  ///< Sorted back-to-front, then by pipeline and material.
+};
+
+
+/// A list of draw calls for a single frame, ordered by packed 64-bit sort keys.
+///
+/// Opaque keys are laid out so that sorting groups draws sharing a pipeline, and then a
+/// material, minimizing state changes when the list is submitted:
+///
+///   63    60 59   56 55        44 43        28 27           4 3    0
+///   [layer] [pass]  [pipeline]   [material]   [depth]         [0]
+///
+/// Transparent keys move inverted depth above the state bits so that blending happens
+/// back-to-front.
+///
+/// Storage is allocated from a frame allocator by begin(), so a RenderQueue holds no
+/// memory of its own between frames.
+class RenderQueue {
+public:
+	static const uint LAYER_BITS = 4;
+	static const uint PASS_BITS = 4;
+	static const uint PIPELINE_BITS = 12;
+	static const uint MATERIAL_BITS = 16;
+	static const uint DEPTH_BITS = 24;
+
+	explicit RenderQueue (
+		JobSystem & jobSystem
+	);
+
+	/// Starts a new frame, discarding queued draw calls and the pipeline and material
+	/// identifiers assigned to them.  Storage for up to capacity draw calls is allocated
+	/// from frameAllocator, and must remain valid until the queue has been submitted.
+	void begin (
+		Allocator & frameAllocator,
+		uint32 capacity
+	);
+
+	/// Queues drawCall, generating its sort key from the given parameters.
+	/// @param depth - normalized view depth in [0, 1].
+	void push (
+		const DrawCall & drawCall,
+		RenderLayer layer,
+		RenderPass pass,
+		float depth
+	);
+
+	/// Queues drawCall with a precomputed sort key.
+	void push (
+		const DrawCall & drawCall,
+		uint64 sortKey
+	);
+
+	/// Sorts queued draw calls by key.
+	void sort ();
+
+	/// Submits queued draw calls to renderer in their current order.
+	void submit (
+		IRenderer & renderer
+	) const;
+
+	uint32 size () const;
+
+	/// Returns the i-th draw call in the queue's current order.
+	const DrawCall & drawCall (
+		uint32 i
+	) const;
+
+	/// Returns the sort key of the i-th draw call in the queue's current order.
+	uint64 sortKey (
+		uint32 i
+	) const;
+
+	/// Packs sort key fields according to the layout described above.  Fields are
+	/// truncated to their bit widths, and depth is clamped to [0, 1].
+	static uint64 MakeSortKey (
+		RenderLayer layer,
+		RenderPass pass,
+		uint32 pipelineId,
+		uint32 materialId,
+		float depth
+	);
+
+
+private:
+	/// Sort key identifiers assigned to a Material.
+	struct MaterialIds {
+		uint32 pipelineId;
+		uint32 materialId;
+	};
+
+	const MaterialIds & idsForMaterial (
+		const Material * material
+	);
+
+	JobSystem & m_jobSystem;
+
+	DrawCall * m_drawCalls;
+	SortEntry * m_entries;
+	SortEntry * m_scratch;
+	uint32 m_count;
+	uint32 m_capacity;
+
+	// Identifiers are assigned densely in the order materials are first pushed each
+	// frame, so that a material or shader freed or reloaded since an earlier frame never
+	// shares an identifier with the one it replaced.
+	std::unordered_map<const Material *, MaterialIds> m_materialIds;
+	std::map<std::pair<const CompiledShader *, const CompiledShader *>, uint32> m_pipelineIds;
+};
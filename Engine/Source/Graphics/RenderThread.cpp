@@ -0,0 +1,202 @@
+//
+// RenderThread.cpp
+//
+#include "pch.h"
+
+#include "Core/Profiler.hpp"
+#include "Graphics/RenderQueue.hpp"
+#include "Graphics/RenderThread.hpp"
+
+
+//---------------------------------------------------------------------------------------
+RenderPacket::RenderPacket (
+	size_t arenaBytes
+)
+	: m_memory (new byte[arenaBytes]),
+	  m_allocator (m_memory.get (), arenaBytes),
+	  m_drawCalls (nullptr),
+	  m_drawCallCount (0),
+	  m_frameNumber (0)
+{
+
+}
+
+//---------------------------------------------------------------------------------------
+RenderPacket::~RenderPacket ()
+{
+	// Anything still allocated is discarded along with the packet.
+	m_allocator.reset ();
+}
+
+//---------------------------------------------------------------------------------------
+Allocator & RenderPacket::allocator ()
+{
+	return m_allocator;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderPacket::setDrawCalls (
+	const RenderQueue & queue
+) {
+	const uint32 count = queue.size ();
+	DrawCall * drawCalls = static_cast<DrawCall *>(
+		m_allocator.allocate (count * sizeof (DrawCall), alignof (DrawCall)));
+
+	for (uint32 i (0); i < count; ++i) {
+		drawCalls[i] = queue.drawCall (i);
+	}
+
+	m_drawCalls = drawCalls;
+	m_drawCallCount = count;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderPacket::submit (
+	IRenderer & renderer
+) const {
+	for (uint32 i (0); i < m_drawCallCount; ++i) {
+		renderer.submit (m_drawCalls[i]);
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint32 RenderPacket::drawCallCount () const
+{
+	return m_drawCallCount;
+}
+
+//---------------------------------------------------------------------------------------
+const DrawCall & RenderPacket::drawCall (
+	uint32 i
+) const {
+	assert (i < m_drawCallCount);
+	return m_drawCalls[i];
+}
+
+//---------------------------------------------------------------------------------------
+uint64 RenderPacket::frameNumber () const
+{
+	return m_frameNumber;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderPacket::reset (
+	uint64 frameNumber
+) {
+	m_allocator.reset ();
+	m_drawCalls = nullptr;
+	m_drawCallCount = 0;
+	m_frameNumber = frameNumber;
+}
+
+//---------------------------------------------------------------------------------------
+RenderThread::RenderThread (
+	IRenderer & renderer,
+	size_t packetBytes
+)
+	: m_renderer (renderer),
+	  m_submittedCount (0),
+	  m_renderedCount (0),
+	  m_building (false),
+	  m_shutdown (false)
+{
+	for (auto & packet : m_packets) {
+		packet.reset (new RenderPacket (packetBytes));
+	}
+
+	// Started last, once every member it uses has been initialized.
+	m_thread = std::thread (&RenderThread::renderMain, this);
+}
+
+//---------------------------------------------------------------------------------------
+RenderThread::~RenderThread ()
+{
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		assert (!m_building);
+		m_shutdown = true;
+	}
+	m_packetSubmitted.notify_one ();
+
+	m_thread.join ();
+}
+
+//---------------------------------------------------------------------------------------
+RenderPacket & RenderThread::beginPacket ()
+{
+	std::unique_lock<std::mutex> lock (m_mutex);
+	assert (!m_building);
+
+	// The packet submitted NUM_PACKETS frames ago shares this packet's slot.
+	m_packetRendered.wait (lock, [this] {
+		return m_submittedCount - m_renderedCount < NUM_PACKETS;
+	});
+	m_building = true;
+
+	RenderPacket & packet = *m_packets[m_submittedCount % NUM_PACKETS];
+	packet.reset (m_submittedCount);
+	return packet;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderThread::submitPacket ()
+{
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		assert (m_building);
+		m_building = false;
+		++m_submittedCount;
+	}
+	m_packetSubmitted.notify_one ();
+}
+
+//---------------------------------------------------------------------------------------
+void RenderThread::flush ()
+{
+	std::unique_lock<std::mutex> lock (m_mutex);
+	m_packetRendered.wait (lock, [this] {
+		return m_renderedCount == m_submittedCount;
+	});
+}
+
+//---------------------------------------------------------------------------------------
+uint64 RenderThread::framesRendered () const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	return m_renderedCount;
+}
+
+//---------------------------------------------------------------------------------------
+void RenderThread::renderMain ()
+{
+	Profiler::SetThreadName ("Render");
+
+	std::unique_lock<std::mutex> lock (m_mutex);
+	while (true) {
+		m_packetSubmitted.wait (lock, [this] {
+			return m_shutdown || m_renderedCount < m_submittedCount;
+		});
+
+		// Drain submitted packets before shutting down.
+		if (m_renderedCount == m_submittedCount) {
+			break;
+		}
+
+		const RenderPacket & packet = *m_packets[m_renderedCount % NUM_PACKETS];
+		lock.unlock ();
+
+		{
+			PROFILE_ZONE ("Render");
+			packet.submit (m_renderer);
+			m_renderer.render ();
+		}
+		{
+			PROFILE_ZONE ("Present");
+			m_renderer.present ();
+		}
+
+		lock.lock ();
+		++m_renderedCount;
+		m_packetRendered.notify_all ();
+	}
+}
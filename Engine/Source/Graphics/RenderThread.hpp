@@ -0,0 +1,137 @@
+//
+// RenderThread.hpp
+//
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Core/Types.hpp"
+#include "Core/Memory.hpp"
+#include "Graphics/DrawCall.hpp"
+#include "Graphics/IRenderer.hpp"
+
+class RenderQueue;
+
+
+/// Everything the render thread needs to draw a single frame, built by the simulation
+/// thread and immutable once submitted.
+///
+/// Data referenced by the packet's draw calls, such as instance buffers, should be
+/// allocated from the packet's allocator so that it lives exactly as long as the packet.
+class RenderPacket {
+public:
+	explicit RenderPacket (
+		size_t arenaBytes
+	);
+
+	~RenderPacket ();
+
+	/// Allocator for data referenced by the packet, valid until the packet has been
+	/// rendered.
+	Allocator & allocator ();
+
+	/// Copies the draw calls of queue into the packet in their current order.
+	void setDrawCalls (
+		const RenderQueue & queue
+	);
+
+	/// Submits the packet's draw calls to renderer in order.
+	void submit (
+		IRenderer & renderer
+	) const;
+
+	uint32 drawCallCount () const;
+
+	const DrawCall & drawCall (
+		uint32 i
+	) const;
+
+	/// Number of packets begun before this one.
+	uint64 frameNumber () const;
+
+
+	/// Forbid copying of RenderPacket objects.
+	RenderPacket (const RenderPacket & other) = delete;
+	RenderPacket & operator = (const RenderPacket & other) = delete;
+
+private:
+	friend class RenderThread;
+
+	void reset (
+		uint64 frameNumber
+	);
+
+	std::unique_ptr<byte[]> m_memory;
+	LinearAllocator m_allocator;
+
+	const DrawCall * m_drawCalls;
+	uint32 m_drawCallCount;
+	uint64 m_frameNumber;
+};
+
+
+/// Renders and presents RenderPackets on a dedicated thread, so that the simulation of
+/// frame N + 1 overlaps the submission of frame N.
+///
+/// Packets cycle through a ring of IRenderer::NUM_BUFFERED_FRAMES entries.  The
+/// simulation thread fills the packet returned by beginPacket() and hands it over with
+/// submitPacket(), while the render thread submits, renders and presents packets in
+/// order.  beginPacket() blocks only once every other packet is waiting to be rendered,
+/// so CPU frame time approaches the longer of simulation and rendering rather than
+/// their sum.
+///
+/// Once constructed, renderer must only be used by the render thread.
+class RenderThread {
+public:
+	static const uint NUM_PACKETS = IRenderer::NUM_BUFFERED_FRAMES;
+
+	/// Starts the render thread.
+	/// @param packetBytes - size of each packet's allocator.
+	RenderThread (
+		IRenderer & renderer,
+		size_t packetBytes = 4194304
+	);
+
+	/// Renders every submitted packet, then stops the render thread.
+	~RenderThread ();
+
+	/// Returns an empty packet for the next frame, blocking until the render thread has
+	/// finished with it.  Must be followed by submitPacket().
+	RenderPacket & beginPacket ();
+
+	/// Queues the packet returned by the last call to beginPacket() for rendering.
+	void submitPacket ();
+
+	/// Blocks until every submitted packet has been rendered and presented.
+	void flush ();
+
+	/// Number of packets rendered and presented so far.
+	uint64 framesRendered () const;
+
+
+	/// Forbid copying of RenderThread objects.
+	RenderThread (const RenderThread & other) = delete;
+	RenderThread & operator = (const RenderThread & other) = delete;
+
+private:
+	void renderMain ();
+
+	IRenderer & m_renderer;
+	std::unique_ptr<RenderPacket> m_packets[NUM_PACKETS];
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_packetSubmitted;
+	std::condition_variable m_packetRendered;
+
+	// Packets [m_renderedCount, m_submittedCount) are waiting to be rendered.  Only
+	// written while holding m_mutex.
+	uint64 m_submittedCount;
+	uint64 m_renderedCount;
+	bool m_building;
+	bool m_shutdown;
+
+	std::thread m_thread;
+};
@@ -3,7 +3,8 @@
 #include "Graphics/ShaderUtils.hpp"
 
 CompiledShader::CompiledShader ()
-	: byteCode{nullptr, 0}
+	: byteCode{nullptr, 0},
+	  ownsByteCode (true)
 {
 
 }
@@ -11,7 +12,9 @@ CompiledShader::CompiledShader ()
 //---------------------------------------------------------------------------------------
 CompiledShader::~CompiledShader ()
 {
-	delete byteCode.pShaderBytecode;
+	if (ownsByteCode) {
+		delete byteCode.pShaderBytecode;
+	}
 }
 
 
@@ -13,6 +13,10 @@ public:
 	~CompiledShader ();
 
 	D3D12_SHADER_BYTECODE byteCode;
+
+	// True if byteCode was allocated with new, and is deleted with this object.  False
+	// if it lies in memory owned elsewhere, such as a mapped pack file.
+	bool ownsByteCode;
 };
 
 
@@ -0,0 +1,610 @@
+//
+// SoftwareRenderer.cpp
+//
+#include "pch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+#include "Core/ParallelFor.hpp"
+#include "Graphics/SoftwareRenderer.hpp"
+
+namespace
+{
+	// Number of vertices transformed by a single task.
+	const uint32 VERTICES_PER_TASK = 8192;
+
+	// Number of triangles set up and binned by a single task.
+	const uint32 TRIANGLES_PER_BATCH = 4096;
+
+	// Triangles with a vertex closer than this to the eye plane are discarded.
+	const float MIN_CLIP_W = 1e-5f;
+
+	// Matches the clear color used by D3D12Renderer::prepareRender().
+	const float CLEAR_COLOR[] = {0.0f, 0.2f, 0.4f, 1.0f};
+	const float CLEAR_DEPTH = 1.0f;
+
+	// Normalized direction towards the light, in world space.
+	const float LIGHT_DIRECTION[] = {-0.4082483f, 0.8164966f, -0.4082483f};
+	const float AMBIENT = 0.2f;
+
+	// Number of instances rasterized for drawCall.  Without instance data every instance
+	// would be identical, so only one is drawn.
+	uint32 drawnInstanceCount (
+		const DrawCall & drawCall
+	) {
+		return drawCall.instances ? drawCall.instanceCount : 1;
+	}
+
+	uint32 packColor (
+		float r,
+		float g,
+		float b,
+		float a
+	) {
+		auto toByte = [] (float c) {
+			c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+			return static_cast<uint32>(c * 255.0f + 0.5f);
+		};
+		return toByte (r) | (toByte (g) << 8) | (toByte (b) << 16) | (toByte (a) << 24);
+	}
+
+	/// Nearest-neighbour sample of texture with wrap addressing.  Writes RGB in [0, 1].
+	void sampleTexture (
+		const Texture & texture,
+		float u,
+		float v,
+		float rgb[3]
+	) {
+		u -= std::floor (u);
+		v -= std::floor (v);
+
+		uint x = std::min (static_cast<uint>(u * texture.width), texture.width - 1);
+		uint y = std::min (static_cast<uint>(v * texture.height), texture.height - 1);
+
+		const byte * texel = static_cast<const byte *>(texture.imageData) +
+			(y * texture.width + x) * texture.bytesPerPixel;
+
+		const float scale = 1.0f / 255.0f;
+		if (texture.bytesPerPixel >= 3) {
+			rgb[0] = texel[0] * scale;
+			rgb[1] = texel[1] * scale;
+			rgb[2] = texel[2] * scale;
+		}
+		else {
+			rgb[0] = rgb[1] = rgb[2] = texel[0] * scale;
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer (
+	uint framebufferWidth,
+	uint framebufferHeight,
+	JobSystem & jobSystem
+)
+	: m_jobSystem (jobSystem),
+	  m_hWindow (nullptr),
+	  m_framebufferWidth (framebufferWidth),
+	  m_framebufferHeight (framebufferHeight),
+	  m_tileCountX ((framebufferWidth + TILE_SIZE - 1) / TILE_SIZE),
+	  m_tileCountY ((framebufferHeight + TILE_SIZE - 1) / TILE_SIZE),
+	  m_colorBuffer (framebufferWidth * framebufferHeight),
+	  m_depthBuffer (framebufferWidth * framebufferHeight),
+	  m_viewProjection (math::identity ()),
+	  m_trianglesRasterized (0)
+{
+	assert (framebufferWidth > 0 && framebufferHeight > 0);
+
+	clearFramebuffer ();
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::initialize (
+	HWND hWindow
+) {
+	m_hWindow = hWindow;
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::submit (
+	const DrawCall & drawCall
+) {
+	assert (drawCall.mesh);
+	assert (drawCall.material);
+
+	m_drawCalls.push_back (drawCall);
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::setViewProjection (
+	const Matrix4 & viewProjection
+) {
+	m_viewProjection = viewProjection;
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::render ()
+{
+	//-- Compute where each draw call's vertices and triangles start.
+	m_firstVertex.resize (m_drawCalls.size () + 1);
+	m_firstTriangle.resize (m_drawCalls.size () + 1);
+	m_firstVertex[0] = 0;
+	m_firstTriangle[0] = 0;
+	for (size_t i (0); i < m_drawCalls.size (); ++i) {
+		const MeshComponent * mesh = m_drawCalls[i].mesh;
+		const uint32 instanceCount = drawnInstanceCount (m_drawCalls[i]);
+		m_firstVertex[i + 1] = m_firstVertex[i] + mesh->numVertices * instanceCount;
+		m_firstTriangle[i + 1] = m_firstTriangle[i] + (mesh->numIndices / 3) * instanceCount;
+	}
+
+	transformVertices ();
+
+	//-- Set up triangles and bin them into tiles.
+	const uint32 numTriangles = m_firstTriangle.back ();
+	const uint32 numBatches = (numTriangles + TRIANGLES_PER_BATCH - 1) / TRIANGLES_PER_BATCH;
+	const uint32 numTiles = m_tileCountX * m_tileCountY;
+
+	if (m_batches.size () < numBatches) {
+		m_batches.resize (numBatches);
+	}
+
+	ParallelFor (m_jobSystem, 0, numBatches, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 batchIndex (rangeBegin); batchIndex < rangeEnd; ++batchIndex) {
+			TriangleBatch & batch = m_batches[batchIndex];
+			batch.triangles.clear ();
+			batch.tileBins.resize (numTiles);
+			for (auto & bin : batch.tileBins) {
+				bin.clear ();
+			}
+
+			const uint32 first = batchIndex * TRIANGLES_PER_BATCH;
+			const uint32 last = std::min (first + TRIANGLES_PER_BATCH, numTriangles);
+			setupAndBinTriangles (first, last, batch);
+		}
+	});
+
+	m_trianglesRasterized = 0;
+	for (uint32 i (0); i < numBatches; ++i) {
+		m_trianglesRasterized += static_cast<uint32>(m_batches[i].triangles.size ());
+	}
+
+	// Release batches beyond this frame's count so that rasterizeTile() skips them.
+	for (uint32 i (numBatches); i < m_batches.size (); ++i) {
+		m_batches[i].triangles.clear ();
+		for (auto & bin : m_batches[i].tileBins) {
+			bin.clear ();
+		}
+	}
+
+	//-- Rasterize every tile in parallel.
+	ParallelFor (m_jobSystem, 0, numTiles, [this] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 tileIndex (rangeBegin); tileIndex < rangeEnd; ++tileIndex) {
+			rasterizeTile (tileIndex);
+		}
+	});
+
+	m_drawCalls.clear ();
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::present ()
+{
+#if defined(WIN32)
+	if (!m_hWindow) {
+		return;
+	}
+
+	BITMAPINFO bitmapInfo = {};
+	bitmapInfo.bmiHeader.biSize = sizeof (BITMAPINFOHEADER);
+	bitmapInfo.bmiHeader.biWidth = m_framebufferWidth;
+	bitmapInfo.bmiHeader.biHeight = -static_cast<LONG>(m_framebufferHeight); // Top-down rows.
+	bitmapInfo.bmiHeader.biPlanes = 1;
+	bitmapInfo.bmiHeader.biBitCount = 32;
+	bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+	// GDI expects BGRA, so swap red and blue channels.
+	std::vector<uint32> bgra (m_colorBuffer.size ());
+	for (size_t i (0); i < m_colorBuffer.size (); ++i) {
+		const uint32 c = m_colorBuffer[i];
+		bgra[i] = (c & 0xFF00FF00) | ((c & 0xFF) << 16) | ((c >> 16) & 0xFF);
+	}
+
+	HDC hdc = ::GetDC (m_hWindow);
+	::SetDIBitsToDevice (hdc, 0, 0, m_framebufferWidth, m_framebufferHeight,
+		0, 0, 0, m_framebufferHeight, bgra.data (), &bitmapInfo, DIB_RGB_COLORS);
+	::ReleaseDC (m_hWindow, hdc);
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+uint SoftwareRenderer::framebufferWidth () const
+{
+	return m_framebufferWidth;
+}
+
+//---------------------------------------------------------------------------------------
+uint SoftwareRenderer::framebufferHeight () const
+{
+	return m_framebufferHeight;
+}
+
+//---------------------------------------------------------------------------------------
+const uint32 * SoftwareRenderer::colorBuffer () const
+{
+	return m_colorBuffer.data ();
+}
+
+//---------------------------------------------------------------------------------------
+const float * SoftwareRenderer::depthBuffer () const
+{
+	return m_depthBuffer.data ();
+}
+
+//---------------------------------------------------------------------------------------
+uint32 SoftwareRenderer::trianglesRasterized () const
+{
+	return m_trianglesRasterized;
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::transformVertices ()
+{
+	const uint32 numVertices = m_firstVertex.back ();
+	m_clipPositions.resize (size_t (numVertices) * 4);
+
+	const uint32 numTasks = (numVertices + VERTICES_PER_TASK - 1) / VERTICES_PER_TASK;
+
+	ParallelFor (m_jobSystem, 0, numTasks, [&] (uint32 rangeBegin, uint32 rangeEnd) {
+		for (uint32 taskIndex (rangeBegin); taskIndex < rangeEnd; ++taskIndex) {
+			const uint32 first = taskIndex * VERTICES_PER_TASK;
+			const uint32 last = std::min (first + VERTICES_PER_TASK, numVertices);
+
+			// Find the draw call containing the first vertex of this task.
+			size_t drawIndex = std::upper_bound (
+				m_firstVertex.begin (), m_firstVertex.end (), first) - m_firstVertex.begin () - 1;
+
+			// Model-to-clip transform of the instance being processed.
+			Matrix4 transform;
+			size_t transformDraw = ~size_t (0);
+			uint32 transformInstance = 0;
+
+			for (uint32 v (first); v < last; ++v) {
+				while (v >= m_firstVertex[drawIndex + 1]) {
+					++drawIndex;
+				}
+				const DrawCall & drawCall = m_drawCalls[drawIndex];
+				const uint32 localVertex = v - m_firstVertex[drawIndex];
+				const uint32 instance = localVertex / drawCall.mesh->numVertices;
+
+				if (drawIndex != transformDraw || instance != transformInstance) {
+					transform = drawCall.instances ?
+						math::multiply (math::affine (drawCall.instances[instance].world), m_viewProjection) :
+						m_viewProjection;
+					transformDraw = drawIndex;
+					transformInstance = instance;
+				}
+
+				const Vertex & vertex =
+					drawCall.mesh->vertices[localVertex - instance * drawCall.mesh->numVertices];
+				math::transformPoint (vertex.position, transform, &m_clipPositions[size_t (v) * 4]);
+			}
+		}
+	});
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::setupAndBinTriangles (
+	uint32 firstTriangle,
+	uint32 lastTriangle,
+	TriangleBatch & batch
+) {
+	if (firstTriangle >= lastTriangle) {
+		return;
+	}
+
+	const float width = static_cast<float>(m_framebufferWidth);
+	const float height = static_cast<float>(m_framebufferHeight);
+
+	size_t drawIndex = std::upper_bound (
+		m_firstTriangle.begin (), m_firstTriangle.end (), firstTriangle) - m_firstTriangle.begin () - 1;
+
+	for (uint32 t (firstTriangle); t < lastTriangle; ++t) {
+		while (t >= m_firstTriangle[drawIndex + 1]) {
+			++drawIndex;
+		}
+		const DrawCall & drawCall = m_drawCalls[drawIndex];
+		const MeshComponent & mesh = *drawCall.mesh;
+		const uint32 trianglesPerInstance = mesh.numIndices / 3;
+		const uint32 instance = (t - m_firstTriangle[drawIndex]) / trianglesPerInstance;
+		const uint32 localTriangle = t - m_firstTriangle[drawIndex] - instance * trianglesPerInstance;
+		const uint32 firstVertex = m_firstVertex[drawIndex] + instance * mesh.numVertices;
+
+		const Vertex * vertex[3];
+		const float * clip[3];
+		for (uint k (0); k < 3; ++k) {
+			const Index index = mesh.indices[localTriangle * 3 + k];
+			vertex[k] = &mesh.vertices[index];
+			clip[k] = &m_clipPositions[size_t (firstVertex + index) * 4];
+		}
+
+		//-- Discard triangles crossing the near plane, or entirely outside the frustum.
+		if (clip[0][3] < MIN_CLIP_W || clip[1][3] < MIN_CLIP_W || clip[2][3] < MIN_CLIP_W) {
+			continue;
+		}
+		bool outside = false;
+		for (uint axis (0); axis < 2 && !outside; ++axis) {
+			outside =
+				(clip[0][axis] > clip[0][3] && clip[1][axis] > clip[1][3] && clip[2][axis] > clip[2][3]) ||
+				(clip[0][axis] < -clip[0][3] && clip[1][axis] < -clip[1][3] && clip[2][axis] < -clip[2][3]);
+		}
+		if (outside ||
+			(clip[0][2] > clip[0][3] && clip[1][2] > clip[1][3] && clip[2][2] > clip[2][3]))
+		{
+			continue;
+		}
+
+		//-- Project to screen space.
+		float x[3], y[3], z[3], invW[3];
+		for (uint k (0); k < 3; ++k) {
+			invW[k] = 1.0f / clip[k][3];
+			x[k] = (clip[k][0] * invW[k] * 0.5f + 0.5f) * width;
+			y[k] = (0.5f - clip[k][1] * invW[k] * 0.5f) * height;
+			z[k] = clip[k][2] * invW[k];
+		}
+
+		// Counter-clockwise front faces become clockwise once y is flipped to point
+		// down the screen, giving them a negative signed area.
+		const float signedArea = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+		if (signedArea >= 0.0f) {
+			continue;
+		}
+
+		// Reorder vertices so the triangle has positive area.
+		const uint order[3] = {0, 2, 1};
+
+		TriangleSetup setup;
+		setup.minX = std::max (0, static_cast<int>(std::floor (std::min ({x[0], x[1], x[2]}))));
+		setup.minY = std::max (0, static_cast<int>(std::floor (std::min ({y[0], y[1], y[2]}))));
+		setup.maxX = std::min (static_cast<int>(m_framebufferWidth) - 1,
+			static_cast<int>(std::floor (std::max ({x[0], x[1], x[2]}))));
+		setup.maxY = std::min (static_cast<int>(m_framebufferHeight) - 1,
+			static_cast<int>(std::floor (std::max ({y[0], y[1], y[2]}))));
+		if (setup.minX > setup.maxX || setup.minY > setup.maxY) {
+			continue;
+		}
+
+		setup.invArea = 1.0f / -signedArea;
+		setup.material = drawCall.material;
+
+		// Normals are rotated into world space for lighting.  Instance transforms are
+		// assumed to scale uniformly, as normals are not transformed by the inverse
+		// transpose.
+		const Matrix4 world = drawCall.instances ?
+			math::affine (drawCall.instances[instance].world) : math::identity ();
+
+		for (uint k (0); k < 3; ++k) {
+			const uint i = order[k];
+			setup.z[k] = z[i];
+			setup.invW[k] = invW[i];
+
+			float normal[3];
+			math::transformDirection (vertex[i]->normal, world, normal);
+			for (uint c (0); c < 3; ++c) {
+				setup.normal[k][c] = normal[c] * invW[i];
+			}
+			setup.uv[k][0] = vertex[i]->uv_diffuse[0] * invW[i];
+			setup.uv[k][1] = vertex[i]->uv_diffuse[1] * invW[i];
+		}
+
+		// Edge k lies opposite vertex k, so that E_k / area is the barycentric weight
+		// of vertex k.
+		for (uint k (0); k < 3; ++k) {
+			const uint a = order[(k + 1) % 3];
+			const uint b = order[(k + 2) % 3];
+			const float A = y[a] - y[b];
+			const float B = x[b] - x[a];
+			setup.edgeA[k] = A;
+			setup.edgeB[k] = B;
+			setup.edgeC[k] = -(A * x[a] + B * y[a]);
+
+			// Pixel centers lying exactly on an edge belong to the triangle only for
+			// top and left edges.
+			setup.edgeTopLeft[k] = A > 0.0f || (A == 0.0f && B > 0.0f);
+		}
+
+		//-- Bin into every tile overlapped by the triangle's bounds.
+		const uint32 triangleIndex = static_cast<uint32>(batch.triangles.size ());
+		batch.triangles.push_back (setup);
+
+		const uint tileMinX = setup.minX / TILE_SIZE;
+		const uint tileMaxX = setup.maxX / TILE_SIZE;
+		const uint tileMinY = setup.minY / TILE_SIZE;
+		const uint tileMaxY = setup.maxY / TILE_SIZE;
+		for (uint ty (tileMinY); ty <= tileMaxY; ++ty) {
+			for (uint tx (tileMinX); tx <= tileMaxX; ++tx) {
+				batch.tileBins[ty * m_tileCountX + tx].push_back (triangleIndex);
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::rasterizeTile (
+	uint32 tileIndex
+) {
+	const int tileMinX = (tileIndex % m_tileCountX) * TILE_SIZE;
+	const int tileMinY = (tileIndex / m_tileCountX) * TILE_SIZE;
+	const int tileMaxX = std::min (tileMinX + int (TILE_SIZE), int (m_framebufferWidth)) - 1;
+	const int tileMaxY = std::min (tileMinY + int (TILE_SIZE), int (m_framebufferHeight)) - 1;
+
+	//-- Clear this tile's region of the framebuffer.
+	const uint32 clearColor =
+		packColor (CLEAR_COLOR[0], CLEAR_COLOR[1], CLEAR_COLOR[2], CLEAR_COLOR[3]);
+	for (int y (tileMinY); y <= tileMaxY; ++y) {
+		const size_t rowStart = size_t (y) * m_framebufferWidth;
+		std::fill (&m_colorBuffer[rowStart + tileMinX], &m_colorBuffer[rowStart + tileMaxX] + 1, clearColor);
+		std::fill (&m_depthBuffer[rowStart + tileMinX], &m_depthBuffer[rowStart + tileMaxX] + 1, CLEAR_DEPTH);
+	}
+
+	//-- Rasterize binned triangles in submission order.
+	for (const TriangleBatch & batch : m_batches) {
+		if (batch.tileBins.empty ()) {
+			continue;
+		}
+		for (uint32 triangleIndex : batch.tileBins[tileIndex]) {
+			rasterizeTriangle (batch.triangles[triangleIndex],
+				tileMinX, tileMinY, tileMaxX, tileMaxY);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::rasterizeTriangle (
+	const TriangleSetup & triangle,
+	int tileMinX,
+	int tileMinY,
+	int tileMaxX,
+	int tileMaxY
+) {
+	// Tiles are a multiple of 4 pixels wide, so aligning down to 4 stays in the tile.
+	const int minX = std::max (triangle.minX, tileMinX) & ~3;
+	const int maxX = std::min (triangle.maxX, tileMaxX);
+	const int minY = std::max (triangle.minY, tileMinY);
+	const int maxY = std::min (triangle.maxY, tileMaxY);
+
+	const __m128 laneOffsets = _mm_setr_ps (0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128i laneIndices = _mm_setr_epi32 (0, 1, 2, 3);
+	const __m128i lastX = _mm_set1_epi32 (maxX);
+	const __m128 zero = _mm_setzero_ps ();
+
+	__m128 edgeA[3];
+	__m128 topLeftMask[3];
+	for (uint k (0); k < 3; ++k) {
+		edgeA[k] = _mm_set1_ps (triangle.edgeA[k]);
+		topLeftMask[k] = _mm_castsi128_ps (_mm_set1_epi32 (triangle.edgeTopLeft[k] ? -1 : 0));
+	}
+
+	const __m128 invArea = _mm_set1_ps (triangle.invArea);
+	const __m128 z0 = _mm_set1_ps (triangle.z[0]);
+	const __m128 dz1 = _mm_set1_ps (triangle.z[1] - triangle.z[0]);
+	const __m128 dz2 = _mm_set1_ps (triangle.z[2] - triangle.z[0]);
+
+	for (int y (minY); y <= maxY; ++y) {
+		const float py = y + 0.5f;
+
+		// Edge function values at x = 0 for this row.
+		__m128 rowEdge[3];
+		for (uint k (0); k < 3; ++k) {
+			rowEdge[k] = _mm_set1_ps (triangle.edgeB[k] * py + triangle.edgeC[k]);
+		}
+
+		float * depthRow = &m_depthBuffer[size_t (y) * m_framebufferWidth];
+		uint32 * colorRow = &m_colorBuffer[size_t (y) * m_framebufferWidth];
+
+		for (int x (minX); x <= maxX; x += 4) {
+			const __m128 px = _mm_add_ps (_mm_set1_ps (static_cast<float>(x)), laneOffsets);
+
+			__m128 edge[3];
+			__m128 coverage = _mm_castsi128_ps (_mm_cmplt_epi32 (
+				_mm_add_epi32 (_mm_set1_epi32 (x), laneIndices),
+				_mm_add_epi32 (lastX, _mm_set1_epi32 (1))
+			));
+			for (uint k (0); k < 3; ++k) {
+				edge[k] = _mm_add_ps (_mm_mul_ps (edgeA[k], px), rowEdge[k]);
+				const __m128 inside = _mm_or_ps (
+					_mm_cmpgt_ps (edge[k], zero),
+					_mm_and_ps (_mm_cmpeq_ps (edge[k], zero), topLeftMask[k])
+				);
+				coverage = _mm_and_ps (coverage, inside);
+			}
+			if (_mm_movemask_ps (coverage) == 0) {
+				continue;
+			}
+
+			const __m128 b1 = _mm_mul_ps (edge[1], invArea);
+			const __m128 b2 = _mm_mul_ps (edge[2], invArea);
+			const __m128 z = _mm_add_ps (z0,
+				_mm_add_ps (_mm_mul_ps (b1, dz1), _mm_mul_ps (b2, dz2)));
+
+			// Gather depth, avoiding reads past the end of the row.
+			alignas(16) float depth[4];
+			const int lanes = std::min (4, maxX - x + 1);
+			if (lanes == 4) {
+				_mm_store_ps (depth, _mm_loadu_ps (&depthRow[x]));
+			}
+			else {
+				for (int i (0); i < 4; ++i) {
+					depth[i] = i < lanes ? depthRow[x + i] : 0.0f;
+				}
+			}
+
+			const __m128 pass = _mm_and_ps (coverage, _mm_cmplt_ps (z, _mm_load_ps (depth)));
+			int passMask = _mm_movemask_ps (pass);
+			if (passMask == 0) {
+				continue;
+			}
+
+			alignas(16) float zLanes[4], b1Lanes[4], b2Lanes[4];
+			_mm_store_ps (zLanes, z);
+			_mm_store_ps (b1Lanes, b1);
+			_mm_store_ps (b2Lanes, b2);
+
+			while (passMask) {
+				const int lane = math::countTrailingZeros (passMask);
+				passMask &= passMask - 1;
+
+				depthRow[x + lane] = zLanes[lane];
+				colorRow[x + lane] = shadePixel (triangle,
+					1.0f - b1Lanes[lane] - b2Lanes[lane], b1Lanes[lane], b2Lanes[lane]);
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------
+uint32 SoftwareRenderer::shadePixel (
+	const TriangleSetup & triangle,
+	float b0,
+	float b1,
+	float b2
+) const {
+	// Recover perspective-correct attributes from their 1/w premultiplied values.
+	const float w = 1.0f / (b0 * triangle.invW[0] + b1 * triangle.invW[1] + b2 * triangle.invW[2]);
+
+	float normal[3];
+	for (uint c (0); c < 3; ++c) {
+		normal[c] = (b0 * triangle.normal[0][c] + b1 * triangle.normal[1][c] +
+			b2 * triangle.normal[2][c]) * w;
+	}
+	const float u = (b0 * triangle.uv[0][0] + b1 * triangle.uv[1][0] + b2 * triangle.uv[2][0]) * w;
+	const float v = (b0 * triangle.uv[0][1] + b1 * triangle.uv[1][1] + b2 * triangle.uv[2][1]) * w;
+
+	float rgb[3] = {1.0f, 1.0f, 1.0f};
+	const Texture & texture = triangle.material->texture;
+	if (texture.imageData && texture.width > 0 && texture.height > 0) {
+		sampleTexture (texture, u, v, rgb);
+	}
+
+	float diffuse = 1.0f;
+	const float lengthSquared =
+		normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+	if (lengthSquared > 0.0f) {
+		const float nDotL = (normal[0] * LIGHT_DIRECTION[0] + normal[1] * LIGHT_DIRECTION[1] +
+			normal[2] * LIGHT_DIRECTION[2]) / std::sqrt (lengthSquared);
+		diffuse = AMBIENT + (1.0f - AMBIENT) * std::max (nDotL, 0.0f);
+	}
+
+	return packColor (rgb[0] * diffuse, rgb[1] * diffuse, rgb[2] * diffuse, 1.0f);
+}
+
+//---------------------------------------------------------------------------------------
+void SoftwareRenderer::clearFramebuffer ()
+{
+	const uint32 clearColor =
+		packColor (CLEAR_COLOR[0], CLEAR_COLOR[1], CLEAR_COLOR[2], CLEAR_COLOR[3]);
+	std::fill (m_colorBuffer.begin (), m_colorBuffer.end (), clearColor);
+	std::fill (m_depthBuffer.begin (), m_depthBuffer.end (), CLEAR_DEPTH);
+}
@@ -0,0 +1,161 @@
+//
+// SoftwareRenderer.hpp
+//
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Core/MathUtils.hpp"
+#include "Graphics/IRenderer.hpp"
+#include "Graphics/DrawCall.hpp"
+
+class JobSystem;
+
+
+/// Renderer that rasterizes triangles on the CPU, requiring no graphics device.
+///
+/// Triangles are set up and binned into screen tiles, after which each tile is
+/// rasterized independently across the threads of a JobSystem.  Rasterization state
+/// mirrors the pipeline state of D3D12Renderer: counter-clockwise front faces with
+/// back-face culling, and a D32_FLOAT depth buffer cleared to 1.0 using a LESS depth
+/// test.
+///
+/// render() must be called from the thread that constructed the JobSystem, or from
+/// within a job, so not from a RenderThread.
+///
+/// Triangles that cross the near plane are discarded rather than clipped.
+class SoftwareRenderer : public IRenderer {
+public:
+	/// Width and height of square screen tiles, in pixels.
+	static const uint TILE_SIZE = 64;
+
+	SoftwareRenderer (
+		uint framebufferWidth,
+		uint framebufferHeight,
+		JobSystem & jobSystem
+	);
+
+	/// Associates the renderer with hWindow so present() can blit the color buffer
+	/// into it.  hWindow may be nullptr for headless rendering.
+	void initialize (
+		HWND hWindow
+	) override;
+
+	void submit (
+		const DrawCall & drawCall
+	) override;
+
+	/// Rasterizes all draw calls submitted since the last call to render().
+	void render () override;
+
+	void present () override;
+
+	/// Sets the transform from world space to clip space.  Draw calls carrying instance
+	/// data first transform each instance's vertices into world space; otherwise vertices
+	/// are assumed to already be in world space.
+	void setViewProjection (
+		const Matrix4 & viewProjection
+	);
+
+	uint framebufferWidth () const;
+
+	uint framebufferHeight () const;
+
+	/// RGBA8 color buffer, stored row by row with framebufferWidth() pixels per row.
+	const uint32 * colorBuffer () const;
+
+	/// Depth buffer, stored with the same layout as the color buffer.
+	const float * depthBuffer () const;
+
+	/// Number of triangles that survived culling during the last call to render().
+	uint32 trianglesRasterized () const;
+
+
+private:
+	/// Triangle in screen space, ready for rasterization.
+	struct TriangleSetup {
+		// Edge function coefficients: E(x, y) = A * x + B * y + C.
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		bool edgeTopLeft[3];
+
+		float invArea;
+
+		// Depth and 1/w at each vertex.
+		float z[3];
+		float invW[3];
+
+		// Attributes at each vertex, premultiplied by 1/w for perspective correction.
+		float normal[3][3];
+		float uv[3][2];
+
+		// Inclusive pixel bounds.
+		int minX, minY, maxX, maxY;
+
+		const Material * material;
+	};
+
+	/// Triangles set up by a single binning task, along with their per-tile bins.
+	struct TriangleBatch {
+		std::vector<TriangleSetup> triangles;
+		std::vector<std::vector<uint32>> tileBins;
+	};
+
+	void transformVertices ();
+
+	void setupAndBinTriangles (
+		uint32 firstTriangle,
+		uint32 lastTriangle,
+		TriangleBatch & batch
+	);
+
+	void rasterizeTile (
+		uint32 tileIndex
+	);
+
+	void rasterizeTriangle (
+		const TriangleSetup & triangle,
+		int tileMinX,
+		int tileMinY,
+		int tileMaxX,
+		int tileMaxY
+	);
+
+	uint32 shadePixel (
+		const TriangleSetup & triangle,
+		float b0,
+		float b1,
+		float b2
+	) const;
+
+	void clearFramebuffer ();
+
+	JobSystem & m_jobSystem;
+	HWND m_hWindow;
+
+	uint m_framebufferWidth;
+	uint m_framebufferHeight;
+	uint m_tileCountX;
+	uint m_tileCountY;
+
+	std::vector<uint32> m_colorBuffer;
+	std::vector<float> m_depthBuffer;
+
+	Matrix4 m_viewProjection;
+
+	std::vector<DrawCall> m_drawCalls;
+
+	// First entry of each draw call within m_clipPositions and the global triangle
+	// index space.  Both contain one extra entry holding the totals.
+	std::vector<uint32> m_firstVertex;
+	std::vector<uint32> m_firstTriangle;
+
+	// Clip space position (x, y, z, w) of every vertex of every draw call.
+	std::vector<float> m_clipPositions;
+
+	std::vector<TriangleBatch> m_batches;
+
+	uint32 m_trianglesRasterized;
+};
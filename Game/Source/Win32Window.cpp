@@ -62,15 +62,13 @@ int Win32Window::Run (
 	::ShowWindow (_hWindow, nCmdShow);
 
     //-- Timing information:
-    static uint32 frameCount(0);
-    static float fpsTimer(0.f);
+    FrameStats frameStats;
+    auto frameStart = std::chrono::high_resolution_clock::now();
 
 	// Main sample loop.
 	MSG msg = {0};
 	while (msg.message != WM_QUIT)
 	{
-        // Start frame timer.
-        auto timerStart = std::chrono::high_resolution_clock::now();
         // Process any messages in the queue.
         if (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
         {
@@ -81,30 +79,30 @@ int Win32Window::Run (
             ::DispatchMessage(&msg);
         }
 
+        auto tickStart = std::chrono::high_resolution_clock::now();
 		game->update ();
+        auto frameEnd = std::chrono::high_resolution_clock::now();
 
-        // End frame timer.
-        auto timerEnd = std::chrono::high_resolution_clock::now();
-        ++frameCount;
+        // Frames are timed end to end, so no time between them goes unrecorded.
+        double frameMs = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+        double tickMs = std::chrono::duration<double, std::milli>(frameEnd - tickStart).count();
+        frameStart = frameEnd;
 
-        auto timeDelta = std::chrono::duration<double, std::milli>(timerEnd - timerStart).count();
-        fpsTimer += static_cast<float>(timeDelta);
-
-        //-- Update window title only after so many milliseconds:
-        if (fpsTimer > 400.0f) {
-			float msPerFrame = fpsTimer / float(frameCount);
-            float fps = float(frameCount) / fpsTimer * 1000.0f;
+        //-- Update window title each time a window of frames completes:
+        if (frameStats.recordFrame(frameMs, tickMs)) {
+            const FrameStatsWindow & window = frameStats.windows().back();
+            float fps = float(window.frame.frames) / float(window.milliseconds) * 1000.0f;
             char buffer[256];
-			sprintf_s(buffer, 256, "%s - %.1f fps (%.2f ms)", 
-				game->getWindowTitle(), fps, msPerFrame);
+			sprintf_s(buffer, 256, "%s - %.1f fps (p50 %.2f ms, p99 %.2f ms, max %.2f ms)",
+				game->getWindowTitle(), fps, window.frame.p50, window.frame.p99,
+				window.frame.max);
             ::SetWindowText(_hWindow, buffer);
-
-            // Reset timing info.
-            fpsTimer = 0.0f;
-            frameCount = 0;
         }
 	}
 
+	frameStats.saveCsv("FrameStats.csv");
+	frameStats.saveJson("FrameStats.json");
+
 	// Return this part of the WM_QUIT message to Windows.
 	return static_cast<char>(msg.wParam);
 }
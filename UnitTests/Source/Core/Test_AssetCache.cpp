@@ -0,0 +1,128 @@
+//
+// Test_AssetCache.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Engine/Source/Core/AssetCache.hpp"
+
+
+namespace
+{
+	const uint32 TYPE = 1;
+
+	/// Acquires the asset under key, setting it to value and its size to size if it
+	/// was added.
+	AssetHandle<uint> acquire (
+		AssetCache & cache,
+		uint64 key,
+		uint value,
+		size_t size
+	) {
+		bool added;
+		AssetHandle<uint> handle = cache.acquire<uint> (key, TYPE, added);
+		if (added) {
+			handle.record ()->asset = value;
+			cache.setSize (key, size);
+			handle.record ()->complete (true);
+		}
+		return handle;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (AssetCache, counts_hits_and_misses)
+{
+	AssetCache cache;
+
+	bool added;
+	AssetHandle<uint> first = cache.acquire<uint> (1, TYPE, added);
+	EXPECT_TRUE (added);
+	EXPECT_TRUE (first.isLoading ());
+
+	AssetHandle<uint> second = cache.acquire<uint> (1, TYPE, added);
+	EXPECT_FALSE (added);
+	EXPECT_EQ (first, second);
+
+	// The handles, and the cache.
+	EXPECT_EQ (3u, first.record ()->referenceCount ());
+
+	cache.setSize (1, 100);
+	const AssetCacheStats stats = cache.stats (TYPE);
+	EXPECT_EQ (1u, stats.hits);
+	EXPECT_EQ (1u, stats.misses);
+	EXPECT_EQ (0u, stats.evictions);
+	EXPECT_EQ (1u, stats.numAssets);
+	EXPECT_EQ (100u, stats.size);
+	EXPECT_EQ (AssetCache::UNLIMITED, stats.budget);
+	EXPECT_EQ (0u, cache.stats (TYPE + 1).numAssets);
+}
+
+TEST (AssetCache, evicts_least_recently_used_unreferenced_assets)
+{
+	// Outlives the cache, which evicts what remains when destroyed.
+	std::vector<uint> evicted;
+	AssetCache cache;
+	cache.setEvictionCallback (TYPE, [&evicted] (AssetRecord & record) {
+		evicted.push_back (static_cast<AssetRecordOf<uint> &>(record).asset);
+	});
+	cache.setBudget (TYPE, 300);
+
+	AssetHandle<uint> held = acquire (cache, 1, 10, 100);
+	acquire (cache, 2, 20, 100);
+	acquire (cache, 3, 30, 100);
+	acquire (cache, 2, 0, 0);
+	EXPECT_TRUE (evicted.empty ());
+
+	// Over budget, so the least recently used of those unreferenced goes once the size
+	// is known.
+	acquire (cache, 4, 40, 100);
+	EXPECT_TRUE (evicted.empty ());
+	cache.trim ();
+	ASSERT_EQ (1u, evicted.size ());
+	EXPECT_EQ (30u, evicted[0]);
+
+	AssetCacheStats stats = cache.stats (TYPE);
+	EXPECT_EQ (1u, stats.evictions);
+	EXPECT_EQ (3u, stats.numAssets);
+	EXPECT_EQ (300u, stats.size);
+
+	// Referenced assets stay over budget.
+	cache.setBudget (TYPE, 0);
+	EXPECT_EQ ((std::vector<uint> {30, 20, 40}), evicted);
+	stats = cache.stats (TYPE);
+	EXPECT_EQ (1u, stats.numAssets);
+	EXPECT_EQ (100u, stats.size);
+	EXPECT_EQ (2u, held.record ()->referenceCount ());
+
+	// An evicted asset is loaded again.
+	bool added;
+	AssetHandle<uint> reloaded = cache.acquire<uint> (3, TYPE, added);
+	EXPECT_TRUE (added);
+	reloaded.record ()->complete (false);
+}
+
+TEST (AssetCache, clear_evicts_referenced_assets)
+{
+	uint evicted = 0;
+	AssetCache cache;
+	cache.setEvictionCallback (TYPE, [&evicted] (AssetRecord &) { ++evicted; });
+	cache.setBudget (TYPE, 1000);
+
+	AssetHandle<uint> held = acquire (cache, 1, 10, 100);
+	acquire (cache, 2, 20, 100);
+	cache.clear ();
+
+	EXPECT_EQ (2u, evicted);
+	EXPECT_EQ (1u, held.record ()->referenceCount ());
+	EXPECT_EQ (10u, *held);
+
+	const AssetCacheStats stats = cache.stats (TYPE);
+	EXPECT_EQ (0u, stats.misses);
+	EXPECT_EQ (0u, stats.numAssets);
+	EXPECT_EQ (0u, stats.size);
+	EXPECT_EQ (1000u, stats.budget);
+}
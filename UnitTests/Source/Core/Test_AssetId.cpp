@@ -0,0 +1,70 @@
+//
+// Test_AssetId.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "Engine/Source/Core/AssetId.hpp"
+#include "Engine/Source/Core/PackFile.hpp"
+
+
+namespace
+{
+	constexpr AssetId SHIP_MODEL ("low_poly_ship");
+
+	// Hashed while compiling.
+	static_assert (SHIP_MODEL.hash () == 0x8cb29482b3e2a363ull, "FNV-1a of low_poly_ship");
+	static_assert (SHIP_MODEL.hashWithExtension (".mesh") == 0x1a972b6669af532aull,
+		"FNV-1a of low_poly_ship.mesh");
+	static_assert (AssetId ("").hash () == asset_id::FNV_OFFSET_BASIS, "FNV-1a of nothing");
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (AssetId, equal_names_at_different_addresses_are_equal)
+{
+	const std::string name ("low_poly_ship");
+	char copy[32];
+	std::strcpy (copy, name.c_str ());
+
+	EXPECT_EQ (SHIP_MODEL, AssetId (name.c_str ()));
+	EXPECT_EQ (SHIP_MODEL, AssetId (copy));
+	EXPECT_NE (SHIP_MODEL, AssetId ("low_poly_ship_diffuse"));
+}
+
+TEST (AssetId, hash_with_extension_is_pack_file_key)
+{
+	EXPECT_EQ (HashAssetName ("low_poly_ship.mesh"), SHIP_MODEL.hashWithExtension (".mesh"));
+	EXPECT_EQ (HashAssetName ("low_poly_ship", ".texture"),
+		SHIP_MODEL.hashWithExtension (".texture"));
+}
+
+TEST (AssetId, finds_registered_names_in_debug_builds)
+{
+	const AssetId id ("Test_AssetId_registered");
+	EXPECT_EQ (nullptr, FindAssetName (id.hash ()));
+
+	EXPECT_TRUE (RegisterAssetName (id));
+	EXPECT_TRUE (RegisterAssetName (id));
+#if defined(_DEBUG)
+	EXPECT_STREQ ("Test_AssetId_registered", id.name ());
+	EXPECT_STREQ ("Test_AssetId_registered", FindAssetName (id.hash ()));
+#else
+	EXPECT_STREQ ("", id.name ());
+	EXPECT_EQ (nullptr, FindAssetName (id.hash ()));
+#endif
+}
+
+TEST (AssetId, cooking_rejects_names_added_twice)
+{
+	// "costarring" and "liquid" are a known 32-bit FNV-1a collision, but differ in 64 bits.
+	const byte data[] = {0};
+	PackWriter writer;
+	EXPECT_TRUE (writer.add ("costarring", data, 1));
+	EXPECT_TRUE (writer.add ("liquid", data, 1));
+	EXPECT_FALSE (writer.add ("liquid", data, 1));
+	EXPECT_EQ (2u, writer.numAssets ());
+}
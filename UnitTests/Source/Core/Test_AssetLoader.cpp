@@ -0,0 +1,235 @@
+//
+// Test_AssetLoader.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Engine/Source/Core/AssetLoader.hpp"
+
+
+namespace
+{
+	const char * PACK_PATH = "Test_AssetLoader.pack";
+
+	const byte VERTEX_SHADER_CODE[] = {'D', 'X', 'B', 'C', 'v', 's'};
+
+	/// Writes a pack holding a vertex shader, and a triangle with a material and texture.
+	void writeTestPack ()
+	{
+		PackWriter writer;
+		std::vector<byte> blob;
+
+		CookShader (VERTEX_SHADER_CODE, sizeof (VERTEX_SHADER_CODE), blob);
+		writer.add ("VertexShader.shader", blob.data (), blob.size ());
+
+		Vertex vertices[3] = {};
+		vertices[2].position[1] = 1.0f;
+		Index indices[3] = {0, 1, 2};
+		const MeshComponent mesh = {3, 3, vertices, indices};
+		CookMesh (mesh, blob);
+		writer.add ("triangle.mesh", blob.data (), blob.size ());
+
+		ObjMaterial material = {};
+		material.opacity = 0.5f;
+		CookMaterial (material, "checker", blob);
+		writer.add ("triangle.material", blob.data (), blob.size ());
+
+		const byte pixels[2 * 2 * 4] = {255, 0, 0, 255};
+		CookTexture (pixels, 2, 2, blob);
+		writer.add ("checker.texture", blob.data (), blob.size ());
+
+		ASSERT_TRUE (writer.write (PACK_PATH));
+	}
+
+	class AssetLoaderTest : public ::testing::Test {
+	protected:
+		void SetUp () override
+		{
+			writeTestPack ();
+			ASSERT_TRUE (AssetLoader::mount (PACK_PATH));
+		}
+
+		void TearDown () override
+		{
+			AssetLoader::setJobSystem (nullptr);
+			AssetLoader::unmount ();
+			std::remove (PACK_PATH);
+		}
+	};
+
+	/// Counts instances destroyed.
+	struct Counted {
+		static uint destroyed;
+
+		~Counted ()
+		{
+			++destroyed;
+		}
+	};
+
+	uint Counted::destroyed = 0;
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (AssetHandle, counts_references_intrusively)
+{
+	Counted::destroyed = 0;
+	{
+		AssetHandle<Counted> handle = AssetHandle<Counted>::MakeReady ();
+		EXPECT_TRUE (handle.isReady ());
+		EXPECT_EQ (1u, handle.record ()->referenceCount ());
+
+		AssetHandle<Counted> copy (handle);
+		EXPECT_EQ (handle, copy);
+		EXPECT_EQ (2u, handle.record ()->referenceCount ());
+
+		AssetHandle<Counted> moved (std::move (copy));
+		EXPECT_FALSE (copy.isValid ());
+		EXPECT_EQ (2u, handle.record ()->referenceCount ());
+
+		moved = AssetHandle<Counted> ();
+		EXPECT_EQ (1u, handle.record ()->referenceCount ());
+		EXPECT_EQ (0u, Counted::destroyed);
+	}
+	EXPECT_EQ (1u, Counted::destroyed);
+}
+
+TEST (AssetHandle, continuations_run_once_complete)
+{
+	AssetHandle<uint> handle (AssetRecordOf<uint>::Create ());
+	EXPECT_TRUE (handle.isLoading ());
+	EXPECT_EQ (nullptr, handle.get ());
+
+	uint calls = 0;
+	handle.then ([&calls] (const AssetHandle<uint> & loaded) {
+		EXPECT_TRUE (loaded.isReady ());
+		++calls;
+	});
+	EXPECT_EQ (0u, calls);
+
+	// The pending continuation holds a reference.
+	EXPECT_EQ (2u, handle.record ()->referenceCount ());
+	handle.record ()->complete (true);
+	EXPECT_EQ (1u, calls);
+	EXPECT_EQ (1u, handle.record ()->referenceCount ());
+
+	handle.then ([&calls] (const AssetHandle<uint> &) { ++calls; });
+	EXPECT_EQ (2u, calls);
+}
+
+TEST_F (AssetLoaderTest, loads_on_calling_thread_without_job_system)
+{
+	AssetHandle<CompiledShader> shader = AssetLoader::load<CompiledShader> ("VertexShader");
+	ASSERT_TRUE (shader.isReady ());
+	ASSERT_EQ (sizeof (VERTEX_SHADER_CODE), shader->byteCode.BytecodeLength);
+	EXPECT_EQ (0, std::memcmp (VERTEX_SHADER_CODE, shader->byteCode.pShaderBytecode,
+		sizeof (VERTEX_SHADER_CODE)));
+
+	AssetHandle<CompiledShader> missing = AssetLoader::load<CompiledShader> ("PixelShader");
+	EXPECT_TRUE (missing.hasFailed ());
+	EXPECT_EQ (nullptr, missing.get ());
+}
+
+TEST_F (AssetLoaderTest, loads_each_asset_once)
+{
+	const std::string name ("VertexShader");
+	AssetHandle<CompiledShader> first = AssetLoader::load<CompiledShader> ("VertexShader");
+	AssetHandle<CompiledShader> second = AssetLoader::load<CompiledShader> (name.c_str ());
+	EXPECT_EQ (first, second);
+
+	// The handles, and the loader.
+	EXPECT_EQ (3u, first.record ()->referenceCount ());
+	AssetLoader::unmount ();
+	EXPECT_EQ (2u, first.record ()->referenceCount ());
+}
+
+TEST_F (AssetLoaderTest, loads_on_job_system)
+{
+	JobSystem jobSystem (2);
+	AssetLoader::setJobSystem (&jobSystem);
+
+	std::atomic<uint> continued (0);
+	std::vector<AssetHandle<ObjAsset>> handles;
+	for (uint i (0); i < 100; ++i) {
+		handles.push_back (AssetLoader::load<ObjAsset> (i % 2 ? "triangle" : "missing"));
+		handles.back ().then ([&continued] (const AssetHandle<ObjAsset> & handle) {
+			EXPECT_NE (AssetState::Loading, handle.state ());
+			++continued;
+		});
+	}
+
+	AssetLoader::wait (handles[1]);
+	EXPECT_FALSE (handles[1].isLoading ());
+	AssetLoader::waitAll ();
+	EXPECT_EQ (100u, continued.load ());
+
+	ASSERT_TRUE (handles[1].isReady ());
+	EXPECT_EQ (handles[1], handles[99]);
+	EXPECT_TRUE (handles[0].hasFailed ());
+
+	const ObjAsset & triangle = *handles[1];
+	EXPECT_EQ (3u, triangle.mesh.numIndices);
+	EXPECT_EQ (1.0f, triangle.mesh.vertices[2].position[1]);
+	EXPECT_EQ (0.5f, triangle.material.opacity);
+	EXPECT_STREQ ("checker", triangle.material.diffuseMap);
+	EXPECT_EQ (2u, triangle.texture.width);
+	EXPECT_EQ (2u, triangle.texture.mipLevels);
+	EXPECT_EQ (255, static_cast<const byte *>(triangle.texture.imageData)[0]);
+}
+
+TEST_F (AssetLoaderTest, wait_returns_once_its_own_asset_completes)
+{
+	// Without workers, loads only progress while the calling thread waits, taking the
+	// newest first.
+	JobSystem jobSystem (0);
+	AssetLoader::setJobSystem (&jobSystem);
+
+	AssetHandle<CompiledShader> shader = AssetLoader::load<CompiledShader> ("VertexShader");
+	AssetHandle<ObjAsset> triangle = AssetLoader::load<ObjAsset> ("triangle");
+	AssetLoader::wait (triangle);
+	EXPECT_TRUE (triangle.isReady ());
+	EXPECT_TRUE (shader.isLoading ());
+
+	AssetLoader::wait (shader);
+	EXPECT_TRUE (shader.isReady ());
+}
+
+TEST_F (AssetLoaderTest, evicts_unreferenced_assets_over_budget)
+{
+	uint evicted = 0;
+	AssetLoader::setEvictionCallback<CompiledShader> ([&evicted] (const CompiledShader & shader) {
+		EXPECT_EQ (sizeof (VERTEX_SHADER_CODE), shader.byteCode.BytecodeLength);
+		++evicted;
+	});
+	AssetLoader::setBudget (CookedAssetType::Shader, 0);
+
+	AssetHandle<CompiledShader> shader = AssetLoader::load<CompiledShader> ("VertexShader");
+	ASSERT_TRUE (shader.isReady ());
+	AssetLoader::load<CompiledShader> ("VertexShader");
+	AssetLoader::trim ();
+	EXPECT_EQ (0u, evicted);
+
+	AssetCacheStats stats = AssetLoader::stats (CookedAssetType::Shader);
+	EXPECT_EQ (1u, stats.hits);
+	EXPECT_EQ (1u, stats.misses);
+	EXPECT_EQ (1u, stats.numAssets);
+	EXPECT_LT (sizeof (VERTEX_SHADER_CODE), stats.size);
+
+	shader = AssetHandle<CompiledShader> ();
+	AssetLoader::trim ();
+	EXPECT_EQ (1u, evicted);
+	stats = AssetLoader::stats (CookedAssetType::Shader);
+	EXPECT_EQ (1u, stats.evictions);
+	EXPECT_EQ (0u, stats.numAssets);
+	EXPECT_EQ (0u, stats.size);
+
+	AssetLoader::setEvictionCallback<CompiledShader> (nullptr);
+	AssetLoader::setBudget (CookedAssetType::Shader, AssetCache::UNLIMITED);
+}
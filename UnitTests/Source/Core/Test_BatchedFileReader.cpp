@@ -0,0 +1,202 @@
+//
+// Test_BatchedFileReader.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Source/Core/BatchedFileReader.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Core/PackFile.hpp"
+
+
+namespace
+{
+	const char * FILE_PATH = "Test_BatchedFileReader.bin";
+
+	byte patternAt (
+		uint64 offset
+	) {
+		return static_cast<byte>((offset * 131) >> 3);
+	}
+
+	void writePatternFile (
+		const char * path,
+		size_t size
+	) {
+		std::vector<byte> data (size);
+		for (size_t i (0); i < size; ++i) {
+			data[i] = patternAt (i);
+		}
+		std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write (reinterpret_cast<const char *>(data.data ()), data.size ());
+	}
+
+	/// Linear allocator over heap storage, reset before the storage is freed.
+	class TestAllocator {
+	public:
+		explicit TestAllocator (
+			size_t size
+		)
+			: _storage (size),
+			  _allocator (_storage.data (), size)
+		{
+
+		}
+
+		~TestAllocator ()
+		{
+			_allocator.reset ();
+		}
+
+		LinearAllocator & get ()
+		{
+			return _allocator;
+		}
+
+	private:
+		std::vector<byte> _storage;
+		LinearAllocator _allocator;
+	};
+
+	void expectRequestsRead (
+		FileReadMode mode
+	) {
+		const size_t FILE_SIZE = 300000;
+		writePatternFile (FILE_PATH, FILE_SIZE);
+
+		TestAllocator allocator (1 << 20);
+		BatchedFileReader reader (allocator.get (), 3, 2 * BatchedFileReader::SECTOR_SIZE);
+		ASSERT_TRUE (reader.open (FILE_PATH, mode));
+
+		// Unaligned, spanning many staging buffers, empty, at the end of the file, and
+		// past the end of the file.
+		const uint64 offsets[] = {0, 1, 4095, 12345, 100, 299990, 299990, 400000, 5000};
+		const uint64 sizes[] = {10, 4096, 2, 150000, 0, 10, 11, 1, 9000};
+		const bool expected[] = {true, true, true, true, true, true, false, false, true};
+		const uint COUNT = sizeof (offsets) / sizeof (offsets[0]);
+
+		std::vector<std::vector<byte>> destinations (COUNT);
+		FileReadRequest requests[COUNT];
+		for (uint i (0); i < COUNT; ++i) {
+			destinations[i].assign (sizes[i] + 1, 0xCD);
+			requests[i] = FileReadRequest {offsets[i], sizes[i], destinations[i].data (), false};
+		}
+
+		EXPECT_EQ (7u, reader.read (requests, COUNT));
+		for (uint i (0); i < COUNT; ++i) {
+			ASSERT_EQ (expected[i], requests[i].succeeded) << "request " << i;
+			if (!expected[i]) {
+				continue;
+			}
+			for (uint64 j (0); j < sizes[i]; ++j) {
+				ASSERT_EQ (patternAt (offsets[i] + j), destinations[i][j]) << "request " << i;
+			}
+			EXPECT_EQ (0xCD, destinations[i][sizes[i]]) << "request " << i;
+		}
+
+		// The reader can be used again.
+		EXPECT_EQ (1u, reader.read (requests, 1));
+		reader.close ();
+		std::remove (FILE_PATH);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (BatchedFileReader, reads_buffered_requests)
+{
+	expectRequestsRead (FileReadMode::Buffered);
+}
+
+TEST (BatchedFileReader, reads_unbuffered_requests)
+{
+	expectRequestsRead (FileReadMode::Unbuffered);
+}
+
+TEST (BatchedFileReader, fails_to_open_missing_file)
+{
+	TestAllocator allocator (4 << 20);
+	BatchedFileReader reader (allocator.get ());
+	EXPECT_FALSE (reader.open ("missing.bin", FileReadMode::Buffered));
+	EXPECT_FALSE (reader.isOpen ());
+}
+
+TEST (BatchedFileReaderBenchmark, DISABLED_load_10k_assets)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const uint NUM_ASSETS = 10000;
+	const char * PACK_PATH = "Test_BatchedFileReader.pack";
+
+	// Assets of 1 to 16 KB, both as loose files and in a pack.
+	PackWriter writer;
+	std::vector<std::string> names;
+	size_t totalSize = 0;
+	for (uint i (0); i < NUM_ASSETS; ++i) {
+		names.push_back ("Test_BatchedFileReader_" + std::to_string (i) + ".bin");
+		const std::vector<byte> data (1024 + (i * 7919) % (15 * 1024), byte (i));
+		std::ofstream file (names.back (), std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write (reinterpret_cast<const char *>(data.data ()), data.size ());
+		writer.add (names.back ().c_str (), data.data (), data.size ());
+		totalSize += data.size ();
+	}
+	ASSERT_TRUE (writer.write (PACK_PATH));
+
+	std::vector<byte> storage (totalSize + NUM_ASSETS * 16 + (8 << 20));
+	LinearAllocator allocator (storage.data (), storage.size ());
+	const double megabytes = totalSize / double (1 << 20);
+
+	// Each file opened and read in turn, as LoadCompiledShaderFromFile does.
+	Clock::time_point start = Clock::now ();
+	for (uint i (0); i < NUM_ASSETS; ++i) {
+		std::ifstream file (names[i], std::ios::in | std::ios::binary | std::ios::ate);
+		ASSERT_TRUE (file.is_open ());
+		const std::streamsize size = file.tellg ();
+		file.seekg (0, std::ios::beg);
+		char * bytes = static_cast<char *>(allocator.allocate (size, 16));
+		ASSERT_TRUE (file.read (bytes, size));
+	}
+	const std::chrono::duration<double> sequential = Clock::now () - start;
+	std::printf ("std::ifstream per file: %.1f MB/s\n", megabytes / sequential.count ());
+	allocator.reset ();
+
+	std::vector<FileReadRequest> requests (NUM_ASSETS);
+	{
+		PackFile pack;
+		ASSERT_TRUE (pack.open (PACK_PATH));
+		for (uint i (0); i < NUM_ASSETS; ++i) {
+			const PackEntry * entry = pack.findEntry (HashAssetName (names[i].c_str ()));
+			ASSERT_NE (nullptr, entry);
+			requests[i] = FileReadRequest {entry->offset, entry->size, nullptr, false};
+		}
+	}
+
+	const FileReadMode modes[] = {FileReadMode::Buffered, FileReadMode::Unbuffered};
+	const char * modeNames[] = {"buffered", "unbuffered"};
+	for (uint mode (0); mode < 2; ++mode) {
+		start = Clock::now ();
+		{
+			BatchedFileReader reader (allocator, 64);
+			ASSERT_TRUE (reader.open (PACK_PATH, modes[mode]));
+			for (FileReadRequest & request : requests) {
+				request.destination = allocator.allocate (static_cast<size_t>(request.size), 16);
+			}
+			ASSERT_EQ (NUM_ASSETS, reader.read (requests.data (), NUM_ASSETS));
+		}
+		const std::chrono::duration<double> batched = Clock::now () - start;
+		std::printf ("Batched %s reads from pack: %.1f MB/s\n", modeNames[mode],
+			megabytes / batched.count ());
+		allocator.reset ();
+	}
+
+	for (const std::string & name : names) {
+		std::remove (name.c_str ());
+	}
+	std::remove (PACK_PATH);
+}
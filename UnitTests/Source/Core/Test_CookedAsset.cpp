@@ -0,0 +1,340 @@
+//
+// Test_CookedAsset.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Source/Core/CookedAsset.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+
+
+namespace
+{
+	const char * COOKED_PATH = "Test_CookedAsset.bin";
+
+	/// Linear allocator over heap storage, reset before the storage is freed.
+	class TestAllocator {
+	public:
+		explicit TestAllocator (
+			size_t size
+		)
+			: _storage (size),
+			  _allocator (_storage.data (), size)
+		{
+
+		}
+
+		~TestAllocator ()
+		{
+			_allocator.reset ();
+		}
+
+		LinearAllocator & get ()
+		{
+			return _allocator;
+		}
+
+	private:
+		std::vector<byte> _storage;
+		LinearAllocator _allocator;
+	};
+
+	/// A blob copied to 16 byte aligned storage, as cooked assets are when loaded.
+	class AlignedBlob {
+	public:
+		explicit AlignedBlob (
+			const std::vector<byte> & blob
+		)
+			: _storage (blob.size () + COOKED_ALIGNMENT),
+			  _size (blob.size ())
+		{
+			_data = _storage.data () + (COOKED_ALIGNMENT -
+				reinterpret_cast<uintptr_t>(_storage.data ()) % COOKED_ALIGNMENT);
+			std::memcpy (_data, blob.data (), blob.size ());
+		}
+
+		byte * data ()
+		{
+			return _data;
+		}
+
+		size_t size () const
+		{
+			return _size;
+		}
+
+	private:
+		std::vector<byte> _storage;
+		byte * _data;
+		size_t _size;
+	};
+
+	void makeQuad (
+		std::vector<Vertex> & vertices,
+		std::vector<Index> & indices
+	) {
+		vertices.clear ();
+		for (uint i (0); i < 4; ++i) {
+			Vertex vertex = {{float (i & 1), float (i >> 1), 0.5f}, {0.0f, 0.0f, 1.0f},
+				{float (i) * 0.25f, 1.0f}};
+			vertices.push_back (vertex);
+		}
+		indices = {0, 1, 2, 2, 1, 3};
+	}
+
+	bool writeFile (
+		const char * path,
+		const void * data,
+		size_t size
+	) {
+		std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+		return static_cast<bool>(file.write (static_cast<const char *>(data), size));
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (CookedAsset, mesh_round_trips)
+{
+	std::vector<Vertex> vertices;
+	std::vector<Index> indices;
+	makeQuad (vertices, indices);
+	const MeshComponent source = {4, 6, vertices.data (), indices.data ()};
+
+	std::vector<byte> blob;
+	CookMesh (source, blob);
+	EXPECT_EQ (0u, blob.size () % COOKED_ALIGNMENT);
+
+	AlignedBlob aligned (blob);
+	MeshComponent mesh;
+	ASSERT_TRUE (ReadCookedMesh (aligned.data (), aligned.size (), mesh));
+	ASSERT_EQ (4u, mesh.numVertices);
+	ASSERT_EQ (6u, mesh.numIndices);
+	EXPECT_EQ (0, std::memcmp (vertices.data (), mesh.vertices, 4 * sizeof (Vertex)));
+	EXPECT_EQ (0, std::memcmp (indices.data (), mesh.indices, 6 * sizeof (Index)));
+
+	// The mesh refers to the blob rather than to a copy.
+	EXPECT_EQ (0u, reinterpret_cast<uintptr_t>(mesh.vertices) % COOKED_ALIGNMENT);
+	EXPECT_GT (reinterpret_cast<byte *>(mesh.vertices), aligned.data ());
+	EXPECT_LT (reinterpret_cast<byte *>(mesh.indices), aligned.data () + aligned.size ());
+}
+
+TEST (CookedAsset, texture_has_box_filtered_mips)
+{
+	// 4 x 2 pixels, whose red channel counts up and alpha is opaque.
+	std::vector<byte> pixels;
+	for (uint i (0); i < 8; ++i) {
+		const byte pixel[] = {byte (i * 10), byte (255 - i), 0, 255};
+		pixels.insert (pixels.end (), pixel, pixel + 4);
+	}
+
+	std::vector<byte> blob;
+	CookTexture (pixels.data (), 4, 2, blob);
+
+	AlignedBlob aligned (blob);
+	Texture texture;
+	ASSERT_TRUE (ReadCookedTexture (aligned.data (), aligned.size (), texture));
+	EXPECT_EQ (4u, texture.width);
+	EXPECT_EQ (2u, texture.height);
+	EXPECT_EQ (4u, texture.bytesPerPixel);
+	ASSERT_EQ (3u, texture.mipLevels);
+
+	const byte * level0 = static_cast<const byte *>(texture.imageData);
+	EXPECT_EQ (0, std::memcmp (pixels.data (), level0, pixels.size ()));
+
+	// 2 x 1, averaging 2 x 2 blocks.
+	const byte * level1 = level0 + 4 * 2 * 4;
+	EXPECT_EQ ((0 + 10 + 40 + 50 + 2) / 4, level1[0]);
+	EXPECT_EQ ((20 + 30 + 60 + 70 + 2) / 4, level1[4]);
+	EXPECT_EQ (255, level1[3]);
+
+	// 1 x 1, averaging the two pixels of the level before with themselves.
+	const byte * level2 = level1 + 2 * 1 * 4;
+	EXPECT_EQ ((2 * level1[0] + 2 * level1[4] + 2) / 4, level2[0]);
+	EXPECT_LE (level2 + 4, aligned.data () + aligned.size ());
+}
+
+TEST (CookedAsset, material_round_trips)
+{
+	ObjMaterial source = {};
+	source.ambient[0] = 0.25f;
+	source.diffuse[2] = 0.64f;
+	source.specularExponent = 96.0f;
+	source.opacity = 0.5f;
+
+	std::vector<byte> blob;
+	CookMaterial (source, "low_poly_ship_diffuse", blob);
+
+	AlignedBlob aligned (blob);
+	const CookedMaterial * material = ReadCookedMaterial (aligned.data (), aligned.size ());
+	ASSERT_NE (nullptr, material);
+	EXPECT_EQ (0.25f, material->ambient[0]);
+	EXPECT_EQ (0.64f, material->diffuse[2]);
+	EXPECT_EQ (96.0f, material->specularExponent);
+	EXPECT_EQ (0.5f, material->opacity);
+	EXPECT_STREQ ("low_poly_ship_diffuse", material->diffuseTexture);
+}
+
+TEST (CookedAsset, shader_round_trips)
+{
+	const byte byteCode[] = {'D', 'X', 'B', 'C', 1, 2, 3, 4, 5};
+
+	std::vector<byte> blob;
+	CookShader (byteCode, sizeof (byteCode), blob);
+
+	AlignedBlob aligned (blob);
+	const D3D12_SHADER_BYTECODE shader = ReadCookedShader (aligned.data (), aligned.size ());
+	ASSERT_EQ (sizeof (byteCode), shader.BytecodeLength);
+	EXPECT_EQ (0, std::memcmp (byteCode, shader.pShaderBytecode, sizeof (byteCode)));
+}
+
+TEST (CookedAsset, rejects_invalid_assets)
+{
+	std::vector<Vertex> vertices;
+	std::vector<Index> indices;
+	makeQuad (vertices, indices);
+	const MeshComponent source = {4, 6, vertices.data (), indices.data ()};
+	std::vector<byte> blob;
+	CookMesh (source, blob);
+
+	MeshComponent mesh;
+	{
+		AlignedBlob aligned (blob);
+		EXPECT_FALSE (ReadCookedMesh (aligned.data (), aligned.size () - 1, mesh));
+		EXPECT_FALSE (ReadCookedMesh (aligned.data (), 4, mesh));
+		Texture texture;
+		EXPECT_FALSE (ReadCookedTexture (aligned.data (), aligned.size (), texture));
+	}
+	{
+		AlignedBlob aligned (blob);
+		reinterpret_cast<CookedHeader *>(aligned.data ())->magic ^= 1;
+		EXPECT_FALSE (ReadCookedMesh (aligned.data (), aligned.size (), mesh));
+	}
+	{
+		AlignedBlob aligned (blob);
+		reinterpret_cast<CookedHeader *>(aligned.data ())->version = CookedMesh::VERSION + 1;
+		EXPECT_FALSE (ReadCookedMesh (aligned.data (), aligned.size (), mesh));
+	}
+	{
+		AlignedBlob aligned (blob);
+		reinterpret_cast<CookedMesh *>(aligned.data ())->numIndices = 1 << 30;
+		EXPECT_FALSE (ReadCookedMesh (aligned.data (), aligned.size (), mesh));
+	}
+}
+
+TEST (CookedAsset, reads_file_into_aligned_allocation)
+{
+	std::vector<Vertex> vertices;
+	std::vector<Index> indices;
+	makeQuad (vertices, indices);
+	const MeshComponent source = {4, 6, vertices.data (), indices.data ()};
+	std::vector<byte> blob;
+	CookMesh (source, blob);
+	ASSERT_TRUE (writeFile (COOKED_PATH, blob.data (), blob.size ()));
+
+	TestAllocator allocator (4096);
+	allocator.get ().allocate (1, 1);
+
+	size_t size;
+	const byte * data = ReadFileInto (COOKED_PATH, allocator.get (), size);
+	std::remove (COOKED_PATH);
+	ASSERT_NE (nullptr, data);
+	EXPECT_EQ (blob.size (), size);
+	EXPECT_EQ (0u, reinterpret_cast<uintptr_t>(data) % COOKED_ALIGNMENT);
+
+	MeshComponent mesh;
+	ASSERT_TRUE (ReadCookedMesh (data, size, mesh));
+	EXPECT_EQ (0, std::memcmp (indices.data (), mesh.indices, 6 * sizeof (Index)));
+
+	EXPECT_EQ (nullptr, ReadFileInto ("missing.mesh", allocator.get (), size));
+}
+
+TEST (CookedAsset, cooks_obj_files)
+{
+	const char quad[] =
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+		"vt 0 0\nvn 0 0 1\n"
+		"f 1/1/1 2/1/1 3/1/1\nf 3/1/1 2/1/1 4/1/1\n";
+	ASSERT_TRUE (writeFile (COOKED_PATH, quad, sizeof (quad) - 1));
+
+	// Without a material library, only the mesh is cooked.
+	std::vector<byte> meshBlob;
+	std::vector<byte> materialBlob (1);
+	ASSERT_TRUE (CookObjFile (COOKED_PATH, nullptr, nullptr, meshBlob, materialBlob));
+	EXPECT_TRUE (materialBlob.empty ());
+
+	AlignedBlob aligned (meshBlob);
+	MeshComponent mesh;
+	ASSERT_TRUE (ReadCookedMesh (aligned.data (), aligned.size (), mesh));
+	EXPECT_EQ (6u, mesh.numIndices);
+
+	// A material library that cannot be found fails the mesh.
+	const std::string missing = std::string ("mtllib missing.mtl\nusemtl Material\n") + quad;
+	ASSERT_TRUE (writeFile (COOKED_PATH, missing.data (), missing.size ()));
+	EXPECT_FALSE (CookObjFile (COOKED_PATH, nullptr, nullptr, meshBlob, materialBlob));
+	std::remove (COOKED_PATH);
+}
+
+TEST (CookedAssetBenchmark, DISABLED_load_time)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const char * OBJ_PATH = "Test_CookedAsset.obj";
+
+	// A 250 x 250 vertex grid of quads, as exported by a modelling tool.
+	std::string text;
+	char line[128];
+	const uint SIZE = 250;
+	for (uint i (0); i < SIZE * SIZE; ++i) {
+		std::snprintf (line, sizeof (line), "v %f %f %f\nvt %f %f\n", (i % SIZE) * 0.013f,
+			(i / SIZE) * 0.027f, i * -0.0001f, float (i % SIZE) / SIZE, float (i / SIZE) / SIZE);
+		text += line;
+	}
+	text += "vn 0 0 1\n";
+	for (uint y (0); y + 1 < SIZE; ++y) {
+		for (uint x (0); x + 1 < SIZE; ++x) {
+			const uint a = y * SIZE + x + 1;
+			std::snprintf (line, sizeof (line), "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n",
+				a, a, a + 1, a + 1, a + SIZE + 1, a + SIZE + 1, a + SIZE, a + SIZE);
+			text += line;
+		}
+	}
+	ASSERT_TRUE (writeFile (OBJ_PATH, text.data (), text.size ()));
+
+	TestAllocator allocator (16 << 20);
+	MeshComponent mesh;
+	ASSERT_TRUE (ParseObj (text.data (), text.size (), allocator.get (), mesh));
+	std::vector<byte> blob;
+	CookMesh (mesh, blob);
+	ASSERT_TRUE (writeFile (COOKED_PATH, blob.data (), blob.size ()));
+
+	const uint NUM_ROUNDS = 10;
+	std::chrono::duration<double, std::milli> parsed (0);
+	std::chrono::duration<double, std::milli> cooked (0);
+	for (uint round (0); round < NUM_ROUNDS; ++round) {
+		allocator.get ().reset ();
+		Clock::time_point start = Clock::now ();
+		std::vector<char> source;
+		ASSERT_TRUE (ReadWholeFile (OBJ_PATH, source));
+		ASSERT_TRUE (ParseObj (source.data (), source.size (), allocator.get (), mesh));
+		parsed += Clock::now () - start;
+
+		start = Clock::now ();
+		size_t size;
+		const byte * data = ReadFileInto (COOKED_PATH, allocator.get (), size);
+		ASSERT_TRUE (data && ReadCookedMesh (data, size, mesh));
+		cooked += Clock::now () - start;
+	}
+	std::remove (OBJ_PATH);
+	std::remove (COOKED_PATH);
+
+	std::printf ("%.1f MB OBJ: %.2f ms, %.1f MB cooked mesh: %.2f ms\n",
+		text.size () / double (1 << 20), parsed.count () / NUM_ROUNDS,
+		blob.size () / double (1 << 20), cooked.count () / NUM_ROUNDS);
+}
@@ -0,0 +1,85 @@
+//
+// Test_Fiber.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Engine/Source/Core/Fiber.hpp"
+
+
+namespace
+{
+	/// Two fibers passing control back and forth, recording the order they ran in.
+	struct PingPong {
+		Fiber thread;
+		Fiber worker;
+		std::vector<uint> order;
+		uint remaining;
+	};
+
+	void pingPongMain (
+		void * userData
+	) {
+		PingPong & pingPong = *static_cast<PingPong *>(userData);
+		while (true) {
+			pingPong.order.push_back (1);
+			pingPong.worker.switchTo (pingPong.thread);
+		}
+	}
+
+	struct SwitchCounter {
+		Fiber thread;
+		Fiber worker;
+	};
+
+	void switchBackMain (
+		void * userData
+	) {
+		SwitchCounter & counter = *static_cast<SwitchCounter *>(userData);
+		while (true) {
+			counter.worker.switchTo (counter.thread);
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (Fiber, switching_resumes_where_each_fiber_left_off)
+{
+	PingPong pingPong;
+	pingPong.worker.create (65536, &pingPongMain, &pingPong);
+	pingPong.thread.convertFromThread ();
+
+	for (uint i (0); i < 3; ++i) {
+		pingPong.order.push_back (0);
+		pingPong.thread.switchTo (pingPong.worker);
+	}
+	pingPong.thread.convertToThread ();
+
+	const std::vector<uint> expected = {0, 1, 0, 1, 0, 1};
+	EXPECT_EQ (expected, pingPong.order);
+}
+
+// Run with --gtest_also_run_disabled_tests to report switch cost.
+TEST (FiberBenchmark, DISABLED_switch_cost)
+{
+	const uint NUM_ROUND_TRIPS = 1000000;
+
+	SwitchCounter counter;
+	counter.worker.create (65536, &switchBackMain, &counter);
+	counter.thread.convertFromThread ();
+
+	const auto start = std::chrono::high_resolution_clock::now ();
+	for (uint i (0); i < NUM_ROUND_TRIPS; ++i) {
+		counter.thread.switchTo (counter.worker);
+	}
+	const std::chrono::duration<double, std::nano> elapsed =
+		std::chrono::high_resolution_clock::now () - start;
+	counter.thread.convertToThread ();
+
+	std::printf ("%.1f ns per fiber switch\n", elapsed.count () / (2.0 * NUM_ROUND_TRIPS));
+}
@@ -0,0 +1,216 @@
+//
+// Test_FrameStats.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "Engine/Include/Engine/Core/FrameStats.hpp"
+
+
+namespace
+{
+	uint countLines (
+		const std::string & text
+	) {
+		uint count = 0;
+		for (char c : text) {
+			count += c == '\n';
+		}
+		return count;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (DurationHistogram, empty_histogram_reports_zero)
+{
+	DurationHistogram histogram;
+	EXPECT_EQ (0u, histogram.count ());
+	EXPECT_EQ (0u, histogram.valueAtPercentile (99.0));
+	EXPECT_EQ (0u, histogram.maxValue ());
+	EXPECT_EQ (0.0, histogram.mean ());
+}
+
+TEST (DurationHistogram, small_values_are_exact)
+{
+	DurationHistogram histogram;
+	for (uint64 value (1); value <= 200; ++value) {
+		histogram.record (value);
+	}
+
+	EXPECT_EQ (200u, histogram.count ());
+	EXPECT_EQ (1u, histogram.valueAtPercentile (0.0));
+	EXPECT_EQ (100u, histogram.valueAtPercentile (50.0));
+	EXPECT_EQ (180u, histogram.valueAtPercentile (90.0));
+	EXPECT_EQ (198u, histogram.valueAtPercentile (99.0));
+	EXPECT_EQ (200u, histogram.valueAtPercentile (100.0));
+	EXPECT_EQ (200u, histogram.maxValue ());
+	EXPECT_DOUBLE_EQ (100.5, histogram.mean ());
+}
+
+TEST (DurationHistogram, large_values_are_within_precision)
+{
+	std::mt19937 random (7);
+	std::uniform_int_distribution<uint64> distribution (256, 10000000);
+
+	for (uint i (0); i < 1000; ++i) {
+		const uint64 value = distribution (random);
+
+		DurationHistogram histogram;
+		histogram.record (value);
+		histogram.record (DurationHistogram::MAX_MICROSECONDS);
+
+		const uint64 reported = histogram.valueAtPercentile (50.0);
+		ASSERT_GE (reported, value);
+		ASSERT_LE (reported - value, value / 128) << value;
+	}
+}
+
+TEST (DurationHistogram, clamps_and_merges)
+{
+	DurationHistogram a;
+	DurationHistogram b;
+	a.record (1000);
+	b.record (uint64 (1) << 40);
+	a.add (b);
+
+	EXPECT_EQ (2u, a.count ());
+	EXPECT_EQ (DurationHistogram::MAX_MICROSECONDS, a.maxValue ());
+	EXPECT_EQ (DurationHistogram::MAX_MICROSECONDS, a.valueAtPercentile (100.0));
+
+	a.reset ();
+	EXPECT_EQ (0u, a.count ());
+	EXPECT_EQ (0u, a.valueAtPercentile (100.0));
+}
+
+TEST (FrameStats, tail_percentiles_expose_stutter_hidden_by_the_mean)
+{
+	FrameStats stats (1000.0, 1000.0, 0.0);
+	for (uint frame (0); frame < 1000; ++frame) {
+		stats.recordFrame (frame % 50 == 0 ? 100.0 : 10.0, 5.0);
+	}
+
+	const FrameStatsSummary frames = stats.frameSummary ();
+	EXPECT_EQ (1000u, frames.frames);
+	EXPECT_NEAR (11.8, frames.mean, 0.01);
+	EXPECT_NEAR (10.0, frames.p50, 0.1);
+	EXPECT_NEAR (10.0, frames.p90, 0.1);
+	EXPECT_NEAR (100.0, frames.p99, 0.5);
+	EXPECT_NEAR (100.0, frames.max, 0.01);
+	EXPECT_NEAR (5.0, stats.tickSummary ().p999, 0.01);
+}
+
+TEST (FrameStats, completes_windows_by_elapsed_time)
+{
+	FrameStats stats (100.0, 50.0, 2.5, 2);
+
+	uint completed = 0;
+	for (uint frame (0); frame < 30; ++frame) {
+		completed += stats.recordFrame (10.0, 1.0);
+	}
+
+	// Windows span the two most recent intervals once two have completed.
+	ASSERT_EQ (3u, completed);
+	ASSERT_EQ (3u, stats.windowCount ());
+	for (uint i (0); i < 3; ++i) {
+		const FrameStatsWindow & window = stats.window (i);
+		EXPECT_EQ (i > 0 ? (i - 1) * 10u : 0u, window.firstFrame);
+		EXPECT_EQ (i > 0 ? 20u : 10u, window.frame.frames);
+		EXPECT_NEAR (i > 0 ? 200.0 : 100.0, window.milliseconds, 1e-9);
+		EXPECT_NEAR (1.0, window.tick.p50, 0.01);
+	}
+	EXPECT_EQ (30u, stats.frameCount ());
+}
+
+TEST (FrameStats, windows_roll_over_the_most_recent_intervals)
+{
+	FrameStats stats (100.0, 1000.0, 0.0, 3);
+
+	// A spike stays in the windows of the three intervals ending after it.
+	stats.recordFrame (100.0, 1.0);
+	for (uint frame (0); frame < 40; ++frame) {
+		stats.recordFrame (10.0, 1.0);
+	}
+
+	ASSERT_EQ (5u, stats.windowCount ());
+	for (uint i (0); i < 5; ++i) {
+		EXPECT_NEAR (i < 3 ? 100.0 : 10.0, stats.window (i).frame.max, 0.01) << i;
+	}
+	EXPECT_EQ (1u, stats.window (3).firstFrame);
+	EXPECT_EQ (30u, stats.window (3).frame.frames);
+	EXPECT_EQ (11u, stats.window (4).firstFrame);
+}
+
+TEST (FrameStats, keeps_a_fixed_number_of_recent_windows)
+{
+	FrameStats stats (1.0, 1000.0, 0.0, 1);
+
+	const uint NUM_WINDOWS = FrameStats::MAX_WINDOWS + 10;
+	for (uint frame (0); frame < NUM_WINDOWS; ++frame) {
+		stats.recordFrame (1.0, 0.5);
+	}
+
+	// The oldest windows are overwritten, oldest first.
+	ASSERT_EQ (FrameStats::MAX_WINDOWS, stats.windowCount ());
+	EXPECT_EQ (NUM_WINDOWS, stats.completedWindowCount ());
+	for (uint i (0); i < stats.windowCount (); ++i) {
+		ASSERT_EQ (10u + i, stats.window (i).firstFrame) << i;
+	}
+	EXPECT_EQ (NUM_WINDOWS, stats.frameSummary ().frames);
+
+	// Rows stay numbered from the start of the run.
+	const std::string csv = stats.csv ();
+	EXPECT_EQ (FrameStats::MAX_WINDOWS + 1, countLines (csv));
+	EXPECT_NE (std::string::npos, csv.find ("\n10,10,1,1.000,"));
+	EXPECT_EQ (std::string::npos, csv.find ("\n9,"));
+}
+
+TEST (FrameStats, detects_absolute_and_relative_hitches)
+{
+	FrameStats stats (100.0, 50.0, 3.0);
+
+	// The relative threshold only applies once a window has completed.
+	stats.recordFrame (40.0, 1.0);
+	for (uint frame (0); frame < 10; ++frame) {
+		stats.recordFrame (10.0, 1.0);
+	}
+	stats.recordFrame (60.0, 55.0);
+	stats.recordFrame (35.0, 2.0);
+	stats.recordFrame (25.0, 2.0);
+
+	ASSERT_EQ (2u, stats.hitchCount ());
+	EXPECT_EQ (11u, stats.hitches ()[0].frame);
+	EXPECT_EQ (60.0, stats.hitches ()[0].frameMilliseconds);
+	EXPECT_EQ (55.0, stats.hitches ()[0].tickMilliseconds);
+	EXPECT_EQ (12u, stats.hitches ()[1].frame);
+	EXPECT_EQ (35.0, stats.hitches ()[1].frameMilliseconds);
+
+	stats.setHitchThresholds (20.0, 0.0);
+	stats.recordFrame (25.0, 2.0);
+	EXPECT_EQ (3u, stats.hitchCount ());
+}
+
+TEST (FrameStats, exports_csv_and_json)
+{
+	FrameStats stats (100.0, 15.0, 2.5, 2);
+	for (uint frame (0); frame < 25; ++frame) {
+		stats.recordFrame (frame == 3 ? 20.0 : 10.0, 1.0);
+	}
+
+	const std::string csv = stats.csv ();
+	EXPECT_EQ (0u, csv.find ("window,first_frame,frames,milliseconds,frame_mean_ms,"));
+	EXPECT_EQ (3u, countLines (csv));
+	EXPECT_NE (std::string::npos, csv.find ("\n0,0,9,100.000,"));
+	EXPECT_NE (std::string::npos, csv.find ("\n1,0,19,200.000,"));
+
+	const std::string json = stats.json ();
+	EXPECT_EQ ('{', json.front ());
+	EXPECT_NE (std::string::npos, json.find ("\"frame\":{\"frames\":25,"));
+	EXPECT_NE (std::string::npos, json.find ("\"p99.9\":"));
+	EXPECT_NE (std::string::npos, json.find ("\"hitchCount\":1,"));
+	EXPECT_NE (std::string::npos,
+		json.find ("{\"frame\":3,\"frameMilliseconds\":20.000,\"tickMilliseconds\":1.000}"));
+}
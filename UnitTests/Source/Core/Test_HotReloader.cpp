@@ -0,0 +1,157 @@
+//
+// Test_HotReloader.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "Engine/Source/Core/AssetLoader.hpp"
+#include "Engine/Source/Core/HotReloader.hpp"
+
+
+namespace
+{
+	const char * PACK_PATH = "Test_HotReloader.pack";
+	const char * SHADER_PATH = "Test_HotReloaderShader.cso";
+	const char * MESH_PATH = "Test_HotReloaderMesh.obj";
+
+	const byte SHADER_CODE[] = {'D', 'X', 'B', 'C', 'v', '1'};
+	const byte RELOADED_SHADER_CODE[] = {'D', 'X', 'B', 'C', 'v', '2', '!'};
+
+	const char * QUAD_OBJ =
+		"v 0 0 0\n"
+		"v 1 0 0\n"
+		"v 1 1 0\n"
+		"v 0 1 0\n"
+		"f 1 2 3 4\n";
+
+	void writeFile (
+		const char * path,
+		const void * data,
+		size_t size
+	) {
+		std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write (static_cast<const char *>(data), size);
+	}
+
+	class HotReloaderTest : public ::testing::Test {
+	protected:
+		void SetUp () override
+		{
+			PackWriter writer;
+			std::vector<byte> blob;
+
+			CookShader (SHADER_CODE, sizeof (SHADER_CODE), blob);
+			writer.add ("Test_HotReloaderShader.shader", blob.data (), blob.size ());
+
+			Vertex vertices[3] = {};
+			Index indices[3] = {0, 1, 2};
+			const MeshComponent mesh = {3, 3, vertices, indices};
+			CookMesh (mesh, blob);
+			writer.add ("Test_HotReloaderMesh.mesh", blob.data (), blob.size ());
+
+			ASSERT_TRUE (writer.write (PACK_PATH));
+			ASSERT_TRUE (AssetLoader::mount (PACK_PATH));
+		}
+
+		void TearDown () override
+		{
+			AssetLoader::unmount ();
+			std::remove (PACK_PATH);
+			std::remove (SHADER_PATH);
+			std::remove (MESH_PATH);
+		}
+	};
+
+	bool hasByteCode (
+		const CompiledShader & shader,
+		const byte * code,
+		size_t size
+	) {
+		return shader.byteCode.BytecodeLength == size &&
+			std::memcmp (shader.byteCode.pShaderBytecode, code, size) == 0;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (HotReloaderTest, reloads_once_changes_settle)
+{
+	typedef HotReloader::Clock Clock;
+	HotReloader reloader (std::chrono::milliseconds (250));
+	uint barriers = 0;
+	reloader.setReloadBarrier ([&barriers] { ++barriers; });
+
+	AssetHandle<CompiledShader> shader =
+		AssetLoader::load<CompiledShader> ("Test_HotReloaderShader");
+	ASSERT_TRUE (shader.isReady ());
+	const CompiledShader * address = shader.get ();
+	EXPECT_EQ (0u, shader.version ());
+
+	// A burst of saves is recooked once, after the last.
+	writeFile (SHADER_PATH, RELOADED_SHADER_CODE, sizeof (RELOADED_SHADER_CODE));
+	const Clock::time_point start = Clock::now ();
+	reloader.notify (SHADER_PATH, start);
+	reloader.notify (SHADER_PATH, start + std::chrono::milliseconds (100));
+	EXPECT_EQ (0u, reloader.update (start + std::chrono::milliseconds (300)));
+	EXPECT_TRUE (hasByteCode (*shader, SHADER_CODE, sizeof (SHADER_CODE)));
+	EXPECT_EQ (0u, barriers);
+
+	// Frames in flight are waited for once before reloading.
+	EXPECT_EQ (1u, reloader.update (start + std::chrono::milliseconds (400)));
+	EXPECT_EQ (0u, reloader.update (start + std::chrono::milliseconds (800)));
+	EXPECT_EQ (1u, barriers);
+	EXPECT_EQ (address, shader.get ());
+	EXPECT_EQ (1u, shader.version ());
+	EXPECT_TRUE (hasByteCode (*shader, RELOADED_SHADER_CODE, sizeof (RELOADED_SHADER_CODE)));
+}
+
+TEST_F (HotReloaderTest, reloads_meshes_in_place)
+{
+	AssetHandle<ObjAsset> mesh = AssetLoader::load<ObjAsset> ("Test_HotReloaderMesh");
+	ASSERT_TRUE (mesh.isReady ());
+	const MeshComponent * address = &mesh->mesh;
+	EXPECT_EQ (3u, mesh->mesh.numIndices);
+
+	HotReloader reloader (std::chrono::milliseconds (0));
+	writeFile (MESH_PATH, QUAD_OBJ, std::strlen (QUAD_OBJ));
+	reloader.notify (MESH_PATH, HotReloader::Clock::now ());
+	EXPECT_EQ (1u, reloader.update ());
+
+	EXPECT_EQ (address, &mesh->mesh);
+	EXPECT_EQ (1u, mesh.version ());
+	EXPECT_EQ (4u, mesh->mesh.numVertices);
+	EXPECT_EQ (6u, mesh->mesh.numIndices);
+}
+
+TEST_F (HotReloaderTest, later_loads_read_recooked_assets)
+{
+	HotReloader reloader (std::chrono::milliseconds (0));
+	writeFile (SHADER_PATH, RELOADED_SHADER_CODE, sizeof (RELOADED_SHADER_CODE));
+	reloader.notify (SHADER_PATH, HotReloader::Clock::now ());
+	EXPECT_EQ (1u, reloader.update ());
+
+	AssetHandle<CompiledShader> shader =
+		AssetLoader::load<CompiledShader> ("Test_HotReloaderShader");
+	ASSERT_TRUE (shader.isReady ());
+	EXPECT_EQ (0u, shader.version ());
+	EXPECT_TRUE (hasByteCode (*shader, RELOADED_SHADER_CODE, sizeof (RELOADED_SHADER_CODE)));
+}
+
+TEST_F (HotReloaderTest, ignores_other_and_unreadable_sources)
+{
+	AssetHandle<CompiledShader> shader =
+		AssetLoader::load<CompiledShader> ("Test_HotReloaderShader");
+
+	HotReloader reloader (std::chrono::milliseconds (0));
+	reloader.notify ("Test_HotReloaderTexture.png", HotReloader::Clock::now ());
+	reloader.notify (SHADER_PATH, HotReloader::Clock::now ());
+	EXPECT_EQ (0u, reloader.update ());
+
+	EXPECT_EQ (0u, shader.version ());
+	EXPECT_TRUE (hasByteCode (*shader, SHADER_CODE, sizeof (SHADER_CODE)));
+}
@@ -0,0 +1,279 @@
+//
+// Test_JobSystem.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+
+
+namespace
+{
+	/// Computes fib(n) by spawning a job for each recursive call.
+	uint64 parallelFibonacci (
+		JobSystem & jobSystem,
+		uint n
+	) {
+		if (n < 2) {
+			return n;
+		}
+
+		uint64 a, b;
+		JobCounter counter;
+		jobSystem.run ([&] { a = parallelFibonacci (jobSystem, n - 1); }, &counter);
+		jobSystem.run ([&] { b = parallelFibonacci (jobSystem, n - 2); }, &counter);
+		jobSystem.wait (counter);
+		return a + b;
+	}
+
+	/// Busy work standing in for a small task, returning a value so it is not elided.
+	float spin (
+		float x,
+		uint iterations
+	) {
+		for (uint i (0); i < iterations; ++i) {
+			x = x * 0.999f + 0.001f;
+		}
+		return x;
+	}
+
+	/// Runs a synthetic frame in which each of numSystems jobs runs numStages stages in
+	/// sequence, each stage spawning numTasks jobs and waiting on them.
+	void runDependencyHeavyFrame (
+		JobSystem & jobSystem,
+		uint numSystems,
+		uint numStages,
+		uint numTasks,
+		std::atomic<float> & sink
+	) {
+		JobCounter systems;
+		for (uint system (0); system < numSystems; ++system) {
+			jobSystem.run ([&jobSystem, numStages, numTasks, &sink] {
+				for (uint stage (0); stage < numStages; ++stage) {
+					JobCounter tasks;
+					for (uint task (0); task < numTasks; ++task) {
+						jobSystem.run ([&sink] {
+							const float x = sink.load (std::memory_order_relaxed);
+							sink.store (spin (x, 2000), std::memory_order_relaxed);
+						}, &tasks);
+					}
+					jobSystem.wait (tasks);
+				}
+			}, &systems);
+		}
+		jobSystem.wait (systems);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (JobSystem, thread_count_includes_constructing_thread)
+{
+	JobSystem jobSystem (3);
+	EXPECT_EQ (4u, jobSystem.threadCount ());
+	EXPECT_EQ (0u, jobSystem.threadIndex ());
+}
+
+TEST (JobSystem, runs_every_job_once)
+{
+	JobSystem jobSystem (3);
+
+	const uint NUM_JOBS = 3000;
+	std::vector<std::atomic<uint>> executed (NUM_JOBS);
+	for (auto & count : executed) {
+		count = 0;
+	}
+
+	JobCounter counter;
+	for (uint i (0); i < NUM_JOBS; ++i) {
+		jobSystem.run ([&executed, i] { ++executed[i]; }, &counter);
+	}
+	jobSystem.wait (counter);
+
+	EXPECT_TRUE (counter.isDone ());
+	for (uint i (0); i < NUM_JOBS; ++i) {
+		EXPECT_EQ (1u, executed[i].load ());
+	}
+}
+
+TEST (JobSystem, waiting_thread_executes_jobs_without_workers)
+{
+	JobSystem jobSystem (0);
+
+	uint sum = 0;
+	JobCounter counter;
+	for (uint i (0); i < 100; ++i) {
+		jobSystem.run ([&sum, i] { sum += i; }, &counter);
+	}
+	EXPECT_FALSE (counter.isDone ());
+
+	jobSystem.wait (counter);
+	EXPECT_EQ (4950u, sum);
+}
+
+TEST (JobSystem, jobs_can_spawn_and_wait_on_jobs)
+{
+	for (uint numWorkers : {0u, 1u, 3u}) {
+		JobSystem jobSystem (numWorkers);
+		EXPECT_EQ (6765u, parallelFibonacci (jobSystem, 20)) << numWorkers;
+	}
+}
+
+TEST (JobSystem, counters_track_independent_groups)
+{
+	JobSystem jobSystem (2);
+
+	std::atomic<uint> first (0);
+	std::atomic<uint> second (0);
+	JobCounter firstCounter;
+	JobCounter secondCounter;
+
+	for (uint i (0); i < 50; ++i) {
+		jobSystem.run ([&] { ++first; }, &firstCounter);
+		jobSystem.run ([&] { ++second; }, &secondCounter);
+	}
+
+	jobSystem.wait (firstCounter);
+	EXPECT_EQ (50u, first.load ());
+
+	jobSystem.wait (secondCounter);
+	EXPECT_EQ (50u, second.load ());
+}
+
+TEST (JobSystem, scratch_allocators_are_per_thread)
+{
+	JobSystem jobSystem (3, JobWaitMode::ExecuteJobs, 4096);
+
+	std::vector<void *> allocations (jobSystem.threadCount (), nullptr);
+	std::vector<uint> threadIndices;
+	std::mutex mutex;
+
+	JobCounter counter;
+	for (uint i (0); i < 64; ++i) {
+		jobSystem.run ([&] {
+			void * p = jobSystem.scratchAllocator ().allocate (16, 16);
+			std::lock_guard<std::mutex> lock (mutex);
+			threadIndices.push_back (jobSystem.threadIndex ());
+			allocations.push_back (p);
+		}, &counter);
+	}
+	jobSystem.wait (counter);
+
+	// Every allocation is unique, even when made by different threads.
+	allocations.erase (std::remove (allocations.begin (), allocations.end (), nullptr), allocations.end ());
+	EXPECT_EQ (64u, std::set<void *> (allocations.begin (), allocations.end ()).size ());
+	for (uint index : threadIndices) {
+		EXPECT_LT (index, jobSystem.threadCount ());
+	}
+
+	jobSystem.resetScratchAllocators ();
+	EXPECT_EQ (0u, jobSystem.scratchAllocator ().totalAllocated ());
+}
+
+TEST (JobSystem, jobs_can_wait_by_switching_fibers)
+{
+	for (uint numWorkers : {0u, 1u, 3u}) {
+		JobSystem jobSystem (numWorkers, JobWaitMode::SwitchFibers);
+		EXPECT_EQ (6765u, parallelFibonacci (jobSystem, 20)) << numWorkers;
+	}
+}
+
+TEST (JobSystem, parked_fibers_resume_once_their_counter_completes)
+{
+	JobSystem jobSystem (3, JobWaitMode::SwitchFibers);
+
+	std::atomic<bool> open (false);
+	JobCounter gate;
+	jobSystem.run ([&open] {
+		while (!open) {
+			std::this_thread::yield ();
+		}
+	}, &gate);
+
+	// More waiters than workers, so they can only all be waiting by parking fibers.
+	std::atomic<uint> resumed (0);
+	JobCounter waiters;
+	for (uint i (0); i < 16; ++i) {
+		jobSystem.run ([&] {
+			jobSystem.wait (gate);
+			EXPECT_TRUE (gate.isDone ());
+			++resumed;
+		}, &waiters);
+	}
+
+	open = true;
+	jobSystem.wait (waiters);
+	EXPECT_EQ (16u, resumed.load ());
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (JobSystemBenchmark, DISABLED_empty_job_throughput)
+{
+	const uint NUM_JOBS = JobSystem::MAX_JOBS_PER_THREAD;
+	const uint NUM_ROUNDS = 200;
+
+	JobSystem jobSystem (JobSystem::DefaultWorkerThreadCount ());
+
+	std::atomic<uint> executed (0);
+	const auto start = std::chrono::high_resolution_clock::now ();
+	for (uint round (0); round < NUM_ROUNDS; ++round) {
+		JobCounter counter;
+		for (uint i (0); i < NUM_JOBS; ++i) {
+			jobSystem.run ([&executed] { executed.fetch_add (1, std::memory_order_relaxed); }, &counter);
+		}
+		jobSystem.wait (counter);
+	}
+	const std::chrono::duration<double, std::nano> elapsed =
+		std::chrono::high_resolution_clock::now () - start;
+
+	std::printf ("%u threads: %.1f ns per job\n",
+		jobSystem.threadCount (), elapsed.count () / (NUM_JOBS * NUM_ROUNDS));
+	EXPECT_EQ (NUM_JOBS * NUM_ROUNDS, executed.load ());
+
+	const auto fibStart = std::chrono::high_resolution_clock::now ();
+	const uint64 fib = parallelFibonacci (jobSystem, 24);
+	const std::chrono::duration<double, std::milli> fibElapsed =
+		std::chrono::high_resolution_clock::now () - fibStart;
+	std::printf ("fib(24) = %llu with a job per call: %.2f ms\n",
+		static_cast<unsigned long long>(fib), fibElapsed.count ());
+}
+
+TEST (JobSystemBenchmark, DISABLED_dependency_heavy_frame_scaling)
+{
+	const uint NUM_FRAMES = 20;
+	const uint NUM_SYSTEMS = 64;
+	const uint NUM_STAGES = 4;
+	const uint NUM_TASKS = 16;
+
+	std::vector<uint> workerCounts = {0, 1, 3};
+	if (JobSystem::DefaultWorkerThreadCount () > 3) {
+		workerCounts.push_back (JobSystem::DefaultWorkerThreadCount ());
+	}
+
+	std::atomic<float> sink (0.0f);
+	for (uint numWorkers : workerCounts) {
+		for (JobWaitMode waitMode : {JobWaitMode::ExecuteJobs, JobWaitMode::SwitchFibers}) {
+			JobSystem jobSystem (numWorkers, waitMode);
+
+			const auto start = std::chrono::high_resolution_clock::now ();
+			for (uint frame (0); frame < NUM_FRAMES; ++frame) {
+				runDependencyHeavyFrame (jobSystem, NUM_SYSTEMS, NUM_STAGES, NUM_TASKS, sink);
+			}
+			const std::chrono::duration<double, std::milli> elapsed =
+				std::chrono::high_resolution_clock::now () - start;
+
+			std::printf ("%u threads, %s: %.2f ms per frame\n", jobSystem.threadCount (),
+				waitMode == JobWaitMode::ExecuteJobs ? "execute jobs" : "switch fibers",
+				elapsed.count () / NUM_FRAMES);
+		}
+	}
+}
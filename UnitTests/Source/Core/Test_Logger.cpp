@@ -0,0 +1,253 @@
+//
+// Test_Logger.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/DebugUtils.hpp"
+
+
+namespace
+{
+	const char * LOG_PATH = "Test_Logger.log";
+
+	/// Directs log output to LOG_PATH for the lifetime of the object.
+	class LogCapture {
+	public:
+		LogCapture ()
+		{
+			EXPECT_TRUE (Logger::SetOutputFile (LOG_PATH));
+		}
+
+		~LogCapture ()
+		{
+			Logger::SetOutputFile (nullptr);
+			Logger::SetRateLimit (Logger::DEFAULT_RATE_LIMIT_BURST,
+				Logger::DEFAULT_RATE_LIMIT_MILLISECONDS);
+			std::remove (LOG_PATH);
+		}
+
+		/// Everything logged so far.
+		std::string contents () const
+		{
+			Logger::Flush ();
+			std::ifstream file (LOG_PATH, std::ios::in | std::ios::binary);
+			std::stringstream stream;
+			stream << file.rdbuf ();
+			return stream.str ();
+		}
+	};
+
+	void logKeyPress (
+		uint i
+	) {
+		LOG_CATEGORY_INFO (Input, "key press %u", i);
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (Logger, formats_each_argument_type)
+{
+	LogCapture capture;
+
+	enum Color { Green = 2 };
+	const wchar_t adapter[16] = L"Adapter";
+	LOG_INFO ("int %d, uint64 %llu, char %c, float %.2f, enum %d, string %s, wide %ls",
+		-42, 12345678901234ull, 'W', 1.5f, Green, "text", adapter);
+	LOG_WARNING ("No arguments");
+	LOG_ERROR ("Null %s", static_cast<const char *>(nullptr));
+
+	const std::string log = capture.contents ();
+	EXPECT_NE (std::string::npos, log.find ("] Log Info: int -42, uint64 12345678901234, char W, "
+		"float 1.50, enum 2, string text, wide Adapter\n"));
+	EXPECT_NE (std::string::npos, log.find ("] Log Warning: No arguments\n"));
+	EXPECT_NE (std::string::npos, log.find ("] Log Error: Null (null)\n"));
+}
+
+TEST (Logger, copies_string_arguments)
+{
+	LogCapture capture;
+
+	{
+		std::string temporary = "before";
+		LOG_INFO ("copied %s", temporary.c_str ());
+		temporary = "after!";
+	}
+
+	EXPECT_NE (std::string::npos, capture.contents ().find ("copied before\n"));
+}
+
+TEST (Logger, truncates_strings_to_fit_the_record)
+{
+	LogCapture capture;
+
+	const std::string longString (1000, 'x');
+	LOG_INFO ("%d %s %d", 1, longString.c_str (), 2);
+
+	const std::string log = capture.contents ();
+	const size_t start = log.find ("1 x");
+	ASSERT_NE (std::string::npos, start);
+
+	// The string shares the record with both integers and its length, and ends in a
+	// mark showing it was truncated.
+	const std::string expected = "1 " +
+		std::string (LogRecord::ARGUMENT_BYTES - 2 * sizeof (int) - 2 - 1 - 3, 'x') +
+		"... 2\n";
+	EXPECT_EQ (expected, log.substr (start, expected.size ()));
+}
+
+TEST (Logger, leaves_strings_that_fit_unmarked)
+{
+	LogCapture capture;
+
+	const std::string shortString (LogRecord::ARGUMENT_BYTES - 2 - 1, 'x');
+	LOG_INFO ("%s", shortString.c_str ());
+
+	EXPECT_NE (std::string::npos, capture.contents ().find (shortString + "\n"));
+}
+
+TEST (Logger, keeps_each_threads_messages_in_order)
+{
+	LogCapture capture;
+	Logger::SetRateLimit (0, 0);
+
+	const uint NUM_THREADS = 4;
+	const uint NUM_MESSAGES = 200;
+
+	std::vector<std::thread> threads;
+	for (uint thread (0); thread < NUM_THREADS; ++thread) {
+		threads.emplace_back ([thread] {
+			for (uint i (0); i < NUM_MESSAGES; ++i) {
+				LOG_INFO ("thread %u message %u", thread, i);
+
+				// Stay within each thread's queue.
+				if (i % 100 == 99) {
+					Logger::Flush ();
+				}
+			}
+		});
+	}
+	for (std::thread & thread : threads) {
+		thread.join ();
+	}
+
+	const std::string log = capture.contents ();
+	for (uint thread (0); thread < NUM_THREADS; ++thread) {
+		size_t previous = 0;
+		for (uint i (0); i < NUM_MESSAGES; ++i) {
+			const std::string message = "thread " + std::to_string (thread) +
+				" message " + std::to_string (i) + "\n";
+			const size_t position = log.find (message);
+			ASSERT_NE (std::string::npos, position) << message;
+			ASSERT_GE (position, previous) << message;
+			previous = position;
+		}
+	}
+}
+
+TEST (Logger, counts_messages_dropped_when_queue_is_full)
+{
+	LogCapture capture;
+	Logger::SetRateLimit (0, 0);
+
+	const uint64 droppedBefore = Logger::DroppedCount ();
+	for (uint i (0); i < 100 * Logger::RECORDS_PER_THREAD; ++i) {
+		LOG_INFO ("flood %u", i);
+	}
+
+	const std::string log = capture.contents ();
+	EXPECT_GT (Logger::DroppedCount (), droppedBefore);
+	EXPECT_NE (std::string::npos, log.find ("messages dropped, log queue full."));
+	EXPECT_NE (std::string::npos, log.find ("flood 0\n"));
+}
+
+TEST (Logger, filters_categories_by_level)
+{
+	static_assert (LogCompiledIn (LogCategory::Input, LogLevel::Info),
+		"Every level is compiled in by default.");
+
+	LogCapture capture;
+
+	uint evaluated = 0;
+	Logger::SetLevel (LogCategory::Input, LogLevel::Warning);
+	LOG_CATEGORY_INFO (Input, "filtered %u", ++evaluated);
+	LOG_CATEGORY_WARNING (Input, "written %u", ++evaluated);
+	LOG_CATEGORY_INFO (Render, "other category %u", ++evaluated);
+	EXPECT_EQ (LogLevel::Warning, Logger::Level (LogCategory::Input));
+	Logger::SetLevel (LogCategory::Input, LogLevel::Info);
+
+	const std::string log = capture.contents ();
+	EXPECT_EQ (2u, evaluated);
+	EXPECT_EQ (std::string::npos, log.find ("filtered"));
+	EXPECT_NE (std::string::npos, log.find ("] Log Warning: [Input] written 1\n"));
+	EXPECT_NE (std::string::npos, log.find ("] Log Info: [Render] other category 2\n"));
+}
+
+TEST (Logger, rate_limits_each_call_site)
+{
+	LogCapture capture;
+	Logger::SetRateLimit (3, 60000);
+
+	for (uint i (0); i < 10; ++i) {
+		logKeyPress (i);
+	}
+	LOG_INFO ("another site");
+
+	// With no interval the next message starts a new window.
+	Logger::SetRateLimit (3, 0);
+	logKeyPress (10);
+
+	const std::string log = capture.contents ();
+	EXPECT_NE (std::string::npos, log.find ("key press 2\n"));
+	EXPECT_EQ (std::string::npos, log.find ("key press 3"));
+	EXPECT_EQ (std::string::npos, log.find ("key press 9"));
+	EXPECT_NE (std::string::npos, log.find ("another site\n"));
+	EXPECT_NE (std::string::npos,
+		log.find ("key press 10 (7 similar messages suppressed)\n"));
+}
+
+// Run with --gtest_also_run_disabled_tests to compare the cost at the call site against
+// formatting synchronously.
+TEST (LoggerBenchmark, DISABLED_call_site_cost)
+{
+	LogCapture capture;
+	Logger::SetRateLimit (0, 0);
+
+	typedef std::chrono::high_resolution_clock Clock;
+	const uint NUM_MESSAGES = Logger::RECORDS_PER_THREAD / 2;
+	const uint NUM_ROUNDS = 100;
+
+	std::chrono::duration<double, std::nano> logged (0);
+	std::chrono::duration<double, std::nano> formatted (0);
+	char buffer[512];
+	uint checksum = 0;
+
+	for (uint round (0); round < NUM_ROUNDS; ++round) {
+		Clock::time_point start = Clock::now ();
+		for (uint i (0); i < NUM_MESSAGES; ++i) {
+			LOG_INFO ("%c Key Pressed at frame %u, %.3f ms", 'W', i, 16.667);
+		}
+		logged += Clock::now () - start;
+		Logger::Flush ();
+
+		start = Clock::now ();
+		for (uint i (0); i < NUM_MESSAGES; ++i) {
+			checksum += std::snprintf (buffer, sizeof (buffer),
+				"Log Info: %c Key Pressed at frame %u, %.3f ms\n", 'W', i, 16.667);
+		}
+		formatted += Clock::now () - start;
+	}
+
+	std::printf ("LOG_INFO: %.1f ns per message\n", logged.count () / (NUM_MESSAGES * NUM_ROUNDS));
+	std::printf ("snprintf: %.1f ns per message (%u)\n",
+		formatted.count () / (NUM_MESSAGES * NUM_ROUNDS), checksum);
+}
@@ -138,3 +138,44 @@ TEST (Memory, align_forward_large)
 	EXPECT_EQ (expected, memory::align_forward ((void *)0xFFFFFFFFFFFF0003, align));
 	EXPECT_EQ (expected, memory::align_forward ((void *)0xFFFFFFFFFFFF0004, align));
 }
+
+//---------------------------------------------------------------------------------------
+// FrameAllocator Tests
+//---------------------------------------------------------------------------------------
+TEST_F (MemoryGlobalsTest, FrameAllocator_starts_empty)
+{
+	EXPECT_EQ (0, memory_globals::frameAllocator ().totalAllocated ());
+}
+
+TEST (FrameAllocator, allocations_survive_one_frame)
+{
+	byte backingStore[1024];
+	FrameAllocator frameAllocator (backingStore, sizeof (backingStore));
+
+	int * a = make_new (frameAllocator, int, 1);
+	EXPECT_EQ (sizeof (int), frameAllocator.totalAllocated ());
+
+	// Next frame allocates from the other arena, leaving a intact.
+	frameAllocator.nextFrame ();
+	EXPECT_EQ (0, frameAllocator.totalAllocated ());
+	int * b = make_new (frameAllocator, int, 2);
+	EXPECT_NE (a, b);
+	EXPECT_EQ (1, *a);
+
+	// Cycling back to the first arena reuses its memory.
+	frameAllocator.nextFrame ();
+	EXPECT_EQ (0, frameAllocator.totalAllocated ());
+	int * c = make_new (frameAllocator, int, 3);
+	EXPECT_EQ (a, c);
+	EXPECT_EQ (2, *b);
+}
+
+TEST (FrameAllocator, respects_alignment)
+{
+	alignas(128) byte backingStore[1024];
+	FrameAllocator frameAllocator (backingStore, sizeof (backingStore));
+
+	make_new (frameAllocator, char);
+	void * p = frameAllocator.allocate (sizeof (SomeStruct128), alignof (SomeStruct128));
+	EXPECT_EQ (0u, reinterpret_cast<uintptr_t>(p) % 128);
+}
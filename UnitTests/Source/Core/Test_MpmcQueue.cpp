@@ -0,0 +1,172 @@
+//
+// Test_MpmcQueue.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/MpmcQueue.hpp"
+
+
+namespace
+{
+	/// Pushes messagesPerProducer distinct values from each of numProducers threads
+	/// while numConsumers threads pop them, recording how often each value was popped.
+	void pushAndPopConcurrently (
+		MpmcQueue<uint32> & queue,
+		uint numProducers,
+		uint numConsumers,
+		uint32 messagesPerProducer,
+		std::vector<std::atomic<uint>> & popCounts
+	) {
+		const uint32 total = numProducers * messagesPerProducer;
+		std::atomic<uint32> popped (0);
+
+		std::vector<std::thread> threads;
+		for (uint p (0); p < numProducers; ++p) {
+			threads.emplace_back ([&, p] {
+				for (uint32 i (0); i < messagesPerProducer; ++i) {
+					while (!queue.tryPush (p * messagesPerProducer + i)) {
+						std::this_thread::yield ();
+					}
+				}
+			});
+		}
+		for (uint c (0); c < numConsumers; ++c) {
+			threads.emplace_back ([&] {
+				uint32 value;
+				while (popped.load (std::memory_order_relaxed) < total) {
+					if (queue.tryPop (value)) {
+						popCounts[value].fetch_add (1, std::memory_order_relaxed);
+						popped.fetch_add (1, std::memory_order_relaxed);
+					}
+					else {
+						std::this_thread::yield ();
+					}
+				}
+			});
+		}
+
+		for (std::thread & thread : threads) {
+			thread.join ();
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (MpmcQueue, pops_in_push_order_until_empty)
+{
+	MpmcQueue<uint> queue (4);
+	EXPECT_EQ (4u, queue.capacity ());
+
+	for (uint i (0); i < 4; ++i) {
+		EXPECT_TRUE (queue.tryPush (i));
+	}
+	EXPECT_FALSE (queue.tryPush (4));
+	EXPECT_EQ (4u, queue.size ());
+
+	uint value;
+	for (uint round (0); round < 3; ++round) {
+		for (uint i (0); i < 4; ++i) {
+			ASSERT_TRUE (queue.tryPop (value));
+			EXPECT_EQ (i, value);
+			EXPECT_TRUE (queue.tryPush (i));
+		}
+	}
+	for (uint i (0); i < 4; ++i) {
+		ASSERT_TRUE (queue.tryPop (value));
+	}
+	EXPECT_FALSE (queue.tryPop (value));
+}
+
+TEST (MpmcQueue, concurrent_producers_and_consumers_deliver_each_message_once)
+{
+	const uint NUM_PRODUCERS = 4;
+	const uint NUM_CONSUMERS = 4;
+	const uint32 MESSAGES_PER_PRODUCER = 100000;
+
+	std::vector<std::atomic<uint>> popCounts (NUM_PRODUCERS * MESSAGES_PER_PRODUCER);
+	for (auto & count : popCounts) {
+		count = 0;
+	}
+
+	MpmcQueue<uint32> queue (256);
+	pushAndPopConcurrently (queue, NUM_PRODUCERS, NUM_CONSUMERS, MESSAGES_PER_PRODUCER, popCounts);
+
+	for (uint32 i (0); i < popCounts.size (); ++i) {
+		ASSERT_EQ (1u, popCounts[i].load ()) << i;
+	}
+	uint32 value;
+	EXPECT_FALSE (queue.tryPop (value));
+}
+
+TEST (MpmcQueue, messages_from_each_producer_stay_in_order)
+{
+	const uint NUM_PRODUCERS = 3;
+	const uint32 MESSAGES_PER_PRODUCER = 100000;
+
+	MpmcQueue<uint32> queue (64);
+	std::vector<std::thread> producers;
+	for (uint p (0); p < NUM_PRODUCERS; ++p) {
+		producers.emplace_back ([&queue, p] {
+			for (uint32 i (0); i < MESSAGES_PER_PRODUCER; ++i) {
+				while (!queue.tryPush ((p << 24) | i)) {
+					std::this_thread::yield ();
+				}
+			}
+		});
+	}
+
+	// A single consumer sees each producer's messages in the order they were pushed.
+	std::vector<uint32> next (NUM_PRODUCERS, 0);
+	uint32 value;
+	for (uint32 received (0); received < NUM_PRODUCERS * MESSAGES_PER_PRODUCER; ) {
+		if (!queue.tryPop (value)) {
+			std::this_thread::yield ();
+			continue;
+		}
+		const uint32 producer = value >> 24;
+		ASSERT_EQ (next[producer], value & 0xFFFFFF);
+		++next[producer];
+		++received;
+	}
+
+	for (std::thread & producer : producers) {
+		producer.join ();
+	}
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (MpmcQueueBenchmark, DISABLED_messages_per_second_by_producer_count)
+{
+	const uint32 TOTAL_MESSAGES = 1 << 23;
+
+	std::vector<std::atomic<uint>> popCounts (TOTAL_MESSAGES);
+	for (uint numProducers : {1u, 2u, 4u, 8u}) {
+		for (uint numConsumers : {1u, numProducers}) {
+			for (auto & count : popCounts) {
+				count.store (0, std::memory_order_relaxed);
+			}
+
+			MpmcQueue<uint32> queue (1024);
+			const auto start = std::chrono::high_resolution_clock::now ();
+			pushAndPopConcurrently (queue, numProducers, numConsumers,
+				TOTAL_MESSAGES / numProducers, popCounts);
+			const std::chrono::duration<double> elapsed =
+				std::chrono::high_resolution_clock::now () - start;
+
+			std::printf ("%u producers, %u consumers: %.1f million messages/s\n",
+				numProducers, numConsumers, TOTAL_MESSAGES / elapsed.count () / 1e6);
+
+			if (numConsumers == numProducers) {
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,486 @@
+//
+// Test_ObjParser.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Core/ObjParser.hpp"
+
+
+namespace
+{
+	// Relative to the UnitTests project directory, where the tests are run from.
+	const char * SHIP_OBJ_PATH = "../Game/Assets/Meshes/low_poly_ship.obj";
+	const char * SHIP_MTL_PATH = "../Game/Assets/Materials/low_poly_ship.mtl";
+
+	/// Linear allocator over heap storage, reset before the storage is freed.
+	class TestAllocator {
+	public:
+		explicit TestAllocator (
+			size_t size
+		)
+			: _storage (size),
+			  _allocator (_storage.data (), size)
+		{
+
+		}
+
+		~TestAllocator ()
+		{
+			_allocator.reset ();
+		}
+
+		LinearAllocator & get ()
+		{
+			return _allocator;
+		}
+
+	private:
+		std::vector<byte> _storage;
+		LinearAllocator _allocator;
+	};
+
+	bool parse (
+		const std::string & text,
+		TestAllocator & allocator,
+		MeshComponent & mesh,
+		ObjReferences * references = nullptr
+	) {
+		return ParseObj (text.data (), text.size (), allocator.get (), mesh, references);
+	}
+
+	/// An OBJ file describing a grid of quads, as exported by a modelling tool, with its
+	/// faces repeated faceRepeats times.
+	std::string makeGridObj (
+		uint size,
+		uint faceRepeats = 1
+	) {
+		std::string text = "# Generated grid\no grid\n";
+		char line[128];
+		for (uint y (0); y < size; ++y) {
+			for (uint x (0); x < size; ++x) {
+				std::snprintf (line, sizeof (line), "v %f %f %f\n", x * 0.013f - 1.5f,
+					y * 0.027f + 0.25f, (x ^ y) * -0.0031f);
+				text += line;
+			}
+		}
+		for (uint y (0); y < size; ++y) {
+			for (uint x (0); x < size; ++x) {
+				std::snprintf (line, sizeof (line), "vt %f %f\n", float (x) / size,
+					float (y) / size);
+				text += line;
+			}
+		}
+		text += "vn 0.000000 0.000000 1.000000\ns off\n";
+		for (uint repeat (0); repeat < faceRepeats; ++repeat) {
+			for (uint y (0); y + 1 < size; ++y) {
+				for (uint x (0); x + 1 < size; ++x) {
+					const uint a = y * size + x + 1;
+					const uint b = a + 1;
+					const uint c = b + size;
+					const uint d = a + size;
+					std::snprintf (line, sizeof (line), "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n",
+						a, a, b, b, c, c, d, d);
+					text += line;
+				}
+			}
+		}
+		return text;
+	}
+
+	/// Expects the parallel parser to produce the same mesh and references as ParseObj for
+	/// every chunk size.
+	void expectParallelMatchesSerial (
+		const std::string & text
+	) {
+		TestAllocator serialAllocator (MaxObjMeshBytes (text.size ()));
+		MeshComponent serial;
+		ObjReferences serialReferences;
+		ASSERT_TRUE (parse (text, serialAllocator, serial, &serialReferences));
+
+		JobSystem jobSystem (3);
+		const size_t chunkSizes[] = {1, 7, 64, 4096, obj_parser::MIN_CHUNK_SIZE};
+		for (size_t chunkSize : chunkSizes) {
+			TestAllocator allocator (MaxObjMeshBytes (text.size ()));
+			MeshComponent mesh;
+			ObjReferences references;
+			ASSERT_TRUE (ParseObj (jobSystem, text.data (), text.size (), allocator.get (), mesh,
+				&references, chunkSize));
+
+			ASSERT_EQ (serial.numVertices, mesh.numVertices) << chunkSize;
+			ASSERT_EQ (serial.numIndices, mesh.numIndices) << chunkSize;
+			EXPECT_EQ (0, std::memcmp (serial.vertices, mesh.vertices,
+				serial.numVertices * sizeof (Vertex))) << chunkSize;
+			EXPECT_EQ (0, std::memcmp (serial.indices, mesh.indices,
+				serial.numIndices * sizeof (Index))) << chunkSize;
+			EXPECT_STREQ (serialReferences.materialLibrary, references.materialLibrary);
+			EXPECT_STREQ (serialReferences.material, references.material);
+		}
+	}
+
+	/// Line by line parser using the standard library, for comparison.
+	uint parseWithStreams (
+		const std::string & text
+	) {
+		std::istringstream input (text);
+		std::vector<float> elements;
+		std::vector<uint> indices;
+		std::string line;
+		std::string keyword;
+		while (std::getline (input, line)) {
+			std::istringstream fields (line);
+			fields >> keyword;
+			if (keyword == "v" || keyword == "vt" || keyword == "vn") {
+				float value;
+				while (fields >> value) {
+					elements.push_back (value);
+				}
+			} else if (keyword == "f") {
+				std::string corner;
+				while (fields >> corner) {
+					indices.push_back (std::strtoul (corner.c_str (), nullptr, 10));
+				}
+			}
+		}
+		return uint (elements.size () + indices.size ());
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (ObjParser, parses_floats_like_strtof)
+{
+	const char * numbers[] = {
+		"0", "1", "-1", "+2.5", "0.000001", "1.000000", "-0.781084", "123456.789",
+		"3.14159265358979323846", "1e10", "1.5E-7", "-2.5e+3", "6.02214076e23",
+		"1.17549435e-38", "0.1", "9999999999999999999999", ".5", "5."
+	};
+
+	for (const char * number : numbers) {
+		float value = -42.0f;
+		const char * end = number + std::strlen (number);
+		EXPECT_EQ (end, obj_parser::ParseFloat (number, end, value)) << number;
+		EXPECT_EQ (std::strtof (number, nullptr), value) << number;
+	}
+}
+
+TEST (ObjParser, float_parsing_stops_at_line_end)
+{
+	const char text[] = "  \n1.0";
+	float value;
+	EXPECT_EQ (nullptr, obj_parser::ParseFloat (text, text + sizeof (text) - 1, value));
+}
+
+TEST (ObjParser, parses_triangle_with_every_element)
+{
+	TestAllocator allocator (4096);
+	MeshComponent mesh;
+	ASSERT_TRUE (parse (
+		"# comment\n"
+		"v 1 2 3\n"
+		"v 4 5 6\r\n"
+		"v 7 8 9\n"
+		"vt 0.5 0.25\n"
+		"vn 0 0 1\n"
+		"f 1/1/1 2/1/1 3/1/1\n", allocator, mesh));
+
+	ASSERT_EQ (3u, mesh.numVertices);
+	ASSERT_EQ (3u, mesh.numIndices);
+	EXPECT_EQ (4.0f, mesh.vertices[1].position[0]);
+	EXPECT_EQ (9.0f, mesh.vertices[2].position[2]);
+	EXPECT_EQ (1.0f, mesh.vertices[0].normal[2]);
+	EXPECT_EQ (0.25f, mesh.vertices[2].uv_diffuse[1]);
+	EXPECT_EQ (0, mesh.indices[0]);
+	EXPECT_EQ (1, mesh.indices[1]);
+	EXPECT_EQ (2, mesh.indices[2]);
+}
+
+TEST (ObjParser, triangulates_polygons_as_fans)
+{
+	TestAllocator allocator (4096);
+	MeshComponent mesh;
+	ASSERT_TRUE (parse (
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 1 0\n"
+		"f 1 2 3 4 5\n", allocator, mesh));
+
+	ASSERT_EQ (5u, mesh.numVertices);
+	const Index expected[] = {0, 1, 2, 0, 2, 3, 0, 3, 4};
+	ASSERT_EQ (9u, mesh.numIndices);
+	for (uint i (0); i < 9; ++i) {
+		EXPECT_EQ (expected[i], mesh.indices[i]) << i;
+	}
+}
+
+TEST (ObjParser, shares_vertices_with_identical_elements)
+{
+	TestAllocator allocator (4096);
+	MeshComponent mesh;
+	ASSERT_TRUE (parse (
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vn 0 0 1\nvn 0 0 -1\n"
+		"f 1//1 2//1 3//1\n"
+		"f 1//1 3//1 4//1\n"
+		"f 1//2 3//2 2//2\n", allocator, mesh));
+
+	// Corners differing only in their normal are separate vertices.
+	EXPECT_EQ (7u, mesh.numVertices);
+	const Index expected[] = {0, 1, 2, 0, 2, 3, 4, 5, 6};
+	ASSERT_EQ (9u, mesh.numIndices);
+	for (uint i (0); i < 9; ++i) {
+		EXPECT_EQ (expected[i], mesh.indices[i]) << i;
+	}
+	EXPECT_EQ (-1.0f, mesh.vertices[6].normal[2]);
+	EXPECT_EQ (1.0f, mesh.vertices[6].position[0]);
+	EXPECT_EQ (0.0f, mesh.vertices[6].uv_diffuse[0]);
+}
+
+TEST (ObjParser, resolves_relative_indices)
+{
+	TestAllocator allocator (4096);
+	MeshComponent mesh;
+	ASSERT_TRUE (parse (
+		"v 0 0 0\nv 1 0 0\nv 2 0 0\n"
+		"vt 0 0\n"
+		"f -3/-1 -2/-1 -1/-1\n"
+		"v 3 0 0\n"
+		"f -4/1 -2/1 -1/1\n", allocator, mesh));
+
+	ASSERT_EQ (6u, mesh.numIndices);
+	EXPECT_EQ (4u, mesh.numVertices);
+	EXPECT_EQ (0, mesh.indices[3]);
+	EXPECT_EQ (2, mesh.indices[4]);
+	EXPECT_EQ (3.0f, mesh.vertices[mesh.indices[5]].position[0]);
+}
+
+TEST (ObjParser, records_material_references)
+{
+	TestAllocator allocator (4096);
+	MeshComponent mesh;
+	ObjReferences references;
+	ASSERT_TRUE (parse (
+		"mtllib  ship materials.mtl \n"
+		"o ship\nv 0 0 0\nv 1 0 0\nv 1 1 0\n"
+		"usemtl Hull\ns 1\ng hull\n"
+		"f 1 2 3\n"
+		"usemtl Glass\n", allocator, mesh, &references));
+
+	EXPECT_STREQ ("ship materials.mtl", references.materialLibrary);
+	EXPECT_STREQ ("Hull", references.material);
+}
+
+TEST (ObjParser, rejects_malformed_input)
+{
+	const char * invalid[] = {
+		"v 1 2\n",
+		"vn 1 two 3\n",
+		"v 0 0 0\nv 1 0 0\nf 1 2\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 x\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 0\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 -4\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1/1 2/1 3/1\n",
+	};
+
+	for (const char * text : invalid) {
+		TestAllocator allocator (4096);
+		MeshComponent mesh;
+		EXPECT_FALSE (parse (text, allocator, mesh)) << text;
+	}
+}
+
+TEST (ObjParser, parses_meshes_beyond_16_bit_indices)
+{
+	const std::string text = makeGridObj (257);
+	TestAllocator allocator (MaxObjMeshBytes (text.size ()));
+	MeshComponent mesh;
+	ASSERT_TRUE (parse (text, allocator, mesh));
+
+	EXPECT_EQ (257u * 257u, mesh.numVertices);
+	EXPECT_EQ (256u * 256u * 6u, mesh.numIndices);
+	EXPECT_EQ (257u * 257u - 1u, mesh.indices[mesh.numIndices - 2]);
+
+	expectParallelMatchesSerial (text);
+}
+
+TEST (ObjParser, corner_table_capacity_stays_within_32_bits)
+{
+	EXPECT_EQ (16u, ObjCornerTableCapacity (0));
+	EXPECT_EQ (16u, ObjCornerTableCapacity (8));
+	EXPECT_EQ (32u, ObjCornerTableCapacity (9));
+
+	// Meshes can have at most 2^30 distinct corners, so larger inputs, which fail, are
+	// sized as if they had that many.
+	const size_t maxVertices = size_t (1) << 30;
+	EXPECT_EQ (0x80000000u, ObjCornerTableCapacity (maxVertices - 1));
+	EXPECT_EQ (0x80000000u, ObjCornerTableCapacity (maxVertices));
+	EXPECT_EQ (0x80000000u, ObjCornerTableCapacity (maxVertices + 1));
+	EXPECT_EQ (0x80000000u, ObjCornerTableCapacity (~size_t (0)));
+}
+
+TEST (ObjParser, parses_material)
+{
+	const std::string text =
+		"# Materials\n"
+		"newmtl Other\nKd 1 0 0\n\n"
+		"newmtl Material\n"
+		"Ns 96.078431\n"
+		"Ka 0.1 0.2 0.3\n"
+		"Kd 0.640000 0.640000 0.640000\n"
+		"Ks 0.5 0.5 0.5\n"
+		"Ke 0 0 0\n"
+		"d 0.75\n"
+		"illum 2\n"
+		"map_Kd Textures\\low_poly_ship_diffuse.png\n";
+
+	ObjMaterial material;
+	ASSERT_TRUE (ParseMtl (text.data (), text.size (), "Material", material));
+	EXPECT_STREQ ("Material", material.name);
+	EXPECT_FLOAT_EQ (96.078431f, material.specularExponent);
+	EXPECT_EQ (0.2f, material.ambient[1]);
+	EXPECT_EQ (0.64f, material.diffuse[2]);
+	EXPECT_EQ (0.75f, material.opacity);
+	EXPECT_STREQ ("Textures\\low_poly_ship_diffuse.png", material.diffuseMap);
+
+	ASSERT_TRUE (ParseMtl (text.data (), text.size (), nullptr, material));
+	EXPECT_STREQ ("Other", material.name);
+	EXPECT_EQ (1.0f, material.diffuse[0]);
+	EXPECT_EQ (1.0f, material.opacity);
+	EXPECT_STREQ ("", material.diffuseMap);
+
+	EXPECT_FALSE (ParseMtl (text.data (), text.size (), "Missing", material));
+}
+
+TEST (ObjParser, parses_ship_asset)
+{
+	std::vector<char> text;
+	ASSERT_TRUE (ReadWholeFile (SHIP_OBJ_PATH, text));
+
+	TestAllocator allocator (1 << 20);
+	MeshComponent mesh;
+	ObjReferences references;
+	ASSERT_TRUE (ParseObj (text.data (), text.size (), allocator.get (), mesh, &references));
+
+	EXPECT_GT (mesh.numVertices, 0u);
+	EXPECT_EQ (0u, mesh.numIndices % 3);
+	for (uint i (0); i < mesh.numIndices; ++i) {
+		ASSERT_LT (mesh.indices[i], mesh.numVertices);
+	}
+	EXPECT_STREQ ("low_poly_ship.mtl", references.materialLibrary);
+
+	ObjMaterial material;
+	ASSERT_TRUE (ReadWholeFile (SHIP_MTL_PATH, text));
+	ASSERT_TRUE (ParseMtl (text.data (), text.size (), references.material, material));
+	EXPECT_STREQ ("Textures\\low_poly_ship_diffuse.png", material.diffuseMap);
+}
+
+TEST (ObjParser, parallel_parse_matches_serial)
+{
+	expectParallelMatchesSerial (makeGridObj (40, 3));
+
+	// Relative indices referring to elements in earlier chunks.
+	expectParallelMatchesSerial (
+		"mtllib a.mtl\n"
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 1\nvn 0 0 1\n"
+		"usemtl first\n"
+		"f -4/-2/-1 -3/-1/-1 -2/-1/-1 -1/-2/-1\n"
+		"f 1/1/1 2/2/1 3/1/1\n"
+		"v 2 2 2\nvn 1 0 0\n"
+		"f -1//-1 -5//-2 -4//2\n"
+		"usemtl second\n"
+		"f -5 4 -1 2 -3\n");
+
+	std::vector<char> ship;
+	ASSERT_TRUE (ReadWholeFile (SHIP_OBJ_PATH, ship));
+	expectParallelMatchesSerial (std::string (ship.begin (), ship.end ()));
+}
+
+TEST (ObjParser, parallel_parse_rejects_malformed_input)
+{
+	JobSystem jobSystem (3);
+	const std::string invalid[] = {
+		makeGridObj (20) + "f 1 2\n",
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\n" + makeGridObj (20) + "f 1 2 -1000\n",
+		makeGridObj (20) + "f 1 2 999\n",
+	};
+
+	for (const std::string & text : invalid) {
+		TestAllocator allocator (1 << 20);
+		MeshComponent mesh;
+		EXPECT_FALSE (ParseObj (jobSystem, text.data (), text.size (), allocator.get (), mesh,
+			nullptr, 64));
+	}
+}
+
+TEST (ObjParserBenchmark, DISABLED_throughput)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const std::string text = makeGridObj (250);
+	const uint NUM_ROUNDS = 10;
+
+	TestAllocator allocator (4 << 20);
+	std::chrono::duration<double> parsed (0);
+	std::chrono::duration<double> streamed (0);
+	uint checksum = 0;
+
+	for (uint round (0); round < NUM_ROUNDS; ++round) {
+		allocator.get ().reset ();
+		MeshComponent mesh;
+		Clock::time_point start = Clock::now ();
+		ASSERT_TRUE (parse (text, allocator, mesh));
+		parsed += Clock::now () - start;
+		checksum += mesh.numIndices;
+
+		start = Clock::now ();
+		checksum += parseWithStreams (text);
+		streamed += Clock::now () - start;
+	}
+
+	const double megabytes = text.size () * double (NUM_ROUNDS) / (1 << 20);
+	std::printf ("%.1f MB OBJ: ParseObj %.0f MB/s, istringstream %.0f MB/s (%u)\n",
+		text.size () / double (1 << 20), megabytes / parsed.count (),
+		megabytes / streamed.count (), checksum);
+}
+
+TEST (ObjParserBenchmark, DISABLED_parallel_throughput)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const std::string text = makeGridObj (250, 4);
+	const uint NUM_ROUNDS = 5;
+	const double megabytes = text.size () * double (NUM_ROUNDS) / (1 << 20);
+
+	TestAllocator allocator (8 << 20);
+	std::chrono::duration<double> serial (0);
+	for (uint round (0); round < NUM_ROUNDS; ++round) {
+		allocator.get ().reset ();
+		MeshComponent mesh;
+		const Clock::time_point start = Clock::now ();
+		ASSERT_TRUE (parse (text, allocator, mesh));
+		serial += Clock::now () - start;
+	}
+	std::printf ("%.1f MB OBJ: serial %.0f MB/s\n", text.size () / double (1 << 20),
+		megabytes / serial.count ());
+
+	for (uint numThreads (1); numThreads <= std::thread::hardware_concurrency (); numThreads *= 2) {
+		JobSystem jobSystem (numThreads - 1);
+		std::chrono::duration<double> parallel (0);
+		for (uint round (0); round < NUM_ROUNDS; ++round) {
+			allocator.get ().reset ();
+			MeshComponent mesh;
+			const Clock::time_point start = Clock::now ();
+			ASSERT_TRUE (ParseObj (jobSystem, text.data (), text.size (), allocator.get (), mesh));
+			parallel += Clock::now () - start;
+		}
+		std::printf ("%u threads: %.0f MB/s\n", numThreads, megabytes / parallel.count ());
+	}
+}
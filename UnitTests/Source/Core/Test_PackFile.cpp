@@ -0,0 +1,232 @@
+//
+// Test_PackFile.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Source/Core/CookedAsset.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Core/PackFile.hpp"
+
+
+namespace
+{
+	const char * PACK_PATH = "Test_PackFile.pack";
+
+	std::vector<byte> makeData (
+		size_t size,
+		byte seed
+	) {
+		std::vector<byte> data (size);
+		for (size_t i (0); i < size; ++i) {
+			data[i] = static_cast<byte>(seed + i * 7);
+		}
+		return data;
+	}
+
+	void writeFile (
+		const char * path,
+		const std::vector<byte> & data
+	) {
+		std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file.write (reinterpret_cast<const char *>(data.data ()), data.size ());
+	}
+
+	std::vector<byte> readFile (
+		const char * path
+	) {
+		std::ifstream file (path, std::ios::in | std::ios::binary);
+		return std::vector<byte> (std::istreambuf_iterator<char> (file),
+			std::istreambuf_iterator<char> ());
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (PackFile, hashes_name_and_extension_as_one_string)
+{
+	EXPECT_EQ (HashAssetName ("low_poly_ship.mesh"), HashAssetName ("low_poly_ship", ".mesh"));
+	EXPECT_NE (HashAssetName ("low_poly_ship.mesh"), HashAssetName ("low_poly_ship.texture"));
+	EXPECT_EQ (14695981039346656037ull, HashAssetName (""));
+}
+
+TEST (PackFile, finds_every_asset_written)
+{
+	const char * names[] = {"a.mesh", "b.texture", "empty.shader", "c.material"};
+	const size_t sizes[] = {1, 4099, 0, 33};
+
+	PackWriter writer;
+	for (uint i (0); i < 4; ++i) {
+		const std::vector<byte> data = makeData (sizes[i], byte (i));
+		ASSERT_TRUE (writer.add (names[i], data.data (), data.size ()));
+	}
+	ASSERT_TRUE (writer.write (PACK_PATH));
+
+	PackFile pack;
+	ASSERT_TRUE (pack.open (PACK_PATH));
+	EXPECT_TRUE (pack.isOpen ());
+	EXPECT_EQ (4u, pack.numAssets ());
+
+	for (uint i (0); i < 4; ++i) {
+		size_t size;
+		const byte * data = pack.find (HashAssetName (names[i]), size);
+		ASSERT_NE (nullptr, data) << names[i];
+		ASSERT_EQ (sizes[i], size);
+		EXPECT_EQ (0u, reinterpret_cast<uintptr_t>(data) % PackWriter::ALIGNMENT);
+		EXPECT_EQ (0, std::memcmp (makeData (sizes[i], byte (i)).data (), data, size));
+	}
+
+	size_t size = 1;
+	EXPECT_EQ (nullptr, pack.find ("missing", ".mesh", size));
+	EXPECT_EQ (0u, size);
+
+	pack.close ();
+	EXPECT_FALSE (pack.isOpen ());
+	EXPECT_EQ (nullptr, pack.find ("a", ".mesh", size));
+	std::remove (PACK_PATH);
+}
+
+TEST (PackFile, rejects_assets_with_the_same_hash)
+{
+	const byte data[] = {1, 2, 3};
+	PackWriter writer;
+	EXPECT_TRUE (writer.add ("ship.mesh", data, sizeof (data)));
+	EXPECT_FALSE (writer.add ("ship.mesh", data, sizeof (data)));
+	EXPECT_EQ (1u, writer.numAssets ());
+}
+
+TEST (PackFile, rejects_invalid_files)
+{
+	PackFile pack;
+	EXPECT_FALSE (pack.open ("missing.pack"));
+
+	const std::vector<byte> data = makeData (100, 1);
+	PackWriter writer;
+	writer.add ("a.mesh", data.data (), data.size ());
+	writer.add ("b.mesh", data.data (), data.size ());
+	ASSERT_TRUE (writer.write (PACK_PATH));
+	const std::vector<byte> valid = readFile (PACK_PATH);
+
+	std::vector<byte> file (valid);
+	reinterpret_cast<PackHeader *>(file.data ())->magic ^= 1;
+	writeFile (PACK_PATH, file);
+	EXPECT_FALSE (pack.open (PACK_PATH));
+
+	file = valid;
+	reinterpret_cast<PackHeader *>(file.data ())->numEntries = 1000;
+	writeFile (PACK_PATH, file);
+	EXPECT_FALSE (pack.open (PACK_PATH));
+
+	// An asset running past the end of the file.
+	file = valid;
+	file.resize (file.size () - 1);
+	writeFile (PACK_PATH, file);
+	EXPECT_FALSE (pack.open (PACK_PATH));
+
+	// Entries out of order.
+	file = valid;
+	PackEntry * entries = reinterpret_cast<PackEntry *>(file.data () + sizeof (PackHeader));
+	std::swap (entries[0], entries[1]);
+	writeFile (PACK_PATH, file);
+	EXPECT_FALSE (pack.open (PACK_PATH));
+
+	writeFile (PACK_PATH, valid);
+	EXPECT_TRUE (pack.open (PACK_PATH));
+	std::remove (PACK_PATH);
+}
+
+TEST (PackFile, cooked_mesh_is_used_in_place)
+{
+	Vertex vertices[3] = {};
+	vertices[1].position[0] = 1.0f;
+	vertices[2].position[1] = 1.0f;
+	Index indices[3] = {0, 1, 2};
+	const MeshComponent source = {3, 3, vertices, indices};
+
+	std::vector<byte> blob;
+	CookMesh (source, blob);
+	PackWriter writer;
+	writer.add ("triangle.mesh", blob.data (), blob.size ());
+	ASSERT_TRUE (writer.write (PACK_PATH));
+
+	PackFile pack;
+	ASSERT_TRUE (pack.open (PACK_PATH));
+	size_t size;
+	const byte * data = pack.find ("triangle", ".mesh", size);
+	ASSERT_NE (nullptr, data);
+
+	MeshComponent mesh;
+	ASSERT_TRUE (ReadCookedMesh (data, size, mesh));
+	EXPECT_EQ (3u, mesh.numIndices);
+	EXPECT_EQ (1.0f, mesh.vertices[2].position[1]);
+	EXPECT_GT (reinterpret_cast<const byte *>(mesh.vertices), data);
+	EXPECT_LT (reinterpret_cast<const byte *>(mesh.indices), data + size);
+
+	pack.close ();
+	std::remove (PACK_PATH);
+}
+
+TEST (PackFileBenchmark, DISABLED_load_from_pack_and_loose_files)
+{
+	typedef std::chrono::high_resolution_clock Clock;
+	const uint NUM_ASSETS = 1000;
+	const size_t ASSET_SIZE = 8 << 10;
+
+	PackWriter writer;
+	std::vector<std::string> names;
+	for (uint i (0); i < NUM_ASSETS; ++i) {
+		names.push_back ("Test_PackFile_" + std::to_string (i) + ".bin");
+		const std::vector<byte> data = makeData (ASSET_SIZE, byte (i));
+		writeFile (names.back ().c_str (), data);
+		writer.add (names.back ().c_str (), data.data (), data.size ());
+	}
+	ASSERT_TRUE (writer.write (PACK_PATH));
+
+	std::vector<byte> storage (NUM_ASSETS * (ASSET_SIZE + 16));
+	LinearAllocator allocator (storage.data (), storage.size ());
+
+	// Sums a byte of every page, as a renderer uploading the assets would touch them.
+	uint64 sum = 0;
+	Clock::time_point start = Clock::now ();
+	for (uint i (0); i < NUM_ASSETS; ++i) {
+		size_t size;
+		const byte * data = ReadFileInto (names[i].c_str (), allocator, size);
+		ASSERT_NE (nullptr, data);
+		for (size_t j (0); j < size; j += 4096) {
+			sum += data[j];
+		}
+	}
+	const std::chrono::duration<double, std::milli> loose = Clock::now () - start;
+	allocator.reset ();
+
+	start = Clock::now ();
+	{
+		PackFile pack;
+		ASSERT_TRUE (pack.open (PACK_PATH));
+		for (uint i (0); i < NUM_ASSETS; ++i) {
+			size_t size;
+			const byte * data = pack.find (names[i].c_str (), "", size);
+			ASSERT_NE (nullptr, data);
+			for (size_t j (0); j < size; j += 4096) {
+				sum += data[j];
+			}
+		}
+	}
+	const std::chrono::duration<double, std::milli> packed = Clock::now () - start;
+
+	for (const std::string & name : names) {
+		std::remove (name.c_str ());
+	}
+	std::remove (PACK_PATH);
+
+	std::printf ("%u assets of %zu KB: loose files %.2f ms, pack file %.2f ms (%llu)\n",
+		NUM_ASSETS, ASSET_SIZE >> 10, loose.count (), packed.count (),
+		static_cast<unsigned long long>(sum));
+}
@@ -0,0 +1,246 @@
+//
+// Test_ParallelFor.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/ParallelFor.hpp"
+
+
+namespace
+{
+	/// Busy waits for roughly the given duration, standing in for an expensive item.
+	void spinFor (
+		std::chrono::nanoseconds duration
+	) {
+		const auto start = std::chrono::high_resolution_clock::now ();
+		while (std::chrono::high_resolution_clock::now () - start < duration) {
+		}
+	}
+
+	/// A contiguous range of indices, reduced by concatenation.
+	struct Span {
+		uint32 begin;
+		uint32 end;
+	};
+
+	/// Thread counts to benchmark, doubling up to the hardware thread count.
+	std::vector<uint> benchmarkThreadCounts ()
+	{
+		std::vector<uint> counts;
+		const uint hardwareThreads = std::max (std::thread::hardware_concurrency (), 1u);
+		for (uint count (1); count < hardwareThreads; count *= 2) {
+			counts.push_back (count);
+		}
+		counts.push_back (hardwareThreads);
+		return counts;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (ParallelFor, executes_every_index_once)
+{
+	JobSystem jobSystem (3);
+
+	const uint32 count = 100000;
+	std::vector<std::atomic<uint>> executed (count);
+	for (auto & value : executed) {
+		value = 0;
+	}
+
+	ParallelFor (jobSystem, 0, count, [&executed] (uint32 begin, uint32 end) {
+		for (uint32 i (begin); i < end; ++i) {
+			++executed[i];
+		}
+	});
+
+	for (uint32 i (0); i < count; ++i) {
+		EXPECT_EQ (1u, executed[i].load ()) << i;
+	}
+}
+
+TEST (ParallelFor, empty_range_does_nothing)
+{
+	JobSystem jobSystem (1);
+
+	bool called = false;
+	ParallelFor (jobSystem, 5, 5, [&called] (uint32, uint32) { called = true; });
+	EXPECT_FALSE (called);
+}
+
+TEST (ParallelFor, cheap_loops_stay_on_calling_thread)
+{
+	JobSystem jobSystem (3);
+
+	std::atomic<uint> otherThreads (0);
+	std::vector<float> values (100, 1.0f);
+	ParallelFor (jobSystem, 0, 100, [&] (uint32 begin, uint32 end) {
+		for (uint32 i (begin); i < end; ++i) {
+			values[i] *= 2.0f;
+		}
+		otherThreads += jobSystem.threadIndex () != 0;
+	});
+
+	EXPECT_EQ (0u, otherThreads.load ());
+	EXPECT_EQ (std::vector<float> (100, 2.0f), values);
+}
+
+TEST (ParallelFor, expensive_loops_are_split_into_jobs)
+{
+	JobSystem jobSystem (3);
+
+	std::atomic<uint> ranges (0);
+	std::atomic<uint> items (0);
+	ParallelFor (jobSystem, 0, 1000, [&] (uint32 begin, uint32 end) {
+		for (uint32 i (begin); i < end; ++i) {
+			spinFor (std::chrono::microseconds (1));
+		}
+		++ranges;
+		items += end - begin;
+	});
+
+	EXPECT_EQ (1000u, items.load ());
+	EXPECT_GT (ranges.load (), 10u);
+}
+
+TEST (ParallelReduce, matches_serial_sum)
+{
+	for (uint numWorkers : {0u, 3u}) {
+		JobSystem jobSystem (numWorkers);
+
+		const uint32 count = 1000000;
+		const uint64 sum = ParallelReduce (jobSystem, 0, count, uint64 (0),
+			[] (uint32 begin, uint32 end) {
+				uint64 partial = 0;
+				for (uint32 i (begin); i < end; ++i) {
+					partial += i;
+				}
+				return partial;
+			},
+			[] (uint64 a, uint64 b) { return a + b; }
+		);
+
+		EXPECT_EQ (uint64 (count) * (count - 1) / 2, sum) << numWorkers;
+	}
+}
+
+TEST (ParallelReduce, combines_adjacent_ranges_in_order)
+{
+	JobSystem jobSystem (3);
+
+	const Span empty = {0, 0};
+	const Span result = ParallelReduce (jobSystem, 0, 2000, empty,
+		[] (uint32 begin, uint32 end) {
+			spinFor (std::chrono::microseconds (end - begin));
+			return Span {begin, end};
+		},
+		[] (const Span & lower, const Span & upper) {
+			if (lower.begin == lower.end) {
+				return upper;
+			}
+			EXPECT_EQ (lower.end, upper.begin);
+			return Span {lower.begin, upper.end};
+		}
+	);
+
+	EXPECT_EQ (0u, result.begin);
+	EXPECT_EQ (2000u, result.end);
+}
+
+TEST (ParallelReduce, empty_range_returns_identity)
+{
+	JobSystem jobSystem (1);
+
+	const int result = ParallelReduce (jobSystem, 3, 3, 42,
+		[] (uint32, uint32) { return 0; },
+		[] (int a, int b) { return a + b; }
+	);
+	EXPECT_EQ (42, result);
+}
+
+// Run with --gtest_also_run_disabled_tests on a many-core machine to report scaling.
+TEST (ParallelForBenchmark, DISABLED_scaling)
+{
+	const uint32 count = 1 << 22;
+	const uint NUM_ROUNDS = 10;
+
+	std::vector<float> positions (count, 0.0f);
+	std::vector<float> velocities (count);
+	for (uint32 i (0); i < count; ++i) {
+		velocities[i] = 0.001f * (i % 1000);
+	}
+
+	const auto integrate = [&] (uint32 begin, uint32 end) {
+		for (uint32 i (begin); i < end; ++i) {
+			positions[i] = std::sqrt (positions[i] * positions[i] + velocities[i]);
+		}
+	};
+
+	double serialMilliseconds = 0.0;
+	for (uint numThreads : benchmarkThreadCounts ()) {
+		JobSystem jobSystem (numThreads - 1);
+
+		const auto start = std::chrono::high_resolution_clock::now ();
+		for (uint round (0); round < NUM_ROUNDS; ++round) {
+			ParallelFor (jobSystem, 0, count, integrate);
+		}
+		const std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::high_resolution_clock::now () - start;
+
+		const double milliseconds = elapsed.count () / NUM_ROUNDS;
+		if (numThreads == 1) {
+			serialMilliseconds = milliseconds;
+		}
+		std::printf ("ParallelFor, %2u threads, %u items: %.3f ms (%.2fx)\n",
+			numThreads, count, milliseconds, serialMilliseconds / milliseconds);
+	}
+}
+
+TEST (ParallelReduceBenchmark, DISABLED_scaling)
+{
+	const uint32 count = 1 << 22;
+	const uint NUM_ROUNDS = 10;
+
+	std::vector<float> values (count);
+	for (uint32 i (0); i < count; ++i) {
+		values[i] = float (i % 1000);
+	}
+
+	const auto sumOfRoots = [&values] (uint32 begin, uint32 end) {
+		double sum = 0.0;
+		for (uint32 i (begin); i < end; ++i) {
+			sum += std::sqrt (values[i]);
+		}
+		return sum;
+	};
+	const auto add = [] (double a, double b) { return a + b; };
+
+	double serialMilliseconds = 0.0;
+	for (uint numThreads : benchmarkThreadCounts ()) {
+		JobSystem jobSystem (numThreads - 1);
+
+		double sum = 0.0;
+		const auto start = std::chrono::high_resolution_clock::now ();
+		for (uint round (0); round < NUM_ROUNDS; ++round) {
+			sum += ParallelReduce (jobSystem, 0, count, 0.0, sumOfRoots, add);
+		}
+		const std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::high_resolution_clock::now () - start;
+
+		const double milliseconds = elapsed.count () / NUM_ROUNDS;
+		if (numThreads == 1) {
+			serialMilliseconds = milliseconds;
+		}
+		std::printf ("ParallelReduce, %2u threads, %u items: %.3f ms (%.2fx), sum %.0f\n",
+			numThreads, count, milliseconds, serialMilliseconds / milliseconds, sum / NUM_ROUNDS);
+	}
+}
@@ -0,0 +1,145 @@
+//
+// Test_Profiler.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "Engine/Source/Core/Profiler.hpp"
+
+
+namespace
+{
+	uint countOccurrences (
+		const std::string & text,
+		const std::string & pattern
+	) {
+		uint count = 0;
+		for (size_t i (text.find (pattern)); i != std::string::npos; i = text.find (pattern, i + 1)) {
+			++count;
+		}
+		return count;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (Profiler, zones_are_only_recorded_while_capturing)
+{
+	Profiler::BeginCapture (1);
+	Profiler::EndCapture ();
+	{
+		PROFILE_ZONE ("ignored");
+	}
+
+	EXPECT_FALSE (Profiler::IsCapturing ());
+	EXPECT_EQ (0u, Profiler::ZoneCount ());
+	EXPECT_EQ (std::string::npos, Profiler::ChromeTrace ().find ("ignored"));
+}
+
+TEST (Profiler, capture_ends_after_frame_count)
+{
+	Profiler::BeginCapture (3);
+	for (uint frame (0); frame < 5; ++frame) {
+		PROFILE_ZONE ("frame");
+		EXPECT_EQ (frame < 3, Profiler::IsCapturing ());
+		Profiler::NextFrame ();
+	}
+
+	// The third frame's zone ends after the capture, so is dropped.
+	EXPECT_EQ (2u, Profiler::ZoneCount ());
+}
+
+TEST (Profiler, capture_without_frame_count_lasts_until_ended)
+{
+	Profiler::BeginCapture (0);
+	for (uint frame (0); frame < 5; ++frame) {
+		PROFILE_ZONE ("frame");
+		Profiler::NextFrame ();
+	}
+	EXPECT_TRUE (Profiler::IsCapturing ());
+
+	Profiler::EndCapture ();
+	EXPECT_EQ (5u, Profiler::ZoneCount ());
+}
+
+TEST (Profiler, exports_nested_zones_from_every_thread)
+{
+	Profiler::BeginCapture (1);
+	{
+		PROFILE_ZONE ("outer");
+		{
+			PROFILE_ZONE ("inner \"quoted\"");
+		}
+
+		std::thread worker ([] {
+			Profiler::SetThreadName ("Test Worker");
+			for (uint i (0); i < 10; ++i) {
+				PROFILE_ZONE ("worker");
+			}
+		});
+		worker.join ();
+	}
+	Profiler::NextFrame ();
+
+	EXPECT_EQ (12u, Profiler::ZoneCount ());
+
+	const std::string trace = Profiler::ChromeTrace ();
+	EXPECT_EQ (0u, trace.find ("{\"traceEvents\":["));
+	EXPECT_EQ (12u, countOccurrences (trace, "\"ph\":\"X\""));
+	EXPECT_EQ (1u, countOccurrences (trace, "\"name\":\"outer\""));
+	EXPECT_EQ (1u, countOccurrences (trace, "\"name\":\"inner \\\"quoted\\\"\""));
+	EXPECT_EQ (10u, countOccurrences (trace, "\"name\":\"worker\""));
+	EXPECT_EQ (1u, countOccurrences (trace, "\"args\":{\"name\":\"Test Worker\"}"));
+}
+
+TEST (Profiler, new_capture_discards_previous_zones)
+{
+	Profiler::BeginCapture (1);
+	{
+		PROFILE_ZONE ("first");
+	}
+	Profiler::NextFrame ();
+
+	Profiler::BeginCapture (1);
+	{
+		PROFILE_ZONE ("second");
+	}
+	Profiler::EndCapture ();
+
+	const std::string trace = Profiler::ChromeTrace ();
+	EXPECT_EQ (1u, Profiler::ZoneCount ());
+	EXPECT_EQ (std::string::npos, trace.find ("first"));
+	EXPECT_NE (std::string::npos, trace.find ("second"));
+}
+
+// Run with --gtest_also_run_disabled_tests to report the cost of a zone.
+TEST (ProfilerBenchmark, DISABLED_zone_cost)
+{
+	const uint NUM_ZONES = Profiler::EVENTS_PER_THREAD;
+	const uint NUM_ROUNDS = 20;
+
+	for (bool capturing : {false, true}) {
+		std::chrono::duration<double, std::nano> elapsed (0);
+		for (uint round (0); round < NUM_ROUNDS; ++round) {
+			if (capturing) {
+				Profiler::BeginCapture (1);
+			}
+
+			const auto start = std::chrono::high_resolution_clock::now ();
+			for (uint i (0); i < NUM_ZONES; ++i) {
+				PROFILE_ZONE ("zone");
+			}
+			elapsed += std::chrono::high_resolution_clock::now () - start;
+
+			Profiler::EndCapture ();
+		}
+
+		std::printf ("%s: %.1f ns per zone\n", capturing ? "capturing" : "not capturing",
+			elapsed.count () / (NUM_ZONES * NUM_ROUNDS));
+	}
+}
@@ -0,0 +1,118 @@
+//
+// Test_RadixSort.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/RadixSort.hpp"
+
+
+namespace
+{
+	std::vector<SortEntry> makeEntries (
+		uint32 count,
+		uint64 keyMask,
+		uint32 seed
+	) {
+		std::mt19937_64 random (seed);
+		std::vector<SortEntry> entries (count);
+		for (uint32 i (0); i < count; ++i) {
+			entries[i].key = random () & keyMask;
+			entries[i].index = i;
+		}
+		return entries;
+	}
+
+	void expectMatchesStableSort (
+		std::vector<SortEntry> entries,
+		JobSystem & jobSystem
+	) {
+		std::vector<SortEntry> expected = entries;
+		std::stable_sort (expected.begin (), expected.end (),
+			[] (const SortEntry & a, const SortEntry & b) { return a.key < b.key; });
+
+		std::vector<SortEntry> scratch (entries.size ());
+		RadixSort (entries.data (), scratch.data (), uint32 (entries.size ()), jobSystem);
+
+		for (size_t i (0); i < entries.size (); ++i) {
+			ASSERT_EQ (expected[i].key, entries[i].key) << "at " << i;
+			ASSERT_EQ (expected[i].index, entries[i].index) << "at " << i;
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (RadixSort, sorts_trivial_inputs)
+{
+	JobSystem jobSystem (0);
+	expectMatchesStableSort ({}, jobSystem);
+	expectMatchesStableSort (makeEntries (1, ~0ull, 1), jobSystem);
+	expectMatchesStableSort (makeEntries (2, ~0ull, 2), jobSystem);
+}
+
+TEST (RadixSort, sorts_random_keys)
+{
+	JobSystem jobSystem (0);
+	expectMatchesStableSort (makeEntries (1000, ~0ull, 3), jobSystem);
+}
+
+TEST (RadixSort, is_stable_with_duplicate_keys)
+{
+	JobSystem jobSystem (3);
+	expectMatchesStableSort (makeEntries (100000, 0xF0000000000000F0ull, 4), jobSystem);
+}
+
+TEST (RadixSort, parallel_matches_serial)
+{
+	JobSystem jobSystem (3);
+	expectMatchesStableSort (makeEntries (200000, ~0ull, 5), jobSystem);
+	expectMatchesStableSort (makeEntries (65537, 0x00FFFF0000000000ull, 6), jobSystem);
+}
+
+TEST (RadixSort, identical_keys_are_left_in_place)
+{
+	JobSystem jobSystem (3);
+	std::vector<SortEntry> entries = makeEntries (50000, 0, 7);
+	expectMatchesStableSort (entries, jobSystem);
+}
+
+// Run with --gtest_also_run_disabled_tests to report sort times.
+TEST (RadixSortBenchmark, DISABLED_sort_times)
+{
+	JobSystem jobSystem (JobSystem::DefaultWorkerThreadCount ());
+	const int repetitions = 20;
+
+	for (uint32 count : {10000u, 50000u, 100000u, 200000u}) {
+		const std::vector<SortEntry> input = makeEntries (count, ~0ull, count);
+		std::vector<SortEntry> entries (count);
+		std::vector<SortEntry> scratch (count);
+
+		double radixMs = 0.0;
+		double stdSortMs = 0.0;
+		for (int r (0); r < repetitions; ++r) {
+			entries = input;
+			auto start = std::chrono::high_resolution_clock::now ();
+			RadixSort (entries.data (), scratch.data (), count, jobSystem);
+			auto end = std::chrono::high_resolution_clock::now ();
+			radixMs += std::chrono::duration<double, std::milli> (end - start).count ();
+
+			entries = input;
+			start = std::chrono::high_resolution_clock::now ();
+			std::sort (entries.begin (), entries.end (),
+				[] (const SortEntry & a, const SortEntry & b) { return a.key < b.key; });
+			end = std::chrono::high_resolution_clock::now ();
+			stdSortMs += std::chrono::duration<double, std::milli> (end - start).count ();
+		}
+
+		std::printf ("%6u items, %u threads: radix %.3f ms, std::sort %.3f ms\n",
+			count, jobSystem.threadCount (), radixMs / repetitions, stdSortMs / repetitions);
+	}
+}
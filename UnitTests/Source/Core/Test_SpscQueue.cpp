@@ -0,0 +1,110 @@
+//
+// Test_SpscQueue.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Engine/Source/Core/InputEvent.hpp"
+#include "Engine/Source/Core/SpscQueue.hpp"
+
+
+//---------------------------------------------------------------------------------------
+TEST (SpscQueue, pops_in_push_order_until_empty)
+{
+	SpscQueue<uint> queue (4);
+	EXPECT_EQ (4u, queue.capacity ());
+
+	for (uint i (0); i < 4; ++i) {
+		EXPECT_TRUE (queue.tryPush (i));
+	}
+	EXPECT_FALSE (queue.tryPush (4));
+	EXPECT_EQ (4u, queue.size ());
+
+	uint value;
+	for (uint i (0); i < 4; ++i) {
+		ASSERT_TRUE (queue.tryPop (value));
+		EXPECT_EQ (i, value);
+	}
+	EXPECT_FALSE (queue.tryPop (value));
+	EXPECT_EQ (0u, queue.size ());
+}
+
+TEST (SpscQueue, wraps_around_capacity)
+{
+	SpscQueue<uint> queue (4);
+
+	uint value;
+	for (uint i (0); i < 100; ++i) {
+		EXPECT_TRUE (queue.tryPush (i));
+		EXPECT_TRUE (queue.tryPush (i + 1000));
+		ASSERT_TRUE (queue.tryPop (value));
+		EXPECT_EQ (i, value);
+		ASSERT_TRUE (queue.tryPop (value));
+		EXPECT_EQ (i + 1000, value);
+	}
+}
+
+TEST (SpscQueue, concurrent_consumer_receives_every_event_in_order)
+{
+	const uint64 NUM_EVENTS = 1000000;
+
+	SpscQueue<InputEvent> queue (64);
+	std::thread producer ([&queue] {
+		for (uint64 i (0); i < NUM_EVENTS; ++i) {
+			const InputEvent event = {
+				i % 2 ? InputEventType::KeyUp : InputEventType::KeyDown, uint8 (i), i
+			};
+			while (!queue.tryPush (event)) {
+				std::this_thread::yield ();
+			}
+		}
+	});
+
+	InputEvent event;
+	for (uint64 i (0); i < NUM_EVENTS; ++i) {
+		while (!queue.tryPop (event)) {
+			std::this_thread::yield ();
+		}
+		ASSERT_EQ (i, event.timestamp);
+		ASSERT_EQ (uint8 (i), event.virtualKey);
+		ASSERT_EQ (i % 2 ? InputEventType::KeyUp : InputEventType::KeyDown, event.type);
+	}
+	producer.join ();
+
+	EXPECT_FALSE (queue.tryPop (event));
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (SpscQueueBenchmark, DISABLED_messages_per_second)
+{
+	const uint64 NUM_MESSAGES = 20000000;
+
+	SpscQueue<uint64> queue (1024);
+	const auto start = std::chrono::high_resolution_clock::now ();
+	std::thread producer ([&queue] {
+		for (uint64 i (0); i < NUM_MESSAGES; ++i) {
+			while (!queue.tryPush (i)) {
+				std::this_thread::yield ();
+			}
+		}
+	});
+
+	uint64 sum = 0;
+	uint64 value;
+	for (uint64 i (0); i < NUM_MESSAGES; ++i) {
+		while (!queue.tryPop (value)) {
+			std::this_thread::yield ();
+		}
+		sum += value;
+	}
+	producer.join ();
+	const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now () - start;
+
+	EXPECT_EQ (NUM_MESSAGES * (NUM_MESSAGES - 1) / 2, sum);
+	std::printf ("1 producer, 1 consumer: %.1f million messages/s\n",
+		NUM_MESSAGES / elapsed.count () / 1e6);
+}
@@ -0,0 +1,133 @@
+//
+// Test_TaskGraph.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Engine/Source/Core/TaskGraph.hpp"
+
+
+namespace
+{
+	/// Busy waits for roughly the given duration.
+	void spinFor (
+		std::chrono::microseconds duration
+	) {
+		const auto start = std::chrono::high_resolution_clock::now ();
+		while (std::chrono::high_resolution_clock::now () - start < duration) {
+		}
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (TaskGraph, tasks_start_after_their_dependencies_end)
+{
+	JobSystem jobSystem (3);
+	TaskGraph graph (jobSystem);
+
+	// Diamond: a -> {b, c} -> d, with e independent.
+	std::atomic<uint> runs[5];
+	for (auto & count : runs) {
+		count = 0;
+	}
+	const TaskId a = graph.addTask ("a", [&] { ++runs[0]; });
+	const TaskId b = graph.addTask ("b", [&] { ++runs[1]; }, {a});
+	const TaskId c = graph.addTask ("c", [&] { ++runs[2]; }, {a});
+	const TaskId d = graph.addTask ("d", [&] { ++runs[3]; }, {b, c});
+	const TaskId e = graph.addTask ("e", [&] { ++runs[4]; });
+	graph.compile ();
+
+	EXPECT_EQ (5u, graph.taskCount ());
+	EXPECT_STREQ ("c", graph.taskName (c));
+
+	for (uint frame (0); frame < 100; ++frame) {
+		graph.execute ();
+
+		EXPECT_GE (graph.taskTiming (b).start, graph.taskTiming (a).end);
+		EXPECT_GE (graph.taskTiming (c).start, graph.taskTiming (a).end);
+		EXPECT_GE (graph.taskTiming (d).start, graph.taskTiming (b).end);
+		EXPECT_GE (graph.taskTiming (d).start, graph.taskTiming (c).end);
+		EXPECT_LE (graph.taskTiming (e).end, graph.frameMilliseconds ());
+	}
+
+	for (auto & count : runs) {
+		EXPECT_EQ (100u, count.load ());
+	}
+}
+
+TEST (TaskGraph, critical_path_follows_longest_chain)
+{
+	// Durations are measured in wall time, so run on one thread to keep other tasks
+	// from inflating them.
+	JobSystem jobSystem (0);
+	TaskGraph graph (jobSystem);
+
+	const TaskId input = graph.addTask ("input", [] { });
+	const TaskId slow = graph.addTask ("slow", [] { spinFor (std::chrono::microseconds (3000)); }, {input});
+	const TaskId fast = graph.addTask ("fast", [] { spinFor (std::chrono::microseconds (100)); }, {input});
+	const TaskId submit = graph.addTask ("submit", [] { }, {fast, slow});
+	graph.compile ();
+	graph.execute ();
+
+	const std::vector<TaskId> expected = {input, slow, submit};
+	EXPECT_EQ (expected, graph.criticalPath ());
+	EXPECT_GE (graph.criticalPathMilliseconds (), 3.0);
+	EXPECT_LE (graph.criticalPathMilliseconds (), graph.frameMilliseconds ());
+
+	const std::string report = graph.report ();
+	EXPECT_NE (std::string::npos, report.find ("input"));
+	EXPECT_NE (std::string::npos, report.find ("> slow"));
+	EXPECT_EQ (std::string::npos, report.find ("fast"));
+}
+
+TEST (TaskGraph, single_threaded_execution_runs_every_task)
+{
+	JobSystem jobSystem (0);
+	TaskGraph graph (jobSystem);
+
+	std::vector<TaskId> order;
+	TaskId previous = graph.addTask ("0", [&] { order.push_back (0); });
+	for (TaskId i (1); i < 7; ++i) {
+		previous = graph.addTask ("n", [&order, i] { order.push_back (i); }, {previous});
+	}
+	graph.compile ();
+	graph.execute ();
+
+	const std::vector<TaskId> expected = {0, 1, 2, 3, 4, 5, 6};
+	EXPECT_EQ (expected, order);
+	EXPECT_EQ (expected, graph.criticalPath ());
+}
+
+// Run with --gtest_also_run_disabled_tests to report scheduling overhead.
+TEST (TaskGraphBenchmark, DISABLED_empty_frame_overhead)
+{
+	const uint NUM_FRAMES = 10000;
+
+	JobSystem jobSystem (JobSystem::DefaultWorkerThreadCount ());
+	TaskGraph graph (jobSystem);
+
+	const TaskId input = graph.addTask ("input", [] { });
+	const TaskId simulation = graph.addTask ("simulation", [] { }, {input});
+	const TaskId collision = graph.addTask ("collision", [] { }, {simulation});
+	const TaskId extract = graph.addTask ("extract", [] { }, {collision});
+	const TaskId cull = graph.addTask ("cull", [] { }, {extract});
+	const TaskId sort = graph.addTask ("sort", [] { }, {cull});
+	graph.addTask ("submit", [] { }, {sort});
+	graph.compile ();
+
+	const auto start = std::chrono::high_resolution_clock::now ();
+	for (uint frame (0); frame < NUM_FRAMES; ++frame) {
+		graph.execute ();
+	}
+	const std::chrono::duration<double, std::micro> elapsed =
+		std::chrono::high_resolution_clock::now () - start;
+
+	std::printf ("%u threads, %u tasks: %.2f us per frame\n%s\n", jobSystem.threadCount (),
+		graph.taskCount (), elapsed.count () / NUM_FRAMES, graph.report ().c_str ());
+}
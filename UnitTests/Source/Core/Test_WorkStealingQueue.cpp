@@ -0,0 +1,104 @@
+//
+// Test_WorkStealingQueue.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/WorkStealingQueue.hpp"
+
+
+//---------------------------------------------------------------------------------------
+TEST (WorkStealingQueue, owner_pops_newest_and_thieves_steal_oldest)
+{
+	WorkStealingQueue queue (8);
+	Job jobs[3];
+	for (Job & job : jobs) {
+		queue.push (&job);
+	}
+	EXPECT_EQ (3u, queue.size ());
+
+	EXPECT_EQ (&jobs[2], queue.pop ());
+	EXPECT_EQ (&jobs[0], queue.steal ());
+	EXPECT_EQ (&jobs[1], queue.pop ());
+	EXPECT_EQ (nullptr, queue.pop ());
+	EXPECT_EQ (nullptr, queue.steal ());
+	EXPECT_EQ (0u, queue.size ());
+}
+
+TEST (WorkStealingQueue, wraps_around_capacity)
+{
+	WorkStealingQueue queue (4);
+	Job jobs[4];
+
+	for (uint round (0); round < 10; ++round) {
+		for (Job & job : jobs) {
+			queue.push (&job);
+		}
+		for (Job & job : jobs) {
+			EXPECT_EQ (&job, queue.steal ());
+		}
+	}
+	EXPECT_EQ (nullptr, queue.pop ());
+}
+
+TEST (WorkStealingQueue, concurrent_thieves_take_each_job_once)
+{
+	const uint NUM_JOBS = 100000;
+	const uint NUM_THIEVES = 3;
+
+	std::vector<Job> jobs (NUM_JOBS);
+	std::vector<std::atomic<uint>> taken (NUM_JOBS);
+	for (auto & count : taken) {
+		count = 0;
+	}
+
+	WorkStealingQueue queue (1024);
+	std::atomic<bool> done (false);
+
+	auto take = [&] (Job * job) {
+		++taken[job - jobs.data ()];
+	};
+
+	std::vector<std::thread> thieves;
+	for (uint i (0); i < NUM_THIEVES; ++i) {
+		thieves.emplace_back ([&] {
+			while (!done.load ()) {
+				if (Job * job = queue.steal ()) {
+					take (job);
+				}
+			}
+		});
+	}
+
+	// The owner pushes in bursts and pops some of them back, racing the thieves.
+	for (uint i (0); i < NUM_JOBS; ++i) {
+		while (queue.size () >= 512) {
+			if (Job * job = queue.pop ()) {
+				take (job);
+			}
+		}
+		queue.push (&jobs[i]);
+		if (i % 3 == 0) {
+			if (Job * job = queue.pop ()) {
+				take (job);
+			}
+		}
+	}
+	while (Job * job = queue.pop ()) {
+		take (job);
+	}
+
+	done = true;
+	for (std::thread & thief : thieves) {
+		thief.join ();
+	}
+
+	for (uint i (0); i < NUM_JOBS; ++i) {
+		ASSERT_EQ (1u, taken[i].load ()) << i;
+	}
+}
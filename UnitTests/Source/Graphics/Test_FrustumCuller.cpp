@@ -0,0 +1,183 @@
+//
+// Test_FrustumCuller.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Graphics/FrustumCuller.hpp"
+
+
+namespace
+{
+	/// Camera at the origin looking down +z, with a 90 degree field of view.
+	Matrix4 makeViewProjection ()
+	{
+		return math::perspectiveFovLH (1.5707963f, 1.0f, 1.0f, 100.0f);
+	}
+
+	/// Spheres scattered through a volume several times larger than the frustum.
+	void makeRandomSpheres (
+		uint32 count,
+		BoundingSpheres & spheres
+	) {
+		std::mt19937 rng (count);
+		std::uniform_real_distribution<float> position (-150.0f, 150.0f);
+		std::uniform_real_distribution<float> radius (0.1f, 5.0f);
+
+		spheres.clear ();
+		spheres.reserve (count);
+		for (uint32 i (0); i < count; ++i) {
+			spheres.add (position (rng), position (rng), position (rng), radius (rng));
+		}
+	}
+
+	std::vector<uint32> cullScalar (
+		const Frustum & frustum,
+		const BoundingSpheres & spheres
+	) {
+		std::vector<uint32> visible (spheres.size ());
+		visible.resize (FrustumCuller::CullScalar (frustum, spheres, visible.data ()));
+		return visible;
+	}
+
+	std::vector<uint32> cull (
+		FrustumCuller & culler,
+		const Frustum & frustum,
+		const BoundingSpheres & spheres
+	) {
+		std::vector<uint32> visible (spheres.size ());
+		visible.resize (culler.cull (frustum, spheres, visible.data ()));
+		return visible;
+	}
+}
+
+
+//---------------------------------------------------------------------------------------
+TEST (FrustumCuller, extracts_inward_facing_normalized_planes)
+{
+	const Frustum frustum = Frustum::FromViewProjection (makeViewProjection ());
+
+	// A point on the view axis between the near and far planes is inside every plane.
+	const float point[3] = {0.0f, 0.0f, 50.0f};
+	for (uint p (0); p < Frustum::NUM_PLANES; ++p) {
+		const float * plane = frustum.planes[p];
+		EXPECT_NEAR (1.0f, plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2], 1e-5f);
+		EXPECT_GT (plane[0] * point[0] + plane[1] * point[1] + plane[2] * point[2] + plane[3], 0.0f);
+	}
+
+	EXPECT_NEAR (-1.0f, frustum.planes[Frustum::Near][3], 1e-5f);
+	EXPECT_NEAR (100.0f, frustum.planes[Frustum::Far][3], 1e-3f);
+}
+
+TEST (FrustumCuller, classifies_spheres_against_each_plane)
+{
+	JobSystem jobSystem (0);
+	FrustumCuller culler (jobSystem);
+	const Frustum frustum = Frustum::FromViewProjection (makeViewProjection ());
+
+	BoundingSpheres spheres;
+	spheres.add (0.0f, 0.0f, 10.0f, 1.0f);     // 0: inside
+	spheres.add (0.0f, 0.0f, -5.0f, 1.0f);     // 1: behind the camera
+	spheres.add (0.0f, 0.0f, 0.5f, 1.0f);      // 2: straddles the near plane
+	spheres.add (0.0f, 0.0f, 150.0f, 10.0f);   // 3: beyond the far plane
+	spheres.add (-20.0f, 0.0f, 10.0f, 1.0f);   // 4: left of the frustum
+	spheres.add (11.0f, 0.0f, 10.0f, 1.5f);    // 5: straddles the right plane
+	spheres.add (0.0f, 20.0f, 10.0f, 1.0f);    // 6: above the frustum
+	spheres.add (0.0f, -10.5f, 10.0f, 1.0f);   // 7: straddles the bottom plane
+	spheres.add (0.0f, 0.0f, 99.5f, 1.0f);     // 8: straddles the far plane
+
+	const std::vector<uint32> expected = {0, 2, 5, 7, 8};
+	EXPECT_EQ (expected, cullScalar (frustum, spheres));
+	EXPECT_EQ (expected, cull (culler, frustum, spheres));
+}
+
+TEST (FrustumCuller, matches_scalar_reference)
+{
+	JobSystem jobSystem (3);
+	FrustumCuller culler (jobSystem);
+	BoundingSpheres spheres;
+
+	const Frustum frustum = Frustum::FromViewProjection (math::multiply (
+		math::multiply (math::rotationY (0.7f), math::translation (5.0f, -3.0f, 20.0f)),
+		makeViewProjection ()));
+
+	// Counts exercise partial SIMD groups and partial worker blocks.
+	for (uint32 count : {0u, 1u, 7u, 8u, 1003u, FrustumCuller::BLOCK_SIZE * 3 + 5}) {
+		makeRandomSpheres (count, spheres);
+		const std::vector<uint32> expected = cullScalar (frustum, spheres);
+
+		culler.setAvx2Enabled (true);
+		EXPECT_EQ (expected, cull (culler, frustum, spheres)) << count;
+
+		culler.setAvx2Enabled (false);
+		EXPECT_EQ (expected, cull (culler, frustum, spheres)) << count;
+	}
+}
+
+TEST (FrustumCuller, output_is_independent_of_thread_count)
+{
+	BoundingSpheres spheres;
+	makeRandomSpheres (100000, spheres);
+	const Frustum frustum = Frustum::FromViewProjection (makeViewProjection ());
+
+	JobSystem serialJobSystem (0);
+	FrustumCuller serialCuller (serialJobSystem);
+	JobSystem threadedJobSystem (3);
+	FrustumCuller threadedCuller (threadedJobSystem);
+
+	const std::vector<uint32> serial = cull (serialCuller, frustum, spheres);
+	EXPECT_GT (serial.size (), 0u);
+	EXPECT_LT (serial.size (), spheres.size ());
+	EXPECT_EQ (serial, cull (threadedCuller, frustum, spheres));
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (FrustumCullerBenchmark, DISABLED_cull_100k_spheres)
+{
+	const uint32 NUM_SPHERES = 100000;
+	const uint NUM_ITERATIONS = 200;
+
+	BoundingSpheres spheres;
+	makeRandomSpheres (NUM_SPHERES, spheres);
+	const Frustum frustum = Frustum::FromViewProjection (makeViewProjection ());
+	std::vector<uint32> visible (NUM_SPHERES);
+
+	JobSystem serialJobSystem (0);
+	JobSystem threadedJobSystem (JobSystem::DefaultWorkerThreadCount ());
+	FrustumCuller serialCuller (serialJobSystem);
+	FrustumCuller threadedCuller (threadedJobSystem);
+
+	auto measure = [&] (const char * name, const std::function<uint32 ()> & cullOnce) {
+		uint32 visibleCount = 0;
+		const auto start = std::chrono::high_resolution_clock::now ();
+		for (uint i (0); i < NUM_ITERATIONS; ++i) {
+			visibleCount = cullOnce ();
+		}
+		const std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::high_resolution_clock::now () - start;
+		std::printf ("%-24s %8.3f ms per cull, %u of %u visible\n",
+			name, elapsed.count () / NUM_ITERATIONS, visibleCount, NUM_SPHERES);
+	};
+
+	measure ("scalar reference", [&] () {
+		return FrustumCuller::CullScalar (frustum, spheres, visible.data ());
+	});
+
+	serialCuller.setAvx2Enabled (true);
+	measure ("avx2, 1 thread", [&] () {
+		return serialCuller.cull (frustum, spheres, visible.data ());
+	});
+
+	char name[32];
+	std::snprintf (name, sizeof (name), "avx2, %u threads", threadedJobSystem.threadCount ());
+	measure (name, [&] () {
+		return threadedCuller.cull (frustum, spheres, visible.data ());
+	});
+}
@@ -0,0 +1,127 @@
+//
+// Test_NullRenderer.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "Engine/Source/Graphics/NullRenderer.hpp"
+
+
+class NullRendererTest : public ::testing::Test {
+protected:
+	NullRenderer renderer;
+
+	Vertex vertices[4];
+	Index indices[6];
+
+	MeshComponent meshA;
+	MeshComponent meshB;
+
+	Material materialA;
+	Material materialB;
+
+	void SetUp () override
+	{
+		renderer.initialize (nullptr);
+
+		meshA = {4, 6, vertices, indices};
+		meshB = {4, 3, vertices, indices};
+
+		// Both materials share a shader pipeline.
+		materialA.shaderGroup.vertexShader = AssetHandle<CompiledShader>::MakeReady ();
+		materialA.shaderGroup.pixelShader = AssetHandle<CompiledShader>::MakeReady ();
+		materialB.shaderGroup = materialA.shaderGroup;
+	}
+
+	DrawCall makeDrawCall (
+		const MeshComponent & mesh,
+		const Material & material,
+		uint32 instanceCount = 1
+	) {
+		DrawCall drawCall;
+		drawCall.mesh = &mesh;
+		drawCall.material = &material;
+		drawCall.instanceCount = instanceCount;
+		return drawCall;
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (NullRendererTest, records_nothing_for_empty_frame)
+{
+	renderer.render ();
+	renderer.present ();
+
+	EXPECT_TRUE (renderer.commandStream ().empty ());
+	EXPECT_EQ (0u, renderer.frameStats ().drawCalls);
+	EXPECT_EQ (1u, renderer.frameCount ());
+}
+
+TEST_F (NullRendererTest, counts_draws_and_instances)
+{
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.submit (makeDrawCall (meshA, materialA, 10));
+	renderer.render ();
+
+	const RenderStats & stats = renderer.frameStats ();
+	EXPECT_EQ (2u, stats.drawCalls);
+	EXPECT_EQ (11u, stats.instances);
+	EXPECT_EQ (22u, stats.triangles);
+}
+
+TEST_F (NullRendererTest, filters_redundant_state_changes)
+{
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.submit (makeDrawCall (meshB, materialA));
+	renderer.submit (makeDrawCall (meshB, materialB));
+	renderer.render ();
+
+	// Pipeline + materialA + meshA, then meshB, then materialB.
+	EXPECT_EQ (5u, renderer.frameStats ().stateChanges);
+}
+
+TEST_F (NullRendererTest, uploads_each_mesh_once)
+{
+	const uint64 meshBytes = 4 * sizeof (Vertex) + 6 * sizeof (Index);
+
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.submit (makeDrawCall (meshB, materialA));
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.render ();
+	EXPECT_EQ (meshBytes + 4 * sizeof (Vertex) + 3 * sizeof (Index),
+		renderer.frameStats ().bytesUploaded);
+
+	// Meshes stay resident across frames.
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.render ();
+	EXPECT_EQ (0u, renderer.frameStats ().bytesUploaded);
+
+	renderer.evictUploadedMeshes ();
+	renderer.submit (makeDrawCall (meshA, materialA));
+	renderer.render ();
+	EXPECT_EQ (meshBytes, renderer.frameStats ().bytesUploaded);
+}
+
+TEST_F (NullRendererTest, replay_reproduces_command_stream)
+{
+	renderer.submit (makeDrawCall (meshA, materialA, 3));
+	renderer.submit (makeDrawCall (meshB, materialB));
+	renderer.submit (makeDrawCall (meshA, materialB, 2));
+	renderer.render ();
+
+	const RenderCommandStream recorded = renderer.commandStream ();
+	const RenderStats recordedStats = renderer.frameStats ();
+
+	renderer.replay (recorded);
+	renderer.render ();
+
+	const RenderCommandStream & replayed = renderer.commandStream ();
+	ASSERT_EQ (recorded.size () - 2, replayed.size ()); // No uploads on replay.
+	EXPECT_EQ (recordedStats.drawCalls, renderer.frameStats ().drawCalls);
+	EXPECT_EQ (recordedStats.instances, renderer.frameStats ().instances);
+	EXPECT_EQ (recordedStats.stateChanges, renderer.frameStats ().stateChanges);
+}
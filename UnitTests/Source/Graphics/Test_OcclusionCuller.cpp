@@ -0,0 +1,238 @@
+//
+// Test_OcclusionCuller.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Graphics/OcclusionCuller.hpp"
+
+
+namespace
+{
+	const uint WIDTH = 128;
+	const uint HEIGHT = 64;
+
+	/// Front facing square in the xy-plane at the origin, spanning [-1, 1].
+	struct Quad {
+		Vertex vertices[4];
+		Index indices[6];
+		MeshComponent mesh;
+
+		Quad ()
+		{
+			const float corners[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+			for (uint i (0); i < 4; ++i) {
+				vertices[i] = {{corners[i][0], corners[i][1], 0.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 0.0f}};
+			}
+			const Index quadIndices[6] = {0, 1, 2, 0, 2, 3};
+			std::copy (quadIndices, quadIndices + 6, indices);
+			mesh = {4, 6, vertices, indices};
+		}
+	};
+
+	/// Camera at the origin looking down +z.
+	Matrix4 makeViewProjection ()
+	{
+		return math::perspectiveFovLH (1.5707963f, float (WIDTH) / HEIGHT, 1.0f, 1000.0f);
+	}
+
+	BoundingBox makeBox (
+		float x,
+		float y,
+		float z,
+		float halfSize
+	) {
+		return {{x - halfSize, y - halfSize, z - halfSize}, {x + halfSize, y + halfSize, z + halfSize}};
+	}
+
+	/// Wall of the given half size centered on the view axis at depth z.
+	Matrix4 makeWall (
+		float halfSize,
+		float z
+	) {
+		return math::multiply (math::scaling (halfSize, halfSize, 1.0f), math::translation (0.0f, 0.0f, z));
+	}
+}
+
+
+class OcclusionCullerTest : public ::testing::Test {
+protected:
+	JobSystem jobSystem;
+	OcclusionCuller culler;
+	Quad quad;
+
+	OcclusionCullerTest ()
+		: jobSystem (3),
+		  culler (WIDTH, HEIGHT, jobSystem)
+	{
+		culler.begin (makeViewProjection ());
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (OcclusionCullerTest, nothing_is_occluded_without_occluders)
+{
+	culler.rasterizeOccluders ();
+
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 50.0f, 1.0f)));
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 999.0f, 0.1f)));
+	EXPECT_EQ (0u, culler.stats ().occluderTriangles);
+}
+
+TEST_F (OcclusionCullerTest, rasterizes_occluder_depth)
+{
+	culler.addOccluder (quad.mesh, makeWall (10.0f, 20.0f));
+	culler.rasterizeOccluders ();
+
+	EXPECT_EQ (2u, culler.stats ().occluderTriangles);
+
+	// The wall covers the center of the screen, but not its corners.
+	const float * depth = culler.depthBuffer ();
+	EXPECT_LT (depth[(HEIGHT / 2) * WIDTH + WIDTH / 2], 1.0f);
+	EXPECT_EQ (1.0f, depth[0]);
+	EXPECT_EQ (1.0f, depth[HEIGHT * WIDTH - 1]);
+}
+
+TEST_F (OcclusionCullerTest, culls_boxes_hidden_behind_occluder)
+{
+	culler.addOccluder (quad.mesh, makeWall (10.0f, 20.0f));
+	culler.rasterizeOccluders ();
+
+	EXPECT_TRUE (culler.isOccluded (makeBox (0.0f, 0.0f, 40.0f, 2.0f)));
+	EXPECT_TRUE (culler.isOccluded (makeBox (5.0f, -5.0f, 100.0f, 5.0f)));
+
+	// In front of the wall.
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 10.0f, 2.0f)));
+	// Straddling the wall.
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 20.0f, 2.0f)));
+	// Behind the wall, but extending past its silhouette.
+	EXPECT_FALSE (culler.isOccluded (makeBox (24.0f, 0.0f, 40.0f, 4.0f)));
+	// Reaching behind the camera.
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 0.0f, 2.0f)));
+}
+
+TEST_F (OcclusionCullerTest, back_faces_do_not_occlude)
+{
+	// Rotating the wall half a turn about the y-axis turns it away from the camera.
+	culler.addOccluder (quad.mesh,
+		math::multiply (math::rotationY (3.14159265f), makeWall (10.0f, 20.0f)));
+	culler.rasterizeOccluders ();
+
+	EXPECT_EQ (0u, culler.stats ().occluderTriangles);
+	EXPECT_FALSE (culler.isOccluded (makeBox (0.0f, 0.0f, 40.0f, 2.0f)));
+}
+
+TEST_F (OcclusionCullerTest, cull_compacts_visible_candidates_and_reports_stats)
+{
+	culler.addOccluder (quad.mesh, makeWall (10.0f, 20.0f));
+	culler.rasterizeOccluders ();
+
+	std::mt19937 rng (7);
+	std::uniform_real_distribution<float> position (-30.0f, 30.0f);
+	std::uniform_real_distribution<float> depth (5.0f, 100.0f);
+
+	std::vector<BoundingBox> boxes;
+	for (uint i (0); i < 5000; ++i) {
+		boxes.push_back (makeBox (position (rng), position (rng), depth (rng), 0.5f));
+	}
+
+	// Test every other box, in place.
+	std::vector<uint32> candidates;
+	std::vector<uint32> expected;
+	for (uint32 i (0); i < boxes.size (); i += 2) {
+		candidates.push_back (i);
+		if (!culler.isOccluded (boxes[i])) {
+			expected.push_back (i);
+		}
+	}
+
+	const uint32 tested = uint32 (candidates.size ());
+	candidates.resize (culler.cull (boxes.data (), candidates.data (), tested, candidates.data ()));
+
+	EXPECT_EQ (expected, candidates);
+	EXPECT_LT (expected.size (), tested);
+
+	const OcclusionStats & stats = culler.stats ();
+	EXPECT_EQ (tested, stats.occludeesTested);
+	EXPECT_EQ (tested - expected.size (), stats.occludeesCulled);
+	EXPECT_FLOAT_EQ (100.0f * stats.occludeesCulled / tested, stats.culledPercentage);
+}
+
+TEST_F (OcclusionCullerTest, output_is_independent_of_thread_count)
+{
+	JobSystem serialJobSystem (0);
+	OcclusionCuller serialCuller (WIDTH, HEIGHT, serialJobSystem);
+	serialCuller.begin (makeViewProjection ());
+
+	const Matrix4 walls[2] = {
+		makeWall (10.0f, 20.0f),
+		math::multiply (math::rotationY (0.5f), math::translation (-15.0f, 3.0f, 30.0f))
+	};
+	for (const Matrix4 & wall : walls) {
+		culler.addOccluder (quad.mesh, wall);
+		serialCuller.addOccluder (quad.mesh, wall);
+	}
+	culler.rasterizeOccluders ();
+	serialCuller.rasterizeOccluders ();
+
+	const std::vector<float> threaded (culler.depthBuffer (), culler.depthBuffer () + WIDTH * HEIGHT);
+	const std::vector<float> serial (serialCuller.depthBuffer (), serialCuller.depthBuffer () + WIDTH * HEIGHT);
+	EXPECT_EQ (serial, threaded);
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (OcclusionCullerBenchmark, DISABLED_asteroid_field_behind_capital_ship)
+{
+	const uint NUM_ASTEROIDS = 100000;
+	const uint NUM_FRAMES = 100;
+
+	JobSystem jobSystem (JobSystem::DefaultWorkerThreadCount ());
+	OcclusionCuller culler (256, 128, jobSystem);
+	Quad quad;
+
+	// Hull plates of a capital ship, spread across the middle of the view.
+	std::vector<Matrix4> hullPlates;
+	for (int i (-4); i <= 4; ++i) {
+		hullPlates.push_back (math::multiply (
+			math::multiply (math::scaling (6.0f, 4.0f, 1.0f), math::rotationY (0.1f * i)),
+			math::translation (i * 11.0f, 0.0f, 60.0f + 2.0f * (i * i))));
+	}
+
+	std::mt19937 rng (1);
+	std::uniform_real_distribution<float> lateral (-150.0f, 150.0f);
+	std::uniform_real_distribution<float> depth (20.0f, 400.0f);
+	std::vector<BoundingBox> boxes;
+	for (uint i (0); i < NUM_ASTEROIDS; ++i) {
+		const float z = depth (rng);
+		boxes.push_back (makeBox (lateral (rng) * z / 400.0f, lateral (rng) * z / 800.0f, z, 0.5f));
+	}
+	std::vector<uint32> visible (NUM_ASTEROIDS);
+
+	OcclusionStats total = {};
+	for (uint frame (0); frame < NUM_FRAMES; ++frame) {
+		culler.begin (makeViewProjection ());
+		for (const Matrix4 & plate : hullPlates) {
+			culler.addOccluder (quad.mesh, plate);
+		}
+		culler.rasterizeOccluders ();
+
+		for (uint32 i (0); i < NUM_ASTEROIDS; ++i) {
+			visible[i] = i;
+		}
+		culler.cull (boxes.data (), visible.data (), NUM_ASTEROIDS, visible.data ());
+
+		total.rasterizeMilliseconds += culler.stats ().rasterizeMilliseconds;
+		total.testMilliseconds += culler.stats ().testMilliseconds;
+		total.culledPercentage = culler.stats ().culledPercentage;
+	}
+
+	std::printf ("%u occludees, %u threads: %.1f%% culled, %.3f ms rasterize, %.3f ms test per frame\n",
+		NUM_ASTEROIDS, jobSystem.threadCount (), total.culledPercentage,
+		total.rasterizeMilliseconds / NUM_FRAMES, total.testMilliseconds / NUM_FRAMES);
+}
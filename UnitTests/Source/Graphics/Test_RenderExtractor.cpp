@@ -0,0 +1,158 @@
+//
+// Test_RenderExtractor.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Engine/Source/Core/GameObject.hpp"
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Graphics/NullRenderer.hpp"
+#include "Engine/Source/Graphics/RenderExtractor.hpp"
+#include "Engine/Source/Graphics/RenderQueue.hpp"
+
+
+class RenderExtractorTest : public ::testing::Test {
+protected:
+	static const uint NUM_MESHES = 3;
+	static const uint NUM_MATERIALS = 2;
+
+	std::vector<byte> backingStore;
+	std::unique_ptr<FrameAllocator> frameAllocator;
+	JobSystem jobSystem;
+	RenderQueue queue;
+	RenderExtractor extractor;
+	NullRenderer renderer;
+
+	Vertex vertices[4];
+	Index indices[6];
+	MeshComponent meshes[NUM_MESHES];
+	Material materials[NUM_MATERIALS];
+
+	RenderExtractorTest ()
+		: backingStore (1 << 22),
+		  frameAllocator (new FrameAllocator (backingStore.data (), backingStore.size ())),
+		  jobSystem (1),
+		  queue (jobSystem)
+	{
+		for (auto & mesh : meshes) {
+			mesh = {4, 6, vertices, indices};
+		}
+		for (auto & material : materials) {
+			material.shaderGroup.vertexShader = AssetHandle<CompiledShader>::MakeReady ();
+			material.shaderGroup.pixelShader = AssetHandle<CompiledShader>::MakeReady ();
+		}
+		renderer.initialize (nullptr);
+	}
+
+	/// Objects cycle through every (mesh, material) pair, spaced along the x-axis.
+	std::vector<GameObject> makeObjects (
+		uint count
+	) {
+		std::vector<GameObject> objects (count);
+		for (uint i (0); i < count; ++i) {
+			objects[i].position[0] = float (i);
+			objects[i].position[1] = 0.0f;
+			objects[i].position[2] = 0.0f;
+			objects[i].render.mesh = &meshes[i % NUM_MESHES];
+			objects[i].render.material = &materials[(i / NUM_MESHES) % NUM_MATERIALS];
+		}
+		return objects;
+	}
+
+	uint32 extract (
+		const std::vector<GameObject> & objects,
+		const uint32 * visibleIndices,
+		uint32 count
+	) {
+		frameAllocator->nextFrame ();
+		queue.begin (*frameAllocator, count);
+		return extractor.extract (objects.data (), visibleIndices, count, *frameAllocator, queue);
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (RenderExtractorTest, draw_calls_collapse_to_unique_mesh_material_pairs)
+{
+	for (uint count : {1u, 4u, 6u, 100u, 10000u}) {
+		const std::vector<GameObject> objects = makeObjects (count);
+		const uint32 drawCalls = extract (objects, nullptr, count);
+		queue.sort ();
+		queue.submit (renderer);
+		renderer.render ();
+
+		const uint32 expectedDrawCalls = std::min (count, NUM_MESHES * NUM_MATERIALS);
+		const RenderStats & stats = renderer.frameStats ();
+		EXPECT_EQ (expectedDrawCalls, drawCalls) << count;
+		EXPECT_EQ (expectedDrawCalls, stats.drawCalls) << count;
+		EXPECT_EQ (count, stats.instances) << count;
+		EXPECT_EQ (count * 2u, stats.triangles) << count;
+	}
+}
+
+TEST_F (RenderExtractorTest, uploads_instance_data_once_per_object)
+{
+	const std::vector<GameObject> objects = makeObjects (60);
+	extract (objects, nullptr, 60);
+	queue.submit (renderer);
+	renderer.render ();
+
+	// Every mesh is uploaded on first use, alongside the instance data of every object.
+	uint64 instanceBytes = 0;
+	for (const RenderCommand & command : renderer.commandStream ()) {
+		if (command.type == RenderCommandType::UploadInstances) {
+			instanceBytes += command.byteCount;
+		}
+	}
+	EXPECT_EQ (60u * sizeof (InstanceData), instanceBytes);
+}
+
+TEST_F (RenderExtractorTest, instances_are_contiguous_per_group)
+{
+	const std::vector<GameObject> objects = makeObjects (12);
+	extract (objects, nullptr, 12);
+
+	ASSERT_EQ (6u, queue.size ());
+	ASSERT_EQ (12u, extractor.instanceCount ());
+
+	// Groups are ordered by first object, so the first group holds objects 0 and 6.
+	const DrawCall & first = queue.drawCall (0);
+	EXPECT_EQ (&meshes[0], first.mesh);
+	EXPECT_EQ (&materials[0], first.material);
+	EXPECT_EQ (2u, first.instanceCount);
+	EXPECT_EQ (0u, first.firstInstance);
+	EXPECT_EQ (extractor.instances (), first.instances);
+	EXPECT_EQ (0.0f, first.instances[0].world[3][0]);
+	EXPECT_EQ (6.0f, first.instances[1].world[3][0]);
+
+	uint32 expectedFirstInstance = 0;
+	for (uint32 i (0); i < queue.size (); ++i) {
+		const DrawCall & drawCall = queue.drawCall (i);
+		EXPECT_EQ (expectedFirstInstance, drawCall.firstInstance);
+		EXPECT_EQ (extractor.instances () + drawCall.firstInstance, drawCall.instances);
+		expectedFirstInstance += drawCall.instanceCount;
+	}
+	EXPECT_EQ (12u, expectedFirstInstance);
+}
+
+TEST_F (RenderExtractorTest, only_visible_objects_are_drawn)
+{
+	const std::vector<GameObject> objects = makeObjects (12);
+	const uint32 visible[3] = {7, 1, 4};
+	extract (objects, visible, 3);
+
+	// Objects 7 and 1 share mesh 1 and material 0, while object 4 uses material 1.
+	ASSERT_EQ (2u, queue.size ());
+	ASSERT_EQ (3u, extractor.instanceCount ());
+	EXPECT_EQ (&meshes[1], queue.drawCall (0).mesh);
+	EXPECT_EQ (&materials[0], queue.drawCall (0).material);
+	EXPECT_EQ (2u, queue.drawCall (0).instanceCount);
+	EXPECT_EQ (7.0f, extractor.instances ()[0].world[3][0]);
+	EXPECT_EQ (1.0f, extractor.instances ()[1].world[3][0]);
+	EXPECT_EQ (4.0f, extractor.instances ()[2].world[3][0]);
+}
@@ -0,0 +1,195 @@
+//
+// Test_RenderQueue.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Graphics/NullRenderer.hpp"
+#include "Engine/Source/Graphics/RenderQueue.hpp"
+
+
+class RenderQueueTest : public ::testing::Test {
+protected:
+	std::vector<byte> backingStore;
+	std::unique_ptr<FrameAllocator> frameAllocator;
+	JobSystem jobSystem;
+	RenderQueue queue;
+
+	MeshComponent meshes[4];
+	Material materials[4];
+
+	RenderQueueTest ()
+		: backingStore (1 << 20),
+		  frameAllocator (new FrameAllocator (backingStore.data (), backingStore.size ())),
+		  jobSystem (3),
+		  queue (jobSystem)
+	{
+		for (auto & mesh : meshes) {
+			mesh = {0, 3, nullptr, nullptr};
+		}
+
+		// Materials 0 and 1 share a pipeline, as do materials 2 and 3.
+		for (uint i (0); i < 4; i += 2) {
+			materials[i].shaderGroup.vertexShader = AssetHandle<CompiledShader>::MakeReady ();
+			materials[i].shaderGroup.pixelShader = AssetHandle<CompiledShader>::MakeReady ();
+			materials[i + 1].shaderGroup = materials[i].shaderGroup;
+		}
+	}
+
+	DrawCall makeDrawCall (
+		uint mesh,
+		uint material
+	) {
+		DrawCall drawCall;
+		drawCall.mesh = &meshes[mesh];
+		drawCall.material = &materials[material];
+		return drawCall;
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (RenderQueueTest, orders_by_layer_then_pass)
+{
+	queue.begin (*frameAllocator, 16);
+	queue.push (makeDrawCall (0, 0), RenderLayer::Overlay, RenderPass::Opaque, 0.0f);
+	queue.push (makeDrawCall (1, 0), RenderLayer::World, RenderPass::Transparent, 0.0f);
+	queue.push (makeDrawCall (2, 0), RenderLayer::World, RenderPass::Opaque, 1.0f);
+	queue.sort ();
+
+	ASSERT_EQ (3u, queue.size ());
+	EXPECT_EQ (&meshes[2], queue.drawCall (0).mesh);
+	EXPECT_EQ (&meshes[1], queue.drawCall (1).mesh);
+	EXPECT_EQ (&meshes[0], queue.drawCall (2).mesh);
+}
+
+TEST_F (RenderQueueTest, opaque_groups_state_then_sorts_front_to_back)
+{
+	queue.begin (*frameAllocator, 16);
+	queue.push (makeDrawCall (0, 2), RenderLayer::World, RenderPass::Opaque, 0.1f);
+	queue.push (makeDrawCall (1, 0), RenderLayer::World, RenderPass::Opaque, 0.9f);
+	queue.push (makeDrawCall (2, 2), RenderLayer::World, RenderPass::Opaque, 0.05f);
+	queue.push (makeDrawCall (3, 0), RenderLayer::World, RenderPass::Opaque, 0.5f);
+	queue.sort ();
+
+	// Material 2 was seen first, so its pipeline and material sort first.
+	EXPECT_EQ (&meshes[2], queue.drawCall (0).mesh);
+	EXPECT_EQ (&meshes[0], queue.drawCall (1).mesh);
+	EXPECT_EQ (&meshes[3], queue.drawCall (2).mesh);
+	EXPECT_EQ (&meshes[1], queue.drawCall (3).mesh);
+}
+
+TEST_F (RenderQueueTest, assigns_identifiers_afresh_each_frame)
+{
+	queue.begin (*frameAllocator, 16);
+	queue.push (makeDrawCall (0, 2), RenderLayer::World, RenderPass::Opaque, 0.0f);
+	queue.push (makeDrawCall (1, 0), RenderLayer::World, RenderPass::Opaque, 0.0f);
+	EXPECT_EQ (RenderQueue::MakeSortKey (RenderLayer::World, RenderPass::Opaque, 1, 1, 0.0f),
+		queue.sortKey (1));
+
+	// Material 0 is seen first this frame, even though its shaders were reloaded.
+	materials[0].shaderGroup.vertexShader = AssetHandle<CompiledShader>::MakeReady ();
+	queue.begin (*frameAllocator, 16);
+	queue.push (makeDrawCall (1, 0), RenderLayer::World, RenderPass::Opaque, 0.0f);
+	queue.push (makeDrawCall (0, 1), RenderLayer::World, RenderPass::Opaque, 0.0f);
+	EXPECT_EQ (RenderQueue::MakeSortKey (RenderLayer::World, RenderPass::Opaque, 0, 0, 0.0f),
+		queue.sortKey (0));
+
+	// Material 1 no longer shares material 0's pipeline.
+	EXPECT_EQ (RenderQueue::MakeSortKey (RenderLayer::World, RenderPass::Opaque, 1, 1, 0.0f),
+		queue.sortKey (1));
+}
+
+TEST_F (RenderQueueTest, transparent_sorts_back_to_front)
+{
+	queue.begin (*frameAllocator, 16);
+	queue.push (makeDrawCall (0, 0), RenderLayer::World, RenderPass::Transparent, 0.2f);
+	queue.push (makeDrawCall (1, 3), RenderLayer::World, RenderPass::Transparent, 0.8f);
+	queue.push (makeDrawCall (2, 1), RenderLayer::World, RenderPass::Transparent, 0.5f);
+	queue.sort ();
+
+	EXPECT_EQ (&meshes[1], queue.drawCall (0).mesh);
+	EXPECT_EQ (&meshes[2], queue.drawCall (1).mesh);
+	EXPECT_EQ (&meshes[0], queue.drawCall (2).mesh);
+}
+
+TEST_F (RenderQueueTest, sort_key_fields_do_not_overlap)
+{
+	const uint64 all = RenderQueue::MakeSortKey (
+		RenderLayer (0xF), RenderPass::Opaque, 0xFFF, 0xFFFF, 1.0f);
+	EXPECT_EQ (0xF0FFFFFFFFFFFFF0ull, all);
+
+	EXPECT_EQ (0ull, RenderQueue::MakeSortKey (
+		RenderLayer::World, RenderPass::Opaque, 0, 0, 0.0f));
+	EXPECT_EQ (0x000000000FFFFFF0ull, RenderQueue::MakeSortKey (
+		RenderLayer::World, RenderPass::Opaque, 0, 0, 1.0f));
+}
+
+TEST_F (RenderQueueTest, sorting_reduces_state_changes)
+{
+	std::mt19937 random (42);
+	const uint32 numDraws = 1000;
+
+	queue.begin (*frameAllocator, numDraws);
+	for (uint32 i (0); i < numDraws; ++i) {
+		const uint object = random () % 4;
+		queue.push (makeDrawCall (object, object),
+			RenderLayer::World, RenderPass::Opaque, (random () % 1000) / 1000.0f);
+	}
+
+	NullRenderer renderer;
+	renderer.initialize (nullptr);
+
+	queue.submit (renderer);
+	renderer.render ();
+	const uint32 unsortedStateChanges = renderer.frameStats ().stateChanges;
+
+	queue.sort ();
+	queue.submit (renderer);
+	renderer.render ();
+	const uint32 sortedStateChanges = renderer.frameStats ().stateChanges;
+
+	EXPECT_EQ (numDraws, renderer.frameStats ().drawCalls);
+	EXPECT_LT (sortedStateChanges, unsortedStateChanges / 10);
+}
+
+TEST_F (RenderQueueTest, submits_one_draw_per_queued_draw_call)
+{
+	const uint32 numDraws = 12;
+	queue.begin (*frameAllocator, numDraws);
+	for (uint32 i (0); i < numDraws; ++i) {
+		DrawCall drawCall = makeDrawCall (i % 4, i % 3);
+		drawCall.instanceCount = i + 1;
+		drawCall.firstInstance = i * 100;
+		queue.push (drawCall, RenderLayer::World, RenderPass::Opaque, i / float (numDraws));
+	}
+	queue.sort ();
+
+	NullRenderer renderer;
+	renderer.initialize (nullptr);
+	queue.submit (renderer);
+	renderer.render ();
+
+	// Each draw keeps its mesh's index count and its own instance range.
+	uint32 recorded = 0;
+	for (const RenderCommand & command : renderer.commandStream ()) {
+		if (command.type != RenderCommandType::DrawIndexed) {
+			continue;
+		}
+
+		ASSERT_LT (recorded, queue.size ());
+		const DrawCall & drawCall = queue.drawCall (recorded);
+		EXPECT_EQ (drawCall.mesh->numIndices, command.indexCount);
+		EXPECT_EQ (drawCall.instanceCount, command.instanceCount);
+		EXPECT_EQ (drawCall.firstInstance, command.firstInstance);
+		++recorded;
+	}
+	EXPECT_EQ (numDraws, recorded);
+	EXPECT_EQ (numDraws, renderer.frameStats ().drawCalls);
+}
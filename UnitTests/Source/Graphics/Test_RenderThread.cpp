@@ -0,0 +1,233 @@
+//
+// Test_RenderThread.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Graphics/RenderQueue.hpp"
+#include "Engine/Source/Graphics/RenderThread.hpp"
+
+
+namespace
+{
+	/// Records the draw calls of each rendered frame, optionally holding render() until
+	/// released.
+	class RecordingRenderer : public IRenderer {
+	public:
+		std::vector<std::vector<DrawCall>> frames;
+		std::vector<DrawCall> pending;
+		std::atomic<uint> presentCount;
+
+		std::mutex mutex;
+		std::condition_variable released;
+		bool blocked;
+
+		RecordingRenderer ()
+			: presentCount (0),
+			  blocked (false)
+		{
+
+		}
+
+		void initialize (HWND) override { }
+
+		void submit (const DrawCall & drawCall) override
+		{
+			pending.push_back (drawCall);
+		}
+
+		void render () override
+		{
+			std::unique_lock<std::mutex> lock (mutex);
+			released.wait (lock, [this] { return !blocked; });
+			frames.push_back (pending);
+			pending.clear ();
+		}
+
+		void present () override
+		{
+			++presentCount;
+		}
+
+		void block ()
+		{
+			std::lock_guard<std::mutex> lock (mutex);
+			blocked = true;
+		}
+
+		void release ()
+		{
+			{
+				std::lock_guard<std::mutex> lock (mutex);
+				blocked = false;
+			}
+			released.notify_all ();
+		}
+	};
+
+	/// Renderer that spends a fixed time rendering each frame.
+	class SlowRenderer : public IRenderer {
+	public:
+		explicit SlowRenderer (std::chrono::microseconds frameTime) : frameTime (frameTime) { }
+
+		void initialize (HWND) override { }
+		void submit (const DrawCall &) override { }
+		void render () override { std::this_thread::sleep_for (frameTime); }
+		void present () override { }
+
+		std::chrono::microseconds frameTime;
+	};
+}
+
+
+class RenderThreadTest : public ::testing::Test {
+protected:
+	JobSystem jobSystem;
+	RenderQueue queue;
+	MeshComponent meshes[4];
+	Material material;
+
+	RenderThreadTest ()
+		: jobSystem (0),
+		  queue (jobSystem),
+		  material ()
+	{
+		for (auto & mesh : meshes) {
+			mesh = {0, 3, nullptr, nullptr};
+		}
+	}
+
+	/// Fills packet with count draw calls of successive meshes.
+	void buildPacket (
+		RenderPacket & packet,
+		uint32 count
+	) {
+		queue.begin (packet.allocator (), count);
+		for (uint32 i (0); i < count; ++i) {
+			DrawCall drawCall;
+			drawCall.mesh = &meshes[i % 4];
+			drawCall.material = &material;
+			queue.push (drawCall, RenderLayer::World, RenderPass::Opaque, 0.1f * i);
+		}
+		queue.sort ();
+		packet.setDrawCalls (queue);
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (RenderThreadTest, renders_packets_in_submission_order)
+{
+	RecordingRenderer renderer;
+	RenderThread renderThread (renderer, 65536);
+
+	for (uint32 frame (0); frame < 10; ++frame) {
+		RenderPacket & packet = renderThread.beginPacket ();
+		EXPECT_EQ (frame, packet.frameNumber ());
+		EXPECT_EQ (0u, packet.drawCallCount ());
+
+		buildPacket (packet, frame % 4);
+		renderThread.submitPacket ();
+	}
+	renderThread.flush ();
+
+	EXPECT_EQ (10u, renderThread.framesRendered ());
+	EXPECT_EQ (10u, renderer.presentCount.load ());
+	ASSERT_EQ (10u, renderer.frames.size ());
+	for (uint32 frame (0); frame < 10; ++frame) {
+		ASSERT_EQ (frame % 4, renderer.frames[frame].size ());
+		for (uint32 i (0); i < frame % 4; ++i) {
+			EXPECT_EQ (&meshes[i], renderer.frames[frame][i].mesh);
+		}
+	}
+}
+
+TEST_F (RenderThreadTest, begin_packet_blocks_once_every_packet_is_in_flight)
+{
+	RecordingRenderer renderer;
+	RenderThread renderThread (renderer, 65536);
+
+	// Hold the render thread within the first frame.
+	renderer.block ();
+	for (uint i (0); i < RenderThread::NUM_PACKETS; ++i) {
+		buildPacket (renderThread.beginPacket (), 1);
+		renderThread.submitPacket ();
+	}
+
+	std::atomic<bool> begun (false);
+	std::thread simulation ([&] {
+		renderThread.beginPacket ();
+		begun = true;
+		renderThread.submitPacket ();
+	});
+
+	std::this_thread::sleep_for (std::chrono::milliseconds (20));
+	EXPECT_FALSE (begun.load ());
+
+	renderer.release ();
+	simulation.join ();
+	EXPECT_TRUE (begun.load ());
+
+	renderThread.flush ();
+	EXPECT_EQ (RenderThread::NUM_PACKETS + 1, renderThread.framesRendered ());
+}
+
+TEST_F (RenderThreadTest, destruction_renders_submitted_packets)
+{
+	RecordingRenderer renderer;
+	{
+		RenderThread renderThread (renderer, 65536);
+		for (uint i (0); i < 5; ++i) {
+			buildPacket (renderThread.beginPacket (), 2);
+			renderThread.submitPacket ();
+		}
+	}
+
+	EXPECT_EQ (5u, renderer.frames.size ());
+	EXPECT_EQ (5u, renderer.presentCount.load ());
+}
+
+// Run with --gtest_also_run_disabled_tests to compare serial and pipelined frame times.
+TEST (RenderThreadBenchmark, DISABLED_pipelined_frame_time)
+{
+	const uint NUM_FRAMES = 100;
+	const auto simulationTime = std::chrono::microseconds (4000);
+	const auto renderTime = std::chrono::microseconds (3000);
+
+	SlowRenderer renderer (renderTime);
+
+	auto start = std::chrono::high_resolution_clock::now ();
+	for (uint frame (0); frame < NUM_FRAMES; ++frame) {
+		std::this_thread::sleep_for (simulationTime);
+		renderer.render ();
+		renderer.present ();
+	}
+	const std::chrono::duration<double, std::milli> serial =
+		std::chrono::high_resolution_clock::now () - start;
+
+	{
+		RenderThread renderThread (renderer);
+		start = std::chrono::high_resolution_clock::now ();
+		for (uint frame (0); frame < NUM_FRAMES; ++frame) {
+			renderThread.beginPacket ();
+			std::this_thread::sleep_for (simulationTime);
+			renderThread.submitPacket ();
+		}
+		renderThread.flush ();
+	}
+	const std::chrono::duration<double, std::milli> pipelined =
+		std::chrono::high_resolution_clock::now () - start;
+
+	std::printf ("simulate %.1f ms, render %.1f ms: serial %.2f ms, pipelined %.2f ms per frame\n",
+		simulationTime.count () / 1000.0, renderTime.count () / 1000.0,
+		serial.count () / NUM_FRAMES, pipelined.count () / NUM_FRAMES);
+}
@@ -0,0 +1,390 @@
+//
+// Test_SoftwareRenderer.cpp
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Engine/Source/Core/JobSystem.hpp"
+#include "Engine/Source/Core/Memory.hpp"
+#include "Engine/Source/Core/ObjParser.hpp"
+#include "Engine/Source/Graphics/SoftwareRenderer.hpp"
+
+
+namespace
+{
+	const uint WIDTH = 128;
+	const uint HEIGHT = 128;
+
+	// Relative to the UnitTests project directory, where the tests are run from.
+	const char * SHIP_OBJ_PATH = "../Game/Assets/Meshes/low_poly_ship.obj";
+
+	// Reference image of the ship, written by the golden image test when it is missing.
+	const char * SHIP_GOLDEN_PATH = "Data/SoftwareRenderer_low_poly_ship.ppm";
+
+	// Largest difference in any channel of a pixel matching the reference, and the
+	// share of pixels allowed to differ by more, from floating point differences
+	// between compilers along triangle edges.
+	const int GOLDEN_CHANNEL_TOLERANCE = 2;
+	const double GOLDEN_MISMATCH_TOLERANCE = 0.01;
+
+	/// Axis-aligned square in the xy-plane at depth z, spanning [-halfSize, halfSize].
+	struct Quad {
+		Vertex vertices[4];
+		Index indices[6];
+		MeshComponent mesh;
+
+		Quad (
+			float halfSize,
+			float z,
+			bool frontFacing = true
+		) {
+			const float corners[4][2] = {
+				{-halfSize, -halfSize}, {halfSize, -halfSize},
+				{halfSize, halfSize}, {-halfSize, halfSize}
+			};
+			for (uint i (0); i < 4; ++i) {
+				vertices[i] = {{corners[i][0], corners[i][1], z}, {0.0f, 0.0f, -1.0f}, {0.0f, 0.0f}};
+			}
+
+			// Counter-clockwise winding is front facing.
+			const Index front[6] = {0, 1, 2, 0, 2, 3};
+			const Index back[6] = {0, 2, 1, 0, 3, 2};
+			for (uint i (0); i < 6; ++i) {
+				indices[i] = frontFacing ? front[i] : back[i];
+			}
+
+			mesh = {4, 6, vertices, indices};
+		}
+	};
+
+	/// UV sphere centered at the origin with unit radius.
+	struct Sphere {
+		std::vector<Vertex> vertices;
+		std::vector<Index> indices;
+		MeshComponent mesh;
+
+		Sphere (
+			uint rings,
+			uint segments
+		) {
+			const float pi = 3.14159265f;
+			for (uint r (0); r <= rings; ++r) {
+				const float phi = pi * r / rings;
+				for (uint s (0); s <= segments; ++s) {
+					const float theta = 2.0f * pi * s / segments;
+					const float p[3] = {
+						std::sin (phi) * std::cos (theta), std::cos (phi), std::sin (phi) * std::sin (theta)
+					};
+					vertices.push_back ({{p[0], p[1], p[2]}, {p[0], p[1], p[2]},
+						{float (s) / segments, float (r) / rings}});
+				}
+			}
+			for (uint r (0); r < rings; ++r) {
+				for (uint s (0); s < segments; ++s) {
+					const Index i0 = Index (r * (segments + 1) + s);
+					const Index i1 = Index (i0 + segments + 1);
+					const Index quad[6] = {i0, Index (i0 + 1), i1, Index (i0 + 1), Index (i1 + 1), i1};
+					indices.insert (indices.end (), quad, quad + 6);
+				}
+			}
+			mesh = {uint32 (vertices.size ()), uint32 (indices.size ()),
+				vertices.data (), indices.data ()};
+		}
+	};
+
+	DrawCall makeDrawCall (
+		const MeshComponent & mesh,
+		const Material & material
+	) {
+		DrawCall drawCall;
+		drawCall.mesh = &mesh;
+		drawCall.material = &material;
+		return drawCall;
+	}
+
+	/// Red, green and blue bytes of each pixel of an RGBA8 color buffer.
+	std::vector<byte> toRgb (
+		const uint32 * colorBuffer,
+		uint numPixels
+	) {
+		std::vector<byte> rgb;
+		for (uint i (0); i < numPixels; ++i) {
+			for (uint c (0); c < 3; ++c) {
+				rgb.push_back (static_cast<byte>(colorBuffer[i] >> (8 * c)));
+			}
+		}
+		return rgb;
+	}
+
+	/// Reads a binary PPM image of width by height pixels.  Returns false if there is
+	/// none at path, or it is of another size.
+	bool readPpm (
+		const char * path,
+		uint width,
+		uint height,
+		std::vector<byte> & rgb
+	) {
+		std::ifstream file (path, std::ios::in | std::ios::binary);
+		std::string magic;
+		uint fileWidth = 0;
+		uint fileHeight = 0;
+		uint maxValue = 0;
+		file >> magic >> fileWidth >> fileHeight >> maxValue;
+		file.get ();
+		if (!file || magic != "P6" || fileWidth != width || fileHeight != height) {
+			return false;
+		}
+
+		rgb.resize (width * height * 3);
+		return bool (file.read (reinterpret_cast<char *>(rgb.data ()), rgb.size ()));
+	}
+
+	void writePpm (
+		const char * path,
+		uint width,
+		uint height,
+		const std::vector<byte> & rgb
+	) {
+		std::ofstream file (path, std::ios::out | std::ios::binary | std::ios::trunc);
+		file << "P6\n" << width << " " << height << "\n255\n";
+		file.write (reinterpret_cast<const char *>(rgb.data ()), rgb.size ());
+	}
+
+	uint countPixelsWithDepth (
+		const SoftwareRenderer & renderer,
+		float depth
+	) {
+		uint count = 0;
+		const float * depthBuffer = renderer.depthBuffer ();
+		for (uint i (0); i < WIDTH * HEIGHT; ++i) {
+			count += depthBuffer[i] == depth;
+		}
+		return count;
+	}
+}
+
+
+class SoftwareRendererTest : public ::testing::Test {
+protected:
+	JobSystem jobSystem;
+	SoftwareRenderer renderer;
+	Material material;
+
+	SoftwareRendererTest ()
+		: jobSystem (3),
+		  renderer (WIDTH, HEIGHT, jobSystem),
+		  material ()
+	{
+		renderer.initialize (nullptr);
+	}
+};
+
+
+//---------------------------------------------------------------------------------------
+TEST_F (SoftwareRendererTest, empty_frame_clears_framebuffer)
+{
+	renderer.render ();
+
+	EXPECT_EQ (WIDTH * HEIGHT, countPixelsWithDepth (renderer, 1.0f));
+	EXPECT_EQ (renderer.colorBuffer ()[0], renderer.colorBuffer ()[WIDTH * HEIGHT - 1]);
+	EXPECT_EQ (0u, renderer.trianglesRasterized ());
+}
+
+TEST_F (SoftwareRendererTest, rasterizes_exact_pixel_coverage)
+{
+	// Covers pixels [32, 96) in both dimensions.
+	Quad quad (0.5f, 0.25f);
+	renderer.submit (makeDrawCall (quad.mesh, material));
+	renderer.render ();
+
+	EXPECT_EQ (2u, renderer.trianglesRasterized ());
+	EXPECT_EQ (64u * 64u, countPixelsWithDepth (renderer, 0.25f));
+
+	const float * depth = renderer.depthBuffer ();
+	EXPECT_EQ (1.0f, depth[31 * WIDTH + 31]);
+	EXPECT_EQ (0.25f, depth[32 * WIDTH + 32]);
+	EXPECT_EQ (0.25f, depth[95 * WIDTH + 95]);
+	EXPECT_EQ (1.0f, depth[96 * WIDTH + 96]);
+}
+
+TEST_F (SoftwareRendererTest, culls_back_faces)
+{
+	Quad quad (0.5f, 0.25f, false);
+	renderer.submit (makeDrawCall (quad.mesh, material));
+	renderer.render ();
+
+	EXPECT_EQ (0u, renderer.trianglesRasterized ());
+	EXPECT_EQ (WIDTH * HEIGHT, countPixelsWithDepth (renderer, 1.0f));
+}
+
+TEST_F (SoftwareRendererTest, depth_test_keeps_nearest_regardless_of_order)
+{
+	Quad nearQuad (0.25f, 0.2f);
+	Quad farQuad (0.5f, 0.6f);
+
+	renderer.submit (makeDrawCall (nearQuad.mesh, material));
+	renderer.submit (makeDrawCall (farQuad.mesh, material));
+	renderer.render ();
+	const uint nearFirst = countPixelsWithDepth (renderer, 0.2f);
+
+	renderer.submit (makeDrawCall (farQuad.mesh, material));
+	renderer.submit (makeDrawCall (nearQuad.mesh, material));
+	renderer.render ();
+	const uint nearLast = countPixelsWithDepth (renderer, 0.2f);
+
+	EXPECT_EQ (32u * 32u, nearFirst);
+	EXPECT_EQ (nearFirst, nearLast);
+	EXPECT_EQ (64u * 64u - 32u * 32u, countPixelsWithDepth (renderer, 0.6f));
+}
+
+TEST_F (SoftwareRendererTest, draws_each_instance_with_its_transform)
+{
+	// Two quads covering pixels [32, 64) and [64, 96) horizontally, at different depths.
+	Quad quad (0.25f, 0.0f);
+	const InstanceData instances[2] = {
+		{{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {-0.25f, 0.0f, 0.25f}}},
+		{{{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.25f, 0.0f, 0.5f}}}
+	};
+
+	DrawCall drawCall = makeDrawCall (quad.mesh, material);
+	drawCall.instanceCount = 2;
+	drawCall.instances = instances;
+	renderer.submit (drawCall);
+	renderer.render ();
+
+	EXPECT_EQ (4u, renderer.trianglesRasterized ());
+	EXPECT_EQ (32u * 32u, countPixelsWithDepth (renderer, 0.25f));
+	EXPECT_EQ (32u * 32u, countPixelsWithDepth (renderer, 0.5f));
+
+	const float * depth = renderer.depthBuffer ();
+	EXPECT_EQ (0.25f, depth[64 * WIDTH + 40]);
+	EXPECT_EQ (0.5f, depth[64 * WIDTH + 80]);
+}
+
+TEST_F (SoftwareRendererTest, output_is_independent_of_thread_count)
+{
+	Sphere sphere (16, 32);
+
+	const Matrix4 viewProjection = math::multiply (
+		math::translation (0.0f, 0.0f, 3.0f),
+		math::perspectiveFovLH (1.0f, 1.0f, 0.1f, 100.0f)
+	);
+
+	renderer.setViewProjection (viewProjection);
+	renderer.submit (makeDrawCall (sphere.mesh, material));
+	renderer.render ();
+	const std::vector<uint32> threaded (renderer.colorBuffer (), renderer.colorBuffer () + WIDTH * HEIGHT);
+
+	JobSystem serialJobSystem (0);
+	SoftwareRenderer serialRenderer (WIDTH, HEIGHT, serialJobSystem);
+	serialRenderer.setViewProjection (viewProjection);
+	serialRenderer.submit (makeDrawCall (sphere.mesh, material));
+	serialRenderer.render ();
+	const std::vector<uint32> serial (serialRenderer.colorBuffer (), serialRenderer.colorBuffer () + WIDTH * HEIGHT);
+
+	EXPECT_GT (renderer.trianglesRasterized (), 0u);
+	EXPECT_EQ (serial, threaded);
+}
+
+TEST_F (SoftwareRendererTest, renders_ship_like_golden_image)
+{
+	std::vector<char> text;
+	ASSERT_TRUE (ReadWholeFile (SHIP_OBJ_PATH, text));
+
+	std::vector<byte> storage (4 << 20);
+	LinearAllocator allocator (storage.data (), storage.size ());
+	MeshComponent ship;
+	ASSERT_TRUE (ParseObj (text.data (), text.size (), allocator, ship));
+
+	// Frame the ship's bounding box, turned to show its side.
+	float lower[3] = {1e30f, 1e30f, 1e30f};
+	float upper[3] = {-1e30f, -1e30f, -1e30f};
+	for (uint i (0); i < ship.numVertices; ++i) {
+		for (uint c (0); c < 3; ++c) {
+			lower[c] = std::min (lower[c], ship.vertices[i].position[c]);
+			upper[c] = std::max (upper[c], ship.vertices[i].position[c]);
+		}
+	}
+	float center[3];
+	float radiusSquared = 0.0f;
+	for (uint c (0); c < 3; ++c) {
+		center[c] = 0.5f * (lower[c] + upper[c]);
+		radiusSquared += 0.25f * (upper[c] - lower[c]) * (upper[c] - lower[c]);
+	}
+	const float radius = std::sqrt (radiusSquared);
+
+	renderer.setViewProjection (math::multiply (
+		math::multiply (
+			math::multiply (math::translation (-center[0], -center[1], -center[2]),
+				math::rotationY (0.6f)),
+			math::translation (0.0f, 0.0f, 2.0f * radius)
+		),
+		math::perspectiveFovLH (1.0f, 1.0f, 0.1f, 100.0f)
+	));
+	renderer.submit (makeDrawCall (ship, material));
+	renderer.render ();
+	const std::vector<byte> rgb = toRgb (renderer.colorBuffer (), WIDTH * HEIGHT);
+	allocator.reset ();
+
+	EXPECT_GT (renderer.trianglesRasterized (), 0u);
+	EXPECT_LT (countPixelsWithDepth (renderer, 1.0f), WIDTH * HEIGHT);
+
+	std::vector<byte> golden;
+	if (!readPpm (SHIP_GOLDEN_PATH, WIDTH, HEIGHT, golden)) {
+		writePpm (SHIP_GOLDEN_PATH, WIDTH, HEIGHT, rgb);
+		FAIL () << "No reference image, wrote " << SHIP_GOLDEN_PATH << " to be checked in";
+	}
+
+	uint mismatches = 0;
+	for (uint i (0); i < WIDTH * HEIGHT; ++i) {
+		for (uint c (0); c < 3; ++c) {
+			if (std::abs (int (rgb[3 * i + c]) - int (golden[3 * i + c])) > GOLDEN_CHANNEL_TOLERANCE) {
+				++mismatches;
+				break;
+			}
+		}
+	}
+	EXPECT_LE (mismatches, uint (GOLDEN_MISMATCH_TOLERANCE * WIDTH * HEIGHT));
+}
+
+// Run with --gtest_also_run_disabled_tests to report throughput.
+TEST (SoftwareRendererBenchmark, DISABLED_sphere_frames_per_second)
+{
+	const uint width = 1024;
+	const uint height = 768;
+	const uint frames = 100;
+
+	JobSystem jobSystem (JobSystem::DefaultWorkerThreadCount ());
+	SoftwareRenderer renderer (width, height, jobSystem);
+	Material material = {};
+	Sphere sphere (128, 256);
+
+	DrawCall drawCall;
+	drawCall.mesh = &sphere.mesh;
+	drawCall.material = &material;
+
+	auto start = std::chrono::high_resolution_clock::now ();
+	for (uint frame (0); frame < frames; ++frame) {
+		renderer.setViewProjection (math::multiply (
+			math::multiply (math::rotationY (0.01f * frame), math::translation (0.0f, 0.0f, 2.5f)),
+			math::perspectiveFovLH (1.0f, float (width) / height, 0.1f, 100.0f)
+		));
+		renderer.submit (drawCall);
+		renderer.render ();
+	}
+	auto end = std::chrono::high_resolution_clock::now ();
+
+	const double seconds = std::chrono::duration<double> (end - start).count ();
+	std::printf ("%u threads, %u triangles: %.1f fps (%.2f ms)\n",
+		jobSystem.threadCount (), sphere.mesh.numIndices / 3, frames / seconds,
+		1000.0 * seconds / frames);
+}